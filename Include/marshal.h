@@ -7,7 +7,7 @@
 extern "C" {
 #endif
 
-#define Py_MARSHAL_VERSION 4
+#define Py_MARSHAL_VERSION 6
 
 PyAPI_FUNC(void) PyMarshal_WriteLongToFile(long, FILE *, int);
 PyAPI_FUNC(void) PyMarshal_WriteObjectToFile(PyObject *, FILE *, int);
@@ -18,6 +18,14 @@ PyAPI_FUNC(long) PyMarshal_ReadLongFromFile(FILE *);
 PyAPI_FUNC(int) PyMarshal_ReadShortFromFile(FILE *);
 PyAPI_FUNC(PyObject *) PyMarshal_ReadObjectFromFile(FILE *);
 PyAPI_FUNC(PyObject *) PyMarshal_ReadLastObjectFromFile(FILE *);
+
+/* Placeholder for a code object nested in the constants of another code
+   object, which marshal.loads() reads on first use (version 5). */
+PyAPI_DATA(PyTypeObject) _PyLazyCode_Type;
+#define _PyLazyCode_Check(op) (Py_TYPE(op) == &_PyLazyCode_Type)
+PyAPI_FUNC(PyObject *) _PyLazyCode_Load(PyObject *);
+PyAPI_FUNC(void) _PyLazyCode_SetFilename(PyObject *, PyObject *);
+PyAPI_FUNC(int) _PyLazyCode_LoadConsts(PyObject *);
 #endif
 PyAPI_FUNC(PyObject *) PyMarshal_ReadObjectFromString(const char *,
                                                       Py_ssize_t);
@@ -269,6 +269,60 @@ class OpenWrapper:
         return open(*args, **kwargs)
 
 
+def read_batch(requests):
+    """Read several ranges of bytes from files at once.
+
+    requests is an iterable of (file, offset, size) tuples, where file is a
+    path or a file descriptor, and a size of -1 reads up to the end of the
+    file.  Return a list of the bytes read for each request, which are
+    shorter than size at the end of the file.
+    """
+    reqs = []
+    for req in requests:
+        if not isinstance(req, tuple) or len(req) != 3:
+            raise TypeError("read_batch() requests must be "
+                            "(file, offset, size) tuples")
+        file, offset, size = req
+        if isinstance(file, int):
+            if file < 0:
+                raise ValueError('negative file descriptor')
+        else:
+            file = os.fspath(file)
+        try:
+            offset = offset.__index__()
+            size = size.__index__()
+        except AttributeError:
+            raise TypeError("read_batch() offset and size must be integers")
+        if offset < 0 or size < -1:
+            raise ValueError("read_batch() offset must be non-negative and "
+                             "size at least -1")
+        reqs.append((file, offset, size))
+    result = []
+    for file, offset, size in reqs:
+        fd = file
+        if not isinstance(file, int):
+            fd = os.open(file, os.O_RDONLY | getattr(os, 'O_BINARY', 0))
+        try:
+            if size < 0:
+                size = max(os.fstat(fd).st_size - offset, 0)
+            data = bytearray()
+            while len(data) < size:
+                pos = offset + len(data)
+                if hasattr(os, 'pread'):
+                    chunk = os.pread(fd, size - len(data), pos)
+                else:
+                    os.lseek(fd, pos, SEEK_SET)
+                    chunk = os.read(fd, size - len(data))
+                if not chunk:
+                    break
+                data += chunk
+            result.append(bytes(data))
+        finally:
+            if fd is not file:
+                os.close(fd)
+    return result
+
+
 # In normal operation, both `UnsupportedOperation`s should be bound to the
 # same object.
 try:
@@ -978,6 +1032,134 @@ class BytesIO(BufferedIOBase):
         return True
 
 
+class MemoryReader(BufferedIOBase):
+
+    """Buffered I/O implementation reading from a bytes-like object.
+
+    The buffer is not copied, so that an mmap can be read without loading
+    it into memory first.  Reads copy straight from it, or return read-only
+    memoryview slices of it if views is true.  Views save copying large
+    reads, but short lines are cheaper as bytes.  The buffer stays exported
+    until the reader is closed and the slices are released.
+    """
+
+    def __init__(self, buffer, *, views=False):
+        view = memoryview(buffer)
+        if not view.c_contiguous:
+            raise BufferError("MemoryReader needs a contiguous buffer")
+        # the slices returned with views must not write to the buffer
+        self._view = view.cast("B").toreadonly()
+        self._views = bool(views)
+        self._pos = 0
+
+    def __getstate__(self):
+        raise TypeError(f"cannot serialize {self.__class__.__name__!r} object")
+
+    def close(self):
+        super().close()
+        self._view = None
+
+    def _slice(self, end):
+        end = min(end, len(self._view))
+        start = min(self._pos, end)
+        if end > self._pos:
+            self._pos = end
+        b = self._view[start:end]
+        return b if self._views else bytes(b)
+
+    def read(self, size=-1):
+        self._checkClosed()
+        if size is None:
+            size = -1
+        else:
+            try:
+                size_index = size.__index__
+            except AttributeError:
+                raise TypeError(f"{size!r} is not an integer")
+            else:
+                size = size_index()
+        if size < 0:
+            size = len(self._view)
+        return self._slice(self._pos + size)
+
+    def read1(self, size=-1):
+        """This is the same as read.
+        """
+        return self.read(size)
+
+    def readinto(self, b):
+        self._checkClosed()
+        with memoryview(b) as m, m.cast("B") as m:
+            data = self._slice(self._pos + len(m))
+            n = len(data)
+            m[:n] = data
+        return n
+
+    def readinto1(self, b):
+        return self.readinto(b)
+
+    def readline(self, size=-1):
+        self._checkClosed()
+        if size is None:
+            size = -1
+        else:
+            try:
+                size_index = size.__index__
+            except AttributeError:
+                raise TypeError(f"{size!r} is not an integer")
+            else:
+                size = size_index()
+        end = len(self._view)
+        if size >= 0:
+            end = min(end, self._pos + size)
+        start = self._pos
+        while start < end:
+            stop = min(end, start + DEFAULT_BUFFER_SIZE)
+            chunk = bytes(self._view[start:stop])
+            nl = chunk.find(b"\n")
+            if nl >= 0:
+                end = start + nl + 1
+                break
+            start += len(chunk)
+        return self._slice(end)
+
+    def seek(self, pos, whence=0):
+        self._checkClosed()
+        try:
+            pos_index = pos.__index__
+        except AttributeError:
+            raise TypeError(f"{pos!r} is not an integer")
+        else:
+            pos = pos_index()
+        if whence == 0:
+            if pos < 0:
+                raise ValueError("negative seek position %r" % (pos,))
+            self._pos = pos
+        elif whence == 1:
+            self._pos = max(0, self._pos + pos)
+        elif whence == 2:
+            self._pos = max(0, len(self._view) + pos)
+        else:
+            raise ValueError("unsupported whence value")
+        return self._pos
+
+    def tell(self):
+        self._checkClosed()
+        return self._pos
+
+    def readable(self):
+        self._checkClosed()
+        return True
+
+    def writable(self):
+        self._checkClosed()
+        return False
+
+    def seekable(self):
+        self._checkClosed()
+        return True
+
+
 class BufferedReader(_BufferedIOMixin):
 
     """BufferedReader(raw[, buffer_size])
@@ -1432,8 +1614,13 @@ class FileIO(RawIOBase):
     _appending = False
     _seekable = None
     _closefd = True
+    _readahead = None
+
+    # size of the chunks a read-ahead is counted in
+    _READAHEAD_CHUNK_SIZE = 128 * 1024
 
-    def __init__(self, file, mode='r', closefd=True, opener=None):
+    def __init__(self, file, mode='r', closefd=True, opener=None, *,
+                 readahead=0):
         """Open a file.  The mode can be 'r' (default), 'w', 'x' or 'a' for reading,
         writing, exclusive creation or appending.  The file will be created if it
         doesn't exist when opened for writing or appending; it will be truncated
@@ -1445,6 +1632,10 @@ class FileIO(RawIOBase):
         object is then obtained by calling opener with (*name*, *flags*).
         *opener* must return an open file descriptor (passing os.open as *opener*
         results in functionality similar to passing None).
+
+        A positive *readahead* makes a file opened for reading only, when it
+        is a regular file, read up to that many chunks of 128 KiB ahead of
+        the current position.  The read-ahead stops when fileno() is called.
         """
         if self._fd >= 0:
             # Have to close the existing file first.
@@ -1454,6 +1645,10 @@ class FileIO(RawIOBase):
             finally:
                 self._fd = -1
 
+        self._readahead = None
+        if readahead < 0:
+            raise ValueError('readahead must not be negative')
+
         if isinstance(file, float):
             raise TypeError('integer argument expected, got float')
         if isinstance(file, int):
@@ -1533,6 +1728,12 @@ class FileIO(RawIOBase):
             self._blksize = getattr(fdfstat, 'st_blksize', 0)
             if self._blksize <= 1:
                 self._blksize = DEFAULT_BUFFER_SIZE
+            if (readahead > 0 and self._readable and not self._writable and
+                stat.S_ISREG(fdfstat.st_mode)):
+                self._readahead = ('fadvise' if hasattr(os, 'posix_fadvise')
+                                   else 'pread')
+                self._readahead_window = readahead * self._READAHEAD_CHUNK_SIZE
+                self._advised = 0
 
             if _setmode:
                 # don't translate newlines (\r\n <=> \n)
@@ -1597,11 +1798,26 @@ class FileIO(RawIOBase):
         self._checkReadable()
         if size is None or size < 0:
             return self.readall()
+        if self._readahead == 'fadvise':
+            self._advise()
         try:
             return os.read(self._fd, size)
         except BlockingIOError:
             return None
 
+    def _advise(self):
+        # keep the kernel reading a window ahead of the current position
+        pos = os.lseek(self._fd, 0, SEEK_CUR)
+        window = self._readahead_window
+        if not pos <= self._advised <= pos + window:
+            # the file was seeked
+            self._advised = pos
+        if self._advised < pos + window // 2:
+            os.posix_fadvise(self._fd, self._advised,
+                             pos + window - self._advised,
+                             os.POSIX_FADV_WILLNEED)
+            self._advised = pos + window
+
     def readall(self):
         """Read all data from the file, returned as bytes.
 
@@ -1733,6 +1949,7 @@ class FileIO(RawIOBase):
     def fileno(self):
         """Return the underlying file descriptor (an integer)."""
         self._checkClosed()
+        self._readahead = None
         return self._fd
 
     def isatty(self):
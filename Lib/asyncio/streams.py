@@ -50,6 +50,46 @@ class LimitOverrunError(Exception):
         return type(self), (self.args[0], self.consumed)
 
 
+class _StreamBuffer(bytearray):
+    """Buffer of the data received by a StreamReader.
+
+    This is the pure Python version of _asyncio.StreamBuffer, which
+    receives data in place and doesn't move the data left when the front
+    of the buffer is consumed.
+    """
+
+    __slots__ = ('_received',)
+
+    def take(self, n):
+        """Remove and return the first n bytes, or all of them."""
+        if n < 0:
+            raise ValueError('n must be non-negative')
+        data = bytes(self[:n])
+        del self[:n]
+        return data
+
+    def get_buffer(self, sizehint):
+        """Return a writable buffer to receive at least sizehint bytes."""
+        if sizehint <= 0:
+            sizehint = _DEFAULT_LIMIT
+        self._received = bytearray(sizehint)
+        return self._received
+
+    def buffer_updated(self, nbytes):
+        """Append the first nbytes of the last buffer returned."""
+        self.extend(memoryview(self._received)[:nbytes])
+
+
+_PyStreamBuffer = _StreamBuffer
+
+try:
+    import _asyncio
+except ImportError:
+    pass
+else:
+    _StreamBuffer = _CStreamBuffer = _asyncio.StreamBuffer
+
+
 async def open_connection(host=None, port=None, *,
                           loop=None, limit=_DEFAULT_LIMIT, **kwds):
     """A wrapper for create_connection() returning a (reader, writer) pair.
@@ -72,7 +112,7 @@ async def open_connection(host=None, port=None, *,
     if loop is None:
         loop = events.get_event_loop()
     reader = StreamReader(limit=limit, loop=loop)
-    protocol = StreamReaderProtocol(reader, loop=loop)
+    protocol = _BufferedStreamReaderProtocol(reader, loop=loop)
     transport, _ = await loop.create_connection(
         lambda: protocol, host, port, **kwds)
     writer = StreamWriter(transport, protocol, reader, loop)
@@ -107,8 +147,8 @@ async def start_server(client_connected_cb, host=None, port=None, *,
 
     def factory():
         reader = StreamReader(limit=limit, loop=loop)
-        protocol = StreamReaderProtocol(reader, client_connected_cb,
-                                        loop=loop)
+        protocol = _BufferedStreamReaderProtocol(reader, client_connected_cb,
+                                                 loop=loop)
         return protocol
 
     return await loop.create_server(factory, host, port, **kwds)
@@ -123,7 +163,7 @@ if hasattr(socket, 'AF_UNIX'):
         if loop is None:
             loop = events.get_event_loop()
         reader = StreamReader(limit=limit, loop=loop)
-        protocol = StreamReaderProtocol(reader, loop=loop)
+        protocol = _BufferedStreamReaderProtocol(reader, loop=loop)
         transport, _ = await loop.create_unix_connection(
             lambda: protocol, path, **kwds)
         writer = StreamWriter(transport, protocol, reader, loop)
@@ -137,8 +177,8 @@ if hasattr(socket, 'AF_UNIX'):
 
         def factory():
             reader = StreamReader(limit=limit, loop=loop)
-            protocol = StreamReaderProtocol(reader, client_connected_cb,
-                                            loop=loop)
+            protocol = _BufferedStreamReaderProtocol(
+                reader, client_connected_cb, loop=loop)
             return protocol
 
         return await loop.create_unix_server(factory, path, **kwds)
@@ -273,6 +313,21 @@ class StreamReaderProtocol(FlowControlMixin, protocols.Protocol):
             closed.exception()
 
 
+class _BufferedStreamReaderProtocol(StreamReaderProtocol,
+                                    protocols.BufferedProtocol):
+    """StreamReaderProtocol receiving data directly into the buffer of
+    the StreamReader.
+
+    Used by the convenience functions, which create the StreamReader.
+    """
+
+    def get_buffer(self, sizehint):
+        return self._stream_reader._get_buffer(sizehint)
+
+    def buffer_updated(self, nbytes):
+        self._stream_reader._buffer_updated(nbytes)
+
+
 class StreamWriter:
     """Wraps a Transport.
 
@@ -362,7 +417,7 @@ class StreamReader:
             self._loop = events.get_event_loop()
         else:
             self._loop = loop
-        self._buffer = bytearray()
+        self._buffer = _StreamBuffer()
         self._eof = False    # Whether we're done.
         self._waiter = None  # A future used by _wait_for_data()
         self._exception = None
@@ -432,7 +487,22 @@ class StreamReader:
 
         self._buffer.extend(data)
         self._wakeup_waiter()
+        self._maybe_pause_transport()
+
+    def _get_buffer(self, sizehint):
+        return self._buffer.get_buffer(sizehint)
+
+    def _buffer_updated(self, nbytes):
+        assert not self._eof, 'buffer_updated after feed_eof'
+
+        if not nbytes:
+            return
+
+        self._buffer.buffer_updated(nbytes)
+        self._wakeup_waiter()
+        self._maybe_pause_transport()
 
+    def _maybe_pause_transport(self):
         if (self._transport is not None and
                 not self._paused and
                 len(self._buffer) > 2 * self._limit):
@@ -498,7 +568,7 @@ class StreamReader:
             return e.partial
         except LimitOverrunError as e:
             if self._buffer.startswith(sep, e.consumed):
-                del self._buffer[:e.consumed + seplen]
+                self._buffer.take(e.consumed + seplen)
             else:
                 self._buffer.clear()
             self._maybe_resume_transport()
@@ -580,8 +650,7 @@ class StreamReader:
             # adds data which makes separator be found. That's why we check for
             # EOF *ater* inspecting the buffer.
             if self._eof:
-                chunk = bytes(self._buffer)
-                self._buffer.clear()
+                chunk = self._buffer.take(len(self._buffer))
                 raise IncompleteReadError(chunk, None)
 
             # _wait_for_data() will resume reading if stream was paused.
@@ -591,10 +660,9 @@ class StreamReader:
             raise LimitOverrunError(
                 'Separator is found, but chunk is longer than limit', isep)
 
-        chunk = self._buffer[:isep + seplen]
-        del self._buffer[:isep + seplen]
+        chunk = self._buffer.take(isep + seplen)
         self._maybe_resume_transport()
-        return bytes(chunk)
+        return chunk
 
     async def read(self, n=-1):
         """Read up to `n` bytes from the stream.
@@ -640,8 +708,7 @@ class StreamReader:
             await self._wait_for_data('read')
 
         # This will work right even if buffer is less than n bytes
-        data = bytes(self._buffer[:n])
-        del self._buffer[:n]
+        data = self._buffer.take(n)
 
         self._maybe_resume_transport()
         return data
@@ -672,18 +739,12 @@ class StreamReader:
 
         while len(self._buffer) < n:
             if self._eof:
-                incomplete = bytes(self._buffer)
-                self._buffer.clear()
+                incomplete = self._buffer.take(len(self._buffer))
                 raise IncompleteReadError(incomplete, n)
 
             await self._wait_for_data('readexactly')
 
-        if len(self._buffer) == n:
-            data = bytes(self._buffer)
-            self._buffer.clear()
-        else:
-            data = bytes(self._buffer[:n])
-            del self._buffer[:n]
+        data = self._buffer.take(n)
         self._maybe_resume_transport()
         return data
 
@@ -1,12 +1,13 @@
 """Support for tasks, coroutines and the scheduler."""
 
 __all__ = (
-    'Task', 'create_task',
+    'Task', 'create_task', 'create_eager_task_factory', 'eager_task_factory',
     'FIRST_COMPLETED', 'FIRST_EXCEPTION', 'ALL_COMPLETED',
     'wait', 'wait_for', 'as_completed', 'sleep',
     'gather', 'shield', 'ensure_future', 'run_coroutine_threadsafe',
     'current_task', 'all_tasks',
     '_register_task', '_unregister_task', '_enter_task', '_leave_task',
+    '_swap_current_task',
 )
 
 import concurrent.futures
@@ -124,7 +125,7 @@ class Task(futures._PyFuture):  # Inherit Python Task implementation
                       stacklevel=2)
         return _all_tasks_compat(loop)
 
-    def __init__(self, coro, *, loop=None):
+    def __init__(self, coro, *, loop=None, eager_start=False):
         super().__init__(loop=loop)
         if self._source_traceback:
             del self._source_traceback[-1]
@@ -139,8 +140,12 @@ class Task(futures._PyFuture):  # Inherit Python Task implementation
         self._coro = coro
         self._context = contextvars.copy_context()
 
-        self._loop.call_soon(self.__step, context=self._context)
-        _register_task(self)
+        if eager_start and self._loop.is_running():
+            _register_task(self)
+            self.__eager_start()
+        else:
+            self._loop.call_soon(self.__step, context=self._context)
+            _register_task(self)
 
     def __del__(self):
         if self._state == futures._PENDING and self._log_destroy_pending:
@@ -229,6 +234,15 @@ class Task(futures._PyFuture):  # Inherit Python Task implementation
         self._must_cancel = True
         return True
 
+    def __eager_start(self):
+        # Run the first step right away, as if the task calling
+        # create_task() was suspended until the new task yields.
+        prev_task = _swap_current_task(self._loop, None)
+        try:
+            self._context.run(self.__step)
+        finally:
+            _swap_current_task(self._loop, prev_task)
+
     def __step(self, exc=None):
         if self.done():
             raise futures.InvalidStateError(
@@ -351,6 +365,28 @@ def create_task(coro):
     return loop.create_task(coro)
 
 
+def create_eager_task_factory(custom_task_constructor):
+    """Create a task factory which starts the tasks eagerly.
+
+    The first step of the coroutine runs as soon as the task is created,
+    if the loop is running.  A coroutine which completes
+    without suspending doesn't go through the event loop at all, and its
+    task is returned already done.  The factory is meant to be passed to
+    loop.set_task_factory().
+
+    custom_task_constructor is called as
+    custom_task_constructor(coro, loop=loop, eager_start=True).
+    """
+
+    def factory(loop, coro):
+        return custom_task_constructor(coro, loop=loop, eager_start=True)
+
+    return factory
+
+
+eager_task_factory = create_eager_task_factory(Task)
+
+
 # wait() and as_completed() similar to those in PEP 3148.
 
 FIRST_COMPLETED = concurrent.futures.FIRST_COMPLETED
@@ -876,6 +912,19 @@ def _leave_task(loop, task):
     del _current_tasks[loop]
 
 
+def _swap_current_task(loop, task):
+    """Make task the current task of loop, return the previous one.
+
+    A task of None leaves loop without a current task.
+    """
+    prev_task = _current_tasks.get(loop)
+    if task is None:
+        _current_tasks.pop(loop, None)
+    else:
+        _current_tasks[loop] = task
+    return prev_task
+
+
 def _unregister_task(task):
     """Unregister a task."""
     _all_tasks.discard(task)
@@ -885,11 +934,12 @@ _py_register_task = _register_task
 _py_unregister_task = _unregister_task
 _py_enter_task = _enter_task
 _py_leave_task = _leave_task
+_py_swap_current_task = _swap_current_task
 
 
 try:
     from _asyncio import (_register_task, _unregister_task,
-                          _enter_task, _leave_task,
+                          _enter_task, _leave_task, _swap_current_task,
                           _all_tasks, _current_tasks)
 except ImportError:
     pass
@@ -898,3 +948,4 @@ else:
     _c_unregister_task = _unregister_task
     _c_enter_task = _enter_task
     _c_leave_task = _leave_task
+    _c_swap_current_task = _swap_current_task
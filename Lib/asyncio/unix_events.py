@@ -24,6 +24,11 @@ from . import tasks
 from . import transports
 from .log import logger
 
+try:
+    from _asyncio import EpollCore as _EpollCore
+except ImportError:
+    _EpollCore = None
+
 
 __all__ = (
     'SelectorEventLoop',
@@ -419,6 +424,57 @@ class _UnixSelectorEventLoop(selector_events.BaseSelectorEventLoop):
         fut.add_done_callback(cb)
 
 
+class _UnixEpollEventLoop(_UnixSelectorEventLoop):
+    """Unix event loop built on the epoll core of the _asyncio module.
+
+    The reader and writer handles are kept in C, indexed by file
+    descriptor, and the handles of the ready ones are scheduled as a list
+    instead of going through the selectors module.
+    """
+
+    def __init__(self):
+        super().__init__(_EpollCore())
+
+    def _add_reader(self, fd, callback, *args):
+        self._check_closed()
+        handle = events.Handle(callback, args, self, None)
+        reader = self._selector.add_reader(fd, handle)
+        if reader is not None:
+            reader.cancel()
+
+    def _remove_reader(self, fd):
+        if self.is_closed():
+            return False
+        reader = self._selector.remove_reader(fd)
+        if reader is not None:
+            reader.cancel()
+            return True
+        else:
+            return False
+
+    def _add_writer(self, fd, callback, *args):
+        self._check_closed()
+        handle = events.Handle(callback, args, self, None)
+        writer = self._selector.add_writer(fd, handle)
+        if writer is not None:
+            writer.cancel()
+
+    def _remove_writer(self, fd):
+        """Remove a writer callback."""
+        if self.is_closed():
+            return False
+        writer = self._selector.remove_writer(fd)
+        if writer is not None:
+            writer.cancel()
+            return True
+        else:
+            return False
+
+    def _process_events(self, event_list):
+        # The core already dropped the cancelled handles.
+        self._ready.extend(event_list)
+
+
 class _UnixReadPipeTransport(transports.ReadTransport):
 
     max_size = 256 * 1024  # max bytes we read in one event loop iteration
@@ -1156,3 +1212,7 @@ class _UnixDefaultEventLoopPolicy(events.BaseDefaultEventLoopPolicy):
 
 SelectorEventLoop = _UnixSelectorEventLoop
 DefaultEventLoopPolicy = _UnixDefaultEventLoopPolicy
+
+if _EpollCore is not None:
+    EpollEventLoop = _UnixEpollEventLoop
+    __all__ += ('EpollEventLoop',)
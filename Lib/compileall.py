@@ -49,7 +49,7 @@ def _walk_dir(dir, ddir=None, maxlevels=10, quiet=0):
 
 def compile_dir(dir, maxlevels=10, ddir=None, force=False, rx=None,
                 quiet=0, legacy=False, optimize=-1, workers=1,
-                invalidation_mode=None):
+                invalidation_mode=None, threads=False):
     """Byte-compile all modules in the given directory tree.
 
     Arguments (only dir is required):
@@ -65,8 +65,11 @@ def compile_dir(dir, maxlevels=10, ddir=None, force=False, rx=None,
     optimize:  optimization level or -1 for level of the interpreter
     workers:   maximum number of parallel workers
     invalidation_mode: how the up-to-dateness of the pyc will be checked
+    threads:   if True, run the workers in threads of this process instead
+               of in separate processes; the GIL is released while source
+               files are tokenized and parsed
     """
-    ProcessPoolExecutor = None
+    Executor = None
     if workers is not None:
         if workers < 0:
             raise ValueError('workers must be greater or equal to 0')
@@ -74,15 +77,23 @@ def compile_dir(dir, maxlevels=10, ddir=None, force=False, rx=None,
             try:
                 # Only import when needed, as low resource platforms may
                 # fail to import it
-                from concurrent.futures import ProcessPoolExecutor
+                if threads:
+                    from concurrent.futures import ThreadPoolExecutor
+                    Executor = ThreadPoolExecutor
+                else:
+                    from concurrent.futures import ProcessPoolExecutor
+                    Executor = ProcessPoolExecutor
             except ImportError:
                 workers = 1
     files_and_ddirs = _walk_dir(dir, quiet=quiet, maxlevels=maxlevels,
                                 ddir=ddir)
     success = True
-    if workers is not None and workers != 1 and ProcessPoolExecutor is not None:
-        workers = workers or None
-        with ProcessPoolExecutor(max_workers=workers) as executor:
+    if workers is not None and workers != 1 and Executor is not None:
+        if threads:
+            workers = workers or os.cpu_count() or 1
+        else:
+            workers = workers or None
+        with Executor(max_workers=workers) as executor:
             results = executor.map(
                     partial(_compile_file_tuple,
                             force=force, rx=rx, quiet=quiet,
@@ -262,6 +273,9 @@ def main():
                               'to the equivalent of -l sys.path'))
     parser.add_argument('-j', '--workers', default=1,
                         type=int, help='Run compileall concurrently')
+    parser.add_argument('--threads', action='store_true',
+                        help=('run the workers in threads rather than in '
+                              'separate processes'))
     invalidation_modes = [mode.name.lower().replace('_', '-')
                           for mode in py_compile.PycInvalidationMode]
     parser.add_argument('--invalidation-mode',
@@ -317,7 +331,8 @@ def main():
                     if not compile_dir(dest, maxlevels, args.ddir,
                                        args.force, args.rx, args.quiet,
                                        args.legacy, workers=args.workers,
-                                       invalidation_mode=invalidation_mode):
+                                       invalidation_mode=invalidation_mode,
+                                       threads=args.threads):
                         success = False
             return success
         else:
@@ -14,7 +14,8 @@ BufferedIOBase deals with buffering on a raw byte stream (RawIOBase). Its
 subclasses, BufferedWriter, BufferedReader, and BufferedRWPair buffer
 streams that are readable, writable, and both respectively.
 BufferedRandom provides a buffered interface to random access
-streams. BytesIO is a simple stream of in-memory bytes.
+streams. BytesIO is a simple stream of in-memory bytes. MemoryReader
+reads a bytes-like object, such as an mmap, without copying it.
 
 Another IOBase subclass, TextIOBase, deals with the encoding and decoding
 of streams into text. TextIOWrapper, which extends it, is a buffered text
@@ -42,19 +43,20 @@ __author__ = ("Guido van Rossum <guido@python.org>, "
               "Benjamin Peterson <benjamin@python.org>")
 
 __all__ = ["BlockingIOError", "open", "IOBase", "RawIOBase", "FileIO",
-           "BytesIO", "StringIO", "BufferedIOBase",
+           "BytesIO", "MemoryReader", "StringIO", "BufferedIOBase",
            "BufferedReader", "BufferedWriter", "BufferedRWPair",
            "BufferedRandom", "TextIOBase", "TextIOWrapper",
-           "UnsupportedOperation", "SEEK_SET", "SEEK_CUR", "SEEK_END"]
+           "UnsupportedOperation", "SEEK_SET", "SEEK_CUR", "SEEK_END",
+           "read_batch"]
 
 
 import _io
 import abc
 
 from _io import (DEFAULT_BUFFER_SIZE, BlockingIOError, UnsupportedOperation,
-                 open, FileIO, BytesIO, StringIO, BufferedReader,
+                 open, FileIO, BytesIO, MemoryReader, StringIO, BufferedReader,
                  BufferedWriter, BufferedRWPair, BufferedRandom,
-                 IncrementalNewlineDecoder, TextIOWrapper)
+                 IncrementalNewlineDecoder, TextIOWrapper, read_batch)
 
 OpenWrapper = _io.open # for compatibility with _pyio
 
@@ -83,8 +85,8 @@ class TextIOBase(_io._TextIOBase, IOBase):
 
 RawIOBase.register(FileIO)
 
-for klass in (BytesIO, BufferedReader, BufferedWriter, BufferedRandom,
-              BufferedRWPair):
+for klass in (BytesIO, MemoryReader, BufferedReader, BufferedWriter,
+              BufferedRandom, BufferedRWPair):
     BufferedIOBase.register(klass)
 
 for klass in (StringIO, TextIOWrapper):
@@ -97,13 +97,13 @@ Using json.tool from the shell to validate and pretty-print::
 """
 __version__ = '2.0.9'
 __all__ = [
-    'dump', 'dumps', 'load', 'loads',
-    'JSONDecoder', 'JSONDecodeError', 'JSONEncoder',
+    'dump', 'dumps', 'load', 'loads', 'iterload',
+    'JSONDecoder', 'JSONIncrementalDecoder', 'JSONDecodeError', 'JSONEncoder',
 ]
 
 __author__ = 'Bob Ippolito <bob@redivi.com>'
 
-from .decoder import JSONDecoder, JSONDecodeError
+from .decoder import JSONDecoder, JSONIncrementalDecoder, JSONDecodeError
 from .encoder import JSONEncoder
 import codecs
 
@@ -359,3 +359,26 @@ def loads(s, *, encoding=None, cls=None, object_hook=None, parse_float=None,
     if parse_constant is not None:
         kw['parse_constant'] = parse_constant
     return cls(**kw).decode(s)
+
+
+def iterload(fp, *, items=False, cls=None, chunk_size=65536, **kw):
+    """Iterate over the JSON values of ``fp`` (a ``.read()``-supporting
+    binary file containing UTF-8 encoded JSON values, one after the other)
+    as soon as they are read.
+
+    If ``items`` is true, ``fp`` contains a single JSON array and its
+    elements are iterated over instead.
+
+    ``fp`` is read ``chunk_size`` bytes at a time.  The other keyword
+    arguments are those of ``load()``; ``cls`` defaults to
+    ``JSONIncrementalDecoder``.
+    """
+    if cls is None:
+        cls = JSONIncrementalDecoder
+    decoder = cls(items=items, **kw)
+    while True:
+        data = fp.read(chunk_size)
+        if not data:
+            break
+        yield from decoder.feed(data)
+    yield from decoder.close()
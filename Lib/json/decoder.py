@@ -7,8 +7,12 @@ try:
     from _json import scanstring as c_scanstring
 except ImportError:
     c_scanstring = None
+try:
+    from _json import make_bytes_decoder as c_make_bytes_decoder
+except ImportError:
+    c_make_bytes_decoder = None
 
-__all__ = ['JSONDecoder', 'JSONDecodeError']
+__all__ = ['JSONDecoder', 'JSONIncrementalDecoder', 'JSONDecodeError']
 
 FLAGS = re.VERBOSE | re.MULTILINE | re.DOTALL
 
@@ -354,3 +358,265 @@ class JSONDecoder(object):
         except StopIteration as err:
             raise JSONDecodeError("Expecting value", s, err.value) from None
         return obj, end
+
+
+# Incremental decoding of UTF-8 bytes: the stream is split into complete
+# values, each of which is decoded once with the scanner.
+
+STRUCTURAL_RE = re.compile(rb'["\[\]{}]')
+STRING_END_RE = re.compile(rb'["\\]')
+SCALAR_END_RE = re.compile(rb'[ \t\n\r"\[\]{},]')
+NONWHITESPACE_RE = re.compile(rb'[^ \t\n\r]')
+
+BOM = b'\xef\xbb\xbf'
+
+# the consumed bytes are trimmed from the buffer once there are that many
+_TRIM_SIZE = 65536
+
+(ITEMS_START,       # expecting the opening bracket
+ ITEMS_FIRST,       # expecting the first element or the closing bracket
+ ITEMS_NEXT,        # expecting an element after a comma
+ ITEMS_AFTER,       # expecting a comma or the closing bracket
+ ITEMS_END,         # the array is closed
+) = range(5)
+
+
+class _BytesDecoder:
+    def __init__(self, context, items):
+        self._scan_once = scanner.make_scanner(context)
+        self.items = bool(items)
+        self._state = ITEMS_START
+        self._buf = bytearray()
+        self._pos = 0
+        self._consumed = 0
+        self._start = None
+        self._stack = []
+        self._in_string = self._escape = self._in_scalar = False
+        self._started = self._closed = self._busy = False
+        self._values = []
+
+    def _emit(self, buf, end):
+        span = buf[self._start:end].decode('utf-8', 'surrogatepass')
+        self._start = None
+        self._consumed = end
+        self._stack.clear()
+        self._in_string = self._escape = self._in_scalar = False
+        if self.items:
+            self._state = ITEMS_AFTER
+        try:
+            value, idx = self._scan_once(span, 0)
+        except StopIteration as err:
+            raise JSONDecodeError('Expecting value', span, err.value) from None
+        if idx != len(span):
+            raise JSONDecodeError('Extra data', span, idx)
+        self._values.append(value)
+
+    def _framing_error(self, msg, buf, pos):
+        doc = buf[self._consumed:pos + 1].decode('utf-8', 'replace')
+        prefix = buf[self._consumed:pos].decode('utf-8', 'replace')
+        return JSONDecodeError(msg, doc, len(prefix))
+
+    def _scan(self, buf):
+        pos = self._pos
+        n = len(buf)
+        stack = self._stack
+        try:
+            while pos < n:
+                if self._start is None:
+                    m = NONWHITESPACE_RE.search(buf, pos)
+                    if m is None:
+                        pos = n
+                        break
+                    pos = m.start()
+                    c = buf[pos:pos + 1]
+                    if self.items:
+                        state = self._state
+                        if state == ITEMS_START:
+                            if c != b'[':
+                                pos += 1
+                                raise self._framing_error(
+                                    'Expecting JSON array', buf, pos - 1)
+                            self._state = ITEMS_FIRST
+                            pos += 1
+                            continue
+                        if c == b']' and state in (ITEMS_FIRST, ITEMS_AFTER):
+                            self._state = ITEMS_END
+                            pos += 1
+                            continue
+                        if state == ITEMS_AFTER:
+                            if c != b',':
+                                pos += 1
+                                raise self._framing_error(
+                                    "Expecting ',' delimiter", buf, pos - 1)
+                            self._state = ITEMS_NEXT
+                            pos += 1
+                            continue
+                        if state == ITEMS_END:
+                            pos += 1
+                            raise self._framing_error('Extra data',
+                                                      buf, pos - 1)
+                    if c in b']},':
+                        pos += 1
+                        raise self._framing_error('Expecting value',
+                                                  buf, pos - 1)
+                    self._start = pos
+                    pos += 1
+                    if c == b'"':
+                        self._in_string = True
+                    elif c in b'[{':
+                        stack.append(c)
+                    else:
+                        self._in_scalar = True
+                elif self._in_string:
+                    if self._escape:
+                        self._escape = False
+                        pos += 1
+                        continue
+                    m = STRING_END_RE.search(buf, pos)
+                    if m is None:
+                        pos = n
+                        break
+                    pos = m.end()
+                    if m.group() == b'\\':
+                        if pos == n:
+                            self._escape = True
+                            break
+                        pos += 1
+                        continue
+                    self._in_string = False
+                    if not stack:
+                        self._emit(buf, pos)
+                elif self._in_scalar:
+                    m = SCALAR_END_RE.search(buf, pos)
+                    if m is None:
+                        pos = n
+                        break
+                    pos = m.start()
+                    self._emit(buf, pos)
+                else:
+                    # inside an array or an object
+                    m = STRUCTURAL_RE.search(buf, pos)
+                    if m is None:
+                        pos = n
+                        break
+                    pos = m.end()
+                    c = m.group()
+                    if c == b'"':
+                        self._in_string = True
+                    elif c in b'[{':
+                        stack.append(c)
+                    else:
+                        if stack[-1] == (b'[' if c == b']' else b'{'):
+                            stack.pop()
+                        else:
+                            # mismatched bracket, left to the parser to report
+                            stack.clear()
+                        if not stack:
+                            self._emit(buf, pos)
+        finally:
+            self._pos = pos
+            self._consumed = pos if self._start is None else self._start
+
+    def _finish(self, buf):
+        n = len(buf)
+        if self._start is not None:
+            # an incomplete array, object or string fails to decode
+            try:
+                self._emit(buf, n)
+            finally:
+                self._pos = self._consumed = n
+        if self.items and self._state != ITEMS_END:
+            msg = ("Expecting ',' delimiter" if self._state == ITEMS_AFTER
+                   else 'Expecting value')
+            raise JSONDecodeError(msg, buf[self._consumed:].decode('utf-8',
+                                                               'replace'),
+                              0)
+
+    def _run(self, data, final):
+        if self._closed:
+            raise ValueError('the decoder is closed')
+        if self._busy:
+            raise RuntimeError('the decoder cannot be fed from a hook')
+        # the chunks are appended in place, the offsets into the buffer stay
+        # valid until its consumed prefix is trimmed
+        buf = self._buf
+        buf += data
+        if not self._started:
+            # skip a byte order mark, which may be split across chunks
+            if len(buf) >= 3 or final or not BOM.startswith(buf):
+                self._started = True
+                if buf.startswith(BOM):
+                    self._pos = self._consumed = 3
+        try:
+            if self._started:
+                self._busy = True
+                self._scan(buf)
+                if final:
+                    self._finish(buf)
+        finally:
+            self._busy = False
+            # keep the bytes of the incomplete value for the next chunk
+            consumed = self._consumed
+            if consumed == len(buf) or consumed >= _TRIM_SIZE or final:
+                del buf[:consumed]
+                self._pos -= consumed
+                if self._start is not None:
+                    self._start -= consumed
+                self._consumed = 0
+            if final:
+                self._closed = True
+        values = self._values
+        self._values = []
+        return values
+
+    def feed(self, data):
+        return self._run(data, False)
+
+    def close(self):
+        return self._run(b'', True)
+
+
+def py_make_bytes_decoder(context, items=False):
+    return _BytesDecoder(context, items)
+
+
+make_bytes_decoder = c_make_bytes_decoder or py_make_bytes_decoder
+
+
+class JSONIncrementalDecoder(JSONDecoder):
+    """Incremental JSON decoder for UTF-8 encoded bytes
+
+    The input is a stream of JSON values, such as JSON Lines, fed in chunks
+    of any size.  Each value is decoded as soon as its last byte has been
+    fed, and only the bytes of the value being read are kept between two
+    chunks.
+
+    If ``items`` is true, the stream holds a single JSON array and its
+    elements are returned one by one instead.
+
+    """
+
+    def __init__(self, *, items=False, **kw):
+        """``items`` selects the decoding of the elements of a top-level
+        array.  The other arguments are those of ``JSONDecoder``.
+        """
+        super().__init__(**kw)
+        self.items = items
+        self._decoder = make_bytes_decoder(self, items)
+
+    def feed(self, data):
+        """Decode the bytes-like object ``data``, and return the list of
+        the values it completes.
+
+        If a value is invalid, JSONDecodeError is raised and decoding goes
+        on after that value on the next call, which also returns the values
+        completed before the error.
+        """
+        return self._decoder.feed(data)
+
+    def close(self):
+        """Signal the end of the stream, and return the list of the values
+        it completes.  JSONDecodeError is raised if the stream ends in the
+        middle of a value.
+        """
+        return self._decoder.close()
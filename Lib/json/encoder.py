@@ -201,6 +201,44 @@ class JSONEncoder(object):
             chunks = list(chunks)
         return ''.join(chunks)
 
+    def encode_bytes(self, o, write=None):
+        """Return the UTF-8 encoded JSON representation of a Python data
+        structure as ``bytes``.
+
+        If ``write`` is given, the output is passed to it in chunks of
+        ``bytes`` as it is produced, and None is returned::
+
+            JSONEncoder().encode_bytes(bigobject, mysocket.sendall)
+
+        >>> from json.encoder import JSONEncoder
+        >>> JSONEncoder(ensure_ascii=False).encode_bytes({"foo": "bär"})
+        b'{"foo": "b\\xc3\\xa4r"}'
+
+        """
+        if c_make_encoder is not None and self.indent is None:
+            if self.ensure_ascii:
+                _encoder = encode_basestring_ascii
+            else:
+                _encoder = encode_basestring
+            _encode_bytes = c_make_encoder(
+                {} if self.check_circular else None, self.default, _encoder,
+                self.indent, self.key_separator, self.item_separator,
+                self.sort_keys, self.skipkeys, self.allow_nan).encode_bytes
+            return _encode_bytes(o, write)
+        if write is None:
+            return self.encode(o).encode('utf-8', 'surrogatepass')
+        chunks = []
+        size = 0
+        for chunk in self.iterencode(o):
+            chunks.append(chunk)
+            size += len(chunk)
+            if size >= 65536:
+                write(''.join(chunks).encode('utf-8', 'surrogatepass'))
+                chunks.clear()
+                size = 0
+        if chunks:
+            write(''.join(chunks).encode('utf-8', 'surrogatepass'))
+
     def iterencode(self, o, _one_shot=False):
         """Encode the given object and yield each string
         representation as available.
@@ -30,20 +30,29 @@ from itertools import islice
 from functools import partial
 import sys
 from sys import maxsize
-from struct import pack, unpack
+from struct import pack, unpack, unpack_from
 import re
 import io
 import codecs
 import _compat_pickle
 
 __all__ = ["PickleError", "PicklingError", "UnpicklingError", "Pickler",
-           "Unpickler", "dump", "dumps", "load", "loads"]
+           "Unpickler", "dump", "dumps", "load", "loads", "chunk_count",
+           "load_chunk"]
+
+try:
+    from _pickle import PickleBuffer
+    __all__.append("PickleBuffer")
+    _HAVE_PICKLE_BUFFER = True
+except ImportError:
+    _HAVE_PICKLE_BUFFER = False
+
 
 # Shortcut for use in isinstance testing
 bytes_types = (bytes, bytearray)
 
 # These are purely informational; no code uses these.
-format_version = "4.0"                  # File format version we write
+format_version = "5.0"                  # File format version we write
 compatible_formats = ["1.0",            # Original protocol 0
                       "1.1",            # Protocol 0 with INST added
                       "1.2",            # Original protocol 1
@@ -51,10 +60,11 @@ compatible_formats = ["1.0",            # Original protocol 0
                       "2.0",            # Protocol 2
                       "3.0",            # Protocol 3
                       "4.0",            # Protocol 4
+                      "5.0",            # Protocol 5
                       ]                 # Old format versions we can read
 
 # This is the highest protocol number we know how to read.
-HIGHEST_PROTOCOL = 4
+HIGHEST_PROTOCOL = 5
 
 # The protocol we write by default.  May be less than HIGHEST_PROTOCOL.
 # We intentionally write a protocol that Python 2.x cannot read;
@@ -178,6 +188,12 @@ STACK_GLOBAL     = b'\x93'  # same as GLOBAL but using names on the stacks
 MEMOIZE          = b'\x94'  # store top of the stack in memo
 FRAME            = b'\x95'  # indicate the beginning of a new frame
 
+# Protocol 5
+
+BYTEARRAY8       = b'\x96'  # push bytearray
+NEXT_BUFFER      = b'\x97'  # push next out-of-band buffer
+READONLY_BUFFER  = b'\x98'  # make top of stack readonly
+
 __all__.extend([x for x in dir() if re.match("[A-Z][A-Z0-9_]+$", x)])
 
 
@@ -371,11 +387,12 @@ def decode_long(data):
 
 class _Pickler:
 
-    def __init__(self, file, protocol=None, *, fix_imports=True):
+    def __init__(self, file, protocol=None, *, fix_imports=True,
+                 buffer_callback=None, chunk_size=0):
         """This takes a binary file for writing a pickle data stream.
 
         The optional *protocol* argument tells the pickler to use the
-        given protocol; supported protocols are 0, 1, 2, 3 and 4.  The
+        given protocol; supported protocols are 0, 1, 2, 3, 4 and 5.  The
         default protocol is 3; a backward-incompatible protocol designed
         for Python 3.
 
@@ -393,6 +410,25 @@ class _Pickler:
         will try to map the new Python 3 names to the old module names
         used in Python 2, so that the pickle data stream is readable
         with Python 2.
+
+        If *buffer_callback* is None (the default), buffer views are
+        serialized into *file* as part of the pickle stream.
+
+        If *buffer_callback* is not None, then it can be called any number
+        of times with a buffer view.  If the callback returns a false value
+        (such as None), the given buffer is out-of-band; otherwise the
+        buffer is serialized in-band, i.e. inside the pickle stream.
+
+        It is an error if *buffer_callback* is not None and *protocol*
+        is None or smaller than 5.
+
+        If *chunk_size* is positive, a list or dict passed to dump() is
+        pickled in chunks of *chunk_size* items that can be decoded
+        independently of each other with load_chunk(), for instance by
+        several processes.  The result is still an ordinary pickle.  This
+        requires protocol 4 or higher.  Objects shared by items of
+        different chunks are pickled once per chunk, so they are no longer
+        shared once loaded.
         """
         if protocol is None:
             protocol = DEFAULT_PROTOCOL
@@ -400,6 +436,15 @@ class _Pickler:
             protocol = HIGHEST_PROTOCOL
         elif not 0 <= protocol <= HIGHEST_PROTOCOL:
             raise ValueError("pickle protocol must be <= %d" % HIGHEST_PROTOCOL)
+        if buffer_callback is not None and protocol < 5:
+            raise ValueError("buffer_callback needs protocol >= 5")
+        self._buffer_callback = buffer_callback
+        if chunk_size < 0:
+            raise ValueError("chunk_size must be >= 0")
+        if chunk_size and protocol < 4:
+            raise ValueError("chunk_size needs protocol >= 4")
+        self._chunk_size = chunk_size
+        self._chunk_container = None
         try:
             self._file_write = file.write
         except AttributeError:
@@ -434,10 +479,72 @@ class _Pickler:
             self.write(PROTO + pack("<B", self.proto))
         if self.proto >= 4:
             self.framer.start_framing()
+        if self._chunk_size and type(obj) in (list, dict):
+            self._dump_chunked(obj)
+            return
         self.save(obj)
         self.write(STOP)
         self.framer.end_framing()
 
+    def _dump_chunked(self, obj):
+        # See the description of chunked pickles above load_chunk().
+        framer = self.framer
+        file_write = framer.file_write
+        # PROTO has already been written
+        written = 2
+        def counting_write(data):
+            nonlocal written
+            written += len(data)
+            return file_write(data)
+        framer.file_write = counting_write
+        try:
+            if type(obj) is list:
+                container_op, items_op = EMPTY_LIST, APPENDS
+                items = iter(obj)
+            else:
+                container_op, items_op = EMPTY_DICT, SETITEMS
+                items = iter(obj.items())
+            # The container itself isn't memoized: a chunk referring to it
+            # couldn't be decoded on its own.
+            self.write(container_op)
+            index = []
+            while True:
+                chunk = list(islice(items, self._chunk_size))
+                if not chunk:
+                    break
+                framer.commit_frame(force=True)
+                self.memo.clear()
+                self._chunk_container = obj
+                start = written
+                self.write(MARK)
+                if items_op is APPENDS:
+                    for x in chunk:
+                        self.save(x)
+                else:
+                    for k, v in chunk:
+                        self.save(k)
+                        self.save(v)
+                self.write(items_op)
+                framer.commit_frame(force=True)
+                self._chunk_container = None
+                index.append((start, written - start))
+            self.memo.clear()
+            # The index is written outside of any frame, so that it ends
+            # the data
+            framer.commit_frame(force=True)
+            framer.current_frame = None
+            self.write(BINBYTES8 +
+                       pack("<Q", 16 * len(index) + _CHUNK_TRAILER_SIZE))
+            index_offset = written
+            for offset, length in index:
+                self.write(pack("<QQ", offset, length))
+            self.write(pack("<QQB", index_offset, len(index), self.proto) +
+                       container_op + _CHUNK_MAGIC)
+            self.write(POP + STOP)
+        finally:
+            self._chunk_container = None
+            framer.file_write = file_write
+
     def memoize(self, obj):
         """Store an object in the memo."""
 
@@ -462,7 +569,8 @@ class _Pickler:
 
     # Return a PUT (BINPUT, LONG_BINPUT) opcode string, with argument i.
     def put(self, idx):
-        if self.proto >= 4:
+        # Chunks of a chunked pickle number their memo entries explicitly
+        if self.proto >= 4 and self._chunk_container is None:
             return MEMOIZE
         elif self.bin:
             if idx < 256:
@@ -497,6 +605,10 @@ class _Pickler:
             self.write(self.get(x[0]))
             return
 
+        if self._chunk_container is not None and obj is self._chunk_container:
+            raise PicklingError("can't pickle a reference to a chunked "
+                                "container")
+
         # Check the type dispatch table
         t = type(obj)
         f = self.dispatch.get(t)
@@ -735,6 +847,46 @@ class _Pickler:
         self.memoize(obj)
     dispatch[bytes] = save_bytes
 
+    def save_bytearray(self, obj):
+        if self.proto < 5:
+            # Older protocols have no opcode for bytearrays
+            self.save_reduce(obj=obj, *obj.__reduce_ex__(self.proto))
+            return
+        n = len(obj)
+        if n >= self.framer._FRAME_SIZE_TARGET:
+            self._write_large_bytes(BYTEARRAY8 + pack("<Q", n), obj)
+        else:
+            self.write(BYTEARRAY8 + pack("<Q", n) + obj)
+        self.memoize(obj)
+    dispatch[bytearray] = save_bytearray
+
+    if _HAVE_PICKLE_BUFFER:
+        def save_picklebuffer(self, obj):
+            if self.proto < 5:
+                raise PicklingError("PickleBuffer can only pickled with "
+                                    "protocol >= 5")
+            with obj.raw() as m:
+                if not m.contiguous:
+                    raise PicklingError("PickleBuffer can not be pickled when "
+                                        "pointing to a non-contiguous buffer")
+                in_band = True
+                if self._buffer_callback is not None:
+                    in_band = bool(self._buffer_callback(obj))
+                if in_band:
+                    # Write data in-band
+                    # XXX The C implementation avoids a copy here
+                    if m.readonly:
+                        self.save_bytes(m.tobytes())
+                    else:
+                        self.save_bytearray(m.tobytes())
+                else:
+                    # Write data out-of-band
+                    self.write(NEXT_BUFFER)
+                    if m.readonly:
+                        self.write(READONLY_BUFFER)
+
+        dispatch[PickleBuffer] = save_picklebuffer
+
     def save_str(self, obj):
         if self.bin:
             encoded = obj.encode('utf-8', 'surrogatepass')
@@ -1021,10 +1173,27 @@ class _Pickler:
 
 # Unpickling machinery
 
+def _map_file(file):
+    # Return a read-only mapping of *file* positioned at the file's current
+    # position, or None if the file can't be mapped.
+    try:
+        import mmap
+        fd = file.fileno()
+        pos = file.tell()
+        mapping = mmap.mmap(fd, 0, access=mmap.ACCESS_READ)
+    except (AttributeError, ImportError, OSError, ValueError):
+        return None
+    if not 0 <= pos <= len(mapping):
+        mapping.close()
+        return None
+    mapping.seek(pos)
+    return mapping
+
 class _Unpickler:
 
     def __init__(self, file, *, fix_imports=True,
-                 encoding="ASCII", errors="strict"):
+                 encoding="ASCII", errors="strict", buffers=None,
+                 use_mmap=False):
         """This takes a binary file for reading a pickle data stream.
 
         The protocol version of the pickle is detected automatically, so
@@ -1051,9 +1220,21 @@ class _Unpickler:
         to decode 8-bit string instances pickled by Python 2; these
         default to 'ASCII' and 'strict', respectively. *encoding* can be
         'bytes' to read theses 8-bit string instances as bytes objects.
+
+        If *buffers* is not None, it should be an iterable of buffer-enabled
+        objects that is consumed each time the pickle stream references
+        an out-of-band buffer view.  Such buffers have been given in order
+        to the *buffer_callback* of a Pickler object.
+
+        If *use_mmap* is true and *file* is a regular file, load() maps it
+        into memory and parses the pickle from the mapping instead of
+        read()ing it, then seeks the file past the pickle.  Other files
+        are read as usual.
         """
+        self._buffers = iter(buffers) if buffers is not None else None
         self._file_readline = file.readline
         self._file_read = file.read
+        self._mmap_file = file if use_mmap else None
         self.memo = {}
         self.encoding = encoding
         self.errors = errors
@@ -1070,7 +1251,13 @@ class _Unpickler:
         if not hasattr(self, "_file_read"):
             raise UnpicklingError("Unpickler.__init__() was not called by "
                                   "%s.__init__()" % (self.__class__.__name__,))
-        self._unframer = _Unframer(self._file_read, self._file_readline)
+        mapping = None
+        if self._mmap_file is not None:
+            mapping = _map_file(self._mmap_file)
+        if mapping is not None:
+            self._unframer = _Unframer(mapping.read, mapping.readline)
+        else:
+            self._unframer = _Unframer(self._file_read, self._file_readline)
         self.read = self._unframer.read
         self.readline = self._unframer.readline
         self.metastack = []
@@ -1087,7 +1274,12 @@ class _Unpickler:
                 assert isinstance(key, bytes_types)
                 dispatch[key[0]](self)
         except _Stop as stopinst:
+            if mapping is not None:
+                self._mmap_file.seek(mapping.tell())
             return stopinst.value
+        finally:
+            if mapping is not None:
+                mapping.close()
 
     # Return a list of items pushed in the stack after last MARK instruction.
     def pop_mark(self):
@@ -1258,6 +1450,32 @@ class _Unpickler:
         self.append(self.read(len))
     dispatch[BINBYTES8[0]] = load_binbytes8
 
+    def load_bytearray8(self):
+        len, = unpack('<Q', self.read(8))
+        if len > maxsize:
+            raise UnpicklingError("BYTEARRAY8 exceeds system's maximum size "
+                                  "of %d bytes" % maxsize)
+        self.append(bytearray(self.read(len)))
+    dispatch[BYTEARRAY8[0]] = load_bytearray8
+
+    def load_next_buffer(self):
+        if self._buffers is None:
+            raise UnpicklingError("pickle stream refers to out-of-band data "
+                                  "but no *buffers* argument was given")
+        try:
+            buf = next(self._buffers)
+        except StopIteration:
+            raise UnpicklingError("not enough out-of-band buffers")
+        self.append(buf)
+    dispatch[NEXT_BUFFER[0]] = load_next_buffer
+
+    def load_readonly_buffer(self):
+        buf = self.stack[-1]
+        with memoryview(buf) as m:
+            if not m.readonly:
+                self.stack[-1] = m.toreadonly()
+    dispatch[READONLY_BUFFER[0]] = load_readonly_buffer
+
     def load_short_binstring(self):
         len = self.read(1)[0]
         data = self.read(len)
@@ -1581,25 +1799,34 @@ class _Unpickler:
 
 # Shorthands
 
-def _dump(obj, file, protocol=None, *, fix_imports=True):
-    _Pickler(file, protocol, fix_imports=fix_imports).dump(obj)
+def _dump(obj, file, protocol=None, *, fix_imports=True,
+          buffer_callback=None, chunk_size=0):
+    _Pickler(file, protocol, fix_imports=fix_imports,
+             buffer_callback=buffer_callback,
+             chunk_size=chunk_size).dump(obj)
 
-def _dumps(obj, protocol=None, *, fix_imports=True):
+def _dumps(obj, protocol=None, *, fix_imports=True, buffer_callback=None,
+           chunk_size=0):
     f = io.BytesIO()
-    _Pickler(f, protocol, fix_imports=fix_imports).dump(obj)
+    _Pickler(f, protocol, fix_imports=fix_imports,
+             buffer_callback=buffer_callback,
+             chunk_size=chunk_size).dump(obj)
     res = f.getvalue()
     assert isinstance(res, bytes_types)
     return res
 
-def _load(file, *, fix_imports=True, encoding="ASCII", errors="strict"):
-    return _Unpickler(file, fix_imports=fix_imports,
-                     encoding=encoding, errors=errors).load()
+def _load(file, *, fix_imports=True, encoding="ASCII", errors="strict",
+          buffers=None, use_mmap=False):
+    return _Unpickler(file, fix_imports=fix_imports, buffers=buffers,
+                     encoding=encoding, errors=errors,
+                     use_mmap=use_mmap).load()
 
-def _loads(s, *, fix_imports=True, encoding="ASCII", errors="strict"):
+def _loads(s, *, fix_imports=True, encoding="ASCII", errors="strict",
+           buffers=None):
     if isinstance(s, str):
         raise TypeError("Can't load pickle from unicode string")
     file = io.BytesIO(s)
-    return _Unpickler(file, fix_imports=fix_imports,
+    return _Unpickler(file, fix_imports=fix_imports, buffers=buffers,
                       encoding=encoding, errors=errors).load()
 
 # Use the faster _pickle if possible
@@ -1619,6 +1846,69 @@ except ImportError:
     Pickler, Unpickler = _Pickler, _Unpickler
     dump, dumps, load, loads = _dump, _dumps, _load, _loads
 
+# Chunked pickles
+#
+# A list or dict pickled with a positive chunk_size is an ordinary pickle
+# whose items are split into chunks.  Each chunk is an APPENDS or SETITEMS
+# group that starts a new frame with an empty memo, so that it can be
+# decoded on its own.  Objects shared by items of different chunks are
+# pickled once per chunk, and aren't shared once loaded.
+#
+# The index of the chunks ends the pickle, as a BINBYTES8 object popped
+# right before STOP, so that loaders skip it and the pickle can be followed
+# by others in the same file: an (offset, length) pair of 8-byte
+# little-endian integers per chunk, relative to the start of the pickle,
+# then a trailer holding the offset of the index, the number of chunks, the
+# protocol, the opcode creating the container and _CHUNK_MAGIC.
+
+_CHUNK_MAGIC = b'PKLCHK'
+_CHUNK_TRAILER_SIZE = 24
+
+def _chunk_index(data):
+    # Return (view, start of the pickle, start of the index, number of
+    # chunks, protocol, container opcode)
+    view = memoryview(data).cast('B')
+    index_end = len(view) - _CHUNK_TRAILER_SIZE - 2
+    if index_end < 0 or view[-2:] != POP + STOP:
+        raise ValueError("not a chunked pickle")
+    index_offset, nchunks, proto, container_op, magic = \
+        unpack_from("<QQBc6s", view, index_end)
+    index_start = index_end - 16 * nchunks
+    start = index_start - index_offset
+    if magic != _CHUNK_MAGIC or start < 0:
+        raise ValueError("not a chunked pickle")
+    return view, start, index_start, nchunks, proto, container_op
+
+def chunk_count(data):
+    """Return the number of chunks of the chunked pickle *data*.
+
+    *data* is a bytes-like object ending with a pickle written with a
+    positive *chunk_size*.
+    """
+    return _chunk_index(data)[3]
+
+def load_chunk(data, index, *, fix_imports=True, encoding="ASCII",
+               errors="strict"):
+    """Return the list or dict holding the items of chunk *index* of the
+    chunked pickle *data*.
+
+    Chunks are independent of each other, so several processes can load
+    the chunks of the same mapped file in parallel.  An object shared by
+    items of different chunks is loaded once per chunk.  The optional
+    keyword arguments are the same as for loads().
+    """
+    view, start, index_start, nchunks, proto, container_op = \
+        _chunk_index(data)
+    if not -nchunks <= index < nchunks:
+        raise IndexError("chunk index out of range")
+    if index < 0:
+        index += nchunks
+    offset, length = unpack_from("<QQ", view, index_start + 16 * index)
+    return loads(b''.join((PROTO, bytes([proto]), container_op,
+                           view[start + offset:start + offset + length],
+                           STOP)),
+                 fix_imports=fix_imports, encoding=encoding, errors=errors)
+
 # Doctest
 def _test():
     import doctest
@@ -116,15 +116,20 @@ A, L, and U are mutually exclusive.
     X  VERBOSE     Ignore whitespace and comments for nicer looking RE's.
     U  UNICODE     For compatibility only. Ignored for string patterns (it
                    is the default), and forbidden for bytes patterns.
+       LINEAR      Match in time linear in the length of the string, without
+                   backtracking.  Backreferences and lookaround assertions
+                   are not supported.
 
 This module also defines an exception 'error'.
 
 """
 
 import enum
+import sys
 import sre_compile
 import sre_parse
 import functools
+import _sre
 try:
     import _locale
 except ImportError:
@@ -135,9 +140,10 @@ except ImportError:
 __all__ = [
     "match", "fullmatch", "search", "sub", "subn", "split",
     "findall", "finditer", "compile", "purge", "template", "escape",
-    "error", "Pattern", "Match", "A", "I", "L", "M", "S", "X", "U",
+    "error", "Pattern", "Match", "RegexSet",
+    "A", "I", "L", "M", "S", "X", "U",
     "ASCII", "IGNORECASE", "LOCALE", "MULTILINE", "DOTALL", "VERBOSE",
-    "UNICODE",
+    "UNICODE", "LINEAR",
 ]
 
 __version__ = "2.2.1"
@@ -150,6 +156,7 @@ class RegexFlag(enum.IntFlag):
     MULTILINE = sre_compile.SRE_FLAG_MULTILINE # make anchors look for newline
     DOTALL = sre_compile.SRE_FLAG_DOTALL # make dot match newline
     VERBOSE = sre_compile.SRE_FLAG_VERBOSE # ignore whitespace and comments
+    LINEAR = sre_compile.SRE_FLAG_LINEAR # match without backtracking
     A = ASCII
     I = IGNORECASE
     L = LOCALE
@@ -316,6 +323,51 @@ def _subx(pattern, template):
         return sre_parse.expand_template(template, match)
     return filter
 
+# --------------------------------------------------------------------
+# pattern sets
+
+class RegexSet:
+    """A sequence of patterns matched against a string in a single pass.
+
+    The patterns are compiled together for the linear-time matcher (see
+    the LINEAR flag), so backreferences and lookaround assertions are not
+    supported.  The match methods return the sorted list of the indices
+    of the patterns that match.
+    """
+
+    def __init__(self, patterns, flags=0):
+        if isinstance(flags, RegexFlag):
+            flags = flags.value
+        self.patterns = tuple(patterns)
+        self.flags = flags
+        self._code = sre_compile.compile_set(self.patterns, flags)
+
+    def __len__(self):
+        return len(self.patterns)
+
+    def __repr__(self):
+        if self.flags:
+            flags = '|'.join('re.' + flag.name for flag in RegexFlag
+                             if flag.value & self.flags)
+            return 're.RegexSet(%r, %s)' % (list(self.patterns), flags)
+        return 're.RegexSet(%r)' % (list(self.patterns),)
+
+    def search(self, string, pos=0, endpos=sys.maxsize):
+        """Return the indices of the patterns that match anywhere in
+        string."""
+        return _sre.set_matches(self._code, string, pos, endpos)
+
+    def match(self, string, pos=0, endpos=sys.maxsize):
+        """Return the indices of the patterns that match at the beginning
+        of string."""
+        return _sre.set_matches(self._code, string, pos, endpos,
+                                anchored=True)
+
+    def fullmatch(self, string, pos=0, endpos=sys.maxsize):
+        """Return the indices of the patterns that match all of string."""
+        return _sre.set_matches(self._code, string, pos, endpos,
+                                anchored=True, fullmatch=True)
+
 # register myself for pickling
 
 import copyreg
@@ -280,6 +280,9 @@ class socket(_socket.socket):
             timeout = self.gettimeout()
             if timeout == 0:
                 raise ValueError("non-blocking sockets are not supported")
+            if hasattr(_socket.socket, '_sendfile'):
+                return self._sendfile_use_c_sendfile(file, fileno, offset,
+                                                     count)
             # poll/select have the advantage of not requiring any
             # extra file descriptor, contrarily to epoll/kqueue
             # (also, they require a single syscall).
@@ -326,6 +329,35 @@ class socket(_socket.socket):
             finally:
                 if total_sent > 0 and hasattr(file, 'seek'):
                     file.seek(offset)
+
+        def _sendfile_use_c_sendfile(self, file, fileno, offset, count):
+            # The whole transfer, including the waits for the socket to be
+            # writable, runs in C without the GIL.  _sendfile() returns
+            # early when an error occurs after some data was sent; the next
+            # call raises it.
+            total_sent = 0
+            sendfile = self._sendfile
+            try:
+                while not count or total_sent < count:
+                    try:
+                        sent = sendfile(fileno, offset,
+                                        count - total_sent if count else -1)
+                    except _socket.timeout:
+                        raise
+                    except OSError as err:
+                        if total_sent == 0:
+                            # Not a regular mmap(2)-like file: fall back on
+                            # using plain send().
+                            raise _GiveupOnSendfile(err)
+                        raise err from None
+                    if sent == 0:
+                        break  # EOF
+                    offset += sent
+                    total_sent += sent
+                return total_sent
+            finally:
+                if total_sent > 0 and hasattr(file, 'seek'):
+                    file.seek(offset)
     else:
         def _sendfile_use_sendfile(self, file, offset=0, count=None):
             raise _GiveupOnSendfile(
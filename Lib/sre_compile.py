@@ -533,6 +533,111 @@ def _get_charset_prefix(pattern, flags):
         return charset
     return None
 
+# maximal number of literals in an SRE_INFO_LITERALS automaton
+_MAXLITERALS = 1000
+
+def _literal_alternatives(pattern, flags):
+    # internal: return a list of (literal, complete) pairs such that
+    # every match of pattern starts with one of the literals; complete
+    # is true if the match is the literal itself
+    iscased = _get_iscased(flags)
+    result = [((), True)]
+    for op, av in pattern:
+        if op is LITERAL:
+            if iscased and iscased(av):
+                break
+            alternatives = [((av,), True)]
+        elif op is IN:
+            if not all(op1 is LITERAL and not (iscased and iscased(av1))
+                       for op1, av1 in av):
+                break
+            alternatives = [((av1,), True) for op1, av1 in av]
+        elif op is BRANCH:
+            alternatives = []
+            for p in av[1]:
+                alternatives.extend(_literal_alternatives(p, flags))
+        elif op is SUBPATTERN:
+            group, add_flags, del_flags, p = av
+            flags1 = _combine_flags(flags, add_flags, del_flags)
+            if flags1 & SRE_FLAG_IGNORECASE and flags1 & SRE_FLAG_LOCALE:
+                break
+            alternatives = _literal_alternatives(p, flags1)
+        else:
+            break
+        new = []
+        for literal, complete in result:
+            if complete:
+                new.extend((literal + literal1, complete1)
+                           for literal1, complete1 in alternatives)
+            else:
+                new.append((literal, False))
+        if len(new) > _MAXLITERALS:
+            break
+        result = new
+    else:
+        return result
+    return [(literal, False) for literal, complete in result]
+
+def _get_literals(pattern, flags):
+    # look for a set of literal strings, one of which starts every match
+    literals = []
+    for literal, complete in sorted(_literal_alternatives(pattern, flags)):
+        if not literal:
+            return None
+        # a literal starting with another one doesn't add candidates
+        if not (literals and literal[:len(literals[-1])] == literals[-1]):
+            literals.append(literal)
+    return literals
+
+def _compile_literals(literals, code):
+    # compile an Aho-Corasick automaton finding the literals: the length
+    # of the longest literal, a bitmap of the first characters, and the
+    # nodes in breadth-first order.  A node is <fail> <outlen> <nedges>
+    # followed by (<char> <node>) edges sorted by character, where nodes
+    # are given by their offset from the first node and outlen is the
+    # length of the longest literal ending at the node.
+    edges = [{}]
+    depth = [0]
+    terminal = [False]
+    for literal in literals:
+        node = 0
+        for ch in literal:
+            child = edges[node].get(ch)
+            if child is None:
+                child = edges[node][ch] = len(edges)
+                edges.append({})
+                depth.append(depth[node] + 1)
+                terminal.append(False)
+            node = child
+        terminal[node] = True
+    fail = [0] * len(edges)
+    outlen = [0] * len(edges)
+    order = [0]
+    for node in order:
+        for ch, child in edges[node].items():
+            if node:
+                f = fail[node]
+                while f and ch not in edges[f]:
+                    f = fail[f]
+                fail[child] = edges[f].get(ch, 0)
+            order.append(child)
+        outlen[node] = depth[node] if terminal[node] else outlen[fail[node]]
+    offset = {}
+    size = 0
+    for node in order:
+        offset[node] = size
+        size += 3 + 2 * len(edges[node])
+    bits = bytearray(256)
+    for ch in edges[0]:
+        if ch < 256:
+            bits[ch] = 1
+    code.append(max(map(len, literals)))
+    code.extend(_mk_bitmap(bits))
+    for node in order:
+        code.extend((offset[fail[node]], outlen[node], len(edges[node])))
+        for ch, child in sorted(edges[node].items()):
+            code.extend((ch, offset[child]))
+
 def _compile_info(code, pattern, flags):
     # internal: compile an info block.  in the current version,
     # this contains min/max pattern width, and an optional literal
@@ -547,12 +652,17 @@ def _compile_info(code, pattern, flags):
     prefix = []
     prefix_skip = 0
     charset = [] # not used
+    literals = None
     if not (flags & SRE_FLAG_IGNORECASE and flags & SRE_FLAG_LOCALE):
         # look for literal prefix
         prefix, prefix_skip, got_all = _get_literal_prefix(pattern, flags)
-        # if no prefix, look for charset prefix
         if not prefix:
-            charset = _get_charset_prefix(pattern, flags)
+            # if no prefix, look for a set of literals of two or more
+            # characters, or else for a charset prefix
+            literals = _get_literals(pattern, flags)
+            if not literals or min(map(len, literals)) < 2:
+                literals = None
+                charset = _get_charset_prefix(pattern, flags)
 ##     if prefix:
 ##         print("*** PREFIX", prefix, prefix_skip)
 ##     if charset:
@@ -567,6 +677,8 @@ def _compile_info(code, pattern, flags):
         mask = SRE_INFO_PREFIX
         if prefix_skip is None and got_all:
             mask = mask | SRE_INFO_LITERAL
+    elif literals:
+        mask = mask | SRE_INFO_LITERALS
     elif charset:
         mask = mask | SRE_INFO_CHARSET
     emit(mask)
@@ -586,12 +698,170 @@ def _compile_info(code, pattern, flags):
         code.extend(prefix)
         # generate overlap table
         code.extend(_generate_overlap_table(prefix))
+    elif literals:
+        _compile_literals(literals, code)
     elif charset:
         charset, hascased = _optimize_charset(charset)
         assert not hascased
         _compile_charset(charset, flags, code)
     code[skip] = len(code) - skip
 
+# maximal size of a program for the linear-time matcher
+_MAXLINEARCODE = 100000
+
+# operators compiled to a single LINEAR_CHAR or LINEAR_AT instruction
+_LINEAR_CHAR_CODES = {LITERAL, NOT_LITERAL, IN, ANY, AT}
+
+def _compile_linear_char(op, av, flags):
+    # internal: the instruction for a single-character operator or an AT
+    # assertion
+    subcode = []
+    _compile(subcode, [(op, av)], flags)
+    return (LINEAR_AT if op is AT else LINEAR_CHAR, len(subcode), *subcode)
+
+def _compile_linear_sub(code, pattern, flags, base, groups, limit):
+    # internal: compile a (sub)pattern for the linear-time matcher.  jump
+    # targets are relative to base, only the first groups groups are
+    # captured, and the code may not grow past limit
+    for op, av in pattern:
+        if op in _LINEAR_CHAR_CODES:
+            code.extend(_compile_linear_char(op, av, flags))
+        elif op is SUBPATTERN:
+            group, add_flags, del_flags, p = av
+            flags1 = _combine_flags(flags, add_flags, del_flags)
+            if group and group <= groups:
+                code.extend((LINEAR_SAVE, (group-1)*2))
+            _compile_linear_sub(code, p, flags1, base, groups, limit)
+            if group and group <= groups:
+                code.extend((LINEAR_SAVE, (group-1)*2+1))
+        elif op is BRANCH:
+            tails = []
+            for p in av[1][:-1]:
+                split = len(code)
+                code.extend((LINEAR_SPLIT, split + 3 - base, 0))
+                _compile_linear_sub(code, p, flags, base, groups, limit)
+                tails.append(len(code) + 1)
+                code.extend((LINEAR_JUMP, 0))
+                code[split + 2] = len(code) - base
+            _compile_linear_sub(code, av[1][-1], flags, base, groups, limit)
+            for tail in tails:
+                code[tail] = len(code) - base
+        elif op in (MAX_REPEAT, MIN_REPEAT):
+            lo, hi, p = av
+            greedy = op is MAX_REPEAT
+            for i in range(lo):
+                _compile_linear_sub(code, p, flags, base, groups, limit)
+                if len(code) > limit:
+                    break
+            # as in SRE(match), an optional iteration matching the empty
+            # string ends the repeat.  the iterations of a loop whose body
+            # can match it alternate between two copies of the body, so
+            # that such an iteration doesn't run the instructions the
+            # previous one ended with at the same position
+            empty = p.getwidth()[0] == 0
+            splits = []
+            untils = []
+            if hi == MAXREPEAT:
+                loop = len(code)
+                for i in range(2 if empty else 1):
+                    splits.append(len(code))
+                    code.extend((LINEAR_SPLIT, 0, 0))
+                    _compile_linear_sub(code, p, flags, base, groups, limit)
+                    if empty:
+                        untils.append(len(code) + 2)
+                        code.extend((LINEAR_UNTIL, splits[-1] - base, 0))
+                code.extend((LINEAR_JUMP, loop - base))
+            else:
+                for i in range(hi - lo):
+                    splits.append(len(code))
+                    code.extend((LINEAR_SPLIT, 0, 0))
+                    _compile_linear_sub(code, p, flags, base, groups, limit)
+                    if empty and i < hi - lo - 1:
+                        untils.append(len(code) + 2)
+                        code.extend((LINEAR_UNTIL, splits[-1] - base, 0))
+                    if len(code) > limit:
+                        break
+            end = len(code) - base
+            for split in splits:
+                body = split + 3 - base
+                code[split+1:split+3] = (body, end) if greedy else (end, body)
+            for until in untils:
+                code[until] = end
+        elif op in (GROUPREF, GROUPREF_EXISTS):
+            raise error("backreferences are not supported in linear mode")
+        elif op in (ASSERT, ASSERT_NOT):
+            raise error("lookaround assertions are not supported in "
+                        "linear mode")
+        else:
+            raise error("internal: unsupported operand type %r" % (op,))
+        if len(code) > limit:
+            raise error("pattern too large for linear mode")
+
+def _compile_linear(code, p, flags):
+    # internal: compile a program for the linear-time matcher, which runs
+    # all the threads of the program in lockstep.  The program is
+    # <size> <groups> followed by the instructions, and jump targets are
+    # relative to the first instruction.
+    groups = p.pattern.groups - 1
+    start = len(code)
+    code.extend((0, groups))
+    base = len(code)
+    _compile_linear_sub(code, p, flags, base, groups,
+                        base + _MAXLINEARCODE)
+    code.append(LINEAR_MATCH)
+    code[start] = len(code) - base
+
+# longest shared prefix of the patterns of a set
+_MAXSETPREFIX = 64
+
+def _compile_linear_set(code, patterns):
+    # internal: compile a program for the linear-time matcher from a list
+    # of (pattern, flags) pairs, in which the i-th LINEAR_MATCH ends the
+    # i-th pattern.  The leading single-character operators and AT
+    # assertions of the patterns form a trie, so that a prefix shared by
+    # several patterns is run by a single thread; each leaf jumps to the
+    # rest of its pattern.
+    start = len(code)
+    code.extend((0, 0))
+    base = len(code)
+    root = ({}, [])
+    rests = []
+    for i, (p, flags) in enumerate(patterns):
+        node = root
+        j = 0
+        while (j < len(p.data) and j < _MAXSETPREFIX and
+               p.data[j][0] in _LINEAR_CHAR_CODES):
+            op, av = p.data[j]
+            key = _compile_linear_char(op, av, flags)
+            node = node[0].setdefault(key, ({}, []))
+            j += 1
+        node[1].append(i)
+        rests.append((p.data[j:], flags))
+    jumps = [None] * len(patterns)
+    def _compile_node(node):
+        children, leaves = node
+        alternatives = [(None, i) for i in leaves] + list(children.items())
+        for k, (key, alternative) in enumerate(alternatives):
+            last = k == len(alternatives) - 1
+            if not last:
+                split = len(code)
+                code.extend((LINEAR_SPLIT, split + 3 - base, 0))
+            if key is None:
+                jumps[alternative] = len(code) + 1
+                code.extend((LINEAR_JUMP, 0))
+            else:
+                code.extend(key)
+                _compile_node(alternative)
+            if not last:
+                code[split + 2] = len(code) - base
+    _compile_node(root)
+    for i, (rest, flags) in enumerate(rests):
+        code[jumps[i]] = len(code) - base
+        _compile_linear_sub(code, rest, flags, base, 0,
+                            len(code) + _MAXLINEARCODE)
+        code.append(LINEAR_MATCH)
+    code[start] = len(code) - base
+
 def isstring(obj):
     return isinstance(obj, (str, bytes))
 
@@ -603,6 +873,10 @@ def _code(p, flags):
     # compile info block
     _compile_info(code, p, flags)
 
+    if flags & SRE_FLAG_LINEAR:
+        _compile_linear(code, p, flags)
+        return code
+
     # compile the pattern
     _compile(code, p.data, flags)
 
@@ -742,6 +1016,9 @@ def dis(code):
                     start += prefix_len
                     print_2('  overlap', code[start: start+prefix_len])
                     start += prefix_len
+                if flags & SRE_INFO_LITERALS:
+                    print_2('  literals', 'maxlen=%d' % code[start],
+                            'size=%d' % (i + skip - start - 9))
                 if flags & SRE_INFO_CHARSET:
                     level += 1
                     print_2('in')
@@ -767,7 +1044,7 @@ def compile(p, flags=0):
 
     code = _code(p, flags)
 
-    if flags & SRE_FLAG_DEBUG:
+    if flags & SRE_FLAG_DEBUG and not flags & SRE_FLAG_LINEAR:
         print()
         dis(code)
 
@@ -782,3 +1059,26 @@ def compile(p, flags=0):
         p.pattern.groups-1,
         groupindex, tuple(indexgroup)
         )
+
+def compile_set(patterns, flags=0):
+    # internal: compile a sequence of patterns into a single program for
+    # the linear-time matcher, in which the i-th LINEAR_MATCH instruction
+    # ends the i-th pattern
+
+    flags |= SRE_FLAG_LINEAR
+    ps = [sre_parse.parse(p, flags) for p in patterns]
+    if not ps:
+        raise ValueError("a pattern set needs at least one pattern")
+    if any(isinstance(p, str) != isinstance(patterns[0], str)
+           for p in patterns):
+        raise TypeError("cannot mix str and bytes patterns")
+
+    code = []
+    pflags = ps[0].pattern.flags
+    if all(p.pattern.flags == pflags for p in ps):
+        # the search can skip to where one of the patterns can start
+        union = sre_parse.SubPattern(ps[0].pattern, [(BRANCH, (None, ps))])
+        _compile_info(code, union, pflags)
+    _compile_linear_set(code, [(p, p.pattern.flags) for p in ps])
+
+    return _sre.compile(patterns[0][:0], pflags, code, 0, {}, (None,))
@@ -13,7 +13,7 @@
 
 # update when constants are added or removed
 
-MAGIC = 20171005
+MAGIC = 20261018
 
 from _sre import MAXREPEAT, MAXGROUPS
 
@@ -131,6 +131,12 @@ ATCODES = _makecodes("""
     AT_UNI_BOUNDARY AT_UNI_NON_BOUNDARY
 """)
 
+# instructions of the linear-time matcher (SRE_FLAG_LINEAR)
+LINEAR_OPCODES = _makecodes("""
+    LINEAR_MATCH LINEAR_CHAR LINEAR_AT LINEAR_SPLIT LINEAR_JUMP LINEAR_SAVE
+    LINEAR_UNTIL
+""")
+
 # categories
 CHCODES = _makecodes("""
     CATEGORY_DIGIT CATEGORY_NOT_DIGIT
@@ -210,11 +216,13 @@ SRE_FLAG_UNICODE = 32 # use unicode "locale"
 SRE_FLAG_VERBOSE = 64 # ignore whitespace and comments
 SRE_FLAG_DEBUG = 128 # debugging
 SRE_FLAG_ASCII = 256 # use ascii "locale"
+SRE_FLAG_LINEAR = 512 # linear-time matching (no backtracking)
 
 # flags for INFO primitive
 SRE_INFO_PREFIX = 1 # has prefix
 SRE_INFO_LITERAL = 2 # entire pattern is literal (given by prefix)
 SRE_INFO_CHARSET = 4 # pattern starts with character from given set
+SRE_INFO_LITERALS = 8 # pattern starts with one of a set of literal strings
 
 if __name__ == "__main__":
     def dump(f, d, prefix):
@@ -243,6 +251,7 @@ if __name__ == "__main__":
         dump(f, OPCODES, "SRE_OP")
         dump(f, ATCODES, "SRE")
         dump(f, CHCODES, "SRE")
+        dump(f, LINEAR_OPCODES, "SRE_OP")
 
         f.write("#define SRE_FLAG_TEMPLATE %d\n" % SRE_FLAG_TEMPLATE)
         f.write("#define SRE_FLAG_IGNORECASE %d\n" % SRE_FLAG_IGNORECASE)
@@ -253,9 +262,11 @@ if __name__ == "__main__":
         f.write("#define SRE_FLAG_VERBOSE %d\n" % SRE_FLAG_VERBOSE)
         f.write("#define SRE_FLAG_DEBUG %d\n" % SRE_FLAG_DEBUG)
         f.write("#define SRE_FLAG_ASCII %d\n" % SRE_FLAG_ASCII)
+        f.write("#define SRE_FLAG_LINEAR %d\n" % SRE_FLAG_LINEAR)
 
         f.write("#define SRE_INFO_PREFIX %d\n" % SRE_INFO_PREFIX)
         f.write("#define SRE_INFO_LITERAL %d\n" % SRE_INFO_LITERAL)
         f.write("#define SRE_INFO_CHARSET %d\n" % SRE_INFO_CHARSET)
+        f.write("#define SRE_INFO_LITERALS %d\n" % SRE_INFO_LITERALS)
 
     print("done")
@@ -3,6 +3,7 @@ import copyreg
 import dbm
 import io
 import functools
+import mmap
 import os
 import pickle
 import pickletools
@@ -48,6 +49,80 @@ def count_opcode(code, pickle):
     return n
 
 
+class PlainObject:
+    pass
+
+class DictPropertyObject:
+    store = {'a': 1}
+    accessed = 0
+
+    @property
+    def __dict__(self):
+        type(self).accessed += 1
+        return self.store
+
+class GetattrObject:
+    def __getattr__(self, name):
+        if name == '__setstate__':
+            return self.setstate
+        raise AttributeError(name)
+
+    def setstate(self, state):
+        self.__dict__['state'] = state
+
+
+class ZeroCopyBytes(bytes):
+    readonly = True
+    c_contiguous = True
+    f_contiguous = True
+    zero_copy_reconstruct = True
+
+    def __reduce_ex__(self, protocol):
+        if protocol >= 5:
+            return type(self)._reconstruct, (pickle.PickleBuffer(self),), None
+        else:
+            return type(self)._reconstruct, (bytes(self),)
+
+    def __repr__(self):
+        return "{}({!r})".format(self.__class__.__name__, bytes(self))
+
+    @classmethod
+    def _reconstruct(cls, obj):
+        with memoryview(obj) as m:
+            obj = m.obj
+            if type(obj) is cls:
+                # Zero-copy
+                return obj
+            else:
+                return cls(obj)
+
+
+class ZeroCopyBytearray(bytearray):
+    readonly = False
+    c_contiguous = True
+    f_contiguous = True
+    zero_copy_reconstruct = True
+
+    def __reduce_ex__(self, protocol):
+        if protocol >= 5:
+            return type(self)._reconstruct, (pickle.PickleBuffer(self),), None
+        else:
+            return type(self)._reconstruct, (bytes(self),)
+
+    def __repr__(self):
+        return "{}({!r})".format(self.__class__.__name__, bytes(self))
+
+    @classmethod
+    def _reconstruct(cls, obj):
+        with memoryview(obj) as m:
+            obj = m.obj
+            if type(obj) is cls:
+                # Zero-copy
+                return obj
+            else:
+                return cls(obj)
+
+
 class UnseekableIO(io.BytesIO):
     def peek(self, *args):
         raise NotImplementedError
@@ -1499,6 +1574,25 @@ class AbstractPickleTests(unittest.TestCase):
                 p = self.dumps(s, proto)
                 self.assert_is_copy(s, self.loads(p))
 
+    def test_bytearray(self):
+        for proto in protocols:
+            for s in b'', b'xyz', b'xyz'*100:
+                b = bytearray(s)
+                p = self.dumps(b, proto)
+                bb = self.loads(p)
+                self.assertIsNot(bb, b)
+                self.assert_is_copy(b, bb)
+                if proto <= 3:
+                    # bytearray is serialized using a global reference
+                    self.assertIn(b'bytearray', p)
+                    self.assertTrue(opcode_in_pickle(pickle.GLOBAL, p))
+                elif proto == 4:
+                    self.assertIn(b'bytearray', p)
+                    self.assertTrue(opcode_in_pickle(pickle.STACK_GLOBAL, p))
+                elif proto == 5:
+                    self.assertNotIn(b'bytearray', p)
+                    self.assertTrue(opcode_in_pickle(pickle.BYTEARRAY8, p))
+
     def test_ints(self):
         for proto in protocols:
             n = sys.maxsize
@@ -2063,6 +2157,39 @@ class AbstractPickleTests(unittest.TestCase):
             for x_key, y_key in zip(x_keys, y_keys):
                 self.assertIs(x_key, y_key)
 
+    def test_build_instances(self):
+        # Instances of plain classes and of classes overriding the default
+        # state setting behaviour.
+        for proto in protocols:
+            with self.subTest(proto=proto):
+                objs = []
+                for i in range(10):
+                    x = PlainObject()
+                    x.a = i
+                    x.b = [x]
+                    if i % 3 == 0:
+                        x.c = None
+                    objs.append(x)
+                y = self.loads(self.dumps(objs, proto))
+                for x, z in zip(objs, y):
+                    self.assertIs(type(z), PlainObject)
+                    self.assertEqual(list(z.__dict__), list(x.__dict__))
+                    self.assertEqual(z.a, x.a)
+                    self.assertIs(z.b[0], z)
+
+                if proto < 2:
+                    # The state is taken from __dict__ by copyreg
+                    s = self.dumps(DictPropertyObject(), proto)
+                    accessed = DictPropertyObject.accessed
+                    self.assertIs(type(self.loads(s)), DictPropertyObject)
+                    self.assertGreater(DictPropertyObject.accessed, accessed)
+
+                x = GetattrObject()
+                x.a = 1
+                y = self.loads(self.dumps(x, proto))
+                self.assertEqual(y.state, {'a': 1})
+                self.assertNotIn('a', y.__dict__)
+
     def test_pickle_to_2x(self):
         # Pickle non-trivial data with protocol 2, expecting that it yields
         # the same result as Python 2.x did.
@@ -2322,6 +2449,117 @@ class AbstractPickleTests(unittest.TestCase):
                                  len(large_sizes) + len(medium_sizes) + 3,
                                  chunk_sizes)
 
+    def buffer_like_objects(self):
+        # Yield buffer-like objects with the bytestring "abcdef" in them
+        bytestring = b"abcdefgh"
+        yield ZeroCopyBytes(bytestring)
+        yield ZeroCopyBytearray(bytestring)
+
+    def test_in_band_buffers(self):
+        # Test in-band buffers (PEP 574)
+        for obj in self.buffer_like_objects():
+            for proto in range(0, pickle.HIGHEST_PROTOCOL + 1):
+                data = self.dumps(obj, proto)
+                if obj.readonly:
+                    self.assertIn(b"abcdefgh", data)
+                self.assertEqual(count_opcode(pickle.NEXT_BUFFER, data), 0)
+                if proto >= 5:
+                    self.assertEqual(count_opcode(pickle.SHORT_BINBYTES, data),
+                                     1 if obj.readonly else 0)
+                    self.assertEqual(count_opcode(pickle.BYTEARRAY8, data),
+                                     0 if obj.readonly else 1)
+                    # Return a true value from buffer_callback should have
+                    # the same effect
+                    def buffer_callback(obj):
+                        return True
+                    data2 = self.dumps(obj, proto,
+                                       buffer_callback=buffer_callback)
+                    self.assertEqual(data2, data)
+
+                new = self.loads(data)
+                # It's a copy
+                self.assertIsNot(new, obj)
+                self.assertIs(type(new), type(obj))
+                self.assertEqual(new, obj)
+
+    def test_oob_buffers(self):
+        # Test out-of-band buffers (PEP 574)
+        for obj in self.buffer_like_objects():
+            for proto in range(0, 5):
+                # Need protocol >= 5 for buffer_callback
+                with self.assertRaises(ValueError):
+                    self.dumps(obj, proto,
+                               buffer_callback=[].append)
+            for proto in range(5, pickle.HIGHEST_PROTOCOL + 1):
+                buffers = []
+                buffer_callback = lambda pb: buffers.append(pb.raw())
+                data = self.dumps(obj, proto,
+                                  buffer_callback=buffer_callback)
+                self.assertNotIn(b"abcdefgh", data)
+                self.assertEqual(count_opcode(pickle.SHORT_BINBYTES, data), 0)
+                self.assertEqual(count_opcode(pickle.BYTEARRAY8, data), 0)
+                self.assertEqual(count_opcode(pickle.NEXT_BUFFER, data), 1)
+                self.assertEqual(count_opcode(pickle.READONLY_BUFFER, data),
+                                 1 if obj.readonly else 0)
+
+                # Missing buffers
+                with self.assertRaises(pickle.UnpicklingError):
+                    self.loads(data)
+
+                new = self.loads(data, buffers=buffers)
+                if obj.zero_copy_reconstruct:
+                    # Zero-copy achieved
+                    self.assertIs(new, obj)
+                else:
+                    self.assertIs(type(new), type(obj))
+                    self.assertEqual(new, obj)
+                # Non-sequence buffers accepted too
+                new = self.loads(data, buffers=iter(buffers))
+                if obj.zero_copy_reconstruct:
+                    # Zero-copy achieved
+                    self.assertIs(new, obj)
+                else:
+                    self.assertIs(type(new), type(obj))
+                    self.assertEqual(new, obj)
+
+    def test_oob_buffers_writable_to_readonly(self):
+        # Test reconstructing readonly object from writable buffer
+        obj = ZeroCopyBytes(b"foobar")
+        for proto in range(5, pickle.HIGHEST_PROTOCOL + 1):
+            buffers = []
+            buffer_callback = buffers.append
+            data = self.dumps(obj, proto, buffer_callback=buffer_callback)
+
+            buffers = map(bytearray, buffers)
+            new = self.loads(data, buffers=buffers)
+            self.assertIs(type(new), type(obj))
+            self.assertEqual(new, obj)
+
+    def test_picklebuffer_error(self):
+        # PickleBuffer forbidden with protocol < 5
+        pb = pickle.PickleBuffer(b"foobar")
+        for proto in range(0, 5):
+            with self.assertRaises(pickle.PickleError):
+                self.dumps(pb, proto)
+
+    def test_buffer_callback_error(self):
+        def buffer_callback(buffers):
+            1/0
+        pb = pickle.PickleBuffer(b"foobar")
+        with self.assertRaises(ZeroDivisionError):
+            self.dumps(pb, 5, buffer_callback=buffer_callback)
+
+    def test_buffers_error(self):
+        pb = pickle.PickleBuffer(b"foobar")
+        for proto in range(5, pickle.HIGHEST_PROTOCOL + 1):
+            data = self.dumps(pb, proto, buffer_callback=[].append)
+            # Non iterable buffers
+            with self.assertRaises(TypeError):
+                self.loads(data, buffers=object())
+            # Buffer iterable exhausts too early
+            with self.assertRaises(pickle.UnpicklingError):
+                self.loads(data, buffers=[])
+
     def test_nested_names(self):
         global Nested
         class Nested:
@@ -2750,9 +2988,159 @@ class AbstractPickleModuleTests(unittest.TestCase):
         unpickled = self.load(stream)
         self.assertEqual(unpickled, data)
 
+    def test_load_mmap(self):
+        data = [C(), "abc" * 10000, list(range(1000))]
+        data[0].foo = data
+        with open(TESTFN, "wb") as f:
+            f.write(b"header")
+            for proto in protocols:
+                self.dump(data, f, proto)
+            f.write(b"trailer")
+        try:
+            with open(TESTFN, "rb") as f:
+                self.assertEqual(f.read(6), b"header")
+                for proto in protocols:
+                    with self.subTest(proto=proto):
+                        loaded = self.load(f, use_mmap=True)
+                        self.assertEqual(loaded[1:], data[1:])
+                        self.assertIs(loaded[0].foo, loaded)
+                self.assertEqual(f.read(), b"trailer")
+            with open(TESTFN, "rb") as f:
+                f.seek(6)
+                unpickler = self.Unpickler(f, use_mmap=True)
+                for proto in protocols:
+                    self.assertEqual(unpickler.load()[1:], data[1:])
+                self.assertEqual(f.read(), b"trailer")
+            # Truncated pickle
+            with open(TESTFN, "wb") as f:
+                f.write(self.dumps(data, 4)[:-10])
+            with open(TESTFN, "rb") as f:
+                self.assertRaises((EOFError, pickle.UnpicklingError),
+                                  self.load, f, use_mmap=True)
+            # Empty files can't be mapped
+            with open(TESTFN, "wb") as f:
+                pass
+            with open(TESTFN, "rb") as f:
+                self.assertRaises(EOFError, self.load, f, use_mmap=True)
+        finally:
+            support.unlink(TESTFN)
+        # Streams without a file descriptor are read as usual
+        stream = io.BytesIO()
+        self.dump(data, stream)
+        self.dump(123, stream)
+        stream.seek(0)
+        self.assertEqual(self.load(stream, use_mmap=True)[1:], data[1:])
+        self.assertEqual(self.load(stream, use_mmap=True), 123)
+
+    def check_chunks(self, data, obj):
+        loaded = type(obj)()
+        for i in range(pickle.chunk_count(data)):
+            chunk = pickle.load_chunk(data, i)
+            self.assertIs(type(chunk), type(obj))
+            if isinstance(obj, list):
+                loaded.extend(chunk)
+            else:
+                loaded.update(chunk)
+        self.assertEqual(loaded, obj)
+
+    def test_chunked(self):
+        shared = [1, 2]
+        lst = [[i, str(i), shared] for i in range(10)]
+        dct = {str(i): (i, shared) for i in range(10)}
+        for proto in range(4, pickle.HIGHEST_PROTOCOL + 1):
+            for obj in lst, dct, [], {}:
+                for chunk_size in 1, 3, 1000:
+                    with self.subTest(proto=proto, obj=obj,
+                                      chunk_size=chunk_size):
+                        data = self.dumps(obj, proto, chunk_size=chunk_size)
+                        loaded = pickle.loads(data)
+                        self.assertEqual(loaded, obj)
+                        self.assertEqual(pickle.chunk_count(data),
+                                         -(-len(obj) // chunk_size))
+                        self.check_chunks(data, obj)
+                        # Objects shared within a chunk stay shared
+                        chunk = pickle.load_chunk(data, -1) if obj else None
+                        if isinstance(chunk, list):
+                            self.assertIs(chunk[0][2], chunk[-1][2])
+                        elif chunk:
+                            values = list(chunk.values())
+                            self.assertIs(values[0][1], values[-1][1])
+            # Other objects are pickled as usual
+            self.assertEqual(self.dumps((1, 2), proto, chunk_size=1),
+                             self.dumps((1, 2), proto))
+            self.assertRaises(ValueError, pickle.chunk_count,
+                              self.dumps(lst, proto))
+        self.assertEqual(pickle.load_chunk(self.dumps(lst, 4, chunk_size=3),
+                                           3), lst[9:])
+        self.assertRaises(IndexError, pickle.load_chunk,
+                          self.dumps(lst, 4, chunk_size=3), 4)
+        self.assertRaises(ValueError, self.dumps, lst, 3, chunk_size=1)
+        self.assertRaises(ValueError, self.dumps, lst, 4, chunk_size=-1)
+        self.assertRaises(ValueError, self.Pickler, io.BytesIO(), 2,
+                          chunk_size=1)
+
+    def test_chunked_recursive(self):
+        lst = [1, 2]
+        lst.append([lst])
+        self.assertRaises(pickle.PicklingError, self.dumps, lst, 4,
+                          chunk_size=2)
+        dct = {}
+        dct[1] = dct
+        self.assertRaises(pickle.PicklingError, self.dumps, dct, 4,
+                          chunk_size=2)
+
+    def test_chunked_file(self):
+        obj = [b'x' * 100000, 1, 'abc' * 30000, b'y' * 70000, 2.5]
+        with open(TESTFN, "wb") as f:
+            pickler = self.Pickler(f, 4, chunk_size=2)
+            pickler.dump(obj)
+        try:
+            with open(TESTFN, "rb") as f:
+                self.assertEqual(self.load(f), obj)
+                f.seek(0)
+                data = f.read()
+            self.assertEqual(pickle.chunk_count(data), 3)
+            self.check_chunks(data, obj)
+            with open(TESTFN, "rb") as f, \
+                 mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as m:
+                self.assertEqual(pickle.load_chunk(m, 1), obj[2:4])
+        finally:
+            support.unlink(TESTFN)
+
+    def test_chunked_stream(self):
+        # A chunked pickle ends at STOP like any other pickle, so that it
+        # can be followed by other pickles in the same stream
+        shared = [1, 2]
+        obj = [shared, 'a', shared, 'b']
+        for proto in range(4, pickle.HIGHEST_PROTOCOL + 1):
+            with self.subTest(proto=proto):
+                f = io.BytesIO()
+                pickler = self.Pickler(f, proto, chunk_size=2)
+                pickler.dump(obj)
+                end = f.tell()
+                pickler.dump({'x': 1})
+                end2 = f.tell()
+                self.dump('tail', f, proto)
+                f.seek(0)
+                loaded = self.load(f)
+                self.assertEqual(f.tell(), end)
+                self.assertEqual(loaded, obj)
+                # Objects aren't shared between chunks
+                self.assertIs(loaded[0], loaded[0])
+                self.assertIsNot(loaded[0], loaded[2])
+                self.assertEqual(self.load(f), {'x': 1})
+                self.assertEqual(f.tell(), end2)
+                self.assertEqual(self.load(f), 'tail')
+                data = f.getvalue()
+                self.assertEqual(pickle.chunk_count(data[:end]), 2)
+                self.check_chunks(data[:end], obj)
+                self.assertEqual(pickle.chunk_count(data[end:end2]), 1)
+                with self.assertRaises(ValueError):
+                    pickle.chunk_count(data)
+
     def test_highest_protocol(self):
         # Of course this needs to be changed when HIGHEST_PROTOCOL changes.
-        self.assertEqual(pickle.HIGHEST_PROTOCOL, 4)
+        self.assertEqual(pickle.HIGHEST_PROTOCOL, 5)
 
     def test_callapi(self):
         f = io.BytesIO()
@@ -2948,6 +3336,15 @@ class AbstractPicklerUnpicklerObjectTests(unittest.TestCase):
         self.assertEqual(unpickled_data2, data)
         self.assertTrue(unpickled_data2 is unpickled_data1)
 
+    def test_empty_unpickler_memo(self):
+        # The memo grows again after being replaced by an empty one.
+        data = [[i] for i in range(100)] * 2
+        for proto in protocols:
+            f = io.BytesIO(pickle.dumps(data, proto))
+            unpickler = self.unpickler_class(f)
+            unpickler.memo = {}
+            self.assertEqual(unpickler.load(), data)
+
     def test_reusing_unpickler_objects(self):
         data1 = ["abcdefg", "abcdefg", 44]
         f = io.BytesIO()
@@ -266,6 +266,20 @@ class BaseTest:
             self.assertEqual(a.x, b.x)
             self.assertEqual(type(a), type(b))
 
+    def test_pickle_out_of_band(self):
+        a = array.array(self.typecode, self.example)
+        for protocol in range(5, pickle.HIGHEST_PROTOCOL + 1):
+            buffers = []
+            data = pickle.dumps(a, protocol, buffer_callback=buffers.append)
+            self.assertEqual(len(buffers), 1)
+            self.assertEqual(bytes(buffers[0]), a.tobytes())
+            b = pickle.loads(data, buffers=buffers)
+            self.assertNotEqual(id(a), id(b))
+            self.assertEqual(a, b)
+            # in-band
+            b = pickle.loads(pickle.dumps(a, protocol))
+            self.assertEqual(a, b)
+
     def test_pickle_for_empty_array(self):
         for protocol in range(pickle.HIGHEST_PROTOCOL + 1):
             a = array.array(self.typecode)
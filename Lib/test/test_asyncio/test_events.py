@@ -2645,6 +2645,14 @@ else:
             def create_event_loop(self):
                 return asyncio.SelectorEventLoop(selectors.EpollSelector())
 
+    if hasattr(asyncio, 'EpollEventLoop'):
+        class CEPollEventLoopTests(UnixEventLoopTestsMixin,
+                                   SubprocessTestsMixin,
+                                   test_utils.TestCase):
+
+            def create_event_loop(self):
+                return asyncio.EpollEventLoop()
+
     if hasattr(selectors, 'PollSelector'):
         class PollEventLoopTests(UnixEventLoopTestsMixin,
                                  SubprocessTestsMixin,
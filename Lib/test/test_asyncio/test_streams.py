@@ -890,5 +890,169 @@ os.close(fd)
             self.loop.run_until_complete(wr.wait_closed())
 
 
+    def test_open_connection_buffered_flow_control(self):
+        # open_connection() receives the data directly into the buffer of
+        # the reader, which pauses the transport above twice the limit.
+        data = os.urandom(1024 * 1024)
+
+        async def handle_client(client_reader, client_writer):
+            client_writer.write(data)
+            await client_writer.drain()
+            client_writer.close()
+
+        async def client(addr):
+            reader, writer = await asyncio.open_connection(
+                *addr, limit=1024, loop=self.loop)
+            self.assertIsInstance(writer._protocol, asyncio.BufferedProtocol)
+            await asyncio.sleep(0.1, loop=self.loop)
+            self.assertTrue(reader._paused)
+            received = await reader.readexactly(len(data))
+            self.assertEqual(await reader.read(), b'')
+            writer.close()
+            return received
+
+        server = self.loop.run_until_complete(
+            asyncio.start_server(handle_client, '127.0.0.1', 0,
+                                 loop=self.loop))
+        addr = server.sockets[0].getsockname()
+        received = self.loop.run_until_complete(client(addr))
+        server.close()
+        self.loop.run_until_complete(server.wait_closed())
+        self.assertEqual(received, data)
+
+
+class BaseStreamBufferTests:
+
+    buffer_class = None
+
+    def test_extend_take(self):
+        buf = self.buffer_class()
+        self.assertEqual(len(buf), 0)
+        buf.extend(b'line1\n')
+        buf.extend(bytearray(b'line2\n'))
+        buf.extend(memoryview(b'line3\n'))
+        self.assertEqual(len(buf), 18)
+        self.assertEqual(buf.take(6), b'line1\n')
+        self.assertEqual(buf, b'line2\nline3\n')
+        self.assertEqual(buf.take(100), b'line2\nline3\n')
+        self.assertEqual(buf.take(0), b'')
+        self.assertEqual(len(buf), 0)
+        self.assertRaises(ValueError, buf.take, -1)
+
+    def test_clear(self):
+        buf = self.buffer_class()
+        buf.extend(b'data')
+        buf.clear()
+        self.assertEqual(buf, b'')
+        buf.extend(b'more')
+        self.assertEqual(buf.take(4), b'more')
+
+    def test_find(self):
+        buf = self.buffer_class()
+        buf.extend(b'\r\r\nheader\r\n\r\nbody')
+        self.assertEqual(buf.find(b'\n'), 2)
+        self.assertEqual(buf.find(b'\r\n'), 1)
+        self.assertEqual(buf.find(b'\r\n\r\n'), 9)
+        self.assertEqual(buf.find(b'\r\n', 3), 9)
+        self.assertEqual(buf.find(b'\r\n\r\n', 10), -1)
+        self.assertEqual(buf.find(b'missing'), -1)
+        self.assertEqual(buf.find(b'\r\n\r\nbody!'), -1)
+        buf.take(3)
+        self.assertEqual(buf.find(b'\r\n'), 6)
+        self.assertEqual(buf.find(b'body'), 10)
+
+    def test_startswith(self):
+        buf = self.buffer_class()
+        buf.extend(b'abcdef')
+        self.assertTrue(buf.startswith(b'abc'))
+        self.assertTrue(buf.startswith(b'cd', 2))
+        self.assertFalse(buf.startswith(b'abcdefg'))
+        self.assertFalse(buf.startswith(b'bc'))
+        buf.take(1)
+        self.assertTrue(buf.startswith(b'bc'))
+
+    def test_get_buffer(self):
+        buf = self.buffer_class()
+        buf.extend(b'head')
+        view = buf.get_buffer(10)
+        self.assertGreaterEqual(len(view), 10)
+        view[:4] = b'tail'
+        del view
+        buf.buffer_updated(4)
+        self.assertEqual(buf, b'headtail')
+        view = buf.get_buffer(-1)
+        self.assertGreater(len(view), 0)
+        del view
+        buf.buffer_updated(0)
+        self.assertEqual(buf.take(8), b'headtail')
+
+    def test_buffer_interface(self):
+        # The buffer interface exposes the data
+        buf = self.buffer_class()
+        self.assertEqual(bytes(buf), b'')
+        buf.extend(b'abcdef')
+        buf.take(2)
+        self.assertEqual(bytes(buf), b'cdef')
+        with memoryview(buf) as view:
+            self.assertEqual(view, b'cdef')
+        other = self.buffer_class()
+        other.extend(b'cdef')
+        self.assertEqual(buf, other)
+        other.take(1)
+        self.assertNotEqual(buf, other)
+
+
+class PyStreamBufferTests(BaseStreamBufferTests, unittest.TestCase):
+
+    buffer_class = asyncio.streams._PyStreamBuffer
+
+
+@unittest.skipUnless(hasattr(asyncio.streams, '_CStreamBuffer'),
+                     'requires the C _asyncio module')
+class CStreamBufferTests(BaseStreamBufferTests, unittest.TestCase):
+
+    try:
+        buffer_class = asyncio.streams._CStreamBuffer
+    except AttributeError:
+        buffer_class = None
+
+    def test_exported_buffer(self):
+        buf = self.buffer_class()
+        buf.extend(b'data')
+        view = buf.get_buffer(16)
+        # The free space is exported by another object, which keeps the
+        # storage in place until the view is released
+        self.assertIsNot(view.obj, buf)
+        self.assertEqual(bytes(buf), b'data')
+        self.assertRaises(BufferError, buf.extend, b'more')
+        self.assertEqual(buf.take(2), b'da')
+        view[:2] = b'!!'
+        buf.buffer_updated(2)
+        self.assertEqual(buf, b'ta!!')
+        view.release()
+        buf.extend(b'more')
+        self.assertEqual(buf, b'ta!!more')
+        data = memoryview(buf)
+        self.assertRaises(BufferError, buf.extend, b'more')
+        self.assertEqual(data, b'ta!!more')
+        data.release()
+        buf.extend(b'!')
+        self.assertEqual(buf.take(100), b'ta!!more!')
+
+    def test_buffer_updated_out_of_range(self):
+        buf = self.buffer_class()
+        view = buf.get_buffer(16)
+        size = len(view)
+        view.release()
+        self.assertRaises(ValueError, buf.buffer_updated, size + 1)
+        self.assertRaises(ValueError, buf.buffer_updated, -1)
+        self.assertEqual(len(buf), 0)
+
+    def test_repr(self):
+        buf = self.buffer_class()
+        buf.extend(b'abc')
+        self.assertEqual(repr(buf), "StreamBuffer(b'abc')")
+
+
 if __name__ == '__main__':
     unittest.main()
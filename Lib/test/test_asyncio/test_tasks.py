@@ -2386,6 +2386,73 @@ class BaseTaskTests:
 
         self.assertEqual(cvar.get(), -1)
 
+    def test_eager_start(self):
+        current = []
+
+        async def child():
+            current.append(asyncio.current_task(self.loop))
+            return 'spam'
+
+        async def main():
+            parent = asyncio.current_task(self.loop)
+            task = self.Task(child(), loop=self.loop, eager_start=True)
+            self.assertTrue(task.done())
+            self.assertIs(asyncio.current_task(self.loop), parent)
+            return task
+
+        task = self.loop.run_until_complete(self.new_task(self.loop, main()))
+        self.assertEqual(task.result(), 'spam')
+        self.assertEqual(current, [task])
+
+    def test_eager_start_suspended(self):
+        async def child():
+            await asyncio.sleep(0, loop=self.loop)
+            return 'spam'
+
+        async def main():
+            task = self.Task(child(), loop=self.loop, eager_start=True)
+            self.assertFalse(task.done())
+            return await task
+
+        result = self.loop.run_until_complete(
+            self.new_task(self.loop, main()))
+        self.assertEqual(result, 'spam')
+
+    def test_eager_start_exception(self):
+        async def child():
+            raise ValueError('spam')
+
+        async def main():
+            task = self.Task(child(), loop=self.loop, eager_start=True)
+            self.assertTrue(task.done())
+            return task
+
+        task = self.loop.run_until_complete(self.new_task(self.loop, main()))
+        self.assertIsInstance(task.exception(), ValueError)
+
+    def test_eager_start_loop_not_running(self):
+        async def coro():
+            return 'spam'
+
+        task = self.Task(coro(), loop=self.loop, eager_start=True)
+        self.assertFalse(task.done())
+        self.assertEqual(self.loop.run_until_complete(task), 'spam')
+
+    def test_eager_task_factory(self):
+        async def child(i):
+            if i % 2:
+                await asyncio.sleep(0, loop=self.loop)
+            return i
+
+        async def main():
+            return await asyncio.gather(*[child(i) for i in range(10)],
+                                        loop=self.loop)
+
+        self.loop.set_task_factory(
+            asyncio.create_eager_task_factory(self.Task))
+        self.assertEqual(self.loop.run_until_complete(main()),
+                         list(range(10)))
+
 
 def add_subclass_tests(cls):
     BaseTask = cls.Task
@@ -2530,6 +2597,45 @@ class CTask_CFuture_Tests(BaseTaskTests, SetMethodsTest,
         with self.assertRaises(AttributeError):
             del task._log_destroy_pending
 
+    def test_ready_queue(self):
+        # Callbacks of C futures are appended to the ready queue of
+        # the loop without going through call_soon().
+        self.loop.set_debug(False)
+        fut = self.new_future(self.loop)
+        calls = []
+        fut.add_done_callback(calls.append)
+        fut.set_result(1)
+        handle = self.loop._ready[-1]
+        self.assertNotIsInstance(handle, asyncio.Handle)
+        self.assertEqual(handle._callback, calls.append)
+        self.assertEqual(handle._args, (fut,))
+        self.assertFalse(handle._cancelled)
+        test_utils.run_briefly(self.loop)
+        self.assertEqual(calls, [fut])
+
+    def test_ready_queue_exception(self):
+        self.loop.set_debug(False)
+        handler = mock.Mock()
+        self.loop.set_exception_handler(handler)
+        fut = self.new_future(self.loop)
+        fut.add_done_callback(lambda fut: 1 / 0)
+        fut.set_result(1)
+        test_utils.run_briefly(self.loop)
+        context = handler.call_args[0][1]
+        self.assertRegex(context['message'], '^Exception in callback ')
+        self.assertIsInstance(context['exception'], ZeroDivisionError)
+        self.assertIsNotNone(context['exception'].__traceback__)
+        self.assertNotIsInstance(context['handle'], asyncio.Handle)
+
+    def test_ready_queue_debug(self):
+        # Debug mode needs the Handles created by call_soon().
+        self.loop.set_debug(True)
+        fut = self.new_future(self.loop)
+        fut.add_done_callback(lambda fut: None)
+        fut.set_result(1)
+        self.assertIsInstance(self.loop._ready[-1], asyncio.Handle)
+        test_utils.run_briefly(self.loop)
+
 
 @unittest.skipUnless(hasattr(futures, '_CFuture') and
                      hasattr(tasks, '_CTask'),
@@ -2619,6 +2725,7 @@ class BaseTaskIntrospectionTests:
     _unregister_task = None
     _enter_task = None
     _leave_task = None
+    _swap_current_task = None
 
     def test__register_task_1(self):
         class TaskLike:
@@ -2713,6 +2820,18 @@ class BaseTaskIntrospectionTests:
             self._leave_task(loop, task)
         self.assertIsNone(asyncio.current_task(loop))
 
+    def test__swap_current_task(self):
+        task1 = mock.Mock()
+        task2 = mock.Mock()
+        loop = mock.Mock()
+        self.assertIsNone(self._swap_current_task(loop, task1))
+        self.assertIs(asyncio.current_task(loop), task1)
+        self.assertIs(self._swap_current_task(loop, task2), task1)
+        self.assertIs(asyncio.current_task(loop), task2)
+        self.assertIs(self._swap_current_task(loop, None), task2)
+        self.assertIsNone(asyncio.current_task(loop))
+        self.assertIsNone(self._swap_current_task(loop, None))
+
     def test__unregister_task(self):
         task = mock.Mock()
         loop = mock.Mock()
@@ -2733,6 +2852,7 @@ class PyIntrospectionTests(unittest.TestCase, BaseTaskIntrospectionTests):
     _unregister_task = staticmethod(tasks._py_unregister_task)
     _enter_task = staticmethod(tasks._py_enter_task)
     _leave_task = staticmethod(tasks._py_leave_task)
+    _swap_current_task = staticmethod(tasks._py_swap_current_task)
 
 
 @unittest.skipUnless(hasattr(tasks, '_c_register_task'),
@@ -2743,8 +2863,10 @@ class CIntrospectionTests(unittest.TestCase, BaseTaskIntrospectionTests):
         _unregister_task = staticmethod(tasks._c_unregister_task)
         _enter_task = staticmethod(tasks._c_enter_task)
         _leave_task = staticmethod(tasks._c_leave_task)
+        _swap_current_task = staticmethod(tasks._c_swap_current_task)
     else:
         _register_task = _unregister_task = _enter_task = _leave_task = None
+        _swap_current_task = None
 
 
 class BaseCurrentLoopTests:
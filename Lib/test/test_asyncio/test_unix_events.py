@@ -6,6 +6,7 @@ import errno
 import io
 import os
 import pathlib
+import selectors
 import signal
 import socket
 import stat
@@ -627,6 +628,114 @@ class SelectorEventLoopUnixSockSendfileTests(test_utils.TestCase):
         self.assertEqual(1000, self.file.tell())
 
 
+@unittest.skipUnless(hasattr(asyncio, 'EpollEventLoop'),
+                     'EpollEventLoop required')
+class EpollEventLoopTests(test_utils.TestCase):
+
+    def setUp(self):
+        super().setUp()
+        self.loop = asyncio.EpollEventLoop()
+        self.set_event_loop(self.loop)
+        self.rsock, self.wsock = socket.socketpair()
+        self.addCleanup(self.rsock.close)
+        self.addCleanup(self.wsock.close)
+
+    def get_events(self, sock):
+        try:
+            return self.loop._selector.get_key(sock).events
+        except KeyError:
+            return 0
+
+    def test_add_remove(self):
+        reader = mock.Mock()
+        writer = mock.Mock()
+        self.loop.add_reader(self.rsock, reader)
+        self.assertEqual(self.get_events(self.rsock), selectors.EVENT_READ)
+        self.loop.add_writer(self.rsock.fileno(), writer)
+        key = self.loop._selector.get_key(self.rsock)
+        self.assertEqual(key.events,
+                         selectors.EVENT_READ | selectors.EVENT_WRITE)
+        self.assertEqual(key.data[0]._callback, reader)
+        self.assertEqual(key.data[1]._callback, writer)
+        self.assertTrue(self.loop.remove_reader(self.rsock))
+        self.assertFalse(self.loop.remove_reader(self.rsock))
+        self.assertEqual(self.get_events(self.rsock), selectors.EVENT_WRITE)
+        self.assertTrue(self.loop.remove_writer(self.rsock))
+        self.assertEqual(self.get_events(self.rsock), 0)
+        self.assertFalse(self.loop.remove_writer(self.rsock))
+
+    def test_callbacks(self):
+        calls = []
+        self.loop.add_reader(self.rsock, calls.append, 'read')
+        self.loop.add_writer(self.wsock, calls.append, 'write')
+        self.wsock.send(b'x')
+        test_utils.run_briefly(self.loop)
+        self.assertEqual(set(calls), {'read', 'write'})
+        self.loop.remove_writer(self.wsock)
+        self.rsock.recv(1)
+        del calls[:]
+        test_utils.run_briefly(self.loop)
+        self.assertEqual(calls, [])
+
+    def test_replace_reader(self):
+        self.loop.add_reader(self.rsock, mock.Mock())
+        handle = self.loop._selector.get_key(self.rsock).data[0]
+        self.loop.add_reader(self.rsock, mock.Mock())
+        self.assertTrue(handle.cancelled())
+        self.assertIsNot(self.loop._selector.get_key(self.rsock).data[0],
+                         handle)
+
+    def test_cancelled_handle(self):
+        core = self.loop._selector
+        handle = events.Handle(mock.Mock(), (), self.loop)
+        self.assertIsNone(core.add_writer(self.wsock, handle))
+        self.assertEqual(core.select(0), [handle])
+        handle.cancel()
+        self.assertEqual(core.select(0), [])
+        self.assertEqual(self.get_events(self.wsock), 0)
+
+    def test_fd_reused(self):
+        # The kernel drops closed file descriptors from the epoll interest
+        # list, the core registers them again when they are reused.
+        handle = events.Handle(mock.Mock(), (), self.loop)
+        core = self.loop._selector
+        core.add_reader(self.rsock, handle)
+        fd = self.rsock.fileno()
+        self.rsock.close()
+        sock = socket.socket(fileno=os.dup(self.wsock.fileno()))
+        self.addCleanup(sock.close)
+        self.assertEqual(sock.fileno(), fd)
+        core.add_writer(fd, handle)
+        self.assertIn(handle, core.select(0))
+
+    def test_select_timeout(self):
+        core = self.loop._selector
+        t0 = self.loop.time()
+        self.assertEqual(core.select(0.05), [])
+        self.assertGreaterEqual(self.loop.time() - t0, 0.04)
+        self.assertEqual(core.select(-1), [])
+        self.assertRaises(TypeError, core.select, 'spam')
+
+    def test_errors(self):
+        core = self.loop._selector
+        handle = events.Handle(mock.Mock(), (), self.loop)
+        self.assertRaises(ValueError, core.add_reader, -1, handle)
+        self.assertRaises(TypeError, core.add_reader, 'spam', handle)
+        with open(__file__, 'rb') as f:
+            # epoll doesn't support regular files
+            self.assertRaises(OSError, core.add_reader, f, handle)
+            self.assertRaises(KeyError, core.get_key, f)
+        self.assertIsNone(core.remove_reader(self.rsock))
+        self.assertIsNone(core.remove_writer(100000))
+        self.loop.close()
+        self.assertIsNone(self.loop._selector)
+        self.assertFalse(self.loop.remove_reader(self.rsock))
+        self.assertRaises(ValueError, core.fileno)
+        self.assertRaises(ValueError, core.add_reader, self.rsock, handle)
+        self.assertRaises(ValueError, core.select, 0)
+        core.close()
+
+
 class UnixReadPipeTransportTests(test_utils.TestCase):
 
     def setUp(self):
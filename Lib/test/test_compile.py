@@ -684,6 +684,25 @@ if 1:
         # An implicit test for PyUnicode_FSDecoder().
         compile("42", FakePath("test_compile_pathlike"), "single")
 
+    def test_compile_in_threads(self):
+        # Large sources are tokenized and parsed without the GIL; non-ASCII
+        # identifiers still need it to be validated.
+        import threading
+        source = "def f(\u03b4):\n    return \u03b4 + 1\n" * 500
+        bad = "x = 1\n" * 1000 + "a\u00b2 = 2\n"
+        results = []
+        def work():
+            for _ in range(5):
+                ns = {}
+                exec(compile(source.encode(), "<threads>", "exec"), ns)
+                results.append(ns["f"](1))
+                with self.assertRaises(SyntaxError):
+                    compile(bad.encode(), "<threads>", "exec")
+        threads = [threading.Thread(target=work) for _ in range(4)]
+        with support.start_threads(threads):
+            pass
+        self.assertEqual(results, [2] * 20)
+
     def test_stack_overflow(self):
         # bpo-31113: Stack overflow when compile a long sequence of
         # complex statements.
@@ -195,6 +195,19 @@ class CompileallTestsBase:
         compileall.compile_dir(self.directory, quiet=True, workers=5)
         self.assertTrue(compile_file_mock.called)
 
+    def test_compile_threads(self):
+        self.assertFalse(os.path.isfile(self.bc_path))
+        compileall.compile_dir(self.directory, quiet=True, workers=2,
+                               threads=True)
+        self.assertTrue(os.path.isfile(self.bc_path))
+
+    @mock.patch('concurrent.futures.ThreadPoolExecutor')
+    def test_compile_threads_cpu_count(self, pool_mock):
+        compileall.compile_dir(self.directory, quiet=True, workers=0,
+                               threads=True)
+        self.assertEqual(pool_mock.call_args[1]['max_workers'],
+                         os.cpu_count() or 1)
+
 
 class CompileallTestsWithSourceEpoch(CompileallTestsBase,
                                      unittest.TestCase,
@@ -570,6 +583,19 @@ class CommandLineTestsBase:
         for file in files:
             self.assertCompiled(file)
 
+    def test_threads(self):
+        files = []
+        for suffix in range(5):
+            pkgdir = os.path.join(self.directory, 'foo{}'.format(suffix))
+            os.mkdir(pkgdir)
+            script_helper.make_script(pkgdir, '__init__', '')
+            files.append(script_helper.make_script(pkgdir, 'bar2',
+                                                   'x = 1\n' * 1000))
+
+        self.assertRunOK(self.directory, '-j', '3', '--threads')
+        for file in files:
+            self.assertCompiled(file)
+
     @mock.patch('compileall.compile_dir')
     def test_workers_available_cores(self, compile_dir):
         with mock.patch("sys.argv",
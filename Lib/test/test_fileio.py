@@ -4,13 +4,15 @@ import sys
 import os
 import io
 import errno
+import threading
 import unittest
 from array import array
 from weakref import proxy
 from functools import wraps
 
 from test.support import (TESTFN, TESTFN_UNICODE, check_warnings, run_unittest,
-                          make_bad_fd, cpython_only, swap_attr)
+                          make_bad_fd, cpython_only, swap_attr, reap_threads,
+                          start_threads)
 from collections import UserList
 
 import _io  # C implementation of io
@@ -565,8 +567,149 @@ class OtherFileTests:
         self.assertRaises(MyException, MyFileIO, fd)
         os.close(fd)  # should not raise OSError(EBADF)
 
+    def testReadAhead(self):
+        data = bytes(range(256)) * 2000 + b'tail'
+        self.addCleanup(os.unlink, TESTFN)
+        with self.FileIO(TESTFN, 'w') as f:
+            f.write(data)
+        for readahead in (1, 3, 100):
+            with self.FileIO(TESTFN, readahead=readahead) as f:
+                self.assertIsNotNone(f._readahead)
+                chunks = []
+                for size in [1, 1000, 4096, 100000, 300000] * 10:
+                    chunks.append(f.read(size))
+                self.assertEqual(b''.join(chunks), data)
+                self.assertEqual(f.read(10), b'')
+                self.assertEqual(f.tell(), len(data))
+
+                b = bytearray(10)
+                f.seek(1000)
+                self.assertEqual(f.readinto(b), 10)
+                self.assertEqual(b, data[1000:1010])
+                self.assertEqual(f.tell(), 1010)
+                self.assertEqual(f.seek(5, 1), 1015)
+                self.assertEqual(f.read(5), data[1015:1020])
+                self.assertEqual(f.readall(), data[1020:])
+                f.seek(-4, 2)
+                self.assertEqual(f.read(), b'tail')
+                self.assertEqual(f.read(), b'')
+
+    def testReadAheadFileno(self):
+        # the read-ahead stops once the file descriptor is handed out
+        data = b'spam' * 100000
+        self.addCleanup(os.unlink, TESTFN)
+        with self.FileIO(TESTFN, 'w') as f:
+            f.write(data)
+        with self.FileIO(TESTFN, readahead=2) as f:
+            self.assertEqual(f.read(10), data[:10])
+            self.assertEqual(os.read(f.fileno(), 10), data[10:20])
+            self.assertIsNone(f._readahead)
+            self.assertEqual(f.read(10), data[20:30])
+            self.assertEqual(f.tell(), 30)
+
+    def testReadAheadGrowingFile(self):
+        self.addCleanup(os.unlink, TESTFN)
+        with self.FileIO(TESTFN, 'w') as w:
+            w.write(b'spam')
+            with self.FileIO(TESTFN, readahead=4) as f:
+                self.assertEqual(f.read(100), b'spam')
+                self.assertEqual(f.read(100), b'')
+                w.write(b'eggs')
+                self.assertEqual(f.read(100), b'eggs')
+
+    @reap_threads
+    def testReadAheadThreads(self):
+        # concurrent reads get distinct parts of the file
+        data = bytes(range(256)) * (1 << 16)
+        self.addCleanup(os.unlink, TESTFN)
+        with self.FileIO(TESTFN, 'w') as f:
+            f.write(data)
+        for _ in range(10):
+            sizes = []
+            with self.FileIO(TESTFN, readahead=8) as f:
+                def reader():
+                    while True:
+                        n = len(f.read(100000))
+                        if not n:
+                            break
+                        sizes.append(n)
+                threads = [threading.Thread(target=reader) for _ in range(4)]
+                with start_threads(threads):
+                    pass
+            self.assertEqual(sum(sizes), len(data))
+
+    @reap_threads
+    def testReadAheadCloseDuringRead(self):
+        # closing waits for a read in progress in another thread
+        self.addCleanup(os.unlink, TESTFN)
+        with self.FileIO(TESTFN, 'w') as f:
+            f.write(b'x' * (16 << 20))
+        for _ in range(10):
+            f = self.FileIO(TESTFN, readahead=16)
+            started = threading.Event()
+            def reader():
+                try:
+                    while f.read(1 << 20):
+                        started.set()
+                except (ValueError, OSError):
+                    pass
+            thread = threading.Thread(target=reader)
+            with start_threads([thread]):
+                started.wait()
+                f.close()
+            self.assertTrue(f.closed)
+
+    def testReadAheadUnsupported(self):
+        self.addCleanup(os.unlink, TESTFN)
+        self.assertRaises(ValueError, self.FileIO, TESTFN, 'w', readahead=-1)
+        with self.FileIO(TESTFN, 'w', readahead=4) as f:
+            self.assertIsNone(f._readahead)
+        with self.FileIO(TESTFN, 'r+', readahead=4) as f:
+            self.assertIsNone(f._readahead)
+        with self.FileIO(TESTFN, 'r') as f:
+            self.assertIsNone(f._readahead)
+        r, w = os.pipe()
+        with self.FileIO(r, readahead=4) as f, self.FileIO(w, 'w') as g:
+            self.assertIsNone(f._readahead)
+            g.write(b'spam')
+            self.assertEqual(f.read(4), b'spam')
+
+    def testReadBatch(self):
+        data = bytes(range(256)) * 1000
+        self.addCleanup(os.unlink, TESTFN)
+        with self.FileIO(TESTFN, 'w') as f:
+            f.write(data)
+        with self.FileIO(TESTFN) as f:
+            fd = f.fileno()
+            requests = [(TESTFN, 0, 10), (fd, 1000, 100000),
+                        (os.fsencode(TESTFN), len(data) - 4, 100),
+                        (fd, len(data) + 10, 10), (TESTFN, 255000, -1),
+                        (fd, 5, 0)]
+            self.assertEqual(self.read_batch(requests),
+                             [data[:10], data[1000:101000], data[-4:], b'',
+                              data[255000:], b''])
+            self.assertEqual(self.read_batch(iter(requests[:1])),
+                             [data[:10]])
+            self.assertEqual(self.read_batch([]), [])
+            # the file position is left alone
+            self.assertEqual(f.tell(), 0)
+
+    def testReadBatchErrors(self):
+        self.assertRaises(TypeError, self.read_batch, None)
+        self.assertRaises(TypeError, self.read_batch, [TESTFN])
+        self.assertRaises(TypeError, self.read_batch, [(TESTFN, 0)])
+        self.assertRaises(TypeError, self.read_batch, [(TESTFN, 0.0, 1)])
+        self.assertRaises(TypeError, self.read_batch, [(1.0, 0, 1)])
+        self.assertRaises(ValueError, self.read_batch, [(TESTFN, -1, 1)])
+        self.assertRaises(ValueError, self.read_batch, [(TESTFN, 0, -2)])
+        self.assertRaises(ValueError, self.read_batch, [(-1, 0, 1)])
+        with self.assertRaises(FileNotFoundError) as cm:
+            self.read_batch([(__file__, 0, 1), (TESTFN, 0, 1)])
+        self.assertEqual(cm.exception.filename, TESTFN)
+
 class COtherFileTests(OtherFileTests, unittest.TestCase):
     FileIO = _io.FileIO
+    read_batch = staticmethod(_io.read_batch)
     modulename = '_io'
 
     @cpython_only
@@ -578,6 +721,7 @@ class COtherFileTests(OtherFileTests, unittest.TestCase):
 
 class PyOtherFileTests(OtherFileTests, unittest.TestCase):
     FileIO = _pyio.FileIO
+    read_batch = staticmethod(_pyio.read_batch)
     modulename = '_pyio'
 
 
@@ -1556,6 +1556,84 @@ class CBufferedReaderTest(BufferedReaderTest, SizeofTest):
         with self.assertRaisesRegex(TypeError, "BufferedReader"):
             self.tp(io.BytesIO(), 1024, 1024, 1024)
 
+    def test_adaptive_buffer(self):
+        # The buffer grows while the raw stream is read sequentially, and
+        # goes back to its initial size after a seek.
+        data = b"".join(b"line %d\n" % i for i in range(200000))
+        stream = self.BytesIO(data)
+        sizes = []
+        class RecordingRawIO(self.RawIOBase):
+            def readable(self):
+                return True
+            def seekable(self):
+                return True
+            def tell(self):
+                return stream.tell()
+            def seek(self, pos, whence=0):
+                return stream.seek(pos, whence)
+            def readinto(self, b):
+                sizes.append(len(b))
+                return stream.readinto(b)
+
+        bufio = self.tp(RecordingRawIO(), 4096)
+        initial_size = sys.getsizeof(bufio)
+        self.assertEqual(b"".join(iter(lambda: bufio.read(100), b"")), data)
+        self.assertGreater(max(sizes), 4096)
+        self.assertLess(len(sizes), len(data) // 4096 // 4)
+        self.assertGreater(sys.getsizeof(bufio), initial_size)
+
+        del sizes[:]
+        bufio.seek(1000)
+        self.assertEqual(bufio.read(10), data[1000:1010])
+        self.assertEqual(sizes, [4096])
+        self.assertEqual(list(bufio), data[1010:].splitlines(True))
+        self.assertEqual(sizes[1], 4096)
+        self.assertGreater(max(sizes), 4096)
+
+        del sizes[:]
+        bufio.seek(0)
+        self.assertEqual(bufio.read1(10), data[:10])
+        self.assertEqual(bufio.read1(10), data[10:20])
+        self.assertEqual(sizes, [4096])
+
+    def test_adaptive_buffer_unseekable(self):
+        # The buffer does not grow for unseekable streams.
+        sizes = []
+        class RecordingRawIO(self.MockUnseekableIO):
+            def readinto(self, b):
+                sizes.append(len(b))
+                return super().readinto(b)
+        data = b"x" * 100000
+        bufio = self.tp(RecordingRawIO(data), 4096)
+        self.assertEqual(b"".join(iter(lambda: bufio.read(100), b"")), data)
+        self.assertEqual(max(sizes), 4096)
+
+    def test_adaptive_buffer_read_after_seek(self):
+        # A read larger than the initial buffer after a seek, while the
+        # buffer is still grown, returns all the data.
+        data = bytes(i % 251 for i in range(300000))
+        bufio = self.tp(self.BytesIO(data), 4096)
+        bufio.read(5000)
+        bufio.peek(200000)
+        bufio.read(5000)
+        bufio.seek(200000)
+        self.assertEqual(bufio.read(5000), data[200000:205000])
+        self.assertEqual(bufio.tell(), 205000)
+        bufio.peek(200000)
+        bufio.seek(1000)
+        b = bytearray(5000)
+        self.assertEqual(bufio.readinto(b), 5000)
+        self.assertEqual(b, data[1000:6000])
+
+        bufio = self.tp(self.BytesIO(data), 1)
+        self.assertEqual(bufio.read(100), data[:100])
+        bufio.readline(100)
+        bufio.read(200000)
+        bufio.readinto(bytearray(1))
+        bufio.seek(0)
+        self.assertEqual(bufio.read(30), data[:30])
+        self.assertEqual(bufio.tell(), 30)
+
 
 class PyBufferedReaderTest(BufferedReaderTest):
     tp = pyio.BufferedReader
@@ -1734,6 +1812,60 @@ class BufferedWriterTest(unittest.TestCase, CommonBufferedTests):
         self.assertRaises(TypeError, bufio.writelines, None)
         self.assertRaises(TypeError, bufio.writelines, 'abc')
 
+    def test_writelines_file(self):
+        # Batches which don't fit in the buffer are written directly to
+        # the file, along with the buffered data.
+        self.addCleanup(support.unlink, support.TESTFN)
+        lines = []
+        for i in range(200):
+            lines.append(b'%d,' % i)
+            if i % 3 == 0:
+                lines.append(bytes([i % 26 + 97]) * (i % 50))
+            if i % 7 == 0:
+                lines.append(bytearray(b'-' * i))
+            if i % 11 == 0:
+                lines.append(memoryview(b'spam' * i))
+        expected = b'head' + b''.join(lines)
+        for bufsize in 1, 16, 1024, 8192, 100000:
+            with self.subTest(bufsize=bufsize):
+                with self.open(support.TESTFN, self.write_mode,
+                               buffering=0) as raw:
+                    bufio = self.tp(raw, bufsize)
+                    bufio.write(b'head')
+                    bufio.writelines(lines)
+                    self.assertEqual(bufio.tell(), len(expected))
+                    bufio.writelines(iter([b'tail', b'x' * 3 * bufsize]))
+                    bufio.flush()
+                with self.open(support.TESTFN, "rb") as f:
+                    self.assertEqual(f.read(),
+                                     expected + b'tail' + b'x' * 3 * bufsize)
+
+    def test_writelines_file_error(self):
+        self.addCleanup(support.unlink, support.TESTFN)
+        with self.open(support.TESTFN, self.write_mode, buffering=0) as raw:
+            bufio = self.tp(raw, 8)
+            self.assertRaises(TypeError, bufio.writelines, [b'ab', 'cd'])
+            self.assertRaises(TypeError, bufio.writelines, [b'x' * 20, 1])
+            self.assertRaises(TypeError, bufio.writelines, None)
+            bufio.close()
+            self.assertRaises(ValueError, bufio.writelines, [b'ab'])
+
+    def test_write_overflow_file(self):
+        # A write which doesn't fit in the buffer along with the buffered
+        # data.
+        self.addCleanup(support.unlink, support.TESTFN)
+        with self.open(support.TESTFN, self.write_mode, buffering=0) as raw:
+            bufio = self.tp(raw, 16)
+            expected = []
+            for size in 5, 10, 3, 20, 7, 16, 1, 100, 15, 17, 2:
+                data = bytes([size + 64]) * size
+                self.assertEqual(bufio.write(data), size)
+                expected.append(data)
+                self.assertEqual(bufio.tell(), len(b''.join(expected)))
+            bufio.flush()
+        with self.open(support.TESTFN, "rb") as f:
+            self.assertEqual(f.read(), b''.join(expected))
+
     def test_destructor(self):
         writer = self.MockRawIO()
         bufio = self.tp(writer, 8)
@@ -3122,6 +3254,68 @@ class TextIOWrapperTest(unittest.TestCase):
         txt.seek(pos)
         self.assertEqual(txt.read(4), "BBB\n")
 
+    def test_iteration_codecs(self):
+        # Line iteration decodes lines directly for some codecs
+        text = "".join("l\xe9ne %d\n" % i for i in range(20000)) + "last"
+        long_line = "x" * 100000 + "\n"
+        for encoding in ("ascii", "latin-1", "utf-8", "utf-16"):
+            errors = "replace" if encoding == "ascii" else "strict"
+            for newline in (None, "", "\n"):
+                data = (text + long_line + text).encode(encoding, "replace")
+                def lines():
+                    b = self.BufferedReader(self.BytesIO(data))
+                    return self.TextIOWrapper(b, encoding=encoding,
+                                              errors=errors, newline=newline)
+                txt = lines()
+                expected = []
+                while True:
+                    line = txt.readline()
+                    if not line:
+                        break
+                    expected.append(line)
+                txt = lines()
+                self.assertEqual(list(txt), expected)
+                if newline != "\n":
+                    self.assertEqual(txt.newlines, "\n")
+
+    def test_iteration_newlines(self):
+        data = b"a\nb\n" * 10000 + b"c\r\nd\re\n" + b"f\n" * 10000
+        for newline in (None, "", "\n"):
+            b = self.BufferedReader(self.BytesIO(data))
+            txt = self.TextIOWrapper(b, encoding="ascii", newline=newline)
+            expected = data.decode("ascii").splitlines(True)
+            if newline == "\n":
+                expected = [line + "\n" for line in
+                            data.decode("ascii").split("\n")[:-1]]
+            elif newline is None:
+                expected = [line.replace("\r\n", "\n").replace("\r", "\n")
+                            for line in expected]
+            self.assertEqual(list(txt), expected)
+        b = self.BufferedReader(self.BytesIO(data))
+        txt = self.TextIOWrapper(b, encoding="ascii", newline=None)
+        for line in txt:
+            pass
+        self.assertEqual(txt.newlines, ("\r", "\n", "\r\n"))
+
+    def test_iteration_mixed_reads(self):
+        data = "".join("line %d\n" % i for i in range(50000)).encode("ascii")
+        b = self.BufferedReader(self.BytesIO(data))
+        txt = self.TextIOWrapper(b, encoding="ascii")
+        self.assertEqual(next(txt), "line 0\n")
+        self.assertEqual(txt.readline(), "line 1\n")
+        self.assertEqual(next(txt), "line 2\n")
+        self.assertEqual(txt.read(7), "line 3\n")
+        self.assertEqual(next(txt), "line 4\n")
+        self.assertEqual(txt.read(), data[35:].decode("ascii"))
+        self.assertEqual(list(txt), [])
+        self.assertEqual(txt.tell(), len(data))
+        txt.seek(0)
+        self.assertEqual(next(txt), "line 0\n")
+        self.assertEqual(next(txt), "line 1\n")
+        txt.seek(0, 2)
+        self.assertEqual(list(txt), [])
+        self.assertEqual(txt.tell(), len(data))
+
     def test_issue2282(self):
         buffer = self.BytesIO(self.testdata)
         txt = self.TextIOWrapper(buffer, encoding="ascii")
@@ -3800,7 +3994,7 @@ class MiscIOTest(unittest.TestCase):
         for name in self.io.__all__:
             obj = getattr(self.io, name, None)
             self.assertIsNotNone(obj, name)
-            if name == "open":
+            if name in ("open", "read_batch"):
                 continue
             elif "error" in name.lower() or name == "UnsupportedOperation":
                 self.assertTrue(issubclass(obj, Exception), name)
@@ -62,6 +62,35 @@ class TestDecode:
         self.check_keys_reuse(s, decoder.decode)
         self.assertFalse(decoder.memo)
 
+    def test_repeated_keys(self):
+        # objects with the same keys as the previous object at their depth
+        docs = [
+            '[{"a": 1, "b": {"c": 2}}, {"a": 3, "b": {"c": 4}}]',
+            '[{"a": 1, "b": 2}, {"a": 3}, {"a": 4, "b": 5, "c": 6}, {}]',
+            '[{"a": 1, "b": 2}, {"b": 3, "a": 4}, {"ab": 5}, {"a": 6}]',
+            '[{"a": 1, "a\\"": 2}, {"a": 3, "a\\"": 4}, {"a\\"": 5}]',
+            '[{"\\u0061": 1}, {"a": 2}, {"a\\n": 3}, {"a\\n": 4}]',
+            '[{"a": 1}, {"a" : 2}, {"a"  :3}, {"a":4,"b":[{"a":5}]}]',
+            '[{"\xe9": 1}, {"\xe9": 2}, {"€": 3}, {"a": {"€": 4}}]',
+            '[{"a\U0001f600": 1}, {"a\U0001f600": 2}, {"a": 3}, {"a": 4}]',
+        ]
+        decoder = self.json.decoder.JSONDecoder()
+        for doc in docs:
+            with self.subTest(doc=doc):
+                expected = eval(doc.replace('\\u0061', 'a'))
+                self.assertEqual(self.loads(doc), expected)
+                self.assertEqual(decoder.decode(doc), expected)
+                rval = self.loads(doc, object_pairs_hook=OrderedDict)
+                self.assertEqual(rval, expected)
+                self.assertEqual([list(d) for d in rval],
+                                 [list(d) for d in expected])
+        data = [{"id": i, "tags": {"x%d" % (i % 3): i}} for i in range(100)]
+        data += [{"k%d" % i: i} for i in range(1000)]
+        data += [{"id": i, "tags": {"x": i}} for i in range(100)]
+        doc = self.dumps(data)
+        self.assertEqual(decoder.decode(doc), data)
+        self.assertEqual(decoder.decode(doc), data)
+
     def test_extra_data(self):
         s = '[1, 2, 3]5'
         msg = 'Extra data'
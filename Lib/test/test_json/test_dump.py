@@ -57,6 +57,38 @@ class TestDump:
         d[1337] = "true.dat"
         self.assertEqual(self.dumps(d, sort_keys=True), '{"1337": "true.dat"}')
 
+    def test_encode_mutated_dict(self):
+        d = {'a': object(), 'b': 1, 'c': 2}
+        def default(obj):
+            d.clear()
+            return None
+        self.assertEqual(self.dumps(d, default=default, sort_keys=True),
+                         '{"a": null, "b": 1, "c": 2}')
+
+    def test_encode_bytes(self):
+        obj = {'b': ['é\u4e2d\U0001f600', 1.5, -2**70, None],
+               'a': ('\ud800', True, False, 'q"\\\n\x7f')}
+        for kw in ({}, {'ensure_ascii': False}, {'sort_keys': True},
+                   {'separators': (',', ':')}, {'indent': 2}):
+            with self.subTest(**kw):
+                encoder = self.json.JSONEncoder(**kw)
+                expected = self.dumps(obj, **kw).encode('utf-8',
+                                                        'surrogatepass')
+                self.assertEqual(encoder.encode_bytes(obj), expected)
+        self.assertEqual(self.json.JSONEncoder().encode_bytes('x'), b'"x"')
+        with self.assertRaises(TypeError):
+            self.json.JSONEncoder().encode_bytes({b'key': 1})
+
+    def test_encode_bytes_write(self):
+        obj = [{'key%d' % i: 'value' * 20} for i in range(10000)]
+        chunks = []
+        self.assertIsNone(
+            self.json.JSONEncoder().encode_bytes(obj, chunks.append))
+        self.assertGreater(len(chunks), 1)
+        for chunk in chunks:
+            self.assertIsInstance(chunk, bytes)
+        self.assertEqual(b''.join(chunks), self.dumps(obj).encode())
+
 
 class TestPyDump(TestDump, PyTest): pass
 
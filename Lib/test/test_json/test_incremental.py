@@ -0,0 +1,206 @@
+import io
+from collections import OrderedDict
+from decimal import Decimal
+from test.test_json import PyTest, CTest
+
+
+DOCS = [
+    b'{"a": 1, "b": [true, false, null], "c": {"d": "\\u00e9\\ud83d\\ude00"}}',
+    b'[1, 2.5, -3e2, "x\\"y\\\\", [], {}]',
+    '"café 中文 \U0001f600"'.encode('utf-8'),
+    b'123',
+    b'-0.5e-3',
+    b'true',
+    b'null',
+    b'""',
+    b'"\\\\"',
+    b'[[[{"[": "]", "{": "}"}]]]',
+    b'12345678901234567890123',
+]
+
+
+class TestIncremental:
+    def decoder(self, **kw):
+        return self.json.JSONIncrementalDecoder(**kw)
+
+    def decode_chunks(self, chunks, **kw):
+        decoder = self.decoder(**kw)
+        values = []
+        for chunk in chunks:
+            values.extend(decoder.feed(chunk))
+        values.extend(decoder.close())
+        return values
+
+    def decode_split(self, data, size, **kw):
+        chunks = [data[i:i + size] for i in range(0, len(data), size)]
+        return self.decode_chunks(chunks, **kw)
+
+    def test_values(self):
+        expected = [self.loads(doc) for doc in DOCS]
+        for sep in (b'\n', b' ', b'\r\n\t', b''):
+            if not sep:
+                # scalars must be separated
+                docs = [doc for doc in DOCS if doc[:1] in b'{["']
+                expected = [self.loads(doc) for doc in docs]
+            else:
+                docs = DOCS
+            data = sep.join(docs) + sep
+            for size in (1, 2, 3, 7, len(data)):
+                with self.subTest(sep=sep, size=size):
+                    self.assertEqual(self.decode_split(data, size), expected)
+
+    def test_values_completed_early(self):
+        decoder = self.decoder()
+        self.assertEqual(decoder.feed(b'{"a": 1}\n{"b"'), [{'a': 1}])
+        self.assertEqual(decoder.feed(b': 2}'), [{'b': 2}])
+        self.assertEqual(decoder.feed(b' "abc" [1'), ['abc'])
+        self.assertEqual(decoder.feed(b']'), [[1]])
+        # a scalar needs the next byte to be complete
+        self.assertEqual(decoder.feed(b' 12'), [])
+        self.assertEqual(decoder.feed(b'3'), [])
+        self.assertEqual(decoder.feed(b'\n'), [123])
+        self.assertEqual(decoder.feed(b'45'), [])
+        self.assertEqual(decoder.close(), [45])
+
+    def test_items(self):
+        data = b'[' + b', '.join(DOCS) + b']'
+        expected = [self.loads(doc) for doc in DOCS]
+        for size in (1, 2, 5, len(data)):
+            with self.subTest(size=size):
+                self.assertEqual(self.decode_split(data, size, items=True),
+                                 expected)
+        self.assertEqual(self.decode_chunks([b' [ ] '], items=True), [])
+        decoder = self.decoder(items=True)
+        self.assertIs(decoder.items, True)
+        self.assertEqual(decoder.feed(b'[{"a": [1, 2]}, 3'), [{'a': [1, 2]}])
+        self.assertEqual(decoder.feed(b', 4]'), [3, 4])
+        self.assertEqual(decoder.close(), [])
+
+    def test_items_errors(self):
+        for data, msg in [(b'{"a": 1}', 'Expecting JSON array'),
+                          (b'[1 2]', "Expecting ',' delimiter"),
+                          (b'[1, ]', 'Expecting value'),
+                          (b'[1] 2', 'Extra data'),
+                          (b'[1, 2', "Expecting ',' delimiter"),
+                          (b'[1,', 'Expecting value'),
+                          (b'', 'Expecting value')]:
+            with self.subTest(data=data):
+                with self.assertRaises(self.JSONDecodeError) as cm:
+                    self.decode_chunks([data], items=True)
+                self.assertEqual(cm.exception.msg, msg)
+
+    def test_bytes_like(self):
+        decoder = self.decoder()
+        self.assertEqual(decoder.feed(bytearray(b'[1]')), [[1]])
+        self.assertEqual(decoder.feed(memoryview(b' {"a": 2}')), [{'a': 2}])
+        self.assertRaises(TypeError, decoder.feed, '[1]')
+        self.assertEqual(decoder.close(), [])
+
+    def test_large_value(self):
+        value = ['x' * 100] * 2000
+        data = self.dumps(value).encode() + b' '
+        values = self.decode_split(data * 3, 1000)
+        self.assertEqual(values, [value] * 3)
+
+    def test_reentrant_feed(self):
+        def hook(d):
+            decoder.feed(b'1 ')
+        decoder = self.decoder(object_hook=hook)
+        self.assertRaises(RuntimeError, decoder.feed, b'{} ')
+
+    def test_bom(self):
+        data = b'\xef\xbb\xbf[1] [2]'
+        for size in (1, 2, len(data)):
+            with self.subTest(size=size):
+                self.assertEqual(self.decode_split(data, size), [[1], [2]])
+        self.assertEqual(self.decode_chunks([b'\xef\xbb\xbf']), [])
+
+    def test_split_utf8(self):
+        data = '["é中\U0001f600"]'.encode('utf-8')
+        self.assertEqual(self.decode_split(data, 1),
+                         [['é中\U0001f600']])
+        self.assertRaises(UnicodeDecodeError,
+                          self.decode_chunks, [b'"\xff"'])
+
+    def test_surrogates(self):
+        self.assertEqual(self.decode_chunks([b'"\\ud800" "\xed\xa0\x80"']),
+                         ['\ud800', '\ud800'])
+
+    def test_errors(self):
+        for data, msg in [(b'{"a" 1}', "Expecting ':' delimiter"),
+                          (b'[1 2]', "Expecting ',' delimiter"),
+                          (b'{"a": 1]', "Expecting ',' delimiter"),
+                          (b'"\\x"', 'Invalid \\escape'),
+                          (b'"a\nb"', 'Invalid control character'),
+                          (b']', 'Expecting value'),
+                          (b'nul', 'Expecting value'),
+                          (b'1.2.3', 'Extra data'),
+                          (b'[1, 2', "Expecting ',' delimiter"),
+                          (b'"abc', 'Unterminated string starting at')]:
+            with self.subTest(data=data):
+                with self.assertRaises(self.JSONDecodeError) as cm:
+                    self.decode_chunks([data])
+                self.assertTrue(cm.exception.msg.startswith(msg),
+                                cm.exception.msg)
+
+    def test_error_position(self):
+        decoder = self.decoder()
+        with self.assertRaises(self.JSONDecodeError) as cm:
+            decoder.feed('[1]\n{"é": 1,\n "b" 2}'.encode('utf-8'))
+        self.assertEqual(cm.exception.doc, '{"é": 1,\n "b" 2}')
+        self.assertEqual(cm.exception.pos, 14)
+        self.assertEqual(cm.exception.lineno, 2)
+        self.assertEqual(cm.exception.colno, 6)
+
+    def test_recover_after_error(self):
+        decoder = self.decoder()
+        with self.assertRaises(self.JSONDecodeError):
+            decoder.feed(b'{"a": 1}\n{"b": x}\n[2')
+        # the values before the error are not lost
+        self.assertEqual(decoder.feed(b']'), [{'a': 1}, [2]])
+        self.assertEqual(decoder.close(), [])
+
+    def test_close(self):
+        decoder = self.decoder()
+        self.assertEqual(decoder.feed(b'[1] {"a"'), [[1]])
+        with self.assertRaises(self.JSONDecodeError) as cm:
+            decoder.close()
+        self.assertEqual(cm.exception.msg, "Expecting ':' delimiter")
+        self.assertRaises(ValueError, decoder.feed, b'1')
+        self.assertRaises(ValueError, decoder.close)
+
+    def test_options(self):
+        data = b'{"a": 1.5, "b": 2, "c": NaN}\n{"d": "\x01"}'
+        decoder = self.decoder(parse_float=Decimal, parse_int=float,
+                               parse_constant=str, strict=False,
+                               object_pairs_hook=OrderedDict)
+        self.assertEqual(decoder.feed(data) + decoder.close(),
+                         [OrderedDict([('a', Decimal('1.5')), ('b', 2.0),
+                                       ('c', 'NaN')]),
+                          OrderedDict([('d', '\x01')])])
+        decoder = self.decoder(object_hook=lambda d: sorted(d))
+        self.assertEqual(decoder.feed(b'{"b": 1, "a": 2} '), [['a', 'b']])
+
+    def test_deep_nesting(self):
+        data = b'[' * 100000 + b']' * 100000
+        with self.assertRaises(RecursionError):
+            self.decode_chunks([data])
+
+    def test_iterload(self):
+        data = b'{"a": 1}\n[2, 3]\n"4"\n'
+        fp = io.BytesIO(data)
+        values = self.json.iterload(fp, chunk_size=3)
+        self.assertEqual(next(values), {'a': 1})
+        self.assertLess(fp.tell(), len(data))
+        self.assertEqual(list(values), [[2, 3], '4'])
+        self.assertEqual(list(self.json.iterload(io.BytesIO(b'[[1], 2]'),
+                                                 items=True)),
+                         [[1], 2])
+
+
+class TestPyIncremental(TestIncremental, PyTest): pass
+class TestCIncremental(TestIncremental, CTest):
+    def test_shared_keys(self):
+        decoder = self.decoder()
+        values = decoder.feed(b'{"key": 1} {"key": 2}\n')
+        self.assertIs(list(values[0])[0], list(values[1])[0])
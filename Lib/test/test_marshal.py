@@ -134,6 +134,88 @@ class CodeTestCase(unittest.TestCase):
             if isinstance(obj, types.CodeType):
                 self.assertIs(co.co_filename, obj.co_filename)
 
+    nested_source = """if 1:
+        def f(x):
+            def g(y):
+                return [lambda z=z: x + y + z for z in range(3)]
+            return g
+        class C:
+            def m(self):
+                return 'm'
+        """
+
+    def check_nested(self, co):
+        ns = {}
+        exec(co, ns)
+        self.assertEqual([h() for h in ns['f'](1)(2)], [3, 4, 5])
+        self.assertEqual(ns['C']().m(), 'm')
+
+    def test_nested_code(self):
+        co = compile(self.nested_source, "nested", "exec")
+        for version in range(marshal.version + 1):
+            with self.subTest(version=version):
+                data = marshal.dumps(co, version)
+                for new in (marshal.loads(data),
+                            marshal.loads(bytearray(data)),
+                            marshal.load(io.BytesIO(data))):
+                    self.assertEqual(co, new)
+                    self.check_nested(new)
+
+    def test_lazy_code(self):
+        co = compile(self.nested_source, "nested", "exec")
+        data = marshal.dumps(co)
+        # Functions made before co_consts is looked at
+        self.check_nested(marshal.loads(data))
+        new = marshal.loads(data)
+        self.assertEqual(hash(new), hash(co))
+        self.assertEqual([type(c) for c in new.co_consts],
+                         [type(c) for c in co.co_consts])
+        self.assertEqual(new.co_consts, co.co_consts)
+        self.check_nested(new)
+        self.assertEqual(marshal.loads(marshal.dumps(marshal.loads(data))), co)
+
+    def test_lazy_code_filename(self):
+        import _imp
+        co = compile(self.nested_source, "nested", "exec")
+        new = marshal.loads(marshal.dumps(co))
+        _imp._fix_co_filename(new, "renamed")
+        ns = {}
+        exec(new, ns)
+        self.assertEqual(ns['f'].__code__.co_filename, "renamed")
+        self.assertEqual(ns['f'](1).__code__.co_filename, "renamed")
+
+    def test_lazy_code_load_const(self):
+        # A code constant that is not only used by MAKE_FUNCTION
+        co = compile("x = 1", "const", "exec")
+        inner = compile("y", "inner", "eval")
+        consts = tuple(inner if c == 1 else c for c in co.co_consts)
+        co = types.CodeType(co.co_argcount, co.co_kwonlyargcount,
+                            co.co_nlocals, co.co_stacksize, co.co_flags,
+                            co.co_code, consts, co.co_names, co.co_varnames,
+                            co.co_filename, co.co_name, co.co_firstlineno,
+                            co.co_lnotab, co.co_freevars, co.co_cellvars)
+        ns = {}
+        exec(marshal.loads(marshal.dumps(co)), ns)
+        self.assertIsInstance(ns['x'], types.CodeType)
+        self.assertEqual(ns['x'], inner)
+
+    def test_lazy_code_unreachable(self):
+        # The placeholders cannot be found through the garbage collector
+        import gc
+        co = compile(self.nested_source, "nested", "exec")
+        exec(marshal.loads(marshal.dumps(co)), {})
+        lazy = [x for o in gc.get_objects() if type(o) is tuple
+                for x in o if type(x).__name__ == 'lazy_code']
+        self.assertEqual(lazy, [])
+
+    def test_bad_lazy_code(self):
+        co = compile("def f(): pass", "bad", "exec")
+        data = marshal.dumps(co)
+        start = data.index(b'L')
+        size = int.from_bytes(data[start+1:start+5], 'little')
+        bad = data[:start+1] + (size - 1).to_bytes(4, 'little') + data[start+5:]
+        self.assertRaises(ValueError, marshal.loads, bytearray(bad))
+
 class ContainerTestCase(unittest.TestCase, HelperMixin):
     d = {'astring': 'foo@bar.baz.spam',
          'afloat': 7283.43,
@@ -484,6 +566,64 @@ class InterningTestCase(unittest.TestCase, HelperMixin):
         s2 = sys.intern(s)
         self.assertNotEqual(id(s2), id(s))
 
+class StringTableTestCase(unittest.TestCase, HelperMixin):
+    def test_shared_strings(self):
+        s = "".join(["shared"] * 50)
+        new = marshal.loads(marshal.dumps([s, s, (s, s)]))
+        self.assertEqual(new, [s, s, (s, s)])
+        self.assertIs(new[0], new[1])
+        self.assertIs(new[0], new[2][0])
+        self.assertIs(new[0], new[2][1])
+
+    def test_many_strings(self):
+        strings = [str(i) for i in range(70000)]
+        sample = (strings, tuple(strings[:10]), tuple(strings[65530:65540]),
+                  strings[300], strings[69999])
+        self.helper(sample)
+        for version in range(marshal.version + 1):
+            self.helper(sample, version)
+
+    def test_bulk_tuples(self):
+        for sample in [(1, -128, 127), tuple(range(-128, 127)), (128,),
+                       (-129,), (0,) * 256, (1, 'a'), ('a', 1), (True, 1),
+                       (1, 2.0), ('a', 'b'), ('a', b'b'), ('a' * 300,) * 3,
+                       ((1, 2), (1, 2))]:
+            with self.subTest(sample=sample):
+                self.helper(sample)
+                new = marshal.loads(marshal.dumps(sample))
+                self.assertEqual([type(x) for x in new],
+                                 [type(x) for x in sample])
+
+    def test_shared_tuples(self):
+        t = (1, 2, 3)
+        u = ('a', 'b')
+        new = marshal.loads(marshal.dumps([t, t, u, u]))
+        self.assertEqual(new, [t, t, u, u])
+        self.assertIs(new[0], new[1])
+        self.assertIs(new[2], new[3])
+
+    def test_interned(self):
+        s = sys.intern("interned by the string table")
+        new = marshal.loads(marshal.dumps((s, s)))
+        self.assertIs(new[0], s)
+
+    def test_code_size(self):
+        co = compile(CodeTestCase.nested_source, "nested", "exec")
+        self.assertLess(len(marshal.dumps(co, 6)), len(marshal.dumps(co, 5)))
+
+    def test_bad_string_table(self):
+        table = b'W\x01\x00\x00\x00'
+        for data in [b'k\x00', b'K\x00\x00\x00\x00', b'Q\x01\x00\x00',
+                     table + marshal.dumps(1, 4) + b'N',
+                     table + marshal.dumps('a', 4) + b'k\x01',
+                     table + marshal.dumps('a', 4) + b'Q\x01\x01\x00',
+                     table + marshal.dumps('a', 4) + table]:
+            with self.subTest(data=data):
+                self.assertRaises(ValueError, marshal.loads, data)
+        self.assertRaises(EOFError, marshal.loads, table)
+        self.assertEqual(marshal.loads(table + marshal.dumps('a', 4) +
+                                       b'Q\x02\x00\x00\x00\x00'), ('a', 'a'))
+
 @support.cpython_only
 @unittest.skipUnless(_testcapi, 'requires _testcapi')
 class CAPI_TestCase(unittest.TestCase, HelperMixin):
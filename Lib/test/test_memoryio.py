@@ -1,6 +1,7 @@
 """Unit tests for memory-based file-like objects.
 StringIO -- for unicode strings
 BytesIO -- for bytes
+MemoryReader -- for reading bytes-like objects
 """
 
 import unittest
@@ -807,6 +808,142 @@ class CBytesIOTest(PyBytesIOTest):
         memio = self.ioclass(ba)
         self.assertEqual(sys.getrefcount(ba), old_rc)
 
+class PyMemoryReaderTest(MemorySeekTestMixin, unittest.TestCase):
+
+    UnsupportedOperation = pyio.UnsupportedOperation
+
+    @staticmethod
+    def buftype(s):
+        return s.encode("ascii")
+    ioclass = pyio.MemoryReader
+    EOF = b""
+
+    def test_lines(self):
+        buf = b"a\nbc\n\ndef"
+        for views in (False, True):
+            memio = self.ioclass(buf, views=views)
+            lines = list(memio)
+            self.assertEqual([bytes(line) for line in lines],
+                             [b"a\n", b"bc\n", b"\n", b"def"])
+            self.assertIsInstance(lines[0], memoryview if views else bytes)
+            memio.seek(0)
+            self.assertEqual(memio.readline(1), b"a")
+            self.assertEqual(memio.readline(), b"\n")
+            self.assertEqual(memio.readline(None), b"bc\n")
+            self.assertEqual(memio.readlines(), [b"\n", b"def"])
+            self.assertEqual(memio.readline(), b"")
+            memio.seek(0)
+            self.assertEqual(memio.readlines(3), [b"a\n", b"bc\n"])
+            self.assertRaises(TypeError, memio.readline, 1.0)
+
+    def test_read(self):
+        buf = bytearray(b"1234567890")
+        memio = self.ioclass(buf, views=True)
+        view = memio.read(4)
+        self.assertIsInstance(view, memoryview)
+        self.assertEqual(view, b"1234")
+        # The views share the buffer
+        buf[0] = ord("x")
+        self.assertEqual(view, b"x234")
+        # but cannot write to it
+        self.assertTrue(view.readonly)
+        self.assertTrue(memio.readline().readonly)
+        with self.assertRaises(TypeError):
+            view[0] = ord("y")
+        self.assertEqual(buf, b"x234567890")
+        memio.seek(4)
+        self.assertEqual(memio.read1(2), b"56")
+        self.assertEqual(memio.read(None), b"7890")
+        self.assertEqual(memio.read(), b"")
+        memio.seek(100)
+        self.assertEqual(memio.read(), b"")
+        self.assertRaises(TypeError, memio.read, 1.0)
+
+    def test_read_past_end(self):
+        # Reading past the end doesn't move the position
+        memio = self.ioclass(b"abc\n")
+        for read in (memio.read, memio.read1, memio.readline,
+                     memio.readlines, lambda: list(memio),
+                     lambda: memio.readinto(bytearray(2))):
+            memio.seek(10)
+            self.assertFalse(read())
+            self.assertEqual(memio.tell(), 10)
+
+    def test_readinto(self):
+        memio = self.ioclass(b"1234567890")
+        b = bytearray(b"hello")
+        self.assertEqual(memio.readinto(b), 5)
+        self.assertEqual(b, b"12345")
+        self.assertEqual(memio.readinto1(b), 5)
+        self.assertEqual(b, b"67890")
+        self.assertEqual(memio.readinto(b), 0)
+        self.assertEqual(b, b"67890")
+        memio.seek(8)
+        b = bytearray(b"hello")
+        self.assertEqual(memio.readinto(b), 2)
+        self.assertEqual(b, b"90llo")
+        self.assertRaises(TypeError, memio.readinto, b"")
+
+    def test_buffer_types(self):
+        import array
+        a = array.array("i", [1, 2, 3])
+        memio = self.ioclass(a)
+        self.assertEqual(memio.read(), a.tobytes())
+        memio = self.ioclass(memoryview(b"abcdef")[1:5])
+        self.assertEqual(memio.read(), b"bcde")
+        self.assertRaises(TypeError, self.ioclass, "text")
+        self.assertRaises(BufferError, self.ioclass, memoryview(b"abcdef")[::2])
+
+    def test_mmap(self):
+        import mmap
+        m = mmap.mmap(-1, mmap.PAGESIZE)
+        m.write(b"spam\neggs\n")
+        memio = self.ioclass(m, views=True)
+        self.assertEqual(next(memio), b"spam\n")
+        # The reader keeps the mapping exported until it is closed
+        self.assertRaises(BufferError, m.close)
+        line = next(memio)
+        memio.close()
+        self.assertRaises(BufferError, m.close)
+        self.assertEqual(line, b"eggs\n")
+        line.release()
+        m.close()
+
+    def test_subclassing(self):
+        class MyReader(self.ioclass):
+            pass
+        memio = MyReader(b"abc\n")
+        self.assertEqual(list(memio), [b"abc\n"])
+        self.assertTrue(issubclass(self.ioclass, io.BufferedIOBase))
+
+    def test_unsupported(self):
+        memio = self.ioclass(b"abc")
+        self.assertTrue(memio.readable())
+        self.assertFalse(memio.writable())
+        self.assertTrue(memio.seekable())
+        self.assertRaises(self.UnsupportedOperation, memio.write, b"x")
+        self.assertRaises(self.UnsupportedOperation, memio.fileno)
+        self.assertRaises(TypeError, pickle.dumps, memio)
+
+    def test_closed(self):
+        memio = self.ioclass(b"abc")
+        self.assertFalse(memio.closed)
+        with memio:
+            pass
+        self.assertTrue(memio.closed)
+        memio.close()
+        for method in (memio.read, memio.readline, memio.tell,
+                       memio.readable, memio.seekable, memio.__next__):
+            self.assertRaises(ValueError, method)
+        self.assertRaises(ValueError, memio.seek, 0)
+        self.assertRaises(ValueError, memio.readinto, bytearray(1))
+
+
+class CMemoryReaderTest(PyMemoryReaderTest):
+    ioclass = io.MemoryReader
+    UnsupportedOperation = io.UnsupportedOperation
+
+
 class CStringIOTest(PyStringIOTest):
     ioclass = io.StringIO
     UnsupportedOperation = io.UnsupportedOperation
@@ -163,6 +163,30 @@ class FileTests(unittest.TestCase):
             self.assertEqual(fobj.read().splitlines(),
                 [b"bacon", b"eggs", b"spam"])
 
+    @requires_os_func('splice')
+    def test_splice(self):
+        r, w = os.pipe()
+        self.addCleanup(os.close, r)
+        self.addCleanup(os.close, w)
+        os.write(w, b'hello world')
+        fd = os.open(support.TESTFN, os.O_CREAT | os.O_RDWR)
+        self.addCleanup(os.close, fd)
+        self.assertEqual(os.splice(r, fd, 6), 6)
+        self.assertEqual(os.splice(r, fd, 5, offset_dst=2), 5)
+        self.assertEqual(os.lseek(fd, 0, os.SEEK_CUR), 6)
+        self.assertEqual(os.pread(fd, 10, 0), b'heworld')
+        self.assertEqual(os.splice(fd, w, 3, offset_src=4), 3)
+        self.assertEqual(os.read(r, 10), b'rld')
+
+    @requires_os_func('splice')
+    def test_splice_invalid_values(self):
+        with self.assertRaises(ValueError):
+            os.splice(0, 1, -10)
+        r, w = os.pipe()
+        os.close(r)
+        os.close(w)
+        self.assertRaises(OSError, os.splice, r, w, 10)
+
     def write_windows_console(self, *args):
         retcode = subprocess.call(args,
             # use a new console to not flood the test output
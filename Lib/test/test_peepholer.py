@@ -1,8 +1,17 @@
 import dis
+import textwrap
 import unittest
 
 from test.bytecode_helper import BytecodeTestCase
 
+
+def exec_module(source):
+    # Final is not in typing yet: don't evaluate the annotations
+    ns = {}
+    exec("from __future__ import annotations\n" + textwrap.dedent(source), ns)
+    return ns
+
+
 class TestTranforms(BytecodeTestCase):
 
     def test_unot(self):
@@ -318,6 +327,120 @@ class TestTranforms(BytecodeTestCase):
             return 0
         self.assertEqual(f(), 1)
 
+    def test_elim_unreachable_return_none(self):
+        # Both branches return: no implicit "return None" is emitted
+        def f(x):
+            if x:
+                return 1
+            else:
+                return 2
+        consts = [instr.argval for instr in dis.get_instructions(f)
+                               if instr.opname == 'LOAD_CONST']
+        self.assertEqual(consts, [1, 2])
+        self.assertNotInBytecode(f, 'JUMP_FORWARD')
+        self.assertEqual(f(0), 2)
+
+    def test_inline_exit_block(self):
+        # JUMP_FORWARD to LOAD_CONST None RETURN  -->  LOAD_CONST None RETURN
+        def f(x):
+            if x:
+                a = 1
+            else:
+                a = 2
+        self.assertNotInBytecode(f, 'JUMP_FORWARD')
+        self.assertNotInBytecode(f, 'JUMP_ABSOLUTE')
+        returns = [instr for instr in dis.get_instructions(f)
+                          if instr.opname == 'RETURN_VALUE']
+        self.assertEqual(len(returns), 2)
+        self.assertIsNone(f(1))
+
+    def test_constant_condition_in_boolop(self):
+        def f(x):
+            if True and x:
+                return 'a'
+            if False or x:
+                return 'b'
+            if False and x:
+                return 'c'
+            return 'd'
+        consts = [instr.argval for instr in dis.get_instructions(f)
+                               if instr.opname == 'LOAD_CONST']
+        self.assertEqual(consts, ['a', 'b', 'd'])
+        self.assertEqual(f(1), 'a')
+        self.assertEqual(f(0), 'd')
+
+    def test_constant_condition_in_ifexp(self):
+        def f():
+            return 'yes' if __debug__ else 'no'
+        self.assertNotInBytecode(f, 'POP_JUMP_IF_FALSE')
+        self.assertEqual(f(), 'yes' if __debug__ else 'no')
+
+    def test_dead_branch_keeps_generator(self):
+        # The symbol table is built before dead code is dropped
+        def f():
+            if False and (yield):
+                pass
+        self.assertEqual(list(f()), [])
+
+    def test_final_constant_propagation(self):
+        ns = exec_module("""\
+            LIMIT: Final = 60 * 60
+            DEBUG: Final[bool] = False
+            def f(x):
+                if DEBUG:
+                    print(x)
+                return x * LIMIT
+            """)
+        f = ns['f']
+        self.assertInBytecode(f, 'LOAD_CONST', 3600)
+        self.assertNotInBytecode(f, 'LOAD_GLOBAL')
+        self.assertEqual(f(2), 7200)
+
+    def test_final_constant_not_propagated(self):
+        sources = [
+            # rebound at module level
+            "LIMIT: Final = 1\nLIMIT = 2\n",
+            # rebound in a function
+            "LIMIT: Final = 1\ndef g():\n    global LIMIT\n    LIMIT = 2\n",
+            # deleted
+            "LIMIT: Final = 1\ndel LIMIT\n",
+            # may be rebound by a star import
+            "LIMIT: Final = 1\nfrom os import *\n",
+            # not a constant
+            "LIMIT: Final = len('a')\n",
+            # not annotated as Final
+            "LIMIT: int = 1\n",
+            # not at the top level of the module
+            "if True:\n    LIMIT: Final = 1\n",
+        ]
+        for source in sources:
+            with self.subTest(source=source):
+                ns = exec_module(source + "def f():\n    return LIMIT\n")
+                self.assertInBytecode(ns['f'], 'LOAD_GLOBAL', 'LIMIT')
+
+    def test_final_constant_shadowed(self):
+        ns = exec_module("""\
+            LIMIT: Final = 1
+            def f(LIMIT=5):
+                return LIMIT
+            def g():
+                return [LIMIT for LIMIT in range(3)]
+            """)
+        self.assertEqual(ns['f'](), 5)
+        self.assertEqual(ns['g'](), [0, 1, 2])
+
+    def test_final_constant_only_after_definition(self):
+        ns = exec_module("""\
+            def f():
+                return LIMIT
+            LIMIT: Final = 1
+            def g():
+                return LIMIT
+            """)
+        self.assertInBytecode(ns['f'], 'LOAD_GLOBAL', 'LIMIT')
+        self.assertNotInBytecode(ns['g'], 'LOAD_GLOBAL', 'LIMIT')
+        self.assertEqual(ns['f'](), 1)
+
 
 class TestBuglets(unittest.TestCase):
 
@@ -2,8 +2,11 @@ from test.support import (gc_collect, bigmemtest, _2G,
                           cpython_only, captured_stdout)
 import locale
 import re
+import signal
 import sre_compile
 import string
+import sys
+import threading
 import unittest
 import warnings
 from re import Scanner
@@ -1648,6 +1651,199 @@ class ReTests(unittest.TestCase):
         self.assertTrue(re.search("123.*-", '123\U0010ffff-'))
         self.assertTrue(re.search("123.*-", '123\xe9\u20ac\U0010ffff-'))
 
+    def test_search_literal_alternatives(self):
+        # patterns starting with one of a set of literals
+        text = 'xx abcd foo fabx GET /api/users POST /api/x bar'
+        self.assertEqual(re.findall('foo|bar|baz', text), ['foo', 'bar'])
+        self.assertEqual(re.findall('abcd|bc', text), ['abcd'])
+        self.assertEqual(re.findall('bc|abcd', 'abcd bc'), ['abcd', 'bc'])
+        self.assertEqual(re.findall('cd|abce?', 'abcd abc'), ['abc', 'abc'])
+        self.assertEqual(re.findall(r'(?:GET|POST) /api/(\w+)', text),
+                         ['users', 'x'])
+        self.assertEqual(re.findall('(ab|fa)(b|c)', text),
+                         [('ab', 'c'), ('fa', 'b')])
+        self.assertEqual(re.findall('x[ab]yz|qq', 'xbyzxayqqxaxbyz'),
+                         ['xbyz', 'qq', 'xbyz'])
+        # the first alternative matching at the leftmost position wins
+        self.assertEqual(re.search('ab|abc', 'xabc').group(), 'ab')
+        self.assertEqual(re.search('abc|ab', 'xabc').group(), 'abc')
+        self.assertEqual(re.search('ab(?=d)|ab', 'abcabd').span(), (0, 2))
+        # a candidate that doesn't match the whole pattern
+        self.assertEqual(re.search('(?:ab|cd)x', 'abcdabx').span(), (4, 7))
+        self.assertIsNone(re.search('(?:ab|cd)x', 'abcdab'))
+        for s in ('\xe9\u20ac', '\u20ac\U0001f600', '\U0001f600\xe9'):
+            for t in ('', '\xe9', '\u20ac', '\U0001f600'):
+                with self.subTest(s=s, t=t):
+                    pattern = 'zz%s|%szz' % (s, s)
+                    text = t + 'z%s zz %szz' % (s, s) + t
+                    self.assertEqual(re.findall(pattern, text), [s + 'zz'])
+        self.assertEqual(re.findall(b'foo|bar', b'\xfffoo bar\xff'),
+                         [b'foo', b'bar'])
+        self.assertEqual(re.findall('\xe9\xe9|\u20ac\u20ac', 'e\xe9\xe9'),
+                         ['\xe9\xe9'])
+        self.assertEqual(re.findall('(?i)foo|bar', 'FOO BAR'), ['FOO', 'BAR'])
+        many = ['w%dz' % i for i in range(500)]
+        pattern = re.compile('|'.join(many))
+        self.assertEqual(pattern.findall(' '.join(reversed(many))),
+                         list(reversed(many)))
+        self.assertEqual(pattern.search('w12w123z').group(), 'w123z')
+
+    def test_linear(self):
+        # matches are the ones the backtracking engine finds
+        cases = [
+            (r'a(b|c)*d', 'xxabcbd abd ad'), (r'(a+)+$', 'aaaa'),
+            (r'x{2,4}?y', 'xxxxy xy xxy'), (r'\bfoo\b', 'afoo foo foob'),
+            (r'(a)|(b)', 'cba'), (r'(?:(a)|b)*c', 'abbac'),
+            (r'a*', 'baaac'), (r'', 'abc'), (r'x*', 'abxd'),
+            (r'(?i)(\w+)@(\w+)\.com', 'Mail FOO@Example.COM, b@c.com'),
+            (r'(?m)^(\d+)(?:\.(\d+))?$', '1.5\n22\nx\n333.'),
+            (r'(?s)<(.*?)>', '<a>\n<b\n>'), (r'(?:ab|cd)+?e', 'abcdcde'),
+            (r'[^\W\d]+(\d{2,3})', 'ab1 cd12 ef1234'),
+            (r'(?:GET|POST) /(\w+)', 'GET /a POST /bc PUT /d'),
+            (r'(a(b)?)+', 'abaab'), (r'\Bo+\B', 'foo oo boot'),
+            (r'(?:(\s)|(\w))+', 'a b'), (r'\w+$', 'ab\ncd\n'),
+        ]
+        def regs(m):
+            return m and (m.regs, m.lastindex)
+        for pattern, string in cases:
+            for pat, s in ((pattern, string),
+                           (pattern.encode(), string.encode())):
+                p = re.compile(pat)
+                q = re.compile(pat, re.LINEAR)
+                with self.subTest(pattern=pat, string=s):
+                    self.assertEqual(regs(q.match(s)), regs(p.match(s)))
+                    self.assertEqual(regs(q.fullmatch(s)),
+                                     regs(p.fullmatch(s)))
+                    self.assertEqual(regs(q.search(s)), regs(p.search(s)))
+                    self.assertEqual(regs(q.search(s, 1, len(s) - 1)),
+                                     regs(p.search(s, 1, len(s) - 1)))
+                    self.assertEqual(q.findall(s), p.findall(s))
+                    self.assertEqual(q.split(s), p.split(s))
+                    self.assertEqual(q.sub(s[:0], s), p.sub(s[:0], s))
+        # an optional iteration matching the empty string ends the repeat
+        cases = [
+            (r'(?:(?:(?:abc)?|(?:^一|(?:x|c))))+', '1\nccĀ1一'),
+            (r'(?i:(?:(c\s|(?:^|.)|(?:[ab]|^))){1,3})', ' 1'),
+            (r'(?:.{0,2}?|a){2,}', 'bbca'), (r'(?:(?:c*?){2,})*', 'cc'),
+            (r'(?i)((?:(?:[ab]){0,2}?)*){0,2}?', 'cab '),
+            (r'(?m)(?:(\b)|.?|a){2,}', 'ab x c '),
+            (r'(?:(a?)(b?))*(c?)', 'abbcab'), (r'(?:x|(y?)){1,4}z', 'xyxz'),
+        ]
+        for pattern, s in cases:
+            with self.subTest(pattern=pattern, string=s):
+                self.assertEqual(
+                    [(m.regs, m.lastindex)
+                     for m in re.finditer(pattern, s, re.LINEAR)],
+                    [(m.regs, m.lastindex) for m in re.finditer(pattern, s)])
+        self.assertEqual(re.compile('(?P<x>a)', re.LINEAR).search('ba')['x'],
+                         'a')
+        self.assertEqual(repr(re.compile('a', re.LINEAR)),
+                         "re.compile('a', re.LINEAR)")
+        # patterns that take exponential time in the backtracking engine
+        self.assertIsNone(re.match(r'(a+)+$', 'a' * 100000 + 'b', re.LINEAR))
+        self.assertIsNone(re.search(r'(x+x+)+y', 'x' * 10000, re.LINEAR))
+        m = re.search(r'(\w+\s?)*$', 'a ' * 10000 + '!', re.LINEAR)
+        self.assertEqual(m.span(), (20001, 20001))
+        # unsupported constructs
+        for pattern in (r'(a)\1', r'(a)?(?(1)b|c)', r'a(?=b)', r'(?<!a)b'):
+            with self.subTest(pattern=pattern):
+                with self.assertRaisesRegex(re.error, 'linear mode'):
+                    re.compile(pattern, re.LINEAR)
+        with self.assertRaisesRegex(re.error, 'too large'):
+            re.compile(r'(?:a{1000}){1000}', re.LINEAR)
+
+    def test_regex_set(self):
+        patterns = [r'ab', r'a\w*', r'(?i)AB?c', r'\d+$', r'', r'^b|c',
+                    r'x(?:y|z)*', r'a\b', r'abc']
+        strings = ['abc', 'ABC', 'a', 'b12', '12', 'xyzzy', '', 'ab c']
+        def expected(meth, s, *args):
+            return [i for i, p in enumerate(pats)
+                    if getattr(re.compile(p), meth)(s, *args)]
+        for pats, strs in ((patterns, strings),
+                           ([p.encode() for p in patterns],
+                            [s.encode() for s in strings])):
+            regex_set = re.RegexSet(pats)
+            self.assertEqual(len(regex_set), len(pats))
+            for s in strs:
+                with self.subTest(string=s):
+                    self.assertEqual(regex_set.match(s), expected('match', s))
+                    self.assertEqual(regex_set.fullmatch(s),
+                                     expected('fullmatch', s))
+                    self.assertEqual(regex_set.search(s), expected('search', s))
+                    self.assertEqual(regex_set.search(s, 1),
+                                     expected('search', s, 1))
+        regex_set = re.RegexSet(['a', 'b'], re.I)
+        self.assertEqual(regex_set.search('xBA'), [0, 1])
+        self.assertEqual(repr(regex_set),
+                         "re.RegexSet(['a', 'b'], re.IGNORECASE)")
+        self.assertEqual(repr(re.RegexSet(['a'])), "re.RegexSet(['a'])")
+        # many patterns sharing prefixes
+        routes = ['/api/v%d/r%d/(\\d+)$' % (i % 4, i) for i in range(500)]
+        regex_set = re.RegexSet(routes)
+        self.assertEqual(regex_set.match('/api/v2/r42/17'), [42])
+        self.assertEqual(regex_set.match('/api/v2/r4/17'), [])
+        self.assertRaises(ValueError, re.RegexSet, [])
+        self.assertRaises(TypeError, re.RegexSet, ['a', b'b'])
+        with self.assertRaisesRegex(re.error, 'linear mode'):
+            re.RegexSet(['a', r'(a)\1'])
+
+    @cpython_only
+    def test_release_gil(self):
+        # matching a long str or bytes lets other threads run meanwhile
+        self.addCleanup(sys.setswitchinterval, sys.getswitchinterval())
+        sys.setswitchinterval(0.5)
+        started = threading.Event()
+        for pattern, string in ((r'(x+x+)+y', 'x' * 20 + ' ' * 10000),
+                                (br'(x+x+)+y', b'x' * 20 + b' ' * 10000)):
+            with self.subTest(pattern=pattern):
+                search = re.compile(pattern).search
+                def worker():
+                    started.set()
+                    search(string)
+                started.clear()
+                count = 0
+                t = threading.Thread(target=worker)
+                t.start()
+                started.wait()
+                while t.is_alive():
+                    count += 1
+                t.join()
+                self.assertGreater(count, 1000)
+        # but a scanner is used by one thread at a time
+        scanner = re.compile(r'(x+x+)+y').scanner('x' * 20 + ' ' * 10000)
+        errors = []
+        def search():
+            try:
+                scanner.search()
+            except ValueError as exc:
+                errors.append(str(exc))
+        def worker():
+            started.set()
+            search()
+        started.clear()
+        t = threading.Thread(target=worker)
+        t.start()
+        started.wait()
+        search()
+        t.join()
+        self.assertEqual(errors,
+                         ['regular expression scanner already executing'])
+
+    @unittest.skipUnless(hasattr(signal, 'setitimer'), 'requires setitimer()')
+    def test_interrupt_release_gil(self):
+        # signal handlers run while matching without the GIL
+        def handler(signum, frame):
+            1/0
+        old_handler = signal.signal(signal.SIGALRM, handler)
+        self.addCleanup(signal.signal, signal.SIGALRM, old_handler)
+        self.addCleanup(signal.setitimer, signal.ITIMER_REAL, 0)
+        for pattern, string in ((r'(x+x+)+y', 'x' * 40 + ' ' * 10000),
+                                (br'(x+x+)+y', b'x' * 40 + b' ' * 10000)):
+            with self.subTest(pattern=pattern):
+                signal.setitimer(signal.ITIMER_REAL, 0.05)
+                with self.assertRaises(ZeroDivisionError):
+                    re.search(pattern, string)
+
     def test_compile(self):
         # Test return value when given string and pattern as parameter
         pattern = re.compile('random pattern')
@@ -4913,6 +4913,200 @@ class UDPTimeoutTest(SocketUDPTest):
         if not ok:
             self.fail("recv() returned success when we did not expect it")
 
+@requireAttrs(socket.socket, "recvmmsg_into", "sendmmsg")
+class MmsgUDPTest(SocketUDPTest):
+    # Tests for recvmmsg_into() and sendmmsg().
+
+    SIZE = 64
+
+    def setUp(self):
+        super().setUp()
+        self.serv.settimeout(30.0)
+        self.cli = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.addCleanup(self.cli.close)
+        self.cli.bind((HOST, 0))
+
+    def recv_all(self, count, with_addresses=False):
+        # Receive count datagrams with recvmmsg_into().
+        buf = bytearray(self.SIZE * count)
+        sizes = array.array('i', [-1] * count)
+        addrs = bytearray(socket.SOCKADDR_SIZE * count)
+        received = 0
+        while received < count:
+            n = self.serv.recvmmsg_into(
+                memoryview(buf)[received * self.SIZE:],
+                self.SIZE,
+                memoryview(sizes)[received:],
+                memoryview(addrs)[received * socket.SOCKADDR_SIZE:]
+                if with_addresses else None)
+            self.assertGreater(n, 0)
+            received += n
+        return buf, sizes, addrs
+
+    def test_recvmmsg_into(self):
+        msgs = [b'', b'a', b'spam' * 4, b'x' * (self.SIZE - 1),
+                b'y' * self.SIZE] + [b'%d' % i for i in range(20)]
+        for msg in msgs:
+            self.cli.sendto(msg, (HOST, self.port))
+        buf, sizes, addrs = self.recv_all(len(msgs), True)
+        self.assertEqual(sizes.tolist(), [len(msg) for msg in msgs])
+        for i, msg in enumerate(msgs):
+            self.assertEqual(buf[i * self.SIZE:i * self.SIZE + sizes[i]], msg)
+            port, host = struct.unpack_from(
+                '!H4s', addrs, i * socket.SOCKADDR_SIZE + 2)
+            self.assertEqual((socket.inet_ntoa(host), port),
+                             self.cli.getsockname())
+
+    def test_recvmmsg_into_truncated(self):
+        self.cli.sendto(b'z' * (self.SIZE + 10), (HOST, self.port))
+        buf, sizes, addrs = self.recv_all(1)
+        self.assertEqual(sizes[0], self.SIZE)
+        self.assertEqual(buf, b'z' * self.SIZE)
+
+    def test_recvmmsg_into_limits(self):
+        # The number of datagrams is limited by the shortest argument.
+        for i in range(3):
+            self.cli.sendto(b'%d' % i, (HOST, self.port))
+        sizes = array.array('i', [-1] * 3)
+        self.assertEqual(self.serv.recvmmsg_into(bytearray(self.SIZE * 3),
+                                                 self.SIZE, sizes[:1]), 1)
+        self.assertEqual(self.serv.recvmmsg_into(bytearray(self.SIZE),
+                                                 self.SIZE, sizes), 1)
+        self.assertEqual(self.serv.recvmmsg_into(
+            bytearray(self.SIZE * 3), self.SIZE, sizes,
+            bytearray(socket.SOCKADDR_SIZE)), 1)
+        self.assertEqual(self.serv.recvmmsg_into(bytearray(10), self.SIZE,
+                                                 sizes), 0)
+
+    def test_recvmmsg_into_nonblocking(self):
+        self.serv.setblocking(False)
+        sizes = array.array('i', [0] * 4)
+        self.assertRaises(BlockingIOError, self.serv.recvmmsg_into,
+                          bytearray(self.SIZE * 4), self.SIZE, sizes)
+
+    def test_sendmmsg(self):
+        self.cli.connect((HOST, self.port))
+        msgs = [b'abc', b'', b'x' * self.SIZE, b'spam']
+        buf = bytearray(self.SIZE * len(msgs))
+        for i, msg in enumerate(msgs):
+            buf[i * self.SIZE:i * self.SIZE + len(msg)] = msg
+        sizes = array.array('i', map(len, msgs))
+        self.assertEqual(self.cli.sendmmsg(buf, self.SIZE, sizes), len(msgs))
+        for msg in msgs:
+            self.assertEqual(self.serv.recv(1024), msg)
+        self.assertEqual(self.cli.sendmmsg(b'', self.SIZE, sizes[:0]), 0)
+
+    def test_sendmmsg_addresses(self):
+        # Echo datagrams back to their senders.
+        msgs = [b'%d' % i * i for i in range(10)]
+        for msg in msgs:
+            self.cli.sendto(msg, (HOST, self.port))
+        buf, sizes, addrs = self.recv_all(len(msgs), True)
+        self.assertEqual(self.serv.sendmmsg(buf, self.SIZE, sizes, addrs),
+                         len(msgs))
+        self.cli.settimeout(self.serv.gettimeout())
+        for msg in msgs:
+            self.assertEqual(self.cli.recv(1024), msg)
+
+    def test_errors(self):
+        buf = bytearray(self.SIZE * 2)
+        sizes = array.array('i', [1, 2])
+        for bad in bytearray(8), array.array('h', [0] * 4):
+            self.assertRaises(TypeError, self.serv.recvmmsg_into,
+                              buf, self.SIZE, bad)
+        self.assertRaises(TypeError, self.serv.recvmmsg_into,
+                          b'\0' * 128, self.SIZE, sizes)
+        self.assertRaises(BufferError, self.serv.recvmmsg_into,
+                          buf, self.SIZE, memoryview(sizes).toreadonly())
+        self.assertRaises(BufferError, self.serv.recvmmsg_into,
+                          buf, self.SIZE, sizes, b'\0' * 256)
+        self.assertRaises(ValueError, self.serv.recvmmsg_into, buf, 0, sizes)
+        self.assertRaises(TypeError, self.cli.sendmmsg,
+                          buf, self.SIZE, bytearray(8))
+        self.assertRaises(ValueError, self.cli.sendmmsg, buf, -1, sizes)
+        self.assertRaises(ValueError, self.cli.sendmmsg,
+                          buf, self.SIZE, array.array('i', [self.SIZE + 1]))
+        self.assertRaises(ValueError, self.cli.sendmmsg,
+                          buf, self.SIZE, array.array('i', [1, 2, 3]))
+        self.assertRaises(ValueError, self.cli.sendmmsg,
+                          buf, self.SIZE, array.array('i', [-1]))
+        self.assertRaises(ValueError, self.cli.sendmmsg,
+                          buf, sys.maxsize, array.array('i', [0, 1]))
+        self.assertRaises(ValueError, self.cli.sendmmsg, buf, self.SIZE,
+                          sizes, bytearray(socket.SOCKADDR_SIZE))
+        self.serv.close()
+        self.assertRaises(OSError, self.serv.recvmmsg_into,
+                          buf, self.SIZE, sizes)
+
+@requireAttrs(socket.socket, "splice")
+class SpliceTest(unittest.TestCase):
+    # Tests for splice().
+
+    def setUp(self):
+        self.src, self.src_peer = socket.socketpair()
+        self.dst, self.dst_peer = socket.socketpair()
+        for sock in self.src, self.src_peer, self.dst, self.dst_peer:
+            self.addCleanup(sock.close)
+
+    def transfer(self, data, *args):
+        # Send data to src from a thread, splice it to dst and return the
+        # count along with what was received on the other side.
+        def send():
+            self.src_peer.sendall(data)
+            self.src_peer.shutdown(socket.SHUT_WR)
+        def recv():
+            chunks = []
+            while True:
+                chunk = self.dst_peer.recv(65536)
+                if not chunk:
+                    break
+                chunks.append(chunk)
+            received.append(b''.join(chunks))
+        received = []
+        threads = [threading.Thread(target=send),
+                   threading.Thread(target=recv)]
+        with support.start_threads(threads):
+            try:
+                count = self.src.splice(self.dst, *args)
+            finally:
+                self.dst.shutdown(socket.SHUT_WR)
+        return count, received[0]
+
+    def test_splice(self):
+        data = os.urandom(4 * 1024 * 1024)
+        self.assertEqual(self.transfer(data), (len(data), data))
+
+    def test_splice_count(self):
+        data = b'spam' * 1000
+        self.assertEqual(self.transfer(data, 10), (10, data[:10]))
+        self.assertEqual(self.src.recv(10), data[10:20])
+        self.assertEqual(self.src.splice(self.dst, 0), 0)
+
+    def test_splice_to_pipe(self):
+        r, w = os.pipe()
+        self.addCleanup(os.close, r)
+        self.addCleanup(os.close, w)
+        self.src_peer.sendall(b'eggs')
+        self.src_peer.shutdown(socket.SHUT_WR)
+        self.assertEqual(self.src.splice(w), 4)
+        self.assertEqual(os.read(r, 10), b'eggs')
+
+    def test_splice_timeout(self):
+        self.src.settimeout(0.1)
+        self.src_peer.sendall(b'x')
+        self.assertRaises(socket.timeout, self.src.splice, self.dst)
+
+    def test_errors(self):
+        self.assertRaises(ValueError, self.src.splice, self.dst, -1)
+        self.assertRaises(TypeError, self.src.splice, 'spam')
+        self.dst.setblocking(False)
+        self.assertRaises(ValueError, self.src.splice, self.dst)
+        self.src.setblocking(False)
+        self.assertRaises(ValueError, self.src.splice, 1)
+        self.src.setblocking(True)
+        self.dst.close()
+        self.assertRaises(ValueError, self.src.splice, self.dst)
+
 class TestExceptions(unittest.TestCase):
 
     def testExceptionTree(self):
@@ -5981,7 +6175,8 @@ class TestMSWindowsTCPFlags(unittest.TestCase):
 
 def test_main():
     tests = [GeneralModuleTests, BasicTCPTest, TCPCloserTest, TCPTimeoutTest,
-             TestExceptions, BufferIOTest, BasicTCPTest2, BasicUDPTest, UDPTimeoutTest ]
+             TestExceptions, BufferIOTest, BasicTCPTest2, BasicUDPTest, UDPTimeoutTest,
+             MmsgUDPTest, SpliceTest ]
 
     tests.extend([
         NonBlockingTCPTests,
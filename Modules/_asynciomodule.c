@@ -1,6 +1,10 @@
 #include "Python.h"
 #include "structmember.h"
 
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
+
 
 /*[clinic input]
 module _asyncio
@@ -23,6 +27,7 @@ _Py_IDENTIFIER(throw);
 /* State of the _asyncio module */
 static PyObject *asyncio_mod;
 static PyObject *inspect_isgenerator;
+static PyObject *collections_deque;
 static PyObject *traceback_extract_stack;
 static PyObject *asyncio_get_event_loop_policy;
 static PyObject *asyncio_future_repr_info_func;
@@ -32,12 +37,20 @@ static PyObject *asyncio_task_print_stack_func;
 static PyObject *asyncio_task_repr_info_func;
 static PyObject *asyncio_InvalidStateError;
 static PyObject *asyncio_CancelledError;
+static PyObject *asyncio_format_callback_source_func;
 static PyObject *context_kwname;
+#ifdef HAVE_EPOLL
+static PyObject *selectors_SelectorKey;
+#endif
 
 static PyObject *cached_running_holder;
 static volatile uint64_t cached_running_holder_tsid;
 
 
+/* BaseEventLoop.call_soon(), looked up on first use; None if missing. */
+static PyObject *base_events_call_soon;
+
+
 /* WeakSet containing all alive tasks. */
 static PyObject *all_tasks;
 
@@ -94,6 +107,17 @@ typedef struct {
     TaskObj *ww_task;
 } TaskWakeupMethWrapper;
 
+typedef struct {
+    PyObject_HEAD
+    PyObject *rc_loop;
+    /* The task to step if rc_step is set, the callable to call otherwise */
+    PyObject *rc_callback;
+    PyObject *rc_arg;
+    PyObject *rc_context;
+    int rc_step;
+    int rc_cancelled;
+} ReadyCallbackObj;
+
 typedef struct {
     PyObject_HEAD
     PyObject *rl_loop;
@@ -103,9 +127,62 @@ typedef struct {
 } PyRunningLoopHolder;
 
 
+typedef struct {
+    PyObject_HEAD
+    char *sb_data;
+    /* The data is sb_data[sb_start:sb_end] */
+    Py_ssize_t sb_start;
+    Py_ssize_t sb_end;
+    Py_ssize_t sb_alloc;
+    Py_ssize_t sb_exports;
+} StreamBufferObj;
+
+/* The free space after the data of a StreamBuffer, exported by the views
+   get_buffer() returns */
+typedef struct {
+    PyObject_HEAD
+    StreamBufferObj *ss_buffer;
+} StreamBufferSpaceObj;
+
+#ifdef HAVE_EPOLL
+typedef struct {
+    PyObject *reader;
+    PyObject *writer;
+} epollcore_handles;
+
+typedef struct {
+    PyObject_HEAD
+    int ec_epfd;
+    int ec_nregistered;
+    /* Reader and writer handles, indexed by file descriptor */
+    epollcore_handles *ec_handles;
+    int ec_size;
+    struct epoll_event *ec_events;
+    int ec_maxevents;
+} EpollCoreObj;
+#endif
+
+
 static PyTypeObject FutureType;
 static PyTypeObject TaskType;
 static PyTypeObject PyRunningLoopHolder_Type;
+static PyTypeObject ReadyCallbackType;
+static PyTypeObject StreamBufferType;
+static PyTypeObject StreamBufferSpaceType;
+#ifdef HAVE_EPOLL
+static PyTypeObject EpollCoreType;
+
+static int
+epollcore_fd_converter(PyObject *obj, void *ptr)
+{
+    int fd = PyObject_AsFileDescriptor(obj);
+    if (fd < 0) {
+        return 0;
+    }
+    *(int *)ptr = fd;
+    return 1;
+}
+#endif
 
 
 #define Future_CheckExact(obj) (Py_TYPE(obj) == &FutureType)
@@ -336,6 +413,9 @@ get_event_loop(void)
 }
 
 
+static int ready_callback_schedule(PyObject *, PyObject *, int,
+                                   PyObject *, PyObject *);
+
 static int
 call_soon(PyObject *loop, PyObject *func, PyObject *arg, PyObject *ctx)
 {
@@ -343,6 +423,13 @@ call_soon(PyObject *loop, PyObject *func, PyObject *arg, PyObject *ctx)
     PyObject *stack[3];
     Py_ssize_t nargs;
 
+    if (ctx != NULL) {
+        int res = ready_callback_schedule(loop, func, 0, arg, ctx);
+        if (res != 0) {
+            return res < 0 ? -1 : 0;
+        }
+    }
+
     if (ctx == NULL) {
         handle = _PyObject_CallMethodIdObjArgs(
             loop, &PyId_call_soon, func, arg, NULL);
@@ -1686,6 +1773,7 @@ class _asyncio.Task "TaskObj *" "&Task_Type"
 /*[clinic end generated code: output=da39a3ee5e6b4b0d input=719dcef0fcc03b37]*/
 
 static int task_call_step_soon(TaskObj *, PyObject *);
+static int task_eager_start(TaskObj *);
 static PyObject * task_wakeup(TaskObj *, PyObject *);
 static PyObject * task_step(TaskObj *, PyObject *);
 
@@ -1950,6 +2038,41 @@ leave_task(PyObject *loop, PyObject *task)
     return _PyDict_DelItem_KnownHash(current_tasks, loop, hash);
 }
 
+
+/* Make task the current task of loop, None leaving it without one.
+   Return a new reference to the previous current task, or None. */
+static PyObject *
+swap_current_task(PyObject *loop, PyObject *task)
+{
+    PyObject *prev_task;
+    Py_hash_t hash;
+    hash = PyObject_Hash(loop);
+    if (hash == -1) {
+        return NULL;
+    }
+    prev_task = _PyDict_GetItem_KnownHash(current_tasks, loop, hash);
+    if (prev_task == NULL) {
+        if (PyErr_Occurred()) {
+            return NULL;
+        }
+        prev_task = Py_None;
+    }
+    Py_INCREF(prev_task);
+
+    if (task == Py_None) {
+        if (prev_task != Py_None &&
+            _PyDict_DelItem_KnownHash(current_tasks, loop, hash) < 0) {
+            Py_DECREF(prev_task);
+            return NULL;
+        }
+    }
+    else if (_PyDict_SetItem_KnownHash(current_tasks, loop, task, hash) < 0) {
+        Py_DECREF(prev_task);
+        return NULL;
+    }
+    return prev_task;
+}
+
 /* ----- Task */
 
 /*[clinic input]
@@ -1958,13 +2081,15 @@ _asyncio.Task.__init__
     coro: object
     *
     loop: object = None
+    eager_start: bool = False
 
 A coroutine wrapped in a Future.
 [clinic start generated code]*/
 
 static int
-_asyncio_Task___init___impl(TaskObj *self, PyObject *coro, PyObject *loop)
-/*[clinic end generated code: output=9f24774c2287fc2f input=8d132974b049593e]*/
+_asyncio_Task___init___impl(TaskObj *self, PyObject *coro, PyObject *loop,
+                            int eager_start)
+/*[clinic end generated code: output=e6f25b9e70d1a151 input=a8a7a39188f313a6]*/
 {
     if (future_init((FutureObj*)self, loop)) {
         return -1;
@@ -1993,6 +2118,26 @@ _asyncio_Task___init___impl(TaskObj *self, PyObject *coro, PyObject *loop)
     Py_INCREF(coro);
     Py_XSETREF(self->task_coro, coro);
 
+    if (eager_start) {
+        _Py_IDENTIFIER(is_running);
+        PyObject *res = _PyObject_CallMethodIdObjArgs(
+            self->task_loop, &PyId_is_running, NULL);
+        if (res == NULL) {
+            return -1;
+        }
+        int is_running = PyObject_IsTrue(res);
+        Py_DECREF(res);
+        if (is_running == -1) {
+            return -1;
+        }
+        if (is_running) {
+            if (register_task((PyObject*)self)) {
+                return -1;
+            }
+            return task_eager_start(self);
+        }
+    }
+
     if (task_call_step_soon(self, NULL)) {
         return -1;
     }
@@ -2474,6 +2619,12 @@ TaskObj_dealloc(PyObject *self)
 static int
 task_call_step_soon(TaskObj *task, PyObject *arg)
 {
+    int res = ready_callback_schedule(task->task_loop, (PyObject *)task, 1,
+                                      arg, task->task_context);
+    if (res != 0) {
+        return res < 0 ? -1 : 0;
+    }
+
     PyObject *cb = TaskStepMethWrapper_new(task, arg);
     if (cb == NULL) {
         return -1;
@@ -2909,6 +3060,47 @@ task_step(TaskObj *task, PyObject *exc)
     }
 }
 
+static int
+task_eager_start(TaskObj *task)
+{
+    /* Run the first step right away, as if the task calling
+       create_task() was suspended until the new task yields. */
+    PyObject *prev_task = swap_current_task(task->task_loop, Py_None);
+    if (prev_task == NULL) {
+        return -1;
+    }
+
+    PyObject *res = NULL;
+    if (PyContext_Enter(task->task_context) == 0) {
+        res = task_step(task, NULL);
+
+        PyObject *et, *ev, *tb;
+        PyErr_Fetch(&et, &ev, &tb);
+        if (PyContext_Exit(task->task_context) < 0) {
+            Py_CLEAR(res);
+        }
+        _PyErr_ChainExceptions(et, ev, tb);
+    }
+
+    PyObject *et, *ev, *tb;
+    PyErr_Fetch(&et, &ev, &tb);
+    PyObject *cur_task = swap_current_task(task->task_loop, prev_task);
+    Py_DECREF(prev_task);
+    if (cur_task == NULL) {
+        Py_CLEAR(res);
+    }
+    else {
+        Py_DECREF(cur_task);
+    }
+    _PyErr_ChainExceptions(et, ev, tb);
+
+    if (res == NULL) {
+        return -1;
+    }
+    Py_DECREF(res);
+    return 0;
+}
+
 static PyObject *
 task_wakeup(TaskObj *task, PyObject *o)
 {
@@ -2963,142 +3155,1492 @@ task_wakeup(TaskObj *task, PyObject *o)
 }
 
 
-/*********************** Functions **************************/
-
-
-/*[clinic input]
-_asyncio._get_running_loop
+/*********************** ReadyCallback **************************/
 
-Return the running event loop or None.
+/* Callbacks scheduled by futures and tasks are appended directly to the
+   ready queue of a BaseEventLoop, as ReadyCallback objects instead of
+   Handles created by call_soon().  Nobody else holds a reference to them,
+   so they can be reused from a free list. */
 
-This is a low-level function intended to be used by event loops.
-This function is thread-specific.
+#define RC_FREELIST_MAXLEN 255
+static ReadyCallbackObj *rc_freelist = NULL;
+static Py_ssize_t rc_freelist_len = 0;
 
-[clinic start generated code]*/
 
+/* Return a borrowed reference to the ready queue of loop, or NULL if
+   callbacks must go through loop.call_soon(): when loop isn't a
+   BaseEventLoop using the default call_soon(), is closed or in debug
+   mode. */
 static PyObject *
-_asyncio__get_running_loop_impl(PyObject *module)
-/*[clinic end generated code: output=b4390af721411a0a input=0a21627e25a4bd43]*/
+loop_get_ready_queue(PyObject *loop)
 {
-    PyObject *loop;
-    if (get_running_loop(&loop)) {
+    _Py_IDENTIFIER(_closed);
+    _Py_IDENTIFIER(_debug);
+    _Py_IDENTIFIER(_ready);
+    PyObject **dictptr;
+    PyObject *dict;
+    PyObject *ready;
+
+    if (base_events_call_soon == NULL) {
+        PyObject *cls = NULL;
+        PyObject *module = PyImport_ImportModule("asyncio.base_events");
+        if (module != NULL) {
+            cls = PyObject_GetAttrString(module, "BaseEventLoop");
+            Py_DECREF(module);
+        }
+        if (cls != NULL) {
+            base_events_call_soon = _PyObject_GetAttrId(cls, &PyId_call_soon);
+            Py_DECREF(cls);
+        }
+        if (base_events_call_soon == NULL) {
+            PyErr_Clear();
+            Py_INCREF(Py_None);
+            base_events_call_soon = Py_None;
+        }
+    }
+
+    if (_PyType_LookupId(Py_TYPE(loop), &PyId_call_soon) !=
+            base_events_call_soon) {
         return NULL;
     }
-    if (loop == NULL) {
-        /* There's no currently running event loop */
-        Py_RETURN_NONE;
+    dictptr = _PyObject_GetDictPtr(loop);
+    if (dictptr == NULL || *dictptr == NULL) {
+        return NULL;
     }
-    return loop;
+    dict = *dictptr;
+    /* call_soon() may be overridden on the instance, e.g. by tests */
+    if (_PyDict_GetItemId(dict, &PyId_call_soon) != NULL ||
+        _PyDict_GetItemId(dict, &PyId__closed) != Py_False ||
+        _PyDict_GetItemId(dict, &PyId__debug) != Py_False) {
+        return NULL;
+    }
+    ready = _PyDict_GetItemId(dict, &PyId__ready);
+    if (ready == NULL || !PyObject_TypeCheck(ready, (PyTypeObject *)collections_deque)) {
+        return NULL;
+    }
+    return ready;
 }
 
-/*[clinic input]
-_asyncio._set_running_loop
-    loop: 'O'
-    /
 
-Set the running event loop.
+/* Schedule callback(arg), or a step of the task callback with the
+   exception arg if step is set, in the context ctx.  Return 1 if it
+   was scheduled, 0 if it must be scheduled with loop.call_soon(), or -1
+   with an exception set. */
+static int
+ready_callback_schedule(PyObject *loop, PyObject *callback, int step,
+                        PyObject *arg, PyObject *ctx)
+{
+    _Py_IDENTIFIER(append);
+    ReadyCallbackObj *rc;
+    PyObject *ready;
+    PyObject *res;
 
-This is a low-level function intended to be used by event loops.
-This function is thread-specific.
-[clinic start generated code]*/
+    ready = loop_get_ready_queue(loop);
+    if (ready == NULL) {
+        return 0;
+    }
+
+    if (rc_freelist_len) {
+        rc_freelist_len--;
+        rc = rc_freelist;
+        rc_freelist = (ReadyCallbackObj *) rc->rc_callback;
+        rc->rc_callback = NULL;
+        _Py_NewReference((PyObject *) rc);
+    }
+    else {
+        rc = PyObject_GC_New(ReadyCallbackObj, &ReadyCallbackType);
+        if (rc == NULL) {
+            return -1;
+        }
+    }
+
+    Py_INCREF(loop);
+    rc->rc_loop = loop;
+    Py_INCREF(callback);
+    rc->rc_callback = callback;
+    Py_XINCREF(arg);
+    rc->rc_arg = arg;
+    Py_INCREF(ctx);
+    rc->rc_context = ctx;
+    rc->rc_step = step;
+    rc->rc_cancelled = 0;
+    PyObject_GC_Track(rc);
+
+    Py_INCREF(ready);
+    res = _PyObject_CallMethodIdObjArgs(ready, &PyId_append, rc, NULL);
+    Py_DECREF(ready);
+    Py_DECREF(rc);
+    if (res == NULL) {
+        return -1;
+    }
+    Py_DECREF(res);
+    return 1;
+}
 
 static PyObject *
-_asyncio__set_running_loop(PyObject *module, PyObject *loop)
-/*[clinic end generated code: output=ae56bf7a28ca189a input=4c9720233d606604]*/
+ReadyCallback_get_callback(ReadyCallbackObj *rc, void *Py_UNUSED(ignored))
 {
-    if (set_running_loop(loop)) {
-        return NULL;
+    if (rc->rc_callback == NULL) {
+        Py_RETURN_NONE;
     }
-    Py_RETURN_NONE;
+    if (rc->rc_step) {
+        return TaskStepMethWrapper_new((TaskObj *)rc->rc_callback,
+                                       rc->rc_arg);
+    }
+    Py_INCREF(rc->rc_callback);
+    return rc->rc_callback;
 }
 
-/*[clinic input]
-_asyncio.get_event_loop
-
-Return an asyncio event loop.
-
-When called from a coroutine or a callback (e.g. scheduled with
-call_soon or similar API), this function will always return the
-running event loop.
-
-If there is no running event loop set, the function will return
-the result of `get_event_loop_policy().get_event_loop()` call.
-[clinic start generated code]*/
-
 static PyObject *
-_asyncio_get_event_loop_impl(PyObject *module)
-/*[clinic end generated code: output=2a2d8b2f824c648b input=9364bf2916c8655d]*/
+ReadyCallback_get_args(ReadyCallbackObj *rc, void *Py_UNUSED(ignored))
 {
-    return get_event_loop();
+    if (rc->rc_step || rc->rc_arg == NULL) {
+        return PyTuple_New(0);
+    }
+    return PyTuple_Pack(1, rc->rc_arg);
 }
 
-/*[clinic input]
-_asyncio.get_running_loop
-
-Return the running event loop.  Raise a RuntimeError if there is none.
-
-This function is thread-specific.
-[clinic start generated code]*/
+static PyObject *
+ReadyCallback_get_cancelled(ReadyCallbackObj *rc, void *Py_UNUSED(ignored))
+{
+    return PyBool_FromLong(rc->rc_cancelled);
+}
 
 static PyObject *
-_asyncio_get_running_loop_impl(PyObject *module)
-/*[clinic end generated code: output=c247b5f9e529530e input=2a3bf02ba39f173d]*/
+ReadyCallback_format_source(ReadyCallbackObj *rc)
 {
-    PyObject *loop;
-    if (get_running_loop(&loop)) {
+    PyObject *callback;
+    PyObject *args;
+    PyObject *source;
+
+    callback = ReadyCallback_get_callback(rc, NULL);
+    if (callback == NULL) {
         return NULL;
     }
-    if (loop == NULL) {
-        /* There's no currently running event loop */
-        PyErr_SetString(
-            PyExc_RuntimeError, "no running event loop");
+    args = ReadyCallback_get_args(rc, NULL);
+    if (args == NULL) {
+        Py_DECREF(callback);
+        return NULL;
     }
-    return loop;
+    source = PyObject_CallFunctionObjArgs(
+        asyncio_format_callback_source_func, callback, args, NULL);
+    Py_DECREF(callback);
+    Py_DECREF(args);
+    return source;
 }
 
-/*[clinic input]
-_asyncio._register_task
-
-    task: object
-
-Register a new task in asyncio as executed by loop.
+/* Pass the current exception, raised by the callback, to the exception
+   handler of the loop the way Handle._run() does. */
+static int
+ReadyCallback_report_error(ReadyCallbackObj *rc)
+{
+    _Py_IDENTIFIER(call_exception_handler);
+    PyObject *et, *ev, *tb;
+    PyObject *source;
+    PyObject *context = NULL;
+    PyObject *res;
 
-Returns None.
-[clinic start generated code]*/
+    PyErr_Fetch(&et, &ev, &tb);
+    PyErr_NormalizeException(&et, &ev, &tb);
+    if (tb != NULL) {
+        PyException_SetTraceback(ev, tb);
+    }
+
+    source = ReadyCallback_format_source(rc);
+    if (source != NULL) {
+        context = Py_BuildValue("{s:N,s:O,s:O}",
+                                "message",
+                                PyUnicode_FromFormat(
+                                    "Exception in callback %U", source),
+                                "exception", ev,
+                                "handle", (PyObject *)rc);
+        Py_DECREF(source);
+    }
+    Py_XDECREF(et);
+    Py_XDECREF(ev);
+    Py_XDECREF(tb);
+    if (context == NULL) {
+        return -1;
+    }
 
-static PyObject *
-_asyncio__register_task_impl(PyObject *module, PyObject *task)
-/*[clinic end generated code: output=8672dadd69a7d4e2 input=21075aaea14dfbad]*/
-{
-    if (register_task(task) < 0) {
-        return NULL;
+    res = _PyObject_CallMethodIdObjArgs(
+        rc->rc_loop, &PyId_call_exception_handler, context, NULL);
+    Py_DECREF(context);
+    if (res == NULL) {
+        return -1;
     }
-    Py_RETURN_NONE;
+    Py_DECREF(res);
+    return 0;
 }
 
+static PyObject *
+ReadyCallback_run(ReadyCallbackObj *rc, PyObject *Py_UNUSED(ignored))
+{
+    PyObject *res = NULL;
 
-/*[clinic input]
-_asyncio._unregister_task
+    if (rc->rc_callback == NULL) {
+        Py_RETURN_NONE;
+    }
 
-    task: object
+    /* Keep rc alive: the callback may drop the last other reference */
+    Py_INCREF(rc);
+    if (PyContext_Enter(rc->rc_context) == 0) {
+        if (rc->rc_step) {
+            res = task_step((TaskObj *)rc->rc_callback, rc->rc_arg);
+        }
+        else if (rc->rc_arg != NULL) {
+            res = PyObject_CallFunctionObjArgs(
+                rc->rc_callback, rc->rc_arg, NULL);
+        }
+        else {
+            res = _PyObject_CallNoArg(rc->rc_callback);
+        }
 
-Unregister a task.
+        PyObject *et, *ev, *tb;
+        PyErr_Fetch(&et, &ev, &tb);
+        if (PyContext_Exit(rc->rc_context) < 0) {
+            Py_CLEAR(res);
+        }
+        _PyErr_ChainExceptions(et, ev, tb);
+    }
 
-Returns None.
-[clinic start generated code]*/
+    if (res == NULL) {
+        if (!PyErr_ExceptionMatches(PyExc_Exception) ||
+            ReadyCallback_report_error(rc) < 0) {
+            Py_DECREF(rc);
+            return NULL;
+        }
+    }
+    else {
+        Py_DECREF(res);
+    }
+    Py_DECREF(rc);
+    Py_RETURN_NONE;
+}
 
 static PyObject *
-_asyncio__unregister_task_impl(PyObject *module, PyObject *task)
-/*[clinic end generated code: output=6e5585706d568a46 input=28fb98c3975f7bdc]*/
+ReadyCallback_cancel(ReadyCallbackObj *rc, PyObject *Py_UNUSED(ignored))
 {
-    if (unregister_task(task) < 0) {
-        return NULL;
-    }
+    rc->rc_cancelled = 1;
     Py_RETURN_NONE;
 }
 
+static PyObject *
+ReadyCallback_cancelled(ReadyCallbackObj *rc, PyObject *Py_UNUSED(ignored))
+{
+    return PyBool_FromLong(rc->rc_cancelled);
+}
 
-/*[clinic input]
+static PyObject *
+ReadyCallback_repr(ReadyCallbackObj *rc)
+{
+    PyObject *source;
+    PyObject *repr;
+
+    source = ReadyCallback_format_source(rc);
+    if (source == NULL) {
+        return NULL;
+    }
+    repr = PyUnicode_FromFormat("<%s %s%U>", Py_TYPE(rc)->tp_name,
+                                rc->rc_cancelled ? "cancelled " : "",
+                                source);
+    Py_DECREF(source);
+    return repr;
+}
+
+static int
+ReadyCallback_clear(ReadyCallbackObj *rc)
+{
+    Py_CLEAR(rc->rc_loop);
+    Py_CLEAR(rc->rc_callback);
+    Py_CLEAR(rc->rc_arg);
+    Py_CLEAR(rc->rc_context);
+    return 0;
+}
+
+static int
+ReadyCallback_traverse(ReadyCallbackObj *rc, visitproc visit, void *arg)
+{
+    Py_VISIT(rc->rc_loop);
+    Py_VISIT(rc->rc_callback);
+    Py_VISIT(rc->rc_arg);
+    Py_VISIT(rc->rc_context);
+    return 0;
+}
+
+static void
+ReadyCallback_dealloc(ReadyCallbackObj *rc)
+{
+    PyObject_GC_UnTrack(rc);
+    (void)ReadyCallback_clear(rc);
+
+    if (rc_freelist_len < RC_FREELIST_MAXLEN) {
+        rc_freelist_len++;
+        rc->rc_callback = (PyObject *) rc_freelist;
+        rc_freelist = rc;
+    }
+    else {
+        PyObject_GC_Del(rc);
+    }
+}
+
+static PyMethodDef ReadyCallback_methods[] = {
+    {"_run", (PyCFunction)ReadyCallback_run, METH_NOARGS, NULL},
+    {"cancel", (PyCFunction)ReadyCallback_cancel, METH_NOARGS, NULL},
+    {"cancelled", (PyCFunction)ReadyCallback_cancelled, METH_NOARGS, NULL},
+    {NULL, NULL}        /* Sentinel */
+};
+
+static PyMemberDef ReadyCallback_members[] = {
+    {"_loop", T_OBJECT, offsetof(ReadyCallbackObj, rc_loop), READONLY},
+    {"_context", T_OBJECT, offsetof(ReadyCallbackObj, rc_context), READONLY},
+    {NULL}  /* Sentinel */
+};
+
+static PyGetSetDef ReadyCallback_getsetlist[] = {
+    {"_callback", (getter)ReadyCallback_get_callback, NULL, NULL},
+    {"_args", (getter)ReadyCallback_get_args, NULL, NULL},
+    {"_cancelled", (getter)ReadyCallback_get_cancelled, NULL, NULL},
+    {NULL} /* Sentinel */
+};
+
+static PyTypeObject ReadyCallbackType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_asyncio.ReadyCallback",
+    .tp_basicsize = sizeof(ReadyCallbackObj),
+    .tp_itemsize = 0,
+    .tp_dealloc = (destructor)ReadyCallback_dealloc,
+    .tp_repr = (reprfunc)ReadyCallback_repr,
+    .tp_getattro = PyObject_GenericGetAttr,
+    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+    .tp_traverse = (traverseproc)ReadyCallback_traverse,
+    .tp_clear = (inquiry)ReadyCallback_clear,
+    .tp_methods = ReadyCallback_methods,
+    .tp_members = ReadyCallback_members,
+    .tp_getset = ReadyCallback_getsetlist,
+};
+
+
+/*********************** EpollCore **************************/
+
+#ifdef HAVE_EPOLL
+
+/*[clinic input]
+class _asyncio.EpollCore "EpollCoreObj *" "&EpollCoreType"
+[clinic start generated code]*/
+/*[clinic end generated code: output=da39a3ee5e6b4b0d input=ae267cf0b5fdb520]*/
+
+/* Smallest size of the table of handles, grown as needed to hold the
+   largest registered file descriptor. */
+#define EPOLLCORE_MIN_SIZE 64
+
+static PyObject *
+epollcore_err_closed(void)
+{
+    PyErr_SetString(PyExc_ValueError,
+                    "I/O operation on closed epoll core");
+    return NULL;
+}
+
+static void
+epollcore_clear_handles(EpollCoreObj *self)
+{
+    int fd;
+    for (fd = 0; fd < self->ec_size; fd++) {
+        Py_CLEAR(self->ec_handles[fd].reader);
+        Py_CLEAR(self->ec_handles[fd].writer);
+    }
+    self->ec_nregistered = 0;
+}
+
+static int
+epollcore_grow(EpollCoreObj *self, int fd)
+{
+    epollcore_handles *handles;
+    int size = Py_MAX(self->ec_size, EPOLLCORE_MIN_SIZE);
+
+    while (size <= fd) {
+        if (size > INT_MAX / 2) {
+            size = INT_MAX;
+            break;
+        }
+        size *= 2;
+    }
+    handles = PyMem_Resize(self->ec_handles, epollcore_handles, size);
+    if (handles == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    memset(handles + self->ec_size, 0,
+           (size - self->ec_size) * sizeof(epollcore_handles));
+    self->ec_handles = handles;
+    self->ec_size = size;
+    return 0;
+}
+
+/* Make handle (NULL to remove it) the reader or the writer of fd, updating
+   the interest list of the epoll file descriptor when the events monitored
+   change.  Return a new reference to the previous handle, or None. */
+static PyObject *
+epollcore_set_handle(EpollCoreObj *self, int fd, int writing,
+                     PyObject *handle)
+{
+    epollcore_handles *entry;
+    PyObject **slot, *other, *prev;
+    uint32_t events, new_events;
+
+    if (self->ec_epfd < 0) {
+        return epollcore_err_closed();
+    }
+    if (fd >= self->ec_size) {
+        if (handle == NULL) {
+            Py_RETURN_NONE;
+        }
+        if (epollcore_grow(self, fd) < 0) {
+            return NULL;
+        }
+    }
+
+    entry = &self->ec_handles[fd];
+    slot = writing ? &entry->writer : &entry->reader;
+    other = writing ? entry->reader : entry->writer;
+    events = (entry->reader ? EPOLLIN : 0) | (entry->writer ? EPOLLOUT : 0);
+    new_events = (other ? (writing ? EPOLLIN : EPOLLOUT) : 0) |
+                 (handle ? (writing ? EPOLLOUT : EPOLLIN) : 0);
+
+    if (new_events != events) {
+        struct epoll_event ev;
+        int op = events == 0 ? EPOLL_CTL_ADD :
+                 new_events == 0 ? EPOLL_CTL_DEL : EPOLL_CTL_MOD;
+
+        memset(&ev, 0, sizeof(ev));
+        ev.events = new_events;
+        ev.data.fd = fd;
+        if (epoll_ctl(self->ec_epfd, op, fd, &ev) < 0) {
+            /* The file descriptor may have been closed and reused since it
+               was registered, the kernel then dropped it from the interest
+               list.  Like the selectors module, ignore errors when
+               unregistering. */
+            if (op == EPOLL_CTL_MOD && errno == ENOENT) {
+                op = EPOLL_CTL_ADD;
+                if (epoll_ctl(self->ec_epfd, op, fd, &ev) < 0) {
+                    PyErr_SetFromErrno(PyExc_OSError);
+                    return NULL;
+                }
+            }
+            else if (op != EPOLL_CTL_DEL) {
+                PyErr_SetFromErrno(PyExc_OSError);
+                return NULL;
+            }
+        }
+        if (events == 0) {
+            self->ec_nregistered++;
+        }
+        else if (new_events == 0) {
+            self->ec_nregistered--;
+        }
+    }
+
+    prev = *slot;
+    Py_XINCREF(handle);
+    *slot = handle;
+    if (prev == NULL) {
+        Py_RETURN_NONE;
+    }
+    return prev;
+}
+
+/* Append the handle to the list of ready handles, or stop monitoring the
+   file descriptor if the handle was cancelled. */
+static int
+epollcore_dispatch(EpollCoreObj *self, int fd, int writing, PyObject *ready)
+{
+    _Py_IDENTIFIER(_cancelled);
+    PyObject *handle, *res;
+    int cancelled;
+
+    if (fd >= self->ec_size) {
+        return 0;
+    }
+    handle = writing ? self->ec_handles[fd].writer
+                     : self->ec_handles[fd].reader;
+    if (handle == NULL) {
+        return 0;
+    }
+
+    Py_INCREF(handle);
+    res = _PyObject_GetAttrId(handle, &PyId__cancelled);
+    if (res == NULL) {
+        Py_DECREF(handle);
+        return -1;
+    }
+    cancelled = PyObject_IsTrue(res);
+    Py_DECREF(res);
+    if (cancelled < 0) {
+        Py_DECREF(handle);
+        return -1;
+    }
+
+    if (cancelled) {
+        res = epollcore_set_handle(self, fd, writing, NULL);
+        Py_XDECREF(res);
+        Py_DECREF(handle);
+        return res == NULL ? -1 : 0;
+    }
+    cancelled = PyList_Append(ready, handle);
+    Py_DECREF(handle);
+    return cancelled;
+}
+
+/*[clinic input]
+@classmethod
+_asyncio.EpollCore.__new__ as epollcore_new
+
+Event loop core monitoring file descriptors with epoll.
+
+Each file descriptor has at most one reader and one writer handle.
+select() returns the handles of the file descriptors which are ready,
+without building a list of events and mapping it back to the handles.
+[clinic start generated code]*/
+
+static PyObject *
+epollcore_new_impl(PyTypeObject *type)
+/*[clinic end generated code: output=d1bc593d0b7bf5e2 input=ad25f94220c6910e]*/
+{
+    EpollCoreObj *self;
+
+    self = (EpollCoreObj *)type->tp_alloc(type, 0);
+    if (self == NULL) {
+        return NULL;
+    }
+#ifdef HAVE_EPOLL_CREATE1
+    self->ec_epfd = epoll_create1(EPOLL_CLOEXEC);
+#else
+    self->ec_epfd = epoll_create(FD_SETSIZE - 1);
+#endif
+    if (self->ec_epfd < 0) {
+        PyErr_SetFromErrno(PyExc_OSError);
+        Py_DECREF(self);
+        return NULL;
+    }
+#ifndef HAVE_EPOLL_CREATE1
+    if (_Py_set_inheritable(self->ec_epfd, 0, NULL) < 0) {
+        Py_DECREF(self);
+        return NULL;
+    }
+#endif
+    return (PyObject *)self;
+}
+
+/*[clinic input]
+_asyncio.EpollCore.fileno
+
+Return the epoll file descriptor.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_EpollCore_fileno_impl(EpollCoreObj *self)
+/*[clinic end generated code: output=16cdae6eb09565db input=f760f27440d3b784]*/
+{
+    if (self->ec_epfd < 0) {
+        return epollcore_err_closed();
+    }
+    return PyLong_FromLong(self->ec_epfd);
+}
+
+/*[clinic input]
+_asyncio.EpollCore.close
+
+Close the epoll file descriptor and release the handles.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_EpollCore_close_impl(EpollCoreObj *self)
+/*[clinic end generated code: output=77c0f41d093cb350 input=44db715d47a684d6]*/
+{
+    if (self->ec_epfd >= 0) {
+        int epfd = self->ec_epfd;
+        self->ec_epfd = -1;
+        epollcore_clear_handles(self);
+        if (close(epfd) < 0) {
+            PyErr_SetFromErrno(PyExc_OSError);
+            return NULL;
+        }
+    }
+    Py_RETURN_NONE;
+}
+
+/*[clinic input]
+_asyncio.EpollCore.add_reader
+
+    fd: object(converter='epollcore_fd_converter', type='int')
+    handle: object
+    /
+
+Make handle the reader of fd and return the previous reader, or None.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_EpollCore_add_reader_impl(EpollCoreObj *self, int fd,
+                                   PyObject *handle)
+/*[clinic end generated code: output=a87b1118867ad4f6 input=9ec7f94709b4db78]*/
+{
+    return epollcore_set_handle(self, fd, 0, handle);
+}
+
+/*[clinic input]
+_asyncio.EpollCore.remove_reader
+
+    fd: object(converter='epollcore_fd_converter', type='int')
+    /
+
+Stop monitoring fd for reading and return its reader, or None.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_EpollCore_remove_reader_impl(EpollCoreObj *self, int fd)
+/*[clinic end generated code: output=9e2133b1aae434ee input=02e3090c0a1ce0b1]*/
+{
+    return epollcore_set_handle(self, fd, 0, NULL);
+}
+
+/*[clinic input]
+_asyncio.EpollCore.add_writer
+
+    fd: object(converter='epollcore_fd_converter', type='int')
+    handle: object
+    /
+
+Make handle the writer of fd and return the previous writer, or None.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_EpollCore_add_writer_impl(EpollCoreObj *self, int fd,
+                                   PyObject *handle)
+/*[clinic end generated code: output=109d87571ec9d7e1 input=52018a399673b003]*/
+{
+    return epollcore_set_handle(self, fd, 1, handle);
+}
+
+/*[clinic input]
+_asyncio.EpollCore.remove_writer
+
+    fd: object(converter='epollcore_fd_converter', type='int')
+    /
+
+Stop monitoring fd for writing and return its writer, or None.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_EpollCore_remove_writer_impl(EpollCoreObj *self, int fd)
+/*[clinic end generated code: output=5a6960fb8fe6a177 input=20f281499aa6b5d1]*/
+{
+    return epollcore_set_handle(self, fd, 1, NULL);
+}
+
+/*[clinic input]
+_asyncio.EpollCore.get_key
+
+    fd: object(converter='epollcore_fd_converter', type='int')
+    /
+
+Return the selectors.SelectorKey of fd.
+
+The data of the key is the (reader, writer) pair.  Raise KeyError if fd
+is not monitored.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_EpollCore_get_key_impl(EpollCoreObj *self, int fd)
+/*[clinic end generated code: output=a998ac04308d4e54 input=11cf882def822be0]*/
+{
+    epollcore_handles *entry;
+    int events;
+
+    if (self->ec_epfd < 0) {
+        return epollcore_err_closed();
+    }
+    if (fd >= self->ec_size || (self->ec_handles[fd].reader == NULL &&
+                                self->ec_handles[fd].writer == NULL)) {
+        PyErr_Format(PyExc_KeyError, "%d is not registered", fd);
+        return NULL;
+    }
+    entry = &self->ec_handles[fd];
+    /* selectors.EVENT_READ and selectors.EVENT_WRITE */
+    events = (entry->reader ? 1 : 0) | (entry->writer ? 2 : 0);
+    return PyObject_CallFunction(selectors_SelectorKey, "iii(OO)",
+                                 fd, fd, events,
+                                 entry->reader ? entry->reader : Py_None,
+                                 entry->writer ? entry->writer : Py_None);
+}
+
+/*[clinic input]
+_asyncio.EpollCore.select
+
+    timeout as timeout_obj: object = None
+
+Wait until some file descriptors are ready, or the timeout expires.
+
+Return the list of the handles of the ready readers and writers.  The
+file descriptors of cancelled handles are no longer monitored.  The
+timeout is in seconds, None waits forever.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_EpollCore_select_impl(EpollCoreObj *self, PyObject *timeout_obj)
+/*[clinic end generated code: output=e1677ff3c5cb4496 input=f0d41e7da650b76d]*/
+{
+    struct epoll_event *evs;
+    _PyTime_t timeout, ms, deadline;
+    PyObject *ready;
+    int maxevents, nfds, i;
+
+    if (self->ec_epfd < 0) {
+        return epollcore_err_closed();
+    }
+
+    if (timeout_obj == Py_None) {
+        timeout = -1;
+        ms = -1;
+        deadline = 0;   /* initialize to prevent gcc warning */
+    }
+    else {
+        /* epoll_wait() has a resolution of 1 millisecond, round towards
+           infinity to wait at least timeout seconds. */
+        if (_PyTime_FromSecondsObject(&timeout, timeout_obj,
+                                      _PyTime_ROUND_TIMEOUT) < 0) {
+            return NULL;
+        }
+        if (timeout < 0) {
+            timeout = 0;
+        }
+        ms = _PyTime_AsMilliseconds(timeout, _PyTime_ROUND_CEILING);
+        if (ms > INT_MAX) {
+            PyErr_SetString(PyExc_OverflowError, "timeout is too large");
+            return NULL;
+        }
+        deadline = _PyTime_GetMonotonicClock() + timeout;
+    }
+
+    /* The buffer of events is kept between calls, and only grows with the
+       number of monitored file descriptors. */
+    maxevents = Py_MAX(self->ec_nregistered, 1);
+    if (maxevents > self->ec_maxevents) {
+        evs = PyMem_Resize(self->ec_events, struct epoll_event, maxevents);
+        if (evs == NULL) {
+            PyErr_NoMemory();
+            return NULL;
+        }
+        self->ec_events = evs;
+        self->ec_maxevents = maxevents;
+    }
+    evs = self->ec_events;
+
+    do {
+        Py_BEGIN_ALLOW_THREADS
+        errno = 0;
+        nfds = epoll_wait(self->ec_epfd, evs, maxevents, (int)ms);
+        Py_END_ALLOW_THREADS
+
+        if (errno != EINTR)
+            break;
+
+        /* epoll_wait() was interrupted by a signal */
+        if (PyErr_CheckSignals())
+            return NULL;
+
+        if (timeout >= 0) {
+            timeout = deadline - _PyTime_GetMonotonicClock();
+            if (timeout < 0) {
+                nfds = 0;
+                break;
+            }
+            ms = _PyTime_AsMilliseconds(timeout, _PyTime_ROUND_CEILING);
+            /* retry epoll_wait() with the recomputed timeout */
+        }
+    } while (1);
+
+    if (nfds < 0) {
+        PyErr_SetFromErrno(PyExc_OSError);
+        return NULL;
+    }
+
+    ready = PyList_New(0);
+    if (ready == NULL) {
+        return NULL;
+    }
+    /* Errors and hang-ups wake up both the reader and the writer, as with
+       selectors.EpollSelector.  The table is looked up again for each
+       handle since removing a cancelled handle may change it. */
+    for (i = 0; i < nfds; i++) {
+        int fd = evs[i].data.fd;
+        uint32_t events = evs[i].events;
+
+        if ((events & ~EPOLLOUT) &&
+                epollcore_dispatch(self, fd, 0, ready) < 0) {
+            Py_DECREF(ready);
+            return NULL;
+        }
+        if ((events & ~EPOLLIN) &&
+                epollcore_dispatch(self, fd, 1, ready) < 0) {
+            Py_DECREF(ready);
+            return NULL;
+        }
+    }
+    return ready;
+}
+
+static int
+EpollCoreObj_traverse(EpollCoreObj *self, visitproc visit, void *arg)
+{
+    int fd;
+    for (fd = 0; fd < self->ec_size; fd++) {
+        Py_VISIT(self->ec_handles[fd].reader);
+        Py_VISIT(self->ec_handles[fd].writer);
+    }
+    return 0;
+}
+
+static int
+EpollCoreObj_clear(EpollCoreObj *self)
+{
+    epollcore_clear_handles(self);
+    return 0;
+}
+
+static void
+EpollCoreObj_dealloc(EpollCoreObj *self)
+{
+    PyObject_GC_UnTrack(self);
+    if (self->ec_epfd >= 0) {
+        close(self->ec_epfd);
+    }
+    epollcore_clear_handles(self);
+    PyMem_Free(self->ec_handles);
+    PyMem_Free(self->ec_events);
+    Py_TYPE(self)->tp_free(self);
+}
+
+static PyMethodDef EpollCoreType_methods[] = {
+    _ASYNCIO_EPOLLCORE_FILENO_METHODDEF
+    _ASYNCIO_EPOLLCORE_CLOSE_METHODDEF
+    _ASYNCIO_EPOLLCORE_ADD_READER_METHODDEF
+    _ASYNCIO_EPOLLCORE_REMOVE_READER_METHODDEF
+    _ASYNCIO_EPOLLCORE_ADD_WRITER_METHODDEF
+    _ASYNCIO_EPOLLCORE_REMOVE_WRITER_METHODDEF
+    _ASYNCIO_EPOLLCORE_GET_KEY_METHODDEF
+    _ASYNCIO_EPOLLCORE_SELECT_METHODDEF
+    {NULL, NULL}        /* Sentinel */
+};
+
+static PyTypeObject EpollCoreType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_asyncio.EpollCore",
+    sizeof(EpollCoreObj),                    /* tp_basicsize */
+    .tp_dealloc = (destructor)EpollCoreObj_dealloc,
+    .tp_getattro = PyObject_GenericGetAttr,
+    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+    .tp_doc = epollcore_new__doc__,
+    .tp_traverse = (traverseproc)EpollCoreObj_traverse,
+    .tp_clear = (inquiry)EpollCoreObj_clear,
+    .tp_methods = EpollCoreType_methods,
+    .tp_new = epollcore_new,
+};
+
+#endif /* HAVE_EPOLL */
+
+
+/*********************** StreamBuffer **************************/
+
+/*[clinic input]
+class _asyncio.StreamBuffer "StreamBufferObj *" "&StreamBufferType"
+[clinic start generated code]*/
+/*[clinic end generated code: output=da39a3ee5e6b4b0d input=c8c9ba3c3dceff75]*/
+
+/* Space reserved by get_buffer() when no size is hinted. */
+#define STREAMBUFFER_RECEIVE_SIZE (64 * 1024)
+
+static char streambuffer_empty[1];
+
+static PyObject *
+streambuffer_err_exported(void)
+{
+    PyErr_SetString(PyExc_BufferError,
+                    "Existing exports of data: object cannot be re-sized");
+    return NULL;
+}
+
+/* Release the storage once all the data was consumed, so that idle streams
+   don't keep a receive buffer each. */
+static void
+streambuffer_maybe_release(StreamBufferObj *self)
+{
+    if (self->sb_start == self->sb_end && self->sb_exports == 0) {
+        PyMem_Free(self->sb_data);
+        self->sb_data = NULL;
+        self->sb_alloc = 0;
+        self->sb_start = self->sb_end = 0;
+    }
+}
+
+/* Make room for n more bytes after the data. */
+static int
+streambuffer_reserve(StreamBufferObj *self, Py_ssize_t n)
+{
+    Py_ssize_t size = self->sb_end - self->sb_start;
+    Py_ssize_t alloc;
+    char *data;
+
+    if (self->sb_alloc - self->sb_end >= n) {
+        return 0;
+    }
+    if (self->sb_exports > 0) {
+        streambuffer_err_exported();
+        return -1;
+    }
+    if (n > PY_SSIZE_T_MAX - size) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (self->sb_start >= size && self->sb_alloc - size >= n) {
+        /* Reuse the space of the consumed data.  Moving the data costs
+           less than what was consumed since the previous move. */
+        memmove(self->sb_data, self->sb_data + self->sb_start, size);
+    }
+    else {
+        alloc = size + n;
+        if (self->sb_alloc <= PY_SSIZE_T_MAX / 2) {
+            alloc = Py_MAX(alloc, self->sb_alloc * 2);
+        }
+        data = PyMem_Malloc(alloc);
+        if (data == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        if (size > 0) {
+            memcpy(data, self->sb_data + self->sb_start, size);
+        }
+        PyMem_Free(self->sb_data);
+        self->sb_data = data;
+        self->sb_alloc = alloc;
+    }
+    self->sb_start = 0;
+    self->sb_end = size;
+    return 0;
+}
+
+/*[clinic input]
+@classmethod
+_asyncio.StreamBuffer.__new__ as streambuffer_new
+
+Buffer of the data received by a StreamReader.
+
+Data is appended at the end and consumed from the front without moving
+the rest of it.  get_buffer() and buffer_updated() let a transport
+receive data directly into the buffer.  The buffer interface exposes
+the data.
+[clinic start generated code]*/
+
+static PyObject *
+streambuffer_new_impl(PyTypeObject *type)
+/*[clinic end generated code: output=648af934a7ca80a1 input=c48bbfeb6399e6ae]*/
+{
+    return type->tp_alloc(type, 0);
+}
+
+/*[clinic input]
+_asyncio.StreamBuffer.extend
+
+    data: Py_buffer
+    /
+
+Append data to the end of the buffer.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_StreamBuffer_extend_impl(StreamBufferObj *self, Py_buffer *data)
+/*[clinic end generated code: output=2c7129e21089042d input=fd67e7859d0e6760]*/
+{
+    if (self->sb_exports > 0) {
+        return streambuffer_err_exported();
+    }
+    if (data->len > 0) {
+        if (streambuffer_reserve(self, data->len) < 0) {
+            return NULL;
+        }
+        memcpy(self->sb_data + self->sb_end, data->buf, data->len);
+        self->sb_end += data->len;
+    }
+    Py_RETURN_NONE;
+}
+
+/*[clinic input]
+_asyncio.StreamBuffer.take
+
+    n: Py_ssize_t
+    /
+
+Remove and return the first n bytes, or all of them if there are fewer.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_StreamBuffer_take_impl(StreamBufferObj *self, Py_ssize_t n)
+/*[clinic end generated code: output=11abb6fd81e93352 input=23af89a93b9505bd]*/
+{
+    PyObject *res;
+
+    if (n < 0) {
+        PyErr_SetString(PyExc_ValueError, "n must be non-negative");
+        return NULL;
+    }
+    n = Py_MIN(n, self->sb_end - self->sb_start);
+    res = PyBytes_FromStringAndSize(self->sb_data + self->sb_start, n);
+    if (res == NULL) {
+        return NULL;
+    }
+    self->sb_start += n;
+    streambuffer_maybe_release(self);
+    return res;
+}
+
+/*[clinic input]
+_asyncio.StreamBuffer.clear
+
+Remove all the data.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_StreamBuffer_clear_impl(StreamBufferObj *self)
+/*[clinic end generated code: output=44696c317697feb8 input=789d6fc14715cb8a]*/
+{
+    self->sb_start = self->sb_end;
+    streambuffer_maybe_release(self);
+    Py_RETURN_NONE;
+}
+
+/*[clinic input]
+_asyncio.StreamBuffer.find -> Py_ssize_t
+
+    sub: Py_buffer
+    start: Py_ssize_t = 0
+    /
+
+Return the lowest index of sub at or after start, or -1 if not found.
+[clinic start generated code]*/
+
+static Py_ssize_t
+_asyncio_StreamBuffer_find_impl(StreamBufferObj *self, Py_buffer *sub,
+                                Py_ssize_t start)
+/*[clinic end generated code: output=a0ca23b927d02e8d input=4057ec892456a1f6]*/
+{
+    const char *data = self->sb_data + self->sb_start;
+    const char *sep = sub->buf;
+    const char *p, *last;
+    Py_ssize_t size = self->sb_end - self->sb_start;
+
+    if (start < 0) {
+        start = Py_MAX(start + size, 0);
+    }
+    if (start > size || sub->len > size - start) {
+        return -1;
+    }
+    if (sub->len == 0) {
+        return start;
+    }
+    /* memchr() is vectorized by the C library, only the candidates which
+       start with the first byte of the separator are compared. */
+    p = data + start;
+    last = data + size - sub->len;
+    while (p <= last) {
+        p = memchr(p, sep[0], last - p + 1);
+        if (p == NULL) {
+            break;
+        }
+        if (memcmp(p + 1, sep + 1, sub->len - 1) == 0) {
+            return p - data;
+        }
+        p++;
+    }
+    return -1;
+}
+
+/*[clinic input]
+_asyncio.StreamBuffer.startswith
+
+    prefix: Py_buffer
+    start: Py_ssize_t = 0
+    /
+
+Return True if the data at start begins with prefix.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_StreamBuffer_startswith_impl(StreamBufferObj *self,
+                                      Py_buffer *prefix, Py_ssize_t start)
+/*[clinic end generated code: output=9800b29237c2f5c3 input=6ccdfbe9750f339a]*/
+{
+    Py_ssize_t size = self->sb_end - self->sb_start;
+
+    if (start < 0) {
+        start = Py_MAX(start + size, 0);
+    }
+    if (start > size || prefix->len > size - start) {
+        Py_RETURN_FALSE;
+    }
+    return PyBool_FromLong(
+        memcmp(self->sb_data + self->sb_start + start, prefix->buf,
+               prefix->len) == 0);
+}
+
+/*[clinic input]
+_asyncio.StreamBuffer.get_buffer
+
+    sizehint: Py_ssize_t
+    /
+
+Return a memoryview of the free space after the data.
+
+The view holds at least sizehint bytes, or 64 KiB if sizehint is not
+positive.  Call buffer_updated() once data was written to it.  The data
+can't be extended until the view is released.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_StreamBuffer_get_buffer_impl(StreamBufferObj *self,
+                                      Py_ssize_t sizehint)
+/*[clinic end generated code: output=fdfb7e8dbbb5f6e8 input=58d70ff3f0f601b7]*/
+{
+    StreamBufferSpaceObj *space;
+    PyObject *view;
+
+    if (sizehint <= 0) {
+        sizehint = STREAMBUFFER_RECEIVE_SIZE;
+    }
+    if (streambuffer_reserve(self, sizehint) < 0) {
+        return NULL;
+    }
+    space = PyObject_New(StreamBufferSpaceObj, &StreamBufferSpaceType);
+    if (space == NULL) {
+        return NULL;
+    }
+    Py_INCREF(self);
+    space->ss_buffer = self;
+    view = PyMemoryView_FromObject((PyObject *)space);
+    Py_DECREF(space);
+    return view;
+}
+
+/*[clinic input]
+_asyncio.StreamBuffer.buffer_updated
+
+    nbytes: Py_ssize_t
+    /
+
+Append the nbytes written at the start of the free space to the data.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_StreamBuffer_buffer_updated_impl(StreamBufferObj *self,
+                                          Py_ssize_t nbytes)
+/*[clinic end generated code: output=2ae615137771e697 input=782fde27212b3c48]*/
+{
+    if (nbytes < 0 || nbytes > self->sb_alloc - self->sb_end) {
+        PyErr_SetString(PyExc_ValueError,
+                        "nbytes is larger than the free space");
+        return NULL;
+    }
+    self->sb_end += nbytes;
+    Py_RETURN_NONE;
+}
+
+static Py_ssize_t
+StreamBufferObj_length(StreamBufferObj *self)
+{
+    return self->sb_end - self->sb_start;
+}
+
+static PyObject *
+StreamBufferObj_richcompare(StreamBufferObj *self, PyObject *other, int op)
+{
+    Py_buffer view;
+    Py_ssize_t size = self->sb_end - self->sb_start;
+    int equal;
+
+    if (op != Py_EQ && op != Py_NE) {
+        Py_RETURN_NOTIMPLEMENTED;
+    }
+    if (PyObject_GetBuffer(other, &view, PyBUF_SIMPLE) != 0) {
+        PyErr_Clear();
+        Py_RETURN_NOTIMPLEMENTED;
+    }
+    equal = view.len == size &&
+            (size == 0 ||
+             memcmp(self->sb_data + self->sb_start, view.buf, size) == 0);
+    PyBuffer_Release(&view);
+    return PyBool_FromLong(equal == (op == Py_EQ));
+}
+
+static PyObject *
+StreamBufferObj_repr(StreamBufferObj *self)
+{
+    PyObject *data, *res;
+
+    data = PyBytes_FromStringAndSize(self->sb_data + self->sb_start,
+                                     self->sb_end - self->sb_start);
+    if (data == NULL) {
+        return NULL;
+    }
+    res = PyUnicode_FromFormat("%s(%R)", _PyType_Name(Py_TYPE(self)), data);
+    Py_DECREF(data);
+    return res;
+}
+
+static int
+StreamBufferObj_getbuffer(StreamBufferObj *self, Py_buffer *view, int flags)
+{
+    char *data = self->sb_data ? self->sb_data + self->sb_start
+                               : streambuffer_empty;
+
+    if (PyBuffer_FillInfo(view, (PyObject *)self, data,
+                          self->sb_end - self->sb_start, 0, flags) < 0) {
+        return -1;
+    }
+    self->sb_exports++;
+    return 0;
+}
+
+static void
+StreamBufferObj_releasebuffer(StreamBufferObj *self, Py_buffer *view)
+{
+    self->sb_exports--;
+}
+
+static void
+StreamBufferObj_dealloc(StreamBufferObj *self)
+{
+    PyMem_Free(self->sb_data);
+    Py_TYPE(self)->tp_free(self);
+}
+
+static PySequenceMethods StreamBufferType_as_sequence = {
+    .sq_length = (lenfunc)StreamBufferObj_length,
+};
+
+static PyBufferProcs StreamBufferType_as_buffer = {
+    (getbufferproc)StreamBufferObj_getbuffer,
+    (releasebufferproc)StreamBufferObj_releasebuffer,
+};
+
+static PyMethodDef StreamBufferType_methods[] = {
+    _ASYNCIO_STREAMBUFFER_EXTEND_METHODDEF
+    _ASYNCIO_STREAMBUFFER_TAKE_METHODDEF
+    _ASYNCIO_STREAMBUFFER_CLEAR_METHODDEF
+    _ASYNCIO_STREAMBUFFER_FIND_METHODDEF
+    _ASYNCIO_STREAMBUFFER_STARTSWITH_METHODDEF
+    _ASYNCIO_STREAMBUFFER_GET_BUFFER_METHODDEF
+    _ASYNCIO_STREAMBUFFER_BUFFER_UPDATED_METHODDEF
+    {NULL, NULL}        /* Sentinel */
+};
+
+static PyTypeObject StreamBufferType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_asyncio.StreamBuffer",
+    sizeof(StreamBufferObj),                 /* tp_basicsize */
+    .tp_dealloc = (destructor)StreamBufferObj_dealloc,
+    .tp_repr = (reprfunc)StreamBufferObj_repr,
+    .tp_as_sequence = &StreamBufferType_as_sequence,
+    .tp_as_buffer = &StreamBufferType_as_buffer,
+    .tp_getattro = PyObject_GenericGetAttr,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = streambuffer_new__doc__,
+    .tp_richcompare = (richcmpfunc)StreamBufferObj_richcompare,
+    .tp_methods = StreamBufferType_methods,
+    .tp_new = streambuffer_new,
+};
+
+static int
+StreamBufferSpaceObj_getbuffer(StreamBufferSpaceObj *self, Py_buffer *view,
+                               int flags)
+{
+    StreamBufferObj *buffer = self->ss_buffer;
+    char *free_space = buffer->sb_data ? buffer->sb_data + buffer->sb_end
+                                       : streambuffer_empty;
+
+    if (PyBuffer_FillInfo(view, (PyObject *)self, free_space,
+                          buffer->sb_alloc - buffer->sb_end, 0, flags) < 0) {
+        return -1;
+    }
+    /* The storage mustn't move while the free space is exported */
+    buffer->sb_exports++;
+    return 0;
+}
+
+static void
+StreamBufferSpaceObj_releasebuffer(StreamBufferSpaceObj *self,
+                                   Py_buffer *view)
+{
+    self->ss_buffer->sb_exports--;
+}
+
+static void
+StreamBufferSpaceObj_dealloc(StreamBufferSpaceObj *self)
+{
+    Py_DECREF(self->ss_buffer);
+    PyObject_Del(self);
+}
+
+static PyBufferProcs StreamBufferSpaceType_as_buffer = {
+    (getbufferproc)StreamBufferSpaceObj_getbuffer,
+    (releasebufferproc)StreamBufferSpaceObj_releasebuffer,
+};
+
+static PyTypeObject StreamBufferSpaceType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_asyncio.StreamBufferSpace",
+    sizeof(StreamBufferSpaceObj),            /* tp_basicsize */
+    .tp_dealloc = (destructor)StreamBufferSpaceObj_dealloc,
+    .tp_as_buffer = &StreamBufferSpaceType_as_buffer,
+    .tp_getattro = PyObject_GenericGetAttr,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+};
+
+
+/*********************** Functions **************************/
+
+
+/*[clinic input]
+_asyncio._get_running_loop
+
+Return the running event loop or None.
+
+This is a low-level function intended to be used by event loops.
+This function is thread-specific.
+
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio__get_running_loop_impl(PyObject *module)
+/*[clinic end generated code: output=b4390af721411a0a input=0a21627e25a4bd43]*/
+{
+    PyObject *loop;
+    if (get_running_loop(&loop)) {
+        return NULL;
+    }
+    if (loop == NULL) {
+        /* There's no currently running event loop */
+        Py_RETURN_NONE;
+    }
+    return loop;
+}
+
+/*[clinic input]
+_asyncio._set_running_loop
+    loop: 'O'
+    /
+
+Set the running event loop.
+
+This is a low-level function intended to be used by event loops.
+This function is thread-specific.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio__set_running_loop(PyObject *module, PyObject *loop)
+/*[clinic end generated code: output=ae56bf7a28ca189a input=4c9720233d606604]*/
+{
+    if (set_running_loop(loop)) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+/*[clinic input]
+_asyncio.get_event_loop
+
+Return an asyncio event loop.
+
+When called from a coroutine or a callback (e.g. scheduled with
+call_soon or similar API), this function will always return the
+running event loop.
+
+If there is no running event loop set, the function will return
+the result of `get_event_loop_policy().get_event_loop()` call.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_get_event_loop_impl(PyObject *module)
+/*[clinic end generated code: output=2a2d8b2f824c648b input=9364bf2916c8655d]*/
+{
+    return get_event_loop();
+}
+
+/*[clinic input]
+_asyncio.get_running_loop
+
+Return the running event loop.  Raise a RuntimeError if there is none.
+
+This function is thread-specific.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_get_running_loop_impl(PyObject *module)
+/*[clinic end generated code: output=c247b5f9e529530e input=2a3bf02ba39f173d]*/
+{
+    PyObject *loop;
+    if (get_running_loop(&loop)) {
+        return NULL;
+    }
+    if (loop == NULL) {
+        /* There's no currently running event loop */
+        PyErr_SetString(
+            PyExc_RuntimeError, "no running event loop");
+    }
+    return loop;
+}
+
+/*[clinic input]
+_asyncio._register_task
+
+    task: object
+
+Register a new task in asyncio as executed by loop.
+
+Returns None.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio__register_task_impl(PyObject *module, PyObject *task)
+/*[clinic end generated code: output=8672dadd69a7d4e2 input=21075aaea14dfbad]*/
+{
+    if (register_task(task) < 0) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+
+/*[clinic input]
+_asyncio._unregister_task
+
+    task: object
+
+Unregister a task.
+
+Returns None.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio__unregister_task_impl(PyObject *module, PyObject *task)
+/*[clinic end generated code: output=6e5585706d568a46 input=28fb98c3975f7bdc]*/
+{
+    if (unregister_task(task) < 0) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+
+/*[clinic input]
 _asyncio._enter_task
 
     loop: object
@@ -3146,6 +4688,26 @@ _asyncio__leave_task_impl(PyObject *module, PyObject *loop, PyObject *task)
 }
 
 
+/*[clinic input]
+_asyncio._swap_current_task
+
+    loop: object
+    task: object
+
+Make task the current task of loop and return the previous one.
+
+A task of None leaves loop without a current task.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio__swap_current_task_impl(PyObject *module, PyObject *loop,
+                                 PyObject *task)
+/*[clinic end generated code: output=9f88de958df74c7e input=9e789a26f8b16e19]*/
+{
+    return swap_current_task(loop, task);
+}
+
+
 /*********************** PyRunningLoopHolder ********************/
 
 
@@ -3207,6 +4769,18 @@ module_free_freelists(void)
     }
     assert(fi_freelist_len == 0);
     fi_freelist = NULL;
+
+    next = (PyObject*) rc_freelist;
+    while (next != NULL) {
+        assert(rc_freelist_len > 0);
+        rc_freelist_len--;
+
+        current = next;
+        next = ((ReadyCallbackObj*) current)->rc_callback;
+        PyObject_GC_Del(current);
+    }
+    assert(rc_freelist_len == 0);
+    rc_freelist = NULL;
 }
 
 
@@ -3224,6 +4798,9 @@ module_free(void *m)
     Py_CLEAR(asyncio_task_repr_info_func);
     Py_CLEAR(asyncio_InvalidStateError);
     Py_CLEAR(asyncio_CancelledError);
+    Py_CLEAR(asyncio_format_callback_source_func);
+    Py_CLEAR(collections_deque);
+    Py_CLEAR(base_events_call_soon);
 
     Py_CLEAR(all_tasks);
     Py_CLEAR(current_tasks);
@@ -3231,6 +4808,10 @@ module_free(void *m)
 
     Py_CLEAR(context_kwname);
 
+#ifdef HAVE_EPOLL
+    Py_CLEAR(selectors_SelectorKey);
+#endif
+
     module_free_freelists();
 }
 
@@ -3291,15 +4872,27 @@ module_init(void)
     GET_MOD_ATTR(asyncio_task_get_stack_func, "_task_get_stack")
     GET_MOD_ATTR(asyncio_task_print_stack_func, "_task_print_stack")
 
+    WITH_MOD("asyncio.format_helpers")
+    GET_MOD_ATTR(asyncio_format_callback_source_func,
+                 "_format_callback_source")
+
     WITH_MOD("asyncio.coroutines")
     GET_MOD_ATTR(asyncio_iscoroutine_func, "iscoroutine")
 
+    WITH_MOD("collections")
+    GET_MOD_ATTR(collections_deque, "deque")
+
     WITH_MOD("inspect")
     GET_MOD_ATTR(inspect_isgenerator, "isgenerator")
 
     WITH_MOD("traceback")
     GET_MOD_ATTR(traceback_extract_stack, "extract_stack")
 
+#ifdef HAVE_EPOLL
+    WITH_MOD("selectors")
+    GET_MOD_ATTR(selectors_SelectorKey, "SelectorKey")
+#endif
+
     PyObject *weak_set;
     WITH_MOD("weakref")
     GET_MOD_ATTR(weak_set, "WeakSet");
@@ -3332,6 +4925,7 @@ static PyMethodDef asyncio_methods[] = {
     _ASYNCIO__UNREGISTER_TASK_METHODDEF
     _ASYNCIO__ENTER_TASK_METHODDEF
     _ASYNCIO__LEAVE_TASK_METHODDEF
+    _ASYNCIO__SWAP_CURRENT_TASK_METHODDEF
     {NULL, NULL}
 };
 
@@ -3372,6 +4966,20 @@ PyInit__asyncio(void)
     if (PyType_Ready(&PyRunningLoopHolder_Type) < 0) {
         return NULL;
     }
+    if (PyType_Ready(&ReadyCallbackType) < 0) {
+        return NULL;
+    }
+    if (PyType_Ready(&StreamBufferType) < 0) {
+        return NULL;
+    }
+    if (PyType_Ready(&StreamBufferSpaceType) < 0) {
+        return NULL;
+    }
+#ifdef HAVE_EPOLL
+    if (PyType_Ready(&EpollCoreType) < 0) {
+        return NULL;
+    }
+#endif
 
     PyObject *m = PyModule_Create(&_asynciomodule);
     if (m == NULL) {
@@ -3392,6 +5000,23 @@ PyInit__asyncio(void)
         return NULL;
     }
 
+    Py_INCREF(&StreamBufferType);
+    if (PyModule_AddObject(m, "StreamBuffer",
+                           (PyObject *)&StreamBufferType) < 0) {
+        Py_DECREF(&StreamBufferType);
+        Py_DECREF(m);
+        return NULL;
+    }
+
+#ifdef HAVE_EPOLL
+    Py_INCREF(&EpollCoreType);
+    if (PyModule_AddObject(m, "EpollCore", (PyObject *)&EpollCoreType) < 0) {
+        Py_DECREF(&EpollCoreType);
+        Py_DECREF(m);
+        return NULL;
+    }
+#endif
+
     Py_INCREF(all_tasks);
     if (PyModule_AddObject(m, "_all_tasks", all_tasks) < 0) {
         Py_DECREF(all_tasks);
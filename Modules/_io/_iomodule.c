@@ -72,7 +72,8 @@ PyDoc_STRVAR(module_doc,
 "subclasses, BufferedWriter, BufferedReader, and BufferedRWPair buffer\n"
 "streams that are readable, writable, and both respectively.\n"
 "BufferedRandom provides a buffered interface to random access\n"
-"streams. BytesIO is a simple stream of in-memory bytes.\n"
+"streams. BytesIO is a simple stream of in-memory bytes. MemoryReader\n"
+"reads a bytes-like object, such as an mmap, without copying it.\n"
 "\n"
 "Another IOBase subclass, TextIOBase, deals with the encoding and decoding\n"
 "of streams into text. TextIOWrapper, which extends it, is a buffered text\n"
@@ -492,6 +493,29 @@ _io_open_impl(PyObject *module, PyObject *file, const char *mode,
     Py_XDECREF(modeobj);
     return NULL;
 }
+
+/*[clinic input]
+_io.read_batch
+    requests: object
+    /
+
+Read several ranges of bytes from files at once.
+
+requests is an iterable of (file, offset, size) tuples, where file is a
+path or a file descriptor, and a size of -1 reads up to the end of the
+file.  Return a list of the bytes read for each request, which are
+shorter than size at the end of the file.
+
+Where the platform allows it, the reads are submitted together, so that
+the storage can serve them concurrently.
+[clinic start generated code]*/
+
+static PyObject *
+_io_read_batch(PyObject *module, PyObject *requests)
+/*[clinic end generated code: output=f7ca3e60f4f3ac40 input=afb74e6d30e50c05]*/
+{
+    return _PyIO_read_batch(requests);
+}
 
 /*
  * Private helpers for the io module.
@@ -619,6 +643,7 @@ iomodule_free(PyObject *mod) {
 
 static PyMethodDef module_methods[] = {
     _IO_OPEN_METHODDEF
+    _IO_READ_BATCH_METHODDEF
     {NULL, NULL}
 };
 
@@ -693,6 +718,10 @@ PyInit__io(void)
     if (PyType_Ready(&_PyBytesIOBuffer_Type) < 0)
         goto fail;
 
+    /* MemoryReader */
+    PyMemoryReader_Type.tp_base = &PyBufferedIOBase_Type;
+    ADD_TYPE(&PyMemoryReader_Type, "MemoryReader");
+
     /* StringIO */
     PyStringIO_Type.tp_base = &PyTextIOBase_Type;
     ADD_TYPE(&PyStringIO_Type, "StringIO");
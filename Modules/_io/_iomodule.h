@@ -11,6 +11,7 @@ extern PyTypeObject PyTextIOBase_Type;
 /* Concrete classes */
 extern PyTypeObject PyFileIO_Type;
 extern PyTypeObject PyBytesIO_Type;
+extern PyTypeObject PyMemoryReader_Type;
 extern PyTypeObject PyStringIO_Type;
 extern PyTypeObject PyBufferedReader_Type;
 extern PyTypeObject PyBufferedWriter_Type;
@@ -46,6 +47,21 @@ extern int _PyIOBase_finalize(PyObject *self);
    Doesn't check the argument type, so be careful! */
 extern int _PyFileIO_closed(PyObject *self);
 
+/* Tells the kernel whether the given FileIO object is read sequentially.
+   Only a hint: errors are ignored. */
+extern void _PyFileIO_advise_sequential(PyObject *self, int sequential);
+
+#ifdef HAVE_WRITEV
+struct iovec;
+/* Writes the given buffers to the file descriptor of the given FileIO
+   object with a single writev() call, retrying on EINTR.  Returns the
+   number of bytes written, -2 if the file is non-blocking and the call
+   would block, or -1 with an exception set.
+   Doesn't check the argument type, so be careful! */
+extern Py_ssize_t _PyFileIO_writev(PyObject *self, struct iovec *iov,
+                                   int iovcnt);
+#endif
+
 /* Shortcut to the core of the IncrementalNewlineDecoder.decode method */
 extern PyObject *_PyIncrementalNewlineDecoder_decode(
     PyObject *self, PyObject *input, int final);
@@ -131,6 +147,26 @@ typedef off_t Py_off_t;
 
 extern Py_off_t PyNumber_AsOff_t(PyObject *item, PyObject *err);
 
+/* Read-ahead of sequential readers of regular files (see readahead.c).
+   The read-ahead starts at pos, with depth reads in flight; it reads at
+   explicit offsets, so the offset of the file descriptor is left alone.
+   _PyIO_ReadAhead_Read() returns the number of bytes read, 0 at the end
+   of the file, or -1 with an exception set; _PyIO_ReadAhead_Reset() moves
+   the reader to another position.  Read, Reset and Free release the GIL
+   while they change the read-ahead, so its owner must serialize all the
+   calls. */
+typedef struct _PyIO_ReadAhead _PyIO_ReadAhead;
+extern _PyIO_ReadAhead *_PyIO_ReadAhead_New(int fd, Py_off_t pos, int depth);
+extern Py_ssize_t _PyIO_ReadAhead_Read(_PyIO_ReadAhead *ra, char *buf,
+                                       Py_ssize_t size);
+extern void _PyIO_ReadAhead_Reset(_PyIO_ReadAhead *ra, Py_off_t pos);
+extern Py_off_t _PyIO_ReadAhead_Tell(_PyIO_ReadAhead *ra);
+extern const char *_PyIO_ReadAhead_Backend(_PyIO_ReadAhead *ra);
+extern void _PyIO_ReadAhead_Free(_PyIO_ReadAhead *ra);
+
+/* Implementation of _io.read_batch() */
+extern PyObject *_PyIO_read_batch(PyObject *requests);
+
 /* Implementation details */
 
 /* IO module structure */
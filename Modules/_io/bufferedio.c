@@ -13,6 +13,9 @@
 #include "structmember.h"
 #include "pythread.h"
 #include "_iomodule.h"
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
 
 /*[clinic input]
 module _io
@@ -197,6 +200,9 @@ bufferediobase_write(PyObject *self, PyObject *args)
 }
 
 
+/* Largest size the buffer of a BufferedReader grows to. */
+#define MAX_ADAPTIVE_BUFFER_SIZE (1024 * 1024)
+
 typedef struct {
     PyObject_HEAD
 
@@ -237,6 +243,21 @@ typedef struct {
     Py_ssize_t buffer_size;
     Py_ssize_t buffer_mask;
 
+    /* The read buffer grows while the raw stream is read sequentially.
+       base_buffer_size is the size given to the constructor, and
+       buffer_alloc the allocated size of the buffer. */
+    Py_ssize_t base_buffer_size;
+    Py_ssize_t buffer_alloc;
+    /* True if the buffer can grow: the object is only readable and the
+       raw stream could tell its position. */
+    int adaptive;
+    /* End of the last raw read, and number of bytes read sequentially up
+       to it (see _bufferedreader_adapt_buffer()). */
+    Py_off_t sequential_end;
+    Py_off_t sequential_bytes;
+    /* True if the raw FileIO was advised to be read sequentially. */
+    int advised;
+
     PyObject *dict;
     PyObject *weakreflist;
 } buffered;
@@ -257,6 +278,10 @@ typedef struct {
       also does it). To read it, use RAW_TELL().
     * Three helpers, _bufferedreader_raw_read, _bufferedwriter_raw_write and
       _bufferedwriter_flush_unlocked do a lot of useful housekeeping.
+    * A BufferedReader doubles its buffer, up to MAX_ADAPTIVE_BUFFER_SIZE,
+      while a seekable raw stream is read sequentially, and goes back to the
+      size it was created with after a seek.  This is only done when the
+      buffer is empty, in _bufferedreader_fill_buffer().
 
     NOTE: we should try to maintain block alignment of reads and writes to the
     raw stream (according to the buffer size), but for now it is only done
@@ -373,6 +398,23 @@ _enter_buffered_busy(buffered *self)
 #define RAW_TELL(self) \
     (self->abs_pos != -1 ? self->abs_pos : _buffered_raw_tell(self))
 
+#ifdef HAVE_WRITEV
+/* Maximum number of buffers written by a single writev() call, besides
+   the pending data of the buffer */
+#if defined(IOV_MAX) && IOV_MAX <= 64
+#define WRITEV_MAX_BUFFERS (IOV_MAX - 1)
+#else
+#define WRITEV_MAX_BUFFERS 64
+#endif
+
+/* Writers without a read buffer write to a FileIO with writev(), as long
+   as the raw stream is positioned at the start of the pending data */
+#define CAN_WRITEV(self) \
+    (!self->readable && Py_TYPE(self->raw) == &PyFileIO_Type && \
+     (!VALID_WRITE_BUFFER(self) || \
+      RAW_OFFSET(self) + (self->pos - self->write_pos) == 0))
+#endif
+
 #define MINUS_LAST_BLOCK(self, size) \
     (self->buffer_mask ? \
         (size & ~self->buffer_mask) : \
@@ -409,7 +451,7 @@ buffered_sizeof(buffered *self, void *unused)
 
     res = _PyObject_SIZE(Py_TYPE(self));
     if (self->buffer)
-        res += self->buffer_size;
+        res += self->buffer_alloc;
     return PyLong_FromSsize_t(res);
 }
 
@@ -626,6 +668,8 @@ _bufferedreader_fill_buffer(buffered *self);
 static void
 _bufferedreader_reset_buf(buffered *self);
 static void
+_bufferedreader_adapt_buffer(buffered *self);
+static void
 _bufferedwriter_reset_buf(buffered *self);
 static PyObject *
 _bufferedreader_peek_unlocked(buffered *self);
@@ -728,10 +772,24 @@ _buffered_raw_seek(buffered *self, Py_off_t target, int whence)
     return n;
 }
 
+static void
+_buffered_set_size(buffered *self, Py_ssize_t size)
+{
+    Py_ssize_t n;
+    self->buffer_size = size;
+    /* Find out whether buffer_size is a power of 2 */
+    /* XXX is this optimization useful? */
+    for (n = self->buffer_size - 1; n & 1; n >>= 1)
+        ;
+    if (n == 0)
+        self->buffer_mask = self->buffer_size - 1;
+    else
+        self->buffer_mask = 0;
+}
+
 static int
 _buffered_init(buffered *self)
 {
-    Py_ssize_t n;
     if (self->buffer_size <= 0) {
         PyErr_SetString(PyExc_ValueError,
             "buffer size must be strictly positive");
@@ -752,16 +810,16 @@ _buffered_init(buffered *self)
         return -1;
     }
     self->owner = 0;
-    /* Find out whether buffer_size is a power of 2 */
-    /* XXX is this optimization useful? */
-    for (n = self->buffer_size - 1; n & 1; n >>= 1)
-        ;
-    if (n == 0)
-        self->buffer_mask = self->buffer_size - 1;
-    else
-        self->buffer_mask = 0;
-    if (_buffered_raw_tell(self) == -1)
+    _buffered_set_size(self, self->buffer_size);
+    self->base_buffer_size = self->buffer_alloc = self->buffer_size;
+    self->sequential_end = -1;
+    self->sequential_bytes = 0;
+    self->advised = 0;
+    self->adaptive = self->readable && !self->writable;
+    if (_buffered_raw_tell(self) == -1) {
         PyErr_Clear();
+        self->adaptive = 0;
+    }
     return 0;
 }
 
@@ -946,14 +1004,32 @@ _io__Buffered_read1_impl(buffered *self, Py_ssize_t n)
         assert(res != Py_None);
         return res;
     }
-    res = PyBytes_FromStringAndSize(NULL, n);
-    if (res == NULL)
+    if (!ENTER_BUFFERED(self))
         return NULL;
-    if (!ENTER_BUFFERED(self)) {
-        Py_DECREF(res);
+    _bufferedreader_reset_buf(self);
+    _bufferedreader_adapt_buffer(self);
+    if (n < self->buffer_size && !self->writable) {
+        /* Fill the buffer, so that the next small reads are served from
+           it rather than each doing a raw read. */
+        self->pos = 0;
+        r = _bufferedreader_fill_buffer(self);
+        if (r > 0) {
+            n = Py_MIN(r, n);
+            res = PyBytes_FromStringAndSize(self->buffer, n);
+            if (res != NULL)
+                self->pos = n;
+        }
+        else if (r >= 0 || r == -2) {
+            res = PyBytes_FromStringAndSize(NULL, 0);
+        }
+        LEAVE_BUFFERED(self)
+        return res;
+    }
+    res = PyBytes_FromStringAndSize(NULL, n);
+    if (res == NULL) {
+        LEAVE_BUFFERED(self)
         return NULL;
     }
-    _bufferedreader_reset_buf(self);
     r = _bufferedreader_raw_read(self, PyBytes_AS_STRING(res), n);
     LEAVE_BUFFERED(self)
     if (r == -1) {
@@ -999,6 +1075,7 @@ _buffered_readinto_generic(buffered *self, Py_buffer *buffer, char readinto1)
     }
 
     _bufferedreader_reset_buf(self);
+    _bufferedreader_adapt_buffer(self);
     self->pos = 0;
 
     for (remaining = buffer->len - written;
@@ -1083,7 +1160,7 @@ _buffered_readline(buffered *self, Py_ssize_t limit)
     PyObject *res = NULL;
     PyObject *chunks = NULL;
     Py_ssize_t n, written = 0;
-    const char *start, *s, *end;
+    const char *start, *s;
 
     CHECK_CLOSED(self, "readline of closed file")
 
@@ -1146,16 +1223,14 @@ _buffered_readline(buffered *self, Py_ssize_t limit)
         if (limit >= 0 && n > limit)
             n = limit;
         start = self->buffer;
-        end = start + n;
-        s = start;
-        while (s < end) {
-            if (*s++ == '\n') {
-                res = PyBytes_FromStringAndSize(start, s - start);
-                if (res == NULL)
-                    goto end;
-                self->pos = s - start;
-                goto found;
-            }
+        s = memchr(start, '\n', n);
+        if (s != NULL) {
+            s++;
+            res = PyBytes_FromStringAndSize(start, s - start);
+            if (res == NULL)
+                goto end;
+            self->pos = s - start;
+            goto found;
         }
         res = PyBytes_FromStringAndSize(start, n);
         if (res == NULL)
@@ -1465,6 +1540,8 @@ _bufferedreader_raw_read(buffered *self, char *start, Py_ssize_t len)
     Py_buffer buf;
     PyObject *memobj, *res;
     Py_ssize_t n;
+    int sequential = (self->adaptive && self->abs_pos != -1 &&
+                      self->abs_pos == self->sequential_end);
     /* NOTE: the buffer needn't be released as its object is NULL. */
     if (PyBuffer_FillInfo(&buf, NULL, start, len, 0, PyBUF_CONTIG) == -1)
         return -1;
@@ -1495,11 +1572,52 @@ _bufferedreader_raw_read(buffered *self, char *start, Py_ssize_t len)
                      "(should have been between 0 and %zd)", n, len);
         return -1;
     }
-    if (n > 0 && self->abs_pos != -1)
+    if (n > 0 && self->abs_pos != -1) {
         self->abs_pos += n;
+        self->sequential_bytes = sequential ? self->sequential_bytes + n : n;
+        self->sequential_end = self->abs_pos;
+    }
     return n;
 }
 
+/* Adapt the size of the empty read buffer to the access pattern: double
+   it once two buffers' worth of data were read sequentially, and go back
+   to the initial size when the raw stream was moved since the last read. */
+static void
+_bufferedreader_adapt_buffer(buffered *self)
+{
+    Py_ssize_t size;
+
+    if (!self->adaptive || self->abs_pos == -1)
+        return;
+    if (self->abs_pos != self->sequential_end) {
+        if (self->buffer_size != self->base_buffer_size)
+            _buffered_set_size(self, self->base_buffer_size);
+        if (self->advised) {
+            _PyFileIO_advise_sequential(self->raw, 0);
+            self->advised = 0;
+        }
+        return;
+    }
+    if (self->buffer_size >= MAX_ADAPTIVE_BUFFER_SIZE ||
+        self->sequential_bytes < 2 * (Py_off_t) self->buffer_size)
+        return;
+    size = Py_MIN(2 * self->buffer_size, MAX_ADAPTIVE_BUFFER_SIZE);
+    if (size > self->buffer_alloc) {
+        char *buffer = PyMem_Realloc(self->buffer, size);
+        if (buffer == NULL)
+            return;  /* keep the current size */
+        self->buffer = buffer;
+        self->buffer_alloc = size;
+    }
+    _buffered_set_size(self, size);
+    if (size == MAX_ADAPTIVE_BUFFER_SIZE && !self->advised &&
+        Py_TYPE(self->raw) == &PyFileIO_Type) {
+        _PyFileIO_advise_sequential(self->raw, 1);
+        self->advised = 1;
+    }
+}
+
 static Py_ssize_t
 _bufferedreader_fill_buffer(buffered *self)
 {
@@ -1508,6 +1626,8 @@ _bufferedreader_fill_buffer(buffered *self)
         start = Py_SAFE_DOWNCAST(self->read_end, Py_off_t, Py_ssize_t);
     else
         start = 0;
+    if (start == 0)
+        _bufferedreader_adapt_buffer(self);
     len = self->buffer_size - start;
     n = _bufferedreader_raw_read(self, self->buffer + start, len);
     if (n <= 0)
@@ -1659,6 +1779,10 @@ _bufferedreader_read_generic(buffered *self, Py_ssize_t n)
         Py_DECREF(r);
     }
     _bufferedreader_reset_buf(self);
+    /* Adapt the size of the buffer before splitting the read between the
+       direct reads and the final block: the refill below can only grow it,
+       so the rest of the data still fits in it. */
+    _bufferedreader_adapt_buffer(self);
     while (remaining > 0) {
         /* We want to read a whole block at the end into buffer.
            If we had readv() we could do this in one pass. */
@@ -1852,6 +1976,83 @@ _bufferedwriter_raw_write(buffered *self, char *start, Py_ssize_t len)
     return n;
 }
 
+#ifdef HAVE_WRITEV
+/* Writes the pending data of the buffer followed by the given buffers with
+   writev(), without copying them.  Returns the number of bytes written from
+   the buffers once the pending data has been written, which is less than
+   their total size only if the raw stream is non-blocking; -2 if the raw
+   stream would block before all the pending data is written; -1 with an
+   exception set on error.  The caller must check CAN_WRITEV(). */
+static Py_ssize_t
+_bufferedwriter_raw_writev(buffered *self, Py_buffer *bufs, int nbufs)
+{
+    struct iovec iov[WRITEV_MAX_BUFFERS + 1];
+    Py_ssize_t pending, written = 0, offset = 0;
+    int first = 0;
+
+    assert(nbufs <= WRITEV_MAX_BUFFERS);
+    pending = 0;
+    if (VALID_WRITE_BUFFER(self))
+        pending = Py_SAFE_DOWNCAST(self->write_end - self->write_pos,
+                                   Py_off_t, Py_ssize_t);
+    for (;;) {
+        Py_ssize_t n;
+        int i, cnt = 0;
+
+        /* Skip the buffers which have been completely written */
+        while (first < nbufs && offset == bufs[first].len) {
+            first++;
+            offset = 0;
+        }
+        if (pending > 0) {
+            iov[cnt].iov_base = self->buffer + self->write_pos;
+            iov[cnt].iov_len = pending;
+            cnt++;
+        }
+        for (i = first; i < nbufs; i++) {
+            Py_ssize_t skip = (i == first) ? offset : 0;
+            iov[cnt].iov_base = (char *) bufs[i].buf + skip;
+            iov[cnt].iov_len = bufs[i].len - skip;
+            cnt++;
+        }
+        if (cnt == 0)
+            break;
+
+        n = _PyFileIO_writev(self->raw, iov, cnt);
+        if (n == -2 && pending == 0)
+            break;
+        if (n < 0)
+            return n;
+        if (n > 0 && self->abs_pos != -1)
+            self->abs_pos += n;
+        if (pending > 0) {
+            Py_ssize_t m = Py_MIN(n, pending);
+            self->write_pos += m;
+            self->raw_pos = self->write_pos;
+            pending -= m;
+            n -= m;
+        }
+        written += n;
+        while (n > 0) {
+            Py_ssize_t left = bufs[first].len - offset;
+            if (n < left) {
+                offset += n;
+                break;
+            }
+            n -= left;
+            first++;
+            offset = 0;
+        }
+        /* Partial writes can return successfully when interrupted by a
+           signal (see write(2)).  We must run signal handlers before
+           blocking another time, possibly indefinitely. */
+        if (PyErr_CheckSignals() < 0)
+            return -1;
+    }
+    return written;
+}
+#endif
+
 static PyObject *
 _bufferedwriter_flush_unlocked(buffered *self)
 {
@@ -1954,6 +2155,24 @@ _io_BufferedWriter_write_impl(buffered *self, Py_buffer *buffer)
         goto end;
     }
 
+#ifdef HAVE_WRITEV
+    /* Write the pending data along with the new data in a single writev()
+       call, instead of flushing the buffer first. */
+    if (VALID_WRITE_BUFFER(self) && CAN_WRITEV(self)) {
+        Py_ssize_t n = _bufferedwriter_raw_writev(self, buffer, 1);
+        if (n == -1)
+            goto error;
+        if (n >= 0) {
+            _bufferedwriter_reset_buf(self);
+            written = n;
+            remaining = buffer->len - n;
+            goto write_remaining;
+        }
+        /* The raw stream would block: the flush below buffers what it can
+           and raises BlockingIOError. */
+    }
+#endif
+
     /* First write the current buffer */
     res = _bufferedwriter_flush_unlocked(self);
     if (res == NULL) {
@@ -2011,6 +2230,9 @@ _io_BufferedWriter_write_impl(buffered *self, Py_buffer *buffer)
     /* Then write buf itself. At this point the buffer has been emptied. */
     remaining = buffer->len;
     written = 0;
+#ifdef HAVE_WRITEV
+write_remaining:
+#endif
     while (remaining > self->buffer_size) {
         Py_ssize_t n = _bufferedwriter_raw_write(
             self, (char *) buffer->buf + written, buffer->len - written);
@@ -2060,6 +2282,148 @@ error:
     LEAVE_BUFFERED(self)
     return res;
 }
+
+#ifdef HAVE_WRITEV
+/* Writes a batch of buffers for writelines().  If they don't fit in the
+   buffer, they are written along with the pending data with writev();
+   otherwise, or when the raw stream would block, what remains is written
+   with write(). */
+static int
+_bufferedwriter_write_batch(buffered *self, Py_buffer *bufs, int nbufs,
+                            Py_ssize_t total)
+{
+    Py_ssize_t n = 0, avail;
+    PyObject *res;
+    int i;
+
+    if (!ENTER_BUFFERED(self))
+        return -1;
+    if (IS_CLOSED(self)) {
+        PyErr_SetString(PyExc_ValueError, "write to closed file");
+        LEAVE_BUFFERED(self)
+        return -1;
+    }
+    avail = self->buffer_size;
+    if (VALID_WRITE_BUFFER(self))
+        avail -= Py_SAFE_DOWNCAST(self->pos, Py_off_t, Py_ssize_t);
+    if (total > avail && CAN_WRITEV(self)) {
+        n = _bufferedwriter_raw_writev(self, bufs, nbufs);
+        if (n == -1) {
+            LEAVE_BUFFERED(self)
+            return -1;
+        }
+        if (n >= 0)
+            _bufferedwriter_reset_buf(self);
+        else
+            n = 0;
+    }
+    LEAVE_BUFFERED(self)
+
+    for (i = 0; i < nbufs; i++) {
+        Py_buffer part = bufs[i];
+        if (n >= part.len) {
+            n -= part.len;
+            continue;
+        }
+        part.buf = (char *) part.buf + n;
+        part.len -= n;
+        n = 0;
+        res = _io_BufferedWriter_write_impl(self, &part);
+        if (res == NULL)
+            return -1;
+        Py_DECREF(res);
+    }
+    return 0;
+}
+#endif
+
+/*[clinic input]
+_io.BufferedWriter.writelines
+    lines: object
+    /
+
+Write a list of bytes-like objects to stream.
+
+The objects are written in batches.  On a file, a batch which doesn't
+fit in the buffer is written along with the buffered data by a single
+system call, without being copied into the buffer.
+[clinic start generated code]*/
+
+static PyObject *
+_io_BufferedWriter_writelines(buffered *self, PyObject *lines)
+/*[clinic end generated code: output=7566d221eb1717a5 input=0352bcddd2efdd26]*/
+{
+    PyObject *iter, *line, *res;
+
+    CHECK_INITIALIZED(self)
+    if (IS_CLOSED(self)) {
+        PyErr_SetString(PyExc_ValueError, "write to closed file");
+        return NULL;
+    }
+
+    iter = PyObject_GetIter(lines);
+    if (iter == NULL)
+        return NULL;
+
+#ifdef HAVE_WRITEV
+    /* Subclasses may override write() */
+    if (Py_TYPE(self) == &PyBufferedWriter_Type &&
+        Py_TYPE(self->raw) == &PyFileIO_Type) {
+        Py_buffer bufs[WRITEV_MAX_BUFFERS];
+        Py_ssize_t total = 0;
+        int i, nbufs = 0, done = 0;
+
+        while (!done) {
+            line = PyIter_Next(iter);
+            if (line != NULL) {
+                int r = PyObject_GetBuffer(line, &bufs[nbufs], PyBUF_SIMPLE);
+                Py_DECREF(line);
+                if (r < 0)
+                    goto batch_error;
+                total += bufs[nbufs].len;
+                if (++nbufs < WRITEV_MAX_BUFFERS)
+                    continue;
+            }
+            else if (PyErr_Occurred())
+                goto batch_error;
+            else
+                done = 1;
+            if (nbufs > 0 &&
+                _bufferedwriter_write_batch(self, bufs, nbufs, total) < 0)
+                goto batch_error;
+            for (i = 0; i < nbufs; i++)
+                PyBuffer_Release(&bufs[i]);
+            nbufs = 0;
+            total = 0;
+        }
+        Py_DECREF(iter);
+        Py_RETURN_NONE;
+
+      batch_error:
+        for (i = 0; i < nbufs; i++)
+            PyBuffer_Release(&bufs[i]);
+        Py_DECREF(iter);
+        return NULL;
+    }
+#endif
+
+    while ((line = PyIter_Next(iter)) != NULL) {
+        do {
+            res = PyObject_CallMethodObjArgs((PyObject *)self, _PyIO_str_write,
+                                             line, NULL);
+        } while (res == NULL && _PyIO_trap_eintr());
+        Py_DECREF(line);
+        if (res == NULL) {
+            Py_DECREF(iter);
+            return NULL;
+        }
+        Py_DECREF(res);
+    }
+    Py_DECREF(iter);
+    if (PyErr_Occurred())
+        return NULL;
+    Py_RETURN_NONE;
+}
 
 
 
@@ -2489,6 +2853,7 @@ static PyMethodDef bufferedwriter_methods[] = {
     {"__getstate__", (PyCFunction)buffered_getstate, METH_NOARGS},
 
     _IO_BUFFEREDWRITER_WRITE_METHODDEF
+    _IO_BUFFEREDWRITER_WRITELINES_METHODDEF
     _IO__BUFFERED_TRUNCATE_METHODDEF
     {"flush", (PyCFunction)buffered_flush, METH_NOARGS},
     _IO__BUFFERED_SEEK_METHODDEF
@@ -158,4 +158,21 @@ _io_open(PyObject *module, PyObject *const *args, Py_ssize_t nargs, PyObject *kw
 exit:
     return return_value;
 }
-/*[clinic end generated code: output=a9de1ae79c960e81 input=a9049054013a1b77]*/
+
+PyDoc_STRVAR(_io_read_batch__doc__,
+"read_batch($module, requests, /)\n"
+"--\n"
+"\n"
+"Read several ranges of bytes from files at once.\n"
+"\n"
+"requests is an iterable of (file, offset, size) tuples, where file is a\n"
+"path or a file descriptor, and a size of -1 reads up to the end of the\n"
+"file.  Return a list of the bytes read for each request, which are\n"
+"shorter than size at the end of the file.\n"
+"\n"
+"Where the platform allows it, the reads are submitted together, so that\n"
+"the storage can serve them concurrently.");
+
+#define _IO_READ_BATCH_METHODDEF    \
+    {"read_batch", (PyCFunction)_io_read_batch, METH_O, _io_read_batch__doc__},
+/*[clinic end generated code: output=82316733f8779851 input=a9049054013a1b77]*/
@@ -404,6 +404,19 @@ exit:
     return return_value;
 }
 
+PyDoc_STRVAR(_io_BufferedWriter_writelines__doc__,
+"writelines($self, lines, /)\n"
+"--\n"
+"\n"
+"Write a list of bytes-like objects to stream.\n"
+"\n"
+"The objects are written in batches.  On a file, a batch which doesn\'t\n"
+"fit in the buffer is written along with the buffered data by a single\n"
+"system call, without being copied into the buffer.");
+
+#define _IO_BUFFEREDWRITER_WRITELINES_METHODDEF    \
+    {"writelines", (PyCFunction)_io_BufferedWriter_writelines, METH_O, _io_BufferedWriter_writelines__doc__},
+
 PyDoc_STRVAR(_io_BufferedRWPair___init____doc__,
 "BufferedRWPair(reader, writer, buffer_size=DEFAULT_BUFFER_SIZE, /)\n"
 "--\n"
@@ -476,4 +489,4 @@ _io_BufferedRandom___init__(PyObject *self, PyObject *args, PyObject *kwargs)
 exit:
     return return_value;
 }
-/*[clinic end generated code: output=9a20dd4eaabb5d58 input=a9049054013a1b77]*/
+/*[clinic end generated code: output=4877062dca6039fe input=a9049054013a1b77]*/
@@ -24,7 +24,7 @@ _io_FileIO_close(fileio *self, PyObject *Py_UNUSED(ignored))
 }
 
 PyDoc_STRVAR(_io_FileIO___init____doc__,
-"FileIO(file, mode=\'r\', closefd=True, opener=None)\n"
+"FileIO(file, mode=\'r\', closefd=True, opener=None, *, readahead=0)\n"
 "--\n"
 "\n"
 "Open a file.\n"
@@ -39,28 +39,34 @@ PyDoc_STRVAR(_io_FileIO___init____doc__,
 "passing a callable as *opener*. The underlying file descriptor for the file\n"
 "object is then obtained by calling opener with (*name*, *flags*).\n"
 "*opener* must return an open file descriptor (passing os.open as *opener*\n"
-"results in functionality similar to passing None).");
+"results in functionality similar to passing None).\n"
+"\n"
+"A positive *readahead* makes a file opened for reading only, when it is a\n"
+"regular file, read up to that many chunks of 128 KiB ahead of the\n"
+"current position, with several reads in flight where the platform\n"
+"allows it.  The read-ahead stops when fileno() is called.");
 
 static int
 _io_FileIO___init___impl(fileio *self, PyObject *nameobj, const char *mode,
-                         int closefd, PyObject *opener);
+                         int closefd, PyObject *opener, int readahead);
 
 static int
 _io_FileIO___init__(PyObject *self, PyObject *args, PyObject *kwargs)
 {
     int return_value = -1;
-    static const char * const _keywords[] = {"file", "mode", "closefd", "opener", NULL};
-    static _PyArg_Parser _parser = {"O|siO:FileIO", _keywords, 0};
+    static const char * const _keywords[] = {"file", "mode", "closefd", "opener", "readahead", NULL};
+    static _PyArg_Parser _parser = {"O|siO$i:FileIO", _keywords, 0};
     PyObject *nameobj;
     const char *mode = "r";
     int closefd = 1;
     PyObject *opener = Py_None;
+    int readahead = 0;
 
     if (!_PyArg_ParseTupleAndKeywordsFast(args, kwargs, &_parser,
-        &nameobj, &mode, &closefd, &opener)) {
+        &nameobj, &mode, &closefd, &opener, &readahead)) {
         goto exit;
     }
-    return_value = _io_FileIO___init___impl((fileio *)self, nameobj, mode, closefd, opener);
+    return_value = _io_FileIO___init___impl((fileio *)self, nameobj, mode, closefd, opener, readahead);
 
 exit:
     return return_value;
@@ -373,4 +379,4 @@ _io_FileIO_isatty(fileio *self, PyObject *Py_UNUSED(ignored))
 #ifndef _IO_FILEIO_TRUNCATE_METHODDEF
     #define _IO_FILEIO_TRUNCATE_METHODDEF
 #endif /* !defined(_IO_FILEIO_TRUNCATE_METHODDEF) */
-/*[clinic end generated code: output=a8796438c8b7c49a input=a9049054013a1b77]*/
+/*[clinic end generated code: output=37e4192250ee8b4b input=a9049054013a1b77]*/
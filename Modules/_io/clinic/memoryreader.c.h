@@ -0,0 +1,359 @@
+/*[clinic input]
+preserve
+[clinic start generated code]*/
+
+PyDoc_STRVAR(_io_MemoryReader_readable__doc__,
+"readable($self, /)\n"
+"--\n"
+"\n"
+"Returns True if the IO object can be read.");
+
+#define _IO_MEMORYREADER_READABLE_METHODDEF    \
+    {"readable", (PyCFunction)_io_MemoryReader_readable, METH_NOARGS, _io_MemoryReader_readable__doc__},
+
+static PyObject *
+_io_MemoryReader_readable_impl(memoryreader *self);
+
+static PyObject *
+_io_MemoryReader_readable(memoryreader *self, PyObject *Py_UNUSED(ignored))
+{
+    return _io_MemoryReader_readable_impl(self);
+}
+
+PyDoc_STRVAR(_io_MemoryReader_writable__doc__,
+"writable($self, /)\n"
+"--\n"
+"\n"
+"Always returns False.");
+
+#define _IO_MEMORYREADER_WRITABLE_METHODDEF    \
+    {"writable", (PyCFunction)_io_MemoryReader_writable, METH_NOARGS, _io_MemoryReader_writable__doc__},
+
+static PyObject *
+_io_MemoryReader_writable_impl(memoryreader *self);
+
+static PyObject *
+_io_MemoryReader_writable(memoryreader *self, PyObject *Py_UNUSED(ignored))
+{
+    return _io_MemoryReader_writable_impl(self);
+}
+
+PyDoc_STRVAR(_io_MemoryReader_seekable__doc__,
+"seekable($self, /)\n"
+"--\n"
+"\n"
+"Returns True if the IO object can be seeked.");
+
+#define _IO_MEMORYREADER_SEEKABLE_METHODDEF    \
+    {"seekable", (PyCFunction)_io_MemoryReader_seekable, METH_NOARGS, _io_MemoryReader_seekable__doc__},
+
+static PyObject *
+_io_MemoryReader_seekable_impl(memoryreader *self);
+
+static PyObject *
+_io_MemoryReader_seekable(memoryreader *self, PyObject *Py_UNUSED(ignored))
+{
+    return _io_MemoryReader_seekable_impl(self);
+}
+
+PyDoc_STRVAR(_io_MemoryReader_tell__doc__,
+"tell($self, /)\n"
+"--\n"
+"\n"
+"Current file position, an integer.");
+
+#define _IO_MEMORYREADER_TELL_METHODDEF    \
+    {"tell", (PyCFunction)_io_MemoryReader_tell, METH_NOARGS, _io_MemoryReader_tell__doc__},
+
+static PyObject *
+_io_MemoryReader_tell_impl(memoryreader *self);
+
+static PyObject *
+_io_MemoryReader_tell(memoryreader *self, PyObject *Py_UNUSED(ignored))
+{
+    return _io_MemoryReader_tell_impl(self);
+}
+
+PyDoc_STRVAR(_io_MemoryReader_read__doc__,
+"read($self, size=-1, /)\n"
+"--\n"
+"\n"
+"Read at most size bytes.\n"
+"\n"
+"If the size argument is negative, read until EOF is reached.\n"
+"Return an empty bytes object or memoryview at EOF.");
+
+#define _IO_MEMORYREADER_READ_METHODDEF    \
+    {"read", (PyCFunction)_io_MemoryReader_read, METH_FASTCALL, _io_MemoryReader_read__doc__},
+
+static PyObject *
+_io_MemoryReader_read_impl(memoryreader *self, Py_ssize_t size);
+
+static PyObject *
+_io_MemoryReader_read(memoryreader *self, PyObject *const *args, Py_ssize_t nargs)
+{
+    PyObject *return_value = NULL;
+    Py_ssize_t size = -1;
+
+    if (!_PyArg_ParseStack(args, nargs, "|O&:read",
+        _Py_convert_optional_to_ssize_t, &size)) {
+        goto exit;
+    }
+    return_value = _io_MemoryReader_read_impl(self, size);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(_io_MemoryReader_read1__doc__,
+"read1($self, size=-1, /)\n"
+"--\n"
+"\n"
+"Read at most size bytes.\n"
+"\n"
+"If the size argument is negative or omitted, read until EOF is reached.\n"
+"Return an empty bytes object or memoryview at EOF.");
+
+#define _IO_MEMORYREADER_READ1_METHODDEF    \
+    {"read1", (PyCFunction)_io_MemoryReader_read1, METH_FASTCALL, _io_MemoryReader_read1__doc__},
+
+static PyObject *
+_io_MemoryReader_read1_impl(memoryreader *self, Py_ssize_t size);
+
+static PyObject *
+_io_MemoryReader_read1(memoryreader *self, PyObject *const *args, Py_ssize_t nargs)
+{
+    PyObject *return_value = NULL;
+    Py_ssize_t size = -1;
+
+    if (!_PyArg_ParseStack(args, nargs, "|O&:read1",
+        _Py_convert_optional_to_ssize_t, &size)) {
+        goto exit;
+    }
+    return_value = _io_MemoryReader_read1_impl(self, size);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(_io_MemoryReader_readline__doc__,
+"readline($self, size=-1, /)\n"
+"--\n"
+"\n"
+"Next line from the file.\n"
+"\n"
+"Retain newline.  A non-negative size argument limits the maximum\n"
+"number of bytes to return (an incomplete line may be returned then).\n"
+"Return an empty bytes object or memoryview at EOF.");
+
+#define _IO_MEMORYREADER_READLINE_METHODDEF    \
+    {"readline", (PyCFunction)_io_MemoryReader_readline, METH_FASTCALL, _io_MemoryReader_readline__doc__},
+
+static PyObject *
+_io_MemoryReader_readline_impl(memoryreader *self, Py_ssize_t size);
+
+static PyObject *
+_io_MemoryReader_readline(memoryreader *self, PyObject *const *args, Py_ssize_t nargs)
+{
+    PyObject *return_value = NULL;
+    Py_ssize_t size = -1;
+
+    if (!_PyArg_ParseStack(args, nargs, "|O&:readline",
+        _Py_convert_optional_to_ssize_t, &size)) {
+        goto exit;
+    }
+    return_value = _io_MemoryReader_readline_impl(self, size);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(_io_MemoryReader_readlines__doc__,
+"readlines($self, size=None, /)\n"
+"--\n"
+"\n"
+"List of lines from the file.\n"
+"\n"
+"Call readline() repeatedly and return a list of the lines so read.\n"
+"The optional size argument, if given, is an approximate bound on the\n"
+"total number of bytes in the lines returned.");
+
+#define _IO_MEMORYREADER_READLINES_METHODDEF    \
+    {"readlines", (PyCFunction)_io_MemoryReader_readlines, METH_FASTCALL, _io_MemoryReader_readlines__doc__},
+
+static PyObject *
+_io_MemoryReader_readlines_impl(memoryreader *self, PyObject *arg);
+
+static PyObject *
+_io_MemoryReader_readlines(memoryreader *self, PyObject *const *args, Py_ssize_t nargs)
+{
+    PyObject *return_value = NULL;
+    PyObject *arg = Py_None;
+
+    if (!_PyArg_UnpackStack(args, nargs, "readlines",
+        0, 1,
+        &arg)) {
+        goto exit;
+    }
+    return_value = _io_MemoryReader_readlines_impl(self, arg);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(_io_MemoryReader_readinto__doc__,
+"readinto($self, buffer, /)\n"
+"--\n"
+"\n"
+"Read bytes into buffer.\n"
+"\n"
+"Returns number of bytes read (0 for EOF).");
+
+#define _IO_MEMORYREADER_READINTO_METHODDEF    \
+    {"readinto", (PyCFunction)_io_MemoryReader_readinto, METH_O, _io_MemoryReader_readinto__doc__},
+
+static PyObject *
+_io_MemoryReader_readinto_impl(memoryreader *self, Py_buffer *buffer);
+
+static PyObject *
+_io_MemoryReader_readinto(memoryreader *self, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    Py_buffer buffer = {NULL, NULL};
+
+    if (!PyArg_Parse(arg, "w*:readinto", &buffer)) {
+        goto exit;
+    }
+    return_value = _io_MemoryReader_readinto_impl(self, &buffer);
+
+exit:
+    /* Cleanup for buffer */
+    if (buffer.obj) {
+       PyBuffer_Release(&buffer);
+    }
+
+    return return_value;
+}
+
+PyDoc_STRVAR(_io_MemoryReader_readinto1__doc__,
+"readinto1($self, buffer, /)\n"
+"--\n"
+"\n");
+
+#define _IO_MEMORYREADER_READINTO1_METHODDEF    \
+    {"readinto1", (PyCFunction)_io_MemoryReader_readinto1, METH_O, _io_MemoryReader_readinto1__doc__},
+
+static PyObject *
+_io_MemoryReader_readinto1_impl(memoryreader *self, Py_buffer *buffer);
+
+static PyObject *
+_io_MemoryReader_readinto1(memoryreader *self, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    Py_buffer buffer = {NULL, NULL};
+
+    if (!PyArg_Parse(arg, "w*:readinto1", &buffer)) {
+        goto exit;
+    }
+    return_value = _io_MemoryReader_readinto1_impl(self, &buffer);
+
+exit:
+    /* Cleanup for buffer */
+    if (buffer.obj) {
+       PyBuffer_Release(&buffer);
+    }
+
+    return return_value;
+}
+
+PyDoc_STRVAR(_io_MemoryReader_seek__doc__,
+"seek($self, pos, whence=0, /)\n"
+"--\n"
+"\n"
+"Change stream position.\n"
+"\n"
+"Seek to byte offset pos relative to position indicated by whence:\n"
+"     0  Start of stream (the default).  pos should be >= 0;\n"
+"     1  Current position - pos may be negative;\n"
+"     2  End of stream - pos usually negative.\n"
+"Returns the new absolute position.");
+
+#define _IO_MEMORYREADER_SEEK_METHODDEF    \
+    {"seek", (PyCFunction)_io_MemoryReader_seek, METH_FASTCALL, _io_MemoryReader_seek__doc__},
+
+static PyObject *
+_io_MemoryReader_seek_impl(memoryreader *self, Py_ssize_t pos, int whence);
+
+static PyObject *
+_io_MemoryReader_seek(memoryreader *self, PyObject *const *args, Py_ssize_t nargs)
+{
+    PyObject *return_value = NULL;
+    Py_ssize_t pos;
+    int whence = 0;
+
+    if (!_PyArg_ParseStack(args, nargs, "n|i:seek",
+        &pos, &whence)) {
+        goto exit;
+    }
+    return_value = _io_MemoryReader_seek_impl(self, pos, whence);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(_io_MemoryReader_close__doc__,
+"close($self, /)\n"
+"--\n"
+"\n"
+"Disable all I/O operations and release the buffer.\n"
+"\n"
+"Memoryview slices returned by the reader keep the buffer exported\n"
+"until they are released.");
+
+#define _IO_MEMORYREADER_CLOSE_METHODDEF    \
+    {"close", (PyCFunction)_io_MemoryReader_close, METH_NOARGS, _io_MemoryReader_close__doc__},
+
+static PyObject *
+_io_MemoryReader_close_impl(memoryreader *self);
+
+static PyObject *
+_io_MemoryReader_close(memoryreader *self, PyObject *Py_UNUSED(ignored))
+{
+    return _io_MemoryReader_close_impl(self);
+}
+
+PyDoc_STRVAR(_io_MemoryReader___init____doc__,
+"MemoryReader(buffer, *, views=False)\n"
+"--\n"
+"\n"
+"Buffered I/O implementation reading from a bytes-like object.\n"
+"\n"
+"The buffer is not copied, so that an mmap can be read without loading\n"
+"it into memory first.  Reads copy straight from it, or return read-only\n"
+"memoryview slices of it if views is true.  Views save copying large\n"
+"reads, but short lines are cheaper as bytes.  The buffer stays exported\n"
+"until the reader is closed and the slices are released.");
+
+static int
+_io_MemoryReader___init___impl(memoryreader *self, PyObject *buffer,
+                               int views);
+
+static int
+_io_MemoryReader___init__(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    int return_value = -1;
+    static const char * const _keywords[] = {"buffer", "views", NULL};
+    static _PyArg_Parser _parser = {"O|$p:MemoryReader", _keywords, 0};
+    PyObject *buffer;
+    int views = 0;
+
+    if (!_PyArg_ParseTupleAndKeywordsFast(args, kwargs, &_parser,
+        &buffer, &views)) {
+        goto exit;
+    }
+    return_value = _io_MemoryReader___init___impl((memoryreader *)self, buffer, views);
+
+exit:
+    return return_value;
+}
+/*[clinic end generated code: output=5bfd6db7abd31f38 input=a9049054013a1b77]*/
@@ -16,7 +16,11 @@
 #ifdef HAVE_FCNTL_H
 #include <fcntl.h>
 #endif
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
 #include <stddef.h> /* For offsetof */
+#include "pythread.h"
 #include "_iomodule.h"
 
 /*
@@ -64,6 +68,9 @@ typedef struct {
     unsigned int closefd : 1;
     char finalizing;
     unsigned int blksize;
+    _PyIO_ReadAhead *readahead;
+    PyThread_type_lock readahead_lock;
+    unsigned long readahead_owner;
     PyObject *weakreflist;
     PyObject *dict;
 } fileio;
@@ -83,6 +90,17 @@ _PyFileIO_closed(PyObject *self)
     return ((fileio *)self)->fd < 0;
 }
 
+void
+_PyFileIO_advise_sequential(PyObject *self, int sequential)
+{
+#ifdef HAVE_POSIX_FADVISE
+    int fd = ((fileio *)self)->fd;
+    if (fd >= 0)
+        (void) posix_fadvise(fd, 0, 0, sequential ? POSIX_FADV_SEQUENTIAL
+                                                  : POSIX_FADV_NORMAL);
+#endif
+}
+
 /* Because this can call arbitrary code, it shouldn't be called when
    the refcount is 0 (that is, not directly from tp_dealloc unless
    the refcount has been temporarily re-incremented). */
@@ -102,12 +120,147 @@ fileio_dealloc_warn(fileio *self, PyObject *source)
     Py_RETURN_NONE;
 }
 
+/* The read-ahead changes its state without the GIL, so these macros
+   serialize its users, and keep it from being freed during a read.  Since
+   the lock is released without the GIL, self->readahead must be checked
+   again once it is taken. */
+
+static int
+_enter_readahead_busy(fileio *self)
+{
+    int relax_locking;
+    PyLockStatus st;
+    if (self->readahead_owner == PyThread_get_thread_ident()) {
+        PyErr_Format(PyExc_RuntimeError,
+                     "reentrant call inside %R", self);
+        return 0;
+    }
+    relax_locking = _Py_IsFinalizing();
+    Py_BEGIN_ALLOW_THREADS
+    if (!relax_locking)
+        st = PyThread_acquire_lock(self->readahead_lock, 1);
+    else {
+        /* A daemon thread may have been shut down during a read, see
+           _enter_buffered_busy() */
+        st = PyThread_acquire_lock_timed(self->readahead_lock,
+                                         (PY_TIMEOUT_T)1e6, 0);
+    }
+    Py_END_ALLOW_THREADS
+    if (st != PY_LOCK_ACQUIRED) {
+        PyErr_Format(PyExc_RuntimeError,
+                     "could not acquire the read-ahead lock for %R at "
+                     "interpreter shutdown, possibly due to daemon threads",
+                     self);
+        return 0;
+    }
+    return 1;
+}
+
+#define ENTER_READAHEAD(self) \
+    ( (PyThread_acquire_lock(self->readahead_lock, 0) ? \
+       1 : _enter_readahead_busy(self)) \
+     && (self->readahead_owner = PyThread_get_thread_ident(), 1) )
+
+#define LEAVE_READAHEAD(self) \
+    do { \
+        self->readahead_owner = 0; \
+        PyThread_release_lock(self->readahead_lock); \
+    } while(0);
+
+/* Returns 0 on success, -1 with exception set on failure, in which case
+   the read-ahead is left in place. */
+static int
+readahead_free(fileio *self)
+{
+    _PyIO_ReadAhead *ra;
+
+    if (self->readahead == NULL)
+        return 0;
+    if (!ENTER_READAHEAD(self))
+        return -1;
+    ra = self->readahead;
+    self->readahead = NULL;
+    LEAVE_READAHEAD(self);
+    if (ra != NULL)
+        _PyIO_ReadAhead_Free(ra);
+    return 0;
+}
+
+/* Read with the read-ahead.  Returns 1 and sets *n to the result of
+   _PyIO_ReadAhead_Read() if the file has a read-ahead, 0 otherwise. */
+static int
+readahead_read(fileio *self, char *buf, Py_ssize_t size, Py_ssize_t *n)
+{
+    if (self->readahead == NULL)
+        return 0;
+    if (!ENTER_READAHEAD(self)) {
+        *n = -1;
+        return 1;
+    }
+    if (self->readahead == NULL) {
+        LEAVE_READAHEAD(self);
+        return 0;
+    }
+    *n = _PyIO_ReadAhead_Read(self->readahead, buf, size);
+    LEAVE_READAHEAD(self);
+    return 1;
+}
+
+/* Move the read-ahead to pos.  Returns 0 on success, -1 with exception set
+   on failure. */
+static int
+readahead_reset(fileio *self, Py_off_t pos)
+{
+    if (self->readahead == NULL)
+        return 0;
+    if (!ENTER_READAHEAD(self))
+        return -1;
+    if (self->readahead != NULL)
+        _PyIO_ReadAhead_Reset(self->readahead, pos);
+    LEAVE_READAHEAD(self);
+    return 0;
+}
+
+/* Move the offset of the file descriptor to the position of the
+   read-ahead, which reads at explicit offsets.  Returns 0 on success, -1
+   with exception set on failure. */
+static int
+readahead_sync(fileio *self)
+{
+    Py_off_t pos, res;
+
+    if (self->readahead == NULL)
+        return 0;
+    if (!ENTER_READAHEAD(self))
+        return -1;
+    if (self->readahead == NULL) {
+        LEAVE_READAHEAD(self);
+        return 0;
+    }
+    pos = _PyIO_ReadAhead_Tell(self->readahead);
+    LEAVE_READAHEAD(self);
+    _Py_BEGIN_SUPPRESS_IPH
+#ifdef MS_WINDOWS
+    res = _lseeki64(self->fd, pos, SEEK_SET);
+#else
+    res = lseek(self->fd, pos, SEEK_SET);
+#endif
+    _Py_END_SUPPRESS_IPH
+    if (res < 0) {
+        PyErr_SetFromErrno(PyExc_OSError);
+        return -1;
+    }
+    return 0;
+}
+
 /* Returns 0 on success, -1 with exception set on failure. */
 static int
 internal_close(fileio *self)
 {
     int err = 0;
     int save_errno = 0;
+    if (readahead_free(self) < 0)
+        return -1;
     if (self->fd >= 0) {
         int fd = self->fd;
         self->fd = -1;
@@ -148,6 +301,12 @@ _io_FileIO_close_impl(fileio *self)
     res = _PyObject_CallMethodIdObjArgs((PyObject*)&PyRawIOBase_Type,
                                         &PyId_close, self, NULL);
     if (!self->closefd) {
+        if (self->fd >= 0 && readahead_sync(self) < 0)
+            PyErr_Clear();
+        if (readahead_free(self) < 0) {
+            Py_XDECREF(res);
+            return NULL;
+        }
         self->fd = -1;
         return res;
     }
@@ -185,6 +344,9 @@ fileio_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
         self->seekable = -1;
         self->blksize = 0;
         self->closefd = 1;
+        self->readahead = NULL;
+        self->readahead_lock = NULL;
+        self->readahead_owner = 0;
         self->weakreflist = NULL;
     }
 
@@ -201,6 +363,8 @@ _io.FileIO.__init__
     mode: str = "r"
     closefd: bool(accept={int}) = True
     opener: object = None
+    *
+    readahead: int = 0
 
 Open a file.
 
@@ -215,12 +379,17 @@ passing a callable as *opener*. The underlying file descriptor for the file
 object is then obtained by calling opener with (*name*, *flags*).
 *opener* must return an open file descriptor (passing os.open as *opener*
 results in functionality similar to passing None).
+
+A positive *readahead* makes a file opened for reading only, when it is a
+regular file, read up to that many chunks of 128 KiB ahead of the
+current position, with several reads in flight where the platform
+allows it.  The read-ahead stops when fileno() is called.
 [clinic start generated code]*/
 
 static int
 _io_FileIO___init___impl(fileio *self, PyObject *nameobj, const char *mode,
-                         int closefd, PyObject *opener)
-/*[clinic end generated code: output=23413f68e6484bbd input=1596c9157a042a39]*/
+                         int closefd, PyObject *opener, int readahead)
+/*[clinic end generated code: output=9348b8ea5521c575 input=e816108c1a46454f]*/
 {
 #ifdef MS_WINDOWS
     Py_UNICODE *widename = NULL;
@@ -250,8 +419,16 @@ _io_FileIO___init___impl(fileio *self, PyObject *nameobj, const char *mode,
             if (internal_close(self) < 0)
                 return -1;
         }
-        else
+        else {
+            if (readahead_free(self) < 0)
+                return -1;
             self->fd = -1;
+        }
+    }
+
+    if (readahead < 0) {
+        PyErr_SetString(PyExc_ValueError, "readahead must not be negative");
+        return -1;
     }
 
     if (PyFloat_Check(nameobj)) {
@@ -462,6 +639,34 @@ _io_FileIO___init___impl(fileio *self, PyObject *nameobj, const char *mode,
         if (fdfstat.st_blksize > 1)
             self->blksize = fdfstat.st_blksize;
 #endif /* HAVE_STRUCT_STAT_ST_BLKSIZE */
+#ifdef S_ISREG
+        if (readahead > 0 && self->readable && !self->writable &&
+            S_ISREG(fdfstat.st_mode))
+        {
+            Py_off_t pos;
+            _Py_BEGIN_SUPPRESS_IPH
+#ifdef MS_WINDOWS
+            pos = _lseeki64(self->fd, 0L, SEEK_CUR);
+#else
+            pos = lseek(self->fd, 0L, SEEK_CUR);
+#endif
+            _Py_END_SUPPRESS_IPH
+            if (pos >= 0 && self->readahead_lock == NULL) {
+                self->readahead_lock = PyThread_allocate_lock();
+                if (self->readahead_lock == NULL) {
+                    PyErr_SetString(PyExc_RuntimeError,
+                                    "can't allocate read-ahead lock");
+                    goto error;
+                }
+            }
+            if (pos >= 0) {
+                self->readahead = _PyIO_ReadAhead_New(self->fd, pos,
+                                                      readahead);
+                if (self->readahead == NULL)
+                    goto error;
+            }
+        }
+#endif /* S_ISREG */
     }
 
 #if defined(MS_WINDOWS) || defined(__CYGWIN__)
@@ -517,6 +722,12 @@ fileio_dealloc(fileio *self)
     if (_PyIOBase_finalize((PyObject *) self) < 0)
         return;
     _PyObject_GC_UNTRACK(self);
+    if (readahead_free(self) < 0) {
+        /* still used by a daemon thread at shutdown, so leaked */
+        PyErr_Clear();
+    }
+    else if (self->readahead_lock != NULL)
+        PyThread_free_lock(self->readahead_lock);
     if (self->weakreflist != NULL)
         PyObject_ClearWeakRefs((PyObject *) self);
     Py_CLEAR(self->dict);
@@ -552,6 +763,10 @@ _io_FileIO_fileno_impl(fileio *self)
 {
     if (self->fd < 0)
         return err_closed();
+    /* the caller may use the file descriptor directly from now on, which
+       the read-ahead would not notice */
+    if (readahead_sync(self) < 0 || readahead_free(self) < 0)
+        return NULL;
     return PyLong_FromLong((long) self->fd);
 }
 
@@ -631,6 +846,12 @@ _io_FileIO_readinto_impl(fileio *self, Py_buffer *buffer)
     if (!self->readable)
         return err_mode("reading");
 
+    if (readahead_read(self, buffer->buf, buffer->len, &n)) {
+        if (n < 0)
+            return NULL;
+        return PyLong_FromSsize_t(n);
+    }
+
     n = _Py_read(self->fd, buffer->buf, buffer->len);
     /* copy errno because PyBuffer_Release() can indirectly modify it */
     err = errno;
@@ -688,6 +909,8 @@ _io_FileIO_readall_impl(fileio *self)
 
     if (self->fd < 0)
         return err_closed();
+    if (readahead_sync(self) < 0)
+        return NULL;
 
     Py_BEGIN_ALLOW_THREADS
     _Py_BEGIN_SUPPRESS_IPH
@@ -761,6 +984,10 @@ _io_FileIO_readall_impl(fileio *self)
         if (_PyBytes_Resize(&result, bytes_read) < 0)
             return NULL;
     }
+    if (pos >= 0 && readahead_reset(self, pos) < 0) {
+        Py_DECREF(result);
+        return NULL;
+    }
     return result;
 }
 
@@ -801,7 +1028,8 @@ _io_FileIO_read_impl(fileio *self, Py_ssize_t size)
         return NULL;
     ptr = PyBytes_AS_STRING(bytes);
 
-    n = _Py_read(self->fd, ptr, size);
+    if (!readahead_read(self, ptr, size, &n))
+        n = _Py_read(self->fd, ptr, size);
     if (n == -1) {
         /* copy errno because Py_DECREF() can indirectly modify it */
         int err = errno;
@@ -862,6 +1090,48 @@ _io_FileIO_write_impl(fileio *self, Py_buffer *b)
     return PyLong_FromSsize_t(n);
 }
 
+#ifdef HAVE_WRITEV
+Py_ssize_t
+_PyFileIO_writev(PyObject *self, struct iovec *iov, int iovcnt)
+{
+    fileio *f = (fileio *)self;
+    Py_ssize_t n;
+    int err;
+    int async_err = 0;
+
+    if (f->fd < 0) {
+        err_closed();
+        return -1;
+    }
+    if (!f->writable) {
+        err_mode("writing");
+        return -1;
+    }
+
+    do {
+        Py_BEGIN_ALLOW_THREADS
+        errno = 0;
+        n = writev(f->fd, iov, iovcnt);
+        /* save/restore errno because PyErr_CheckSignals()
+         * and PyErr_SetFromErrno() can modify it */
+        err = errno;
+        Py_END_ALLOW_THREADS
+    } while (n < 0 && err == EINTR &&
+             !(async_err = PyErr_CheckSignals()));
+
+    if (async_err)
+        return -1;
+    if (n < 0) {
+        if (err == EAGAIN)
+            return -2;
+        errno = err;
+        PyErr_SetFromErrno(PyExc_OSError);
+        return -1;
+    }
+    return n;
+}
+#endif
+
 /* XXX Windows support below is likely incomplete */
 
 /* Cribbed from posix_lseek() */
@@ -903,6 +1173,9 @@ portable_lseek(fileio *self, PyObject *posobj, int whence, bool suppress_pipe_er
             return NULL;
     }
 
+    if (readahead_sync(self) < 0)
+        return NULL;
+
     Py_BEGIN_ALLOW_THREADS
     _Py_BEGIN_SUPPRESS_IPH
 #ifdef MS_WINDOWS
@@ -924,6 +1197,9 @@ portable_lseek(fileio *self, PyObject *posobj, int whence, bool suppress_pipe_er
             return PyErr_SetFromErrno(PyExc_OSError);
         }
     }
+    else if (readahead_reset(self, res) < 0) {
+        return NULL;
+    }
 
 #if defined(HAVE_LARGEFILE_SUPPORT)
     return PyLong_FromLongLong(res);
@@ -1175,11 +1451,29 @@ get_mode(fileio *self, void *closure)
     return PyUnicode_FromString(mode_string(self));
 }
 
+static PyObject *
+get_readahead(fileio *self, void *closure)
+{
+    const char *backend = NULL;
+
+    if (self->readahead == NULL)
+        Py_RETURN_NONE;
+    if (!ENTER_READAHEAD(self))
+        return NULL;
+    if (self->readahead != NULL)
+        backend = _PyIO_ReadAhead_Backend(self->readahead);
+    LEAVE_READAHEAD(self);
+    if (backend == NULL)
+        Py_RETURN_NONE;
+    return PyUnicode_FromString(backend);
+}
+
 static PyGetSetDef fileio_getsetlist[] = {
     {"closed", (getter)get_closed, NULL, "True if the file is closed"},
     {"closefd", (getter)get_closefd, NULL,
         "True if the file descriptor will be closed by close()."},
     {"mode", (getter)get_mode, NULL, "String giving the file mode"},
+    {"_readahead", (getter)get_readahead, NULL, NULL},
     {NULL},
 };
 
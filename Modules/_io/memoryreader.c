@@ -0,0 +1,558 @@
+#include "Python.h"
+#include "structmember.h"       /* for offsetof() */
+#include "_iomodule.h"
+
+/*[clinic input]
+module _io
+class _io.MemoryReader "memoryreader *" "&PyMemoryReader_Type"
+[clinic start generated code]*/
+/*[clinic end generated code: output=da39a3ee5e6b4b0d input=44ce28f51774dd73]*/
+
+/* A read-only stream over an object supporting the buffer protocol, such
+   as an mmap.  Unlike BytesIO, it does not copy the buffer: the results
+   are copied straight from it, or are read-only memoryview slices of it. */
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *view;     /* contiguous memoryview of unsigned bytes, or NULL
+                           once closed */
+    const char *data;
+    Py_ssize_t size;
+    Py_ssize_t pos;
+    int views;          /* return memoryview slices instead of bytes */
+    PyObject *dict;
+    PyObject *weakreflist;
+} memoryreader;
+
+#define CHECK_CLOSED(self)                                  \
+    if ((self)->view == NULL) {                             \
+        PyErr_SetString(PyExc_ValueError,                   \
+                        "I/O operation on closed file.");   \
+        return NULL;                                        \
+    }
+
+
+/* Internal routine returning the length between the current position and
+   the end of the line, limited to len bytes if len is not negative. */
+static Py_ssize_t
+scan_eol(memoryreader *self, Py_ssize_t len)
+{
+    const char *start, *n;
+    Py_ssize_t maxlen;
+
+    if (self->pos >= self->size)
+        return 0;
+
+    maxlen = self->size - self->pos;
+    if (len < 0 || len > maxlen)
+        len = maxlen;
+
+    if (len) {
+        start = self->data + self->pos;
+        n = memchr(start, '\n', len);
+        if (n)
+            len = n - start + 1;
+    }
+    return len;
+}
+
+/* Return the next size bytes, as bytes or as a memoryview slice, and
+   advance the position. */
+static PyObject *
+read_bytes(memoryreader *self, Py_ssize_t size)
+{
+    PyObject *result;
+
+    /* The position may be past the end, then size is 0 */
+    assert(size >= 0);
+    assert(size == 0 || size <= self->size - self->pos);
+    if (self->views)
+        result = PySequence_GetSlice(self->view, self->pos, self->pos + size);
+    else
+        result = PyBytes_FromStringAndSize(self->data + self->pos, size);
+    if (result != NULL)
+        self->pos += size;
+    return result;
+}
+
+static PyObject *
+memoryreader_get_closed(memoryreader *self, void *Py_UNUSED(ignored))
+{
+    return PyBool_FromLong(self->view == NULL);
+}
+
+/*[clinic input]
+_io.MemoryReader.readable
+
+Returns True if the IO object can be read.
+[clinic start generated code]*/
+
+static PyObject *
+_io_MemoryReader_readable_impl(memoryreader *self)
+/*[clinic end generated code: output=450225487f2b81bf input=06902bcafc6786c3]*/
+{
+    CHECK_CLOSED(self);
+    Py_RETURN_TRUE;
+}
+
+/*[clinic input]
+_io.MemoryReader.writable
+
+Always returns False.
+[clinic start generated code]*/
+
+static PyObject *
+_io_MemoryReader_writable_impl(memoryreader *self)
+/*[clinic end generated code: output=8c4beb27d8d0735b input=829fb7b2817dd948]*/
+{
+    CHECK_CLOSED(self);
+    Py_RETURN_FALSE;
+}
+
+/*[clinic input]
+_io.MemoryReader.seekable
+
+Returns True if the IO object can be seeked.
+[clinic start generated code]*/
+
+static PyObject *
+_io_MemoryReader_seekable_impl(memoryreader *self)
+/*[clinic end generated code: output=f6dcf7da3faf5df0 input=08bdf4fc9f3ece6b]*/
+{
+    CHECK_CLOSED(self);
+    Py_RETURN_TRUE;
+}
+
+/*[clinic input]
+_io.MemoryReader.tell
+
+Current file position, an integer.
+[clinic start generated code]*/
+
+static PyObject *
+_io_MemoryReader_tell_impl(memoryreader *self)
+/*[clinic end generated code: output=c48f4f46f71a4330 input=a3b0d1d203e8890a]*/
+{
+    CHECK_CLOSED(self);
+    return PyLong_FromSsize_t(self->pos);
+}
+
+/*[clinic input]
+_io.MemoryReader.read
+    size: Py_ssize_t(accept={int, NoneType}) = -1
+    /
+
+Read at most size bytes.
+
+If the size argument is negative, read until EOF is reached.
+Return an empty bytes object or memoryview at EOF.
+[clinic start generated code]*/
+
+static PyObject *
+_io_MemoryReader_read_impl(memoryreader *self, Py_ssize_t size)
+/*[clinic end generated code: output=7b97c323c955130a input=db72d09c83cadcb3]*/
+{
+    Py_ssize_t n;
+
+    CHECK_CLOSED(self);
+
+    /* adjust invalid sizes */
+    n = self->size - self->pos;
+    if (size < 0 || size > n) {
+        size = n;
+        if (size < 0)
+            size = 0;
+    }
+
+    return read_bytes(self, size);
+}
+
+/*[clinic input]
+_io.MemoryReader.read1
+    size: Py_ssize_t(accept={int, NoneType}) = -1
+    /
+
+Read at most size bytes.
+
+If the size argument is negative or omitted, read until EOF is reached.
+Return an empty bytes object or memoryview at EOF.
+[clinic start generated code]*/
+
+static PyObject *
+_io_MemoryReader_read1_impl(memoryreader *self, Py_ssize_t size)
+/*[clinic end generated code: output=76b9e399ca9d4d68 input=aa9cf0c9edfabe6b]*/
+{
+    return _io_MemoryReader_read_impl(self, size);
+}
+
+/*[clinic input]
+_io.MemoryReader.readline
+    size: Py_ssize_t(accept={int, NoneType}) = -1
+    /
+
+Next line from the file.
+
+Retain newline.  A non-negative size argument limits the maximum
+number of bytes to return (an incomplete line may be returned then).
+Return an empty bytes object or memoryview at EOF.
+[clinic start generated code]*/
+
+static PyObject *
+_io_MemoryReader_readline_impl(memoryreader *self, Py_ssize_t size)
+/*[clinic end generated code: output=c9974af84ff1f264 input=3654fb82b2e8e7d2]*/
+{
+    CHECK_CLOSED(self);
+    return read_bytes(self, scan_eol(self, size));
+}
+
+/*[clinic input]
+_io.MemoryReader.readlines
+    size as arg: object = None
+    /
+
+List of lines from the file.
+
+Call readline() repeatedly and return a list of the lines so read.
+The optional size argument, if given, is an approximate bound on the
+total number of bytes in the lines returned.
+[clinic start generated code]*/
+
+static PyObject *
+_io_MemoryReader_readlines_impl(memoryreader *self, PyObject *arg)
+/*[clinic end generated code: output=cb862664cbb5af0b input=9bc71f78f3c4c09a]*/
+{
+    Py_ssize_t maxsize, size, n;
+    PyObject *result, *line;
+
+    CHECK_CLOSED(self);
+
+    if (PyLong_Check(arg)) {
+        maxsize = PyLong_AsSsize_t(arg);
+        if (maxsize == -1 && PyErr_Occurred())
+            return NULL;
+    }
+    else if (arg == Py_None) {
+        /* No size limit, by default. */
+        maxsize = -1;
+    }
+    else {
+        PyErr_Format(PyExc_TypeError, "integer argument expected, got '%s'",
+                     Py_TYPE(arg)->tp_name);
+        return NULL;
+    }
+
+    size = 0;
+    result = PyList_New(0);
+    if (!result)
+        return NULL;
+
+    while ((n = scan_eol(self, -1)) != 0) {
+        line = read_bytes(self, n);
+        if (!line)
+            goto on_error;
+        if (PyList_Append(result, line) == -1) {
+            Py_DECREF(line);
+            goto on_error;
+        }
+        Py_DECREF(line);
+        size += n;
+        if (maxsize > 0 && size >= maxsize)
+            break;
+    }
+    return result;
+
+  on_error:
+    Py_DECREF(result);
+    return NULL;
+}
+
+/*[clinic input]
+_io.MemoryReader.readinto
+    buffer: Py_buffer(accept={rwbuffer})
+    /
+
+Read bytes into buffer.
+
+Returns number of bytes read (0 for EOF).
+[clinic start generated code]*/
+
+static PyObject *
+_io_MemoryReader_readinto_impl(memoryreader *self, Py_buffer *buffer)
+/*[clinic end generated code: output=2c1110e6596a58df input=af90e60ec00d63c6]*/
+{
+    Py_ssize_t len, n;
+
+    CHECK_CLOSED(self);
+
+    /* adjust invalid sizes */
+    len = buffer->len;
+    n = self->size - self->pos;
+    if (len > n) {
+        len = n;
+        if (len < 0)
+            len = 0;
+    }
+
+    memcpy(buffer->buf, self->data + self->pos, len);
+    self->pos += len;
+
+    return PyLong_FromSsize_t(len);
+}
+
+/*[clinic input]
+_io.MemoryReader.readinto1 = _io.MemoryReader.readinto
+[clinic start generated code]*/
+
+static PyObject *
+_io_MemoryReader_readinto1_impl(memoryreader *self, Py_buffer *buffer)
+/*[clinic end generated code: output=b8898110d0dd9679 input=c738906ae334ed4f]*/
+{
+    return _io_MemoryReader_readinto_impl(self, buffer);
+}
+
+static PyObject *
+memoryreader_iternext(memoryreader *self)
+{
+    Py_ssize_t n;
+
+    CHECK_CLOSED(self);
+
+    n = scan_eol(self, -1);
+
+    if (n == 0)
+        return NULL;
+
+    return read_bytes(self, n);
+}
+
+/*[clinic input]
+_io.MemoryReader.seek
+    pos: Py_ssize_t
+    whence: int = 0
+    /
+
+Change stream position.
+
+Seek to byte offset pos relative to position indicated by whence:
+     0  Start of stream (the default).  pos should be >= 0;
+     1  Current position - pos may be negative;
+     2  End of stream - pos usually negative.
+Returns the new absolute position.
+[clinic start generated code]*/
+
+static PyObject *
+_io_MemoryReader_seek_impl(memoryreader *self, Py_ssize_t pos, int whence)
+/*[clinic end generated code: output=3ec5c15cf9f35730 input=328bbb4dc456a344]*/
+{
+    CHECK_CLOSED(self);
+
+    if (pos < 0 && whence == 0) {
+        PyErr_Format(PyExc_ValueError,
+                     "negative seek value %zd", pos);
+        return NULL;
+    }
+
+    if (whence == 1) {
+        if (pos > PY_SSIZE_T_MAX - self->pos) {
+            PyErr_SetString(PyExc_OverflowError,
+                            "new position too large");
+            return NULL;
+        }
+        pos += self->pos;
+    }
+    else if (whence == 2) {
+        if (pos > PY_SSIZE_T_MAX - self->size) {
+            PyErr_SetString(PyExc_OverflowError,
+                            "new position too large");
+            return NULL;
+        }
+        pos += self->size;
+    }
+    else if (whence != 0) {
+        PyErr_Format(PyExc_ValueError,
+                     "invalid whence (%i, should be 0, 1 or 2)", whence);
+        return NULL;
+    }
+
+    if (pos < 0)
+        pos = 0;
+    self->pos = pos;
+
+    return PyLong_FromSsize_t(self->pos);
+}
+
+/*[clinic input]
+_io.MemoryReader.close
+
+Disable all I/O operations and release the buffer.
+
+Memoryview slices returned by the reader keep the buffer exported
+until they are released.
+[clinic start generated code]*/
+
+static PyObject *
+_io_MemoryReader_close_impl(memoryreader *self)
+/*[clinic end generated code: output=e6171bd2a8303aa8 input=fc4175d793715470]*/
+{
+    Py_CLEAR(self->view);
+    self->data = NULL;
+    self->size = self->pos = 0;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+memoryreader_getstate(memoryreader *self)
+{
+    PyErr_Format(PyExc_TypeError,
+                 "cannot serialize '%s' object", Py_TYPE(self)->tp_name);
+    return NULL;
+}
+
+/*[clinic input]
+_io.MemoryReader.__init__
+    buffer: object
+    *
+    views: bool = False
+
+Buffered I/O implementation reading from a bytes-like object.
+
+The buffer is not copied, so that an mmap can be read without loading
+it into memory first.  Reads copy straight from it, or return read-only
+memoryview slices of it if views is true.  Views save copying large
+reads, but short lines are cheaper as bytes.  The buffer stays exported
+until the reader is closed and the slices are released.
+[clinic start generated code]*/
+
+static int
+_io_MemoryReader___init___impl(memoryreader *self, PyObject *buffer,
+                               int views)
+/*[clinic end generated code: output=96e2d8549091f5d6 input=d1561afd674a1ef0]*/
+{
+    _Py_IDENTIFIER(cast);
+    _Py_IDENTIFIER(toreadonly);
+    PyObject *view, *bytes_view;
+    Py_buffer *buf;
+
+    view = PyMemoryView_FromObject(buffer);
+    if (view == NULL)
+        return -1;
+    if (!PyBuffer_IsContiguous(PyMemoryView_GET_BUFFER(view), 'C')) {
+        PyErr_SetString(PyExc_BufferError,
+                        "MemoryReader needs a contiguous buffer");
+        Py_DECREF(view);
+        return -1;
+    }
+    /* Look at the buffer as unsigned bytes, whatever its format */
+    bytes_view = _PyObject_CallMethodId(view, &PyId_cast, "s", "B");
+    Py_DECREF(view);
+    if (bytes_view == NULL)
+        return -1;
+    /* The slices returned with views must not write to the buffer */
+    view = _PyObject_CallMethodId(bytes_view, &PyId_toreadonly, NULL);
+    Py_DECREF(bytes_view);
+    if (view == NULL)
+        return -1;
+    bytes_view = view;
+
+    Py_XSETREF(self->view, bytes_view);
+    buf = PyMemoryView_GET_BUFFER(bytes_view);
+    self->data = buf->buf;
+    self->size = buf->len;
+    self->pos = 0;
+    self->views = views;
+    return 0;
+}
+
+static int
+memoryreader_traverse(memoryreader *self, visitproc visit, void *arg)
+{
+    Py_VISIT(self->view);
+    Py_VISIT(self->dict);
+    return 0;
+}
+
+static int
+memoryreader_clear(memoryreader *self)
+{
+    Py_CLEAR(self->dict);
+    return 0;
+}
+
+static void
+memoryreader_dealloc(memoryreader *self)
+{
+    _PyObject_GC_UNTRACK(self);
+    Py_CLEAR(self->view);
+    Py_CLEAR(self->dict);
+    if (self->weakreflist != NULL)
+        PyObject_ClearWeakRefs((PyObject *) self);
+    Py_TYPE(self)->tp_free(self);
+}
+
+
+#include "clinic/memoryreader.c.h"
+
+static PyGetSetDef memoryreader_getsetlist[] = {
+    {"closed",  (getter)memoryreader_get_closed, NULL,
+     "True if the file is closed."},
+    {NULL},            /* sentinel */
+};
+
+static struct PyMethodDef memoryreader_methods[] = {
+    _IO_MEMORYREADER_READABLE_METHODDEF
+    _IO_MEMORYREADER_SEEKABLE_METHODDEF
+    _IO_MEMORYREADER_WRITABLE_METHODDEF
+    _IO_MEMORYREADER_CLOSE_METHODDEF
+    _IO_MEMORYREADER_TELL_METHODDEF
+    _IO_MEMORYREADER_READ1_METHODDEF
+    _IO_MEMORYREADER_READINTO_METHODDEF
+    _IO_MEMORYREADER_READINTO1_METHODDEF
+    _IO_MEMORYREADER_READLINE_METHODDEF
+    _IO_MEMORYREADER_READLINES_METHODDEF
+    _IO_MEMORYREADER_READ_METHODDEF
+    _IO_MEMORYREADER_SEEK_METHODDEF
+    {"__getstate__",  (PyCFunction)memoryreader_getstate,  METH_NOARGS, NULL},
+    {NULL, NULL}        /* sentinel */
+};
+
+PyTypeObject PyMemoryReader_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_io.MemoryReader",                        /*tp_name*/
+    sizeof(memoryreader),                      /*tp_basicsize*/
+    0,                                         /*tp_itemsize*/
+    (destructor)memoryreader_dealloc,          /*tp_dealloc*/
+    0,                                         /*tp_print*/
+    0,                                         /*tp_getattr*/
+    0,                                         /*tp_setattr*/
+    0,                                         /*tp_reserved*/
+    0,                                         /*tp_repr*/
+    0,                                         /*tp_as_number*/
+    0,                                         /*tp_as_sequence*/
+    0,                                         /*tp_as_mapping*/
+    0,                                         /*tp_hash*/
+    0,                                         /*tp_call*/
+    0,                                         /*tp_str*/
+    0,                                         /*tp_getattro*/
+    0,                                         /*tp_setattro*/
+    0,                                         /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE |
+    Py_TPFLAGS_HAVE_GC,                        /*tp_flags*/
+    _io_MemoryReader___init____doc__,          /*tp_doc*/
+    (traverseproc)memoryreader_traverse,       /*tp_traverse*/
+    (inquiry)memoryreader_clear,               /*tp_clear*/
+    0,                                         /*tp_richcompare*/
+    offsetof(memoryreader, weakreflist),       /*tp_weaklistoffset*/
+    PyObject_SelfIter,                         /*tp_iter*/
+    (iternextfunc)memoryreader_iternext,       /*tp_iternext*/
+    memoryreader_methods,                      /*tp_methods*/
+    0,                                         /*tp_members*/
+    memoryreader_getsetlist,                   /*tp_getset*/
+    0,                                         /*tp_base*/
+    0,                                         /*tp_dict*/
+    0,                                         /*tp_descr_get*/
+    0,                                         /*tp_descr_set*/
+    offsetof(memoryreader, dict),              /*tp_dictoffset*/
+    _io_MemoryReader___init__,                 /*tp_init*/
+    0,                                         /*tp_alloc*/
+    PyType_GenericNew,                         /*tp_new*/
+};
@@ -0,0 +1,796 @@
+/*
+ * Read-ahead and batched reads of regular files.
+ *
+ * On Linux, the reads are queued on an io_uring, so that several of them
+ * are in flight at once and the storage can serve them concurrently.
+ * Elsewhere, or when the kernel refuses to set up a ring, the kernel is
+ * told about the upcoming reads with posix_fadvise(), and they are made
+ * one at a time with pread().
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+#include <stddef.h>               /* For offsetof */
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include "_iomodule.h"
+
+#if defined(__linux__) && defined(HAVE_LINUX_IO_URING_H) && \
+    defined(HAVE_SYS_SYSCALL_H) && defined(HAVE_SYS_MMAN_H)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define USE_IO_URING
+#endif
+#endif
+
+/* Size of the reads made ahead of a sequential reader, and of the pieces
+   read_batch() splits large requests into. */
+#define READAHEAD_CHUNK_SIZE (128 * 1024)
+#define READAHEAD_MAX_DEPTH 64
+#define BATCH_MAX_READ (1 << 30)
+#define BATCH_RING_ENTRIES 64
+
+
+#ifdef USE_IO_URING
+
+/* A minimal io_uring: the submission and completion queues are mapped
+   once, entries are queued with ring_prep_readv() and handed to the
+   kernel by ring_enter(), which can also wait for completions, and the
+   completions are taken with ring_reap().  Only one thread uses a ring
+   at a time, so the queue heads and tails owned by this side are
+   read without barriers. */
+
+typedef struct {
+    int fd;
+    unsigned entries;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_cqe *cqes;
+    void *sq_ring, *cq_ring;
+    size_t sq_ring_size, cq_ring_size, sqes_size;
+} ring_t;
+
+static void
+ring_fini(ring_t *ring)
+{
+    if (ring->sqes)
+        munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ring)
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    if (ring->sq_ring)
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    if (ring->fd >= 0)
+        close(ring->fd);
+    ring->fd = -1;
+}
+
+/* Return 0 on success, -1 with errno set on failure. */
+static int
+ring_init(ring_t *ring, unsigned entries)
+{
+    struct io_uring_params p;
+    char *sq, *cq;
+    void *sqes;
+    int err;
+
+    memset(&p, 0, sizeof(p));
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = (int) syscall(__NR_io_uring_setup, entries, &p);
+    if (ring->fd < 0)
+        return -1;
+    ring->entries = p.sq_entries;
+
+    ring->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    sq = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (sq == MAP_FAILED)
+        goto error;
+    ring->sq_ring = sq;
+
+    ring->cq_ring_size = p.cq_off.cqes +
+                         p.cq_entries * sizeof(struct io_uring_cqe);
+    cq = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+    if (cq == MAP_FAILED)
+        goto error;
+    ring->cq_ring = cq;
+
+    ring->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+        goto error;
+    ring->sqes = sqes;
+
+    ring->sq_head = (unsigned *) (sq + p.sq_off.head);
+    ring->sq_tail = (unsigned *) (sq + p.sq_off.tail);
+    ring->sq_mask = (unsigned *) (sq + p.sq_off.ring_mask);
+    ring->sq_array = (unsigned *) (sq + p.sq_off.array);
+    ring->cq_head = (unsigned *) (cq + p.cq_off.head);
+    ring->cq_tail = (unsigned *) (cq + p.cq_off.tail);
+    ring->cq_mask = (unsigned *) (cq + p.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *) (cq + p.cq_off.cqes);
+    return 0;
+
+  error:
+    err = errno;
+    ring_fini(ring);
+    errno = err;
+    return -1;
+}
+
+/* Queue a read into iov at offset of fd.  The caller never has more
+   reads in flight than the ring has entries, so there is always room. */
+static void
+ring_prep_readv(ring_t *ring, int fd, struct iovec *iov, Py_off_t offset,
+                uint64_t data)
+{
+    unsigned tail = *ring->sq_tail;
+    unsigned index = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->off = (uint64_t) offset;
+    sqe->addr = (uint64_t) (uintptr_t) iov;
+    sqe->len = 1;
+    sqe->user_data = data;
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+/* Submit the queued reads, and wait until at least one read completed
+   if wait is nonzero.  Return 0 on success, -1 with errno set on
+   failure.  Called without the GIL. */
+static int
+ring_enter(ring_t *ring, int wait)
+{
+    unsigned queued;
+    int res;
+
+    for (;;) {
+        queued = *ring->sq_tail - __atomic_load_n(ring->sq_head,
+                                                  __ATOMIC_ACQUIRE);
+        if (queued == 0 && !wait)
+            return 0;
+        res = (int) syscall(__NR_io_uring_enter, ring->fd, queued,
+                            wait ? 1 : 0,
+                            wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        if (res >= 0)
+            return 0;
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            return -1;
+    }
+}
+
+/* Take a completion if there is one.  Return 1 and set *data and *res if
+   there was one, 0 otherwise. */
+static int
+ring_reap(ring_t *ring, uint64_t *data, int *res)
+{
+    unsigned head = *ring->cq_head;
+    struct io_uring_cqe *cqe;
+
+    if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE))
+        return 0;
+    cqe = &ring->cqes[head & *ring->cq_mask];
+    *data = cqe->user_data;
+    *res = cqe->res;
+    __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+#endif /* USE_IO_URING */
+
+
+/* Read up to size bytes at offset of fd.  Called without the GIL. */
+static Py_ssize_t
+pread_noraise(int fd, char *buf, Py_ssize_t size, Py_off_t offset)
+{
+    Py_ssize_t n;
+
+    if (size > _PY_READ_MAX)
+        size = _PY_READ_MAX;
+    _Py_BEGIN_SUPPRESS_IPH
+#if defined(HAVE_PREAD)
+    n = pread(fd, buf, (size_t) size, offset);
+#elif defined(MS_WINDOWS)
+    if (_lseeki64(fd, offset, SEEK_SET) < 0)
+        n = -1;
+    else
+        n = read(fd, buf, (int) size);
+#else
+    if (lseek(fd, offset, SEEK_SET) < 0)
+        n = -1;
+    else
+        n = read(fd, buf, (size_t) size);
+#endif
+    _Py_END_SUPPRESS_IPH
+    return n;
+}
+
+static void
+advise_willneed(int fd, Py_off_t offset, Py_off_t len)
+{
+#ifdef HAVE_POSIX_FADVISE
+    (void) posix_fadvise(fd, offset, len, POSIX_FADV_WILLNEED);
+#endif
+}
+
+
+/* Read-ahead of a sequential reader.  The chunks form a circular queue
+   starting at head: the first count of them hold, or are being filled
+   with, consecutive pieces of the file starting at or before pos. */
+
+typedef struct {
+    char *buf;
+    Py_off_t offset;
+    Py_ssize_t len;         /* bytes read, or -errno */
+    int pending;
+#ifdef USE_IO_URING
+    struct iovec iov;
+#endif
+} chunk_t;
+
+struct _PyIO_ReadAhead {
+    int fd;
+    int depth;
+    Py_off_t pos;           /* position of the reader */
+    Py_off_t next;          /* offset of the next chunk to request */
+    Py_off_t advised;       /* end of the range passed to posix_fadvise() */
+    int eof;                /* a chunk came back short, stop requesting */
+    int head, count;
+#ifdef USE_IO_URING
+    int use_ring;
+    ring_t ring;
+    char *buffers;
+#endif
+    chunk_t chunks[1];
+};
+
+_PyIO_ReadAhead *
+_PyIO_ReadAhead_New(int fd, Py_off_t pos, int depth)
+{
+    _PyIO_ReadAhead *ra;
+
+    if (depth > READAHEAD_MAX_DEPTH)
+        depth = READAHEAD_MAX_DEPTH;
+    ra = PyMem_Malloc(offsetof(_PyIO_ReadAhead, chunks) +
+                      depth * sizeof(chunk_t));
+    if (ra == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    memset(ra, 0, offsetof(_PyIO_ReadAhead, chunks));
+    ra->fd = fd;
+    ra->depth = depth;
+    ra->pos = ra->next = ra->advised = pos;
+#ifdef USE_IO_URING
+    ra->buffers = PyMem_Malloc((size_t) depth * READAHEAD_CHUNK_SIZE);
+    if (ra->buffers == NULL) {
+        PyMem_Free(ra);
+        PyErr_NoMemory();
+        return NULL;
+    }
+    if (ring_init(&ra->ring, depth) == 0) {
+        int i;
+        ra->use_ring = 1;
+        for (i = 0; i < depth; i++) {
+            ra->chunks[i].buf = ra->buffers + i * READAHEAD_CHUNK_SIZE;
+            ra->chunks[i].pending = 0;
+        }
+    }
+    else {
+        /* not supported by the kernel or not allowed */
+        PyMem_Free(ra->buffers);
+        ra->buffers = NULL;
+    }
+#endif
+    return ra;
+}
+
+#ifdef USE_IO_URING
+
+/* Take all the completions.  Called without the GIL. */
+static void
+readahead_reap(_PyIO_ReadAhead *ra)
+{
+    uint64_t data;
+    int res;
+
+    while (ring_reap(&ra->ring, &data, &res)) {
+        chunk_t *chunk = &ra->chunks[data];
+        chunk->len = res;
+        chunk->pending = 0;
+        if (res >= 0 && res < READAHEAD_CHUNK_SIZE)
+            ra->eof = 1;
+    }
+}
+
+/* Request chunks until depth of them are in use, and submit them.
+   Called without the GIL. */
+static int
+readahead_submit(_PyIO_ReadAhead *ra)
+{
+    while (ra->count < ra->depth && !ra->eof) {
+        int i = (ra->head + ra->count) % ra->depth;
+        chunk_t *chunk = &ra->chunks[i];
+        chunk->offset = ra->next;
+        chunk->len = 0;
+        chunk->pending = 1;
+        chunk->iov.iov_base = chunk->buf;
+        chunk->iov.iov_len = READAHEAD_CHUNK_SIZE;
+        ring_prep_readv(&ra->ring, ra->fd, &chunk->iov, chunk->offset, i);
+        ra->next += READAHEAD_CHUNK_SIZE;
+        ra->count++;
+    }
+    return ring_enter(&ra->ring, 0);
+}
+
+/* Wait for the reads in flight, and forget all the chunks.  Called
+   without the GIL. */
+static void
+readahead_drain(_PyIO_ReadAhead *ra)
+{
+    int i;
+
+    for (i = 0; i < ra->count; i++) {
+        chunk_t *chunk = &ra->chunks[(ra->head + i) % ra->depth];
+        while (chunk->pending) {
+            if (ring_enter(&ra->ring, 1) < 0) {
+                /* should not happen: the kernel still owns the buffers,
+                   so they are leaked rather than reused */
+                ra->buffers = NULL;
+                ra->use_ring = 0;
+                return;
+            }
+            readahead_reap(ra);
+        }
+    }
+    ra->head = ra->count = 0;
+    ra->eof = 0;
+    ra->next = ra->pos;
+}
+
+static Py_ssize_t
+readahead_ring_read(_PyIO_ReadAhead *ra, char *buf, Py_ssize_t size)
+{
+    Py_ssize_t total = 0;
+    int err = 0;
+
+    Py_BEGIN_ALLOW_THREADS
+    for (;;) {
+        chunk_t *chunk;
+        Py_ssize_t avail, n;
+
+        if (readahead_submit(ra) < 0) {
+            err = errno;
+            break;
+        }
+        if (ra->count == 0 || total == size)
+            break;
+        chunk = &ra->chunks[ra->head];
+        if (chunk->pending) {
+            /* return what is there rather than wait */
+            if (total > 0)
+                break;
+            if (ring_enter(&ra->ring, 1) < 0) {
+                err = errno;
+                break;
+            }
+            readahead_reap(ra);
+            continue;
+        }
+        if (chunk->len < 0) {
+            err = (int) -chunk->len;
+            readahead_drain(ra);
+            break;
+        }
+        avail = (Py_ssize_t) (chunk->offset + chunk->len - ra->pos);
+        if (avail <= 0) {
+            /* end of file; start over from there on the next call, in
+               case the file grows */
+            if (total == 0)
+                readahead_drain(ra);
+            break;
+        }
+        n = Py_MIN(avail, size - total);
+        memcpy(buf + total, chunk->buf + (ra->pos - chunk->offset), n);
+        total += n;
+        ra->pos += n;
+        if (n == avail && chunk->len == READAHEAD_CHUNK_SIZE) {
+            ra->head = (ra->head + 1) % ra->depth;
+            ra->count--;
+        }
+    }
+    Py_END_ALLOW_THREADS
+
+    if (err) {
+        errno = err;
+        PyErr_SetFromErrno(PyExc_OSError);
+        return -1;
+    }
+    return total;
+}
+
+#endif /* USE_IO_URING */
+
+Py_ssize_t
+_PyIO_ReadAhead_Read(_PyIO_ReadAhead *ra, char *buf, Py_ssize_t size)
+{
+    Py_off_t window = (Py_off_t) ra->depth * READAHEAD_CHUNK_SIZE;
+    Py_ssize_t n;
+    int async_err = 0;
+
+#ifdef USE_IO_URING
+    if (ra->use_ring)
+        return readahead_ring_read(ra, buf, size);
+#endif
+    /* keep the kernel reading a window ahead of the reader */
+    if (ra->advised < ra->pos + window / 2) {
+        Py_off_t start = Py_MAX(ra->advised, ra->pos);
+        advise_willneed(ra->fd, start, ra->pos + window - start);
+        ra->advised = ra->pos + window;
+    }
+    do {
+        Py_BEGIN_ALLOW_THREADS
+        n = pread_noraise(ra->fd, buf, size, ra->pos);
+        Py_END_ALLOW_THREADS
+    } while (n < 0 && errno == EINTR && !(async_err = PyErr_CheckSignals()));
+    if (n < 0) {
+        if (!async_err)
+            PyErr_SetFromErrno(PyExc_OSError);
+        return -1;
+    }
+    ra->pos += n;
+    return n;
+}
+
+void
+_PyIO_ReadAhead_Reset(_PyIO_ReadAhead *ra, Py_off_t pos)
+{
+    if (pos == ra->pos)
+        return;
+    ra->pos = ra->advised = pos;
+#ifdef USE_IO_URING
+    if (ra->use_ring) {
+        Py_BEGIN_ALLOW_THREADS
+        readahead_drain(ra);
+        Py_END_ALLOW_THREADS
+    }
+#endif
+}
+
+Py_off_t
+_PyIO_ReadAhead_Tell(_PyIO_ReadAhead *ra)
+{
+    return ra->pos;
+}
+
+const char *
+_PyIO_ReadAhead_Backend(_PyIO_ReadAhead *ra)
+{
+#ifdef USE_IO_URING
+    if (ra->use_ring)
+        return "io_uring";
+#endif
+#ifdef HAVE_POSIX_FADVISE
+    return "fadvise";
+#else
+    return "pread";
+#endif
+}
+
+void
+_PyIO_ReadAhead_Free(_PyIO_ReadAhead *ra)
+{
+#ifdef USE_IO_URING
+    if (ra->use_ring) {
+        Py_BEGIN_ALLOW_THREADS
+        readahead_drain(ra);
+        Py_END_ALLOW_THREADS
+    }
+    if (ra->ring.fd >= 0)
+        ring_fini(&ra->ring);
+    PyMem_Free(ra->buffers);
+#endif
+    PyMem_Free(ra);
+}
+
+
+
+/* Batched reads */
+
+typedef struct {
+    PyObject *file;
+    PyObject *path;         /* encoded path, or NULL if file is an fd */
+    int fd;
+    Py_off_t offset;
+    Py_ssize_t size;
+    Py_ssize_t done;
+    int err;                /* errno of a failed open or read */
+    PyObject *result;
+    char *buf;
+#ifdef USE_IO_URING
+    struct iovec iov;
+#endif
+} batch_t;
+
+static int
+batch_parse(batch_t *req, PyObject *item)
+{
+    PyObject *offset;
+
+    if (!PyTuple_Check(item) || PyTuple_GET_SIZE(item) != 3) {
+        PyErr_SetString(PyExc_TypeError,
+                        "read_batch() requests must be "
+                        "(file, offset, size) tuples");
+        return -1;
+    }
+    req->file = PyTuple_GET_ITEM(item, 0);
+    req->fd = -1;
+    if (PyLong_Check(req->file)) {
+        req->fd = _PyLong_AsInt(req->file);
+        if (req->fd < 0) {
+            if (!PyErr_Occurred())
+                PyErr_SetString(PyExc_ValueError, "negative file descriptor");
+            return -1;
+        }
+    }
+    else if (!PyUnicode_FSConverter(req->file, &req->path))
+        return -1;
+    offset = PyTuple_GET_ITEM(item, 1);
+    req->offset = PyNumber_AsOff_t(offset, PyExc_OverflowError);
+    if (req->offset == -1 && PyErr_Occurred())
+        return -1;
+    req->size = PyNumber_AsSsize_t(PyTuple_GET_ITEM(item, 2),
+                                   PyExc_OverflowError);
+    if (req->size == -1 && PyErr_Occurred())
+        return -1;
+    if (req->offset < 0 || req->size < -1) {
+        PyErr_SetString(PyExc_ValueError,
+                        "read_batch() offset must be non-negative and "
+                        "size at least -1");
+        return -1;
+    }
+    return 0;
+}
+
+/* Open the files given by path, and find the size of the requests up to
+   the end of the file.  Called without the GIL. */
+static void
+batch_open(batch_t *reqs, Py_ssize_t n)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < n; i++) {
+        batch_t *req = &reqs[i];
+        struct _Py_stat_struct st;
+
+        if (req->path) {
+            int flags = O_RDONLY;
+#ifdef O_BINARY
+            flags |= O_BINARY;
+#endif
+#ifdef O_CLOEXEC
+            flags |= O_CLOEXEC;
+#endif
+            do {
+                req->fd = open(PyBytes_AS_STRING(req->path), flags);
+            } while (req->fd < 0 && errno == EINTR);
+            if (req->fd < 0) {
+                req->err = errno;
+                continue;
+            }
+        }
+        if (req->size < 0) {
+            if (_Py_fstat_noraise(req->fd, &st) < 0) {
+                req->err = errno;
+                continue;
+            }
+            req->size = (Py_ssize_t) Py_MIN(
+                Py_MAX(st.st_size - req->offset, 0), PY_SSIZE_T_MAX);
+        }
+    }
+}
+
+#ifdef USE_IO_URING
+
+static void
+batch_prep(ring_t *ring, batch_t *req, Py_ssize_t i)
+{
+    req->iov.iov_base = req->buf + req->done;
+    req->iov.iov_len = (size_t) Py_MIN(req->size - req->done, BATCH_MAX_READ);
+    ring_prep_readv(ring, req->fd, &req->iov, req->offset + req->done, i);
+}
+
+/* Keep up to a ring of reads in flight, until all the requests are done.
+   Return -1 with errno set if no ring could be set up.  Called without
+   the GIL. */
+static int
+batch_ring_read(batch_t *reqs, Py_ssize_t n)
+{
+    ring_t ring;
+    Py_ssize_t next = 0, inflight = 0, i;
+    uint64_t data;
+    int res;
+
+    if (ring_init(&ring, BATCH_RING_ENTRIES) < 0)
+        return -1;
+    for (;;) {
+        for (; inflight < ring.entries && next < n; next++) {
+            if (reqs[next].size > 0 && !reqs[next].err) {
+                batch_prep(&ring, &reqs[next], next);
+                inflight++;
+            }
+        }
+        if (inflight == 0)
+            break;
+        if (ring_enter(&ring, 1) < 0) {
+            int err = errno;
+            for (i = 0; i < n; i++) {
+                if (!reqs[i].err)
+                    reqs[i].err = err;
+            }
+            /* the kernel writes into the buffers until the reads in
+               flight complete, so wait for them without queuing more */
+            for (;;) {
+                while (ring_reap(&ring, &data, &res))
+                    inflight--;
+                if (inflight == 0)
+                    break;
+                if (ring_enter(&ring, 1) < 0) {
+                    /* should not happen: the kernel still owns the
+                       buffers, so they are leaked rather than freed */
+                    for (i = 0; i < next; i++)
+                        reqs[i].result = NULL;
+                    break;
+                }
+            }
+            break;
+        }
+        while (ring_reap(&ring, &data, &res)) {
+            batch_t *req = &reqs[data];
+            inflight--;
+            if (res < 0)
+                req->err = -res;
+            else if (res > 0 && (req->done += res) < req->size) {
+                batch_prep(&ring, req, data);
+                inflight++;
+            }
+        }
+    }
+    ring_fini(&ring);
+    return 0;
+}
+
+#endif /* USE_IO_URING */
+
+/* Tell the kernel about all the reads, then make them one at a time.
+   Called without the GIL. */
+static void
+batch_pread(batch_t *reqs, Py_ssize_t n)
+{
+    Py_ssize_t i, r;
+
+    for (i = 0; i < n; i++) {
+        if (reqs[i].size > 0 && !reqs[i].err)
+            advise_willneed(reqs[i].fd, reqs[i].offset, reqs[i].size);
+    }
+    for (i = 0; i < n; i++) {
+        batch_t *req = &reqs[i];
+        while (req->done < req->size && !req->err) {
+            r = pread_noraise(req->fd, req->buf + req->done,
+                              req->size - req->done,
+                              req->offset + req->done);
+            if (r < 0) {
+                if (errno != EINTR)
+                    req->err = errno;
+            }
+            else if (r == 0)
+                break;
+            else
+                req->done += r;
+        }
+    }
+}
+
+PyObject *
+_PyIO_read_batch(PyObject *requests)
+{
+    PyObject *seq, *result = NULL;
+    batch_t *reqs = NULL;
+    Py_ssize_t n, i;
+
+    seq = PySequence_Fast(requests,
+                          "read_batch() argument must be an iterable");
+    if (seq == NULL)
+        return NULL;
+    n = PySequence_Fast_GET_SIZE(seq);
+    reqs = PyMem_Calloc(Py_MAX(n, 1), sizeof(batch_t));
+    if (reqs == NULL) {
+        PyErr_NoMemory();
+        goto done;
+    }
+    for (i = 0; i < n; i++) {
+        reqs[i].fd = -1;
+        if (batch_parse(&reqs[i], PySequence_Fast_GET_ITEM(seq, i)) < 0) {
+            n = i + 1;
+            goto done;
+        }
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    batch_open(reqs, n);
+    Py_END_ALLOW_THREADS
+    for (i = 0; i < n; i++) {
+        batch_t *req = &reqs[i];
+        if (req->err)
+            continue;
+        req->result = PyBytes_FromStringAndSize(NULL, req->size);
+        if (req->result == NULL)
+            goto done;
+        req->buf = PyBytes_AS_STRING(req->result);
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+#ifdef USE_IO_URING
+    if (batch_ring_read(reqs, n) < 0)
+#endif
+        batch_pread(reqs, n);
+    Py_END_ALLOW_THREADS
+
+    for (i = 0; i < n; i++) {
+        if (reqs[i].err) {
+            errno = reqs[i].err;
+            if (reqs[i].path)
+                PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError,
+                                                     reqs[i].file);
+            else
+                PyErr_SetFromErrno(PyExc_OSError);
+            goto done;
+        }
+    }
+    result = PyList_New(n);
+    if (result == NULL)
+        goto done;
+    for (i = 0; i < n; i++) {
+        if (reqs[i].done < reqs[i].size &&
+            _PyBytes_Resize(&reqs[i].result, reqs[i].done) < 0) {
+            Py_CLEAR(result);
+            goto done;
+        }
+        PyList_SET_ITEM(result, i, reqs[i].result);
+        reqs[i].result = NULL;
+    }
+
+  done:
+    if (reqs != NULL) {
+        for (i = 0; i < n; i++) {
+            if (reqs[i].path) {
+                if (reqs[i].fd >= 0)
+                    close(reqs[i].fd);
+                Py_DECREF(reqs[i].path);
+            }
+            Py_XDECREF(reqs[i].result);
+        }
+        PyMem_Free(reqs);
+    }
+    Py_DECREF(seq);
+    return result;
+}
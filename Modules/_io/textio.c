@@ -673,6 +673,16 @@ typedef struct
     */
     PyObject *decoded_chars;       /* buffer for text returned from decoder */
     Py_ssize_t decoded_chars_used; /* offset into _decoded_chars for read() */
+
+    /* Line iteration bypasses the decoder for the ASCII, Latin-1 and UTF-8
+       codecs when lines end with '\n': it searches the raw chunk for the
+       newline and decodes each line directly.  undecoded is the chunk (a
+       bytes object, or NULL), undecoded_pos the start of the next line in
+       it.  The bytes before undecoded_pos have been returned to the caller
+       and the decoder has not seen any of the chunk. */
+    PyObject *undecoded;
+    Py_ssize_t undecoded_pos;
+    char fastlines;                /* one of the FASTLINES_* values */
     PyObject *pending_bytes;       /* list of bytes objects waiting to be
                                       written, or NULL */
     Py_ssize_t pending_bytes_count;
@@ -697,6 +707,15 @@ typedef struct
 static void
 textiowrapper_set_decoded_chars(textio *self, PyObject *chars);
 
+/* Codecs for which line iteration can decode lines directly */
+#define FASTLINES_NONE   0
+#define FASTLINES_ASCII  1
+#define FASTLINES_LATIN1 2
+#define FASTLINES_UTF8   3
+
+/* Size of the chunks read by line iteration when it bypasses the decoder */
+#define FASTLINES_CHUNK_SIZE (64 * 1024)
+
 /* A couple of specialized cases in order to bypass the slow incremental
    encoding methods for the most popular encodings. */
 
@@ -866,10 +885,30 @@ _textiowrapper_set_decoder(textio *self, PyObject *codec_info,
         return 0;
 
     Py_CLEAR(self->decoder);
+    self->fastlines = FASTLINES_NONE;
     self->decoder = _PyCodecInfo_GetIncrementalDecoder(codec_info, errors);
     if (self->decoder == NULL)
         return -1;
 
+    /* Lines can be decoded one by one, without the incremental decoder,
+       if the codec is stateless and a line always ends with '\n' */
+    if (self->readuniversal ||
+        _PyUnicode_EqualToASCIIString(self->readnl, "\n"))
+    {
+        if (_PyObject_LookupAttrId(codec_info, &PyId_name, &res) < 0) {
+            return -1;
+        }
+        if (res != NULL && PyUnicode_Check(res)) {
+            if (_PyUnicode_EqualToASCIIString(res, "ascii"))
+                self->fastlines = FASTLINES_ASCII;
+            else if (_PyUnicode_EqualToASCIIString(res, "iso8859-1"))
+                self->fastlines = FASTLINES_LATIN1;
+            else if (_PyUnicode_EqualToASCIIString(res, "utf-8"))
+                self->fastlines = FASTLINES_UTF8;
+        }
+        Py_XDECREF(res);
+    }
+
     if (self->readuniversal) {
         PyObject *incrementalDecoder = PyObject_CallFunction(
             (PyObject *)&PyIncrementalNewlineDecoder_Type,
@@ -1059,11 +1098,14 @@ _io_TextIOWrapper___init___impl(textio *self, PyObject *buffer,
     Py_CLEAR(self->decoder);
     Py_CLEAR(self->readnl);
     Py_CLEAR(self->decoded_chars);
+    Py_CLEAR(self->undecoded);
     Py_CLEAR(self->pending_bytes);
     Py_CLEAR(self->snapshot);
     Py_CLEAR(self->errors);
     Py_CLEAR(self->raw);
     self->decoded_chars_used = 0;
+    self->undecoded_pos = 0;
+    self->fastlines = FASTLINES_NONE;
     self->pending_bytes_count = 0;
     self->encodefunc = NULL;
     self->b2cratio = 0.0;
@@ -1311,7 +1353,7 @@ _io_TextIOWrapper_reconfigure_impl(textio *self, PyObject *encoding,
     const char *newline = NULL;
 
     /* Check if something is in the read buffer */
-    if (self->decoded_chars != NULL) {
+    if (self->decoded_chars != NULL || self->undecoded != NULL) {
         if (encoding != Py_None || errors != Py_None || newline_obj != NULL) {
             _unsupported("It is not possible to set the encoding or newline "
                          "of stream after the first read");
@@ -1365,6 +1407,7 @@ textiowrapper_clear(textio *self)
     Py_CLEAR(self->decoder);
     Py_CLEAR(self->readnl);
     Py_CLEAR(self->decoded_chars);
+    Py_CLEAR(self->undecoded);
     Py_CLEAR(self->pending_bytes);
     Py_CLEAR(self->snapshot);
     Py_CLEAR(self->errors);
@@ -1397,6 +1440,7 @@ textiowrapper_traverse(textio *self, visitproc visit, void *arg)
     Py_VISIT(self->decoder);
     Py_VISIT(self->readnl);
     Py_VISIT(self->decoded_chars);
+    Py_VISIT(self->undecoded);
     Py_VISIT(self->pending_bytes);
     Py_VISIT(self->snapshot);
     Py_VISIT(self->errors);
@@ -1480,6 +1524,7 @@ _io_TextIOWrapper_detach_impl(textio *self)
     buffer = self->buffer;
     self->buffer = NULL;
     self->detached = 1;
+    Py_CLEAR(self->undecoded);
     return buffer;
 }
 
@@ -1610,6 +1655,7 @@ _io_TextIOWrapper_write_impl(textio *self, PyObject *text)
     }
 
     textiowrapper_set_decoded_chars(self, NULL);
+    Py_CLEAR(self->undecoded);
     Py_CLEAR(self->snapshot);
 
     if (self->decoder) {
@@ -1795,6 +1841,32 @@ textiowrapper_read_chunk(textio *self, Py_ssize_t size_hint)
     return -1;
 }
 
+/* Hand the rest of the chunk read by line iteration over to the decoder,
+   so that the other read methods find it in self._decoded_chars.
+ */
+static int
+textiowrapper_flush_undecoded(textio *self)
+{
+    PyObject *rest, *decoded_chars;
+
+    if (self->undecoded == NULL)
+        return 0;
+
+    rest = PyBytes_FromStringAndSize(
+        PyBytes_AS_STRING(self->undecoded) + self->undecoded_pos,
+        PyBytes_GET_SIZE(self->undecoded) - self->undecoded_pos);
+    Py_CLEAR(self->undecoded);
+    if (rest == NULL)
+        return -1;
+
+    decoded_chars = _textiowrapper_decode(self->decoder, rest, 0);
+    Py_DECREF(rest);
+    if (decoded_chars == NULL)
+        return -1;
+    textiowrapper_set_decoded_chars(self, decoded_chars);
+    return 0;
+}
+
 /*[clinic input]
 _io.TextIOWrapper.read
     size as n: Py_ssize_t(accept={int, NoneType}) = -1
@@ -1816,6 +1888,9 @@ _io_TextIOWrapper_read_impl(textio *self, Py_ssize_t n)
     if (_textiowrapper_writeflush(self) < 0)
         return NULL;
 
+    if (textiowrapper_flush_undecoded(self) < 0)
+        return NULL;
+
     if (n < 0) {
         /* Read everything */
         PyObject *bytes = _PyObject_CallMethodId(self->buffer, &PyId_read, NULL);
@@ -2022,6 +2097,9 @@ _textiowrapper_readline(textio *self, Py_ssize_t limit)
     if (_textiowrapper_writeflush(self) < 0)
         return NULL;
 
+    if (textiowrapper_flush_undecoded(self) < 0)
+        return NULL;
+
     chunked = 0;
 
     while (1) {
@@ -2379,6 +2457,7 @@ _io_TextIOWrapper_seek_impl(textio *self, PyObject *cookieObj, int whence)
         Py_DECREF(res);
 
         textiowrapper_set_decoded_chars(self, NULL);
+        Py_CLEAR(self->undecoded);
         Py_CLEAR(self->snapshot);
         if (self->decoder) {
             res = _PyObject_CallMethodId(self->decoder, &PyId_reset, NULL);
@@ -2440,6 +2519,7 @@ _io_TextIOWrapper_seek_impl(textio *self, PyObject *cookieObj, int whence)
     Py_DECREF(res);
 
     textiowrapper_set_decoded_chars(self, NULL);
+    Py_CLEAR(self->undecoded);
     Py_CLEAR(self->snapshot);
 
     /* Restore the decoder to its state from the safe start point. */
@@ -2964,6 +3044,173 @@ _io_TextIOWrapper_close_impl(textio *self)
     }
 }
 
+/* Return 1 if the decoder holds no input and no state, 0 otherwise. */
+static int
+_textiowrapper_decoder_is_clean(textio *self)
+{
+    PyObject *state, *dec_buffer, *dec_flags;
+    int r;
+
+    state = PyObject_CallMethodObjArgs(self->decoder,
+                                       _PyIO_str_getstate, NULL);
+    if (state == NULL)
+        return -1;
+    if (!PyTuple_Check(state) ||
+        !PyArg_ParseTuple(state, "OO", &dec_buffer, &dec_flags))
+    {
+        /* Let the regular path report the illegal state */
+        PyErr_Clear();
+        Py_DECREF(state);
+        return 0;
+    }
+    r = (PyBytes_Check(dec_buffer) && PyBytes_GET_SIZE(dec_buffer) == 0);
+    if (r) {
+        r = PyObject_RichCompareBool(dec_flags, _PyLong_Zero, Py_EQ);
+    }
+    Py_DECREF(state);
+    return r;
+}
+
+/* Read the next chunk for textiowrapper_fastlines_next(), appending it to
+   the unread rest of the current one.  Return 1 on success, 0 if the end
+   of the file was reached and -1 on error.
+ */
+static int
+textiowrapper_fastlines_read(textio *self)
+{
+    PyObject *chunk_size, *input_chunk;
+
+    chunk_size = PyLong_FromSsize_t(Py_MAX(self->chunk_size,
+                                           FASTLINES_CHUNK_SIZE));
+    if (chunk_size == NULL)
+        return -1;
+    input_chunk = PyObject_CallMethodObjArgs(self->buffer, _PyIO_str_read1,
+                                             chunk_size, NULL);
+    Py_DECREF(chunk_size);
+    if (input_chunk == NULL)
+        return -1;
+    /* The read1() method of the C buffered objects returns bytes */
+    assert(PyBytes_Check(input_chunk));
+    if (PyBytes_GET_SIZE(input_chunk) == 0) {
+        Py_DECREF(input_chunk);
+        return 0;
+    }
+
+    if (self->undecoded != NULL &&
+        self->undecoded_pos < PyBytes_GET_SIZE(self->undecoded))
+    {
+        PyObject *next_input = PyBytes_FromStringAndSize(
+            PyBytes_AS_STRING(self->undecoded) + self->undecoded_pos,
+            PyBytes_GET_SIZE(self->undecoded) - self->undecoded_pos);
+        PyBytes_Concat(&next_input, input_chunk);
+        Py_DECREF(input_chunk);
+        if (next_input == NULL)
+            return -1;
+        input_chunk = next_input;
+    }
+    Py_XSETREF(self->undecoded, input_chunk);
+    self->undecoded_pos = 0;
+
+    /* In universal newlines mode, '\r' ends a line too: leave the rest of
+       the file to the decoder once one shows up. */
+    if (self->readuniversal &&
+        memchr(PyBytes_AS_STRING(input_chunk), '\r',
+               PyBytes_GET_SIZE(input_chunk)) != NULL)
+    {
+        self->fastlines = FASTLINES_NONE;
+    }
+    return 1;
+}
+
+/* Return the next line for iteration, decoded straight from the raw chunk.
+   Return NULL without an exception set if the line must go through the
+   decoder instead.
+ */
+static PyObject *
+textiowrapper_fastlines_next(textio *self)
+{
+    const char *start, *end, *nl;
+    const char *errors;
+    PyObject *line;
+    Py_ssize_t len;
+    int r;
+
+    CHECK_CLOSED(self);
+
+    if (self->undecoded == NULL) {
+        /* Only start from a clean state, at a chunk boundary */
+        if (self->decoded_chars != NULL &&
+            self->decoded_chars_used < PyUnicode_GET_LENGTH(self->decoded_chars))
+            return NULL;
+        if (_textiowrapper_writeflush(self) < 0)
+            return NULL;
+        r = _textiowrapper_decoder_is_clean(self);
+        if (r <= 0)
+            return NULL;
+        textiowrapper_set_decoded_chars(self, NULL);
+        r = textiowrapper_fastlines_read(self);
+        if (r <= 0)
+            return (r == 0) ? PyUnicode_New(0, 0) : NULL;
+        if (self->fastlines == FASTLINES_NONE)
+            return NULL;
+    }
+
+    while (1) {
+        start = PyBytes_AS_STRING(self->undecoded) + self->undecoded_pos;
+        end = PyBytes_AS_STRING(self->undecoded) +
+              PyBytes_GET_SIZE(self->undecoded);
+        nl = memchr(start, '\n', end - start);
+        if (nl != NULL) {
+            len = nl - start + 1;
+            break;
+        }
+        if (self->undecoded_pos == 0) {
+            /* A line longer than a chunk: let the decoder assemble it */
+            return NULL;
+        }
+        r = textiowrapper_fastlines_read(self);
+        if (r < 0)
+            return NULL;
+        if (r == 0) {
+            /* End of file: the last line has no newline */
+            len = end - start;
+            break;
+        }
+        if (self->fastlines == FASTLINES_NONE)
+            return NULL;
+    }
+
+    if (len == 0) {
+        Py_CLEAR(self->undecoded);
+        return PyUnicode_New(0, 0);
+    }
+
+    errors = PyUnicode_AsUTF8(self->errors);
+    if (errors == NULL)
+        return NULL;
+    switch (self->fastlines) {
+    case FASTLINES_ASCII:
+        line = PyUnicode_DecodeASCII(start, len, errors);
+        break;
+    case FASTLINES_LATIN1:
+        line = PyUnicode_DecodeLatin1(start, len, errors);
+        break;
+    default:
+        line = PyUnicode_DecodeUTF8(start, len, errors);
+        break;
+    }
+    if (line == NULL)
+        return NULL;
+    self->undecoded_pos += len;
+
+    /* Keep the newlines attribute up to date */
+    if (self->readuniversal && start[len - 1] == '\n') {
+        assert(Py_TYPE(self->decoder) == &PyIncrementalNewlineDecoder_Type);
+        ((nldecoder_object *)self->decoder)->seennl |= SEEN_LF;
+    }
+    return line;
+}
+
 static PyObject *
 textiowrapper_iternext(textio *self)
 {
@@ -2974,7 +3221,17 @@ textiowrapper_iternext(textio *self)
     self->telling = 0;
     if (Py_TYPE(self) == &PyTextIOWrapper_Type) {
         /* Skip method call overhead for speed */
-        line = _textiowrapper_readline(self, -1);
+        line = NULL;
+        if (self->fastlines != FASTLINES_NONE &&
+            (Py_TYPE(self->buffer) == &PyBufferedReader_Type ||
+             Py_TYPE(self->buffer) == &PyBufferedRandom_Type))
+        {
+            line = textiowrapper_fastlines_next(self);
+            if (line == NULL && PyErr_Occurred())
+                return NULL;
+        }
+        if (line == NULL)
+            line = _textiowrapper_readline(self, -1);
     }
     else {
         line = PyObject_CallMethodObjArgs((PyObject *)self,
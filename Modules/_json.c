@@ -7,7 +7,6 @@
 
 #include "Python.h"
 #include "structmember.h"
-#include "accu.h"
 
 #ifdef __GNUC__
 #define UNUSED __attribute__((__unused__))
@@ -22,6 +21,15 @@
 
 static PyTypeObject PyScannerType;
 static PyTypeObject PyEncoderType;
+static PyTypeObject PyBytesDecoderType;
+
+/* Objects often have the same keys as the previous object at the same
+   depth, as in an array of records.  The scanner remembers these keys and
+   matches them against the input before decoding a key.  After repeated
+   misses at a depth, keys are not recorded there for a while. */
+#define JSON_SHAPE_DEPTH 16
+#define JSON_SHAPE_MAX_MISSES 4
+#define JSON_SHAPE_BACKOFF 256
 
 typedef struct _PyScannerObject {
     PyObject_HEAD
@@ -32,6 +40,10 @@ typedef struct _PyScannerObject {
     PyObject *parse_int;
     PyObject *parse_constant;
     PyObject *memo;
+    Py_ssize_t depth;                   /* nesting of the objects being read */
+    PyObject *shapes[JSON_SHAPE_DEPTH]; /* keys of the last object per depth */
+    int shape_misses[JSON_SHAPE_DEPTH];
+    int shape_backoff[JSON_SHAPE_DEPTH];
 } PyScannerObject;
 
 static PyMemberDef scanner_members[] = {
@@ -93,6 +105,8 @@ void init_json(void);
 static PyObject *
 scan_once_unicode(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx, Py_ssize_t *next_idx_ptr);
 static PyObject *
+scan_once_bytes(PyScannerObject *s, const char *str, Py_ssize_t length, Py_ssize_t idx, Py_ssize_t *next_idx_ptr);
+static PyObject *
 _build_rval_index_tuple(PyObject *rval, Py_ssize_t idx);
 static PyObject *
 scanner_new(PyTypeObject *type, PyObject *args, PyObject *kwds);
@@ -106,12 +120,13 @@ static void
 encoder_dealloc(PyObject *self);
 static int
 encoder_clear(PyObject *self);
+typedef struct _JSONWriter _JSONWriter;
 static int
-encoder_listencode_list(PyEncoderObject *s, _PyAccu *acc, PyObject *seq, Py_ssize_t indent_level);
+encoder_listencode_list(PyEncoderObject *s, _JSONWriter *w, PyObject *seq, Py_ssize_t indent_level);
 static int
-encoder_listencode_obj(PyEncoderObject *s, _PyAccu *acc, PyObject *obj, Py_ssize_t indent_level);
+encoder_listencode_obj(PyEncoderObject *s, _JSONWriter *w, PyObject *obj, Py_ssize_t indent_level);
 static int
-encoder_listencode_dict(PyEncoderObject *s, _PyAccu *acc, PyObject *dct, Py_ssize_t indent_level);
+encoder_listencode_dict(PyEncoderObject *s, _JSONWriter *w, PyObject *dct, Py_ssize_t indent_level);
 static PyObject *
 _encoded_const(PyObject *obj);
 static void
@@ -672,6 +687,7 @@ static int
 scanner_traverse(PyObject *self, visitproc visit, void *arg)
 {
     PyScannerObject *s;
+    int i;
     assert(PyScanner_Check(self));
     s = (PyScannerObject *)self;
     Py_VISIT(s->object_hook);
@@ -679,6 +695,8 @@ scanner_traverse(PyObject *self, visitproc visit, void *arg)
     Py_VISIT(s->parse_float);
     Py_VISIT(s->parse_int);
     Py_VISIT(s->parse_constant);
+    for (i = 0; i < JSON_SHAPE_DEPTH; i++)
+        Py_VISIT(s->shapes[i]);
     return 0;
 }
 
@@ -686,6 +704,7 @@ static int
 scanner_clear(PyObject *self)
 {
     PyScannerObject *s;
+    int i;
     assert(PyScanner_Check(self));
     s = (PyScannerObject *)self;
     Py_CLEAR(s->object_hook);
@@ -694,9 +713,131 @@ scanner_clear(PyObject *self)
     Py_CLEAR(s->parse_int);
     Py_CLEAR(s->parse_constant);
     Py_CLEAR(s->memo);
+    for (i = 0; i < JSON_SHAPE_DEPTH; i++)
+        Py_CLEAR(s->shapes[i]);
+    return 0;
+}
+
+static int
+shape_key_is_plain(PyObject *key)
+{
+    /* Only keys written without escapes in any input can be matched */
+    const Py_UCS1 *data;
+    Py_ssize_t i, n;
+    if (!PyUnicode_IS_ASCII(key))
+        return 0;
+    data = PyUnicode_1BYTE_DATA(key);
+    n = PyUnicode_GET_LENGTH(key);
+    for (i = 0; i < n; i++) {
+        if (data[i] == '"' || data[i] == '\\' || data[i] < ' ')
+            return 0;
+    }
+    return 1;
+}
+
+static int
+scanner_track_shape(PyScannerObject *s, Py_ssize_t depth)
+{
+    /* Return 1 if the keys of an object read at depth should be recorded */
+    if (depth >= JSON_SHAPE_DEPTH)
+        return 0;
+    if (s->shape_backoff[depth] > 0) {
+        s->shape_backoff[depth]--;
+        return 0;
+    }
+    return 1;
+}
+
+static int
+scanner_set_shape(PyScannerObject *s, Py_ssize_t depth, PyObject *keys)
+{
+    /* Remember the list of keys of an object read at depth */
+    PyObject *shape;
+    Py_ssize_t i;
+    if (++s->shape_misses[depth] >= JSON_SHAPE_MAX_MISSES) {
+        s->shape_misses[depth] = 0;
+        s->shape_backoff[depth] = JSON_SHAPE_BACKOFF;
+        Py_CLEAR(s->shapes[depth]);
+        return 0;
+    }
+    for (i = 0; i < PyList_GET_SIZE(keys); i++) {
+        if (!shape_key_is_plain(PyList_GET_ITEM(keys, i))) {
+            Py_CLEAR(s->shapes[depth]);
+            return 0;
+        }
+    }
+    shape = PyList_AsTuple(keys);
+    if (shape == NULL)
+        return -1;
+    Py_XSETREF(s->shapes[depth], shape);
     return 0;
 }
 
+static PyObject *
+scanner_get_shape(PyScannerObject *s, Py_ssize_t depth)
+{
+    /* Return a new reference to the keys expected at depth, or NULL */
+    PyObject *shape = depth < JSON_SHAPE_DEPTH ? s->shapes[depth] : NULL;
+    Py_XINCREF(shape);
+    return shape;
+}
+
+static int
+shape_add_key(PyObject **keys_ptr, PyObject *shape, Py_ssize_t nkeys, PyObject *key)
+{
+    /* Append key to the keys of an object which differ from the shape.
+       The first call copies the nkeys keys matched before. */
+    if (*keys_ptr == NULL) {
+        Py_ssize_t i;
+        *keys_ptr = PyList_New(nkeys);
+        if (*keys_ptr == NULL)
+            return -1;
+        for (i = 0; i < nkeys; i++) {
+            PyObject *k = PyTuple_GET_ITEM(shape, i);
+            Py_INCREF(k);
+            PyList_SET_ITEM(*keys_ptr, i, k);
+        }
+    }
+    return PyList_Append(*keys_ptr, key);
+}
+
+static int
+match_key_unicode(int kind, const void *str, Py_ssize_t end_idx, Py_ssize_t idx,
+                  PyObject *key, Py_ssize_t *next_idx_ptr)
+{
+    /* Return 1 if the string whose quote is at idx is the plain key */
+    Py_ssize_t i, n = PyUnicode_GET_LENGTH(key);
+    const Py_UCS1 *data = PyUnicode_1BYTE_DATA(key);
+    if (idx + n + 1 > end_idx || PyUnicode_READ(kind, str, idx) != '"' ||
+            PyUnicode_READ(kind, str, idx + n + 1) != '"')
+        return 0;
+    if (kind == PyUnicode_1BYTE_KIND) {
+        if (memcmp((const Py_UCS1 *)str + idx + 1, data, n) != 0)
+            return 0;
+    }
+    else {
+        for (i = 0; i < n; i++) {
+            if (PyUnicode_READ(kind, str, idx + 1 + i) != data[i])
+                return 0;
+        }
+    }
+    *next_idx_ptr = idx + n + 2;
+    return 1;
+}
+
+static int
+match_key_bytes(const char *str, Py_ssize_t len, Py_ssize_t idx,
+                PyObject *key, Py_ssize_t *next_idx_ptr)
+{
+    /* Return 1 if the string whose quote is at idx is the plain key */
+    Py_ssize_t n = PyUnicode_GET_LENGTH(key);
+    if (idx + n + 1 >= len || str[idx] != '"' || str[idx + n + 1] != '"' ||
+            memcmp(str + idx + 1, PyUnicode_1BYTE_DATA(key), n) != 0)
+        return 0;
+    *next_idx_ptr = idx + n + 2;
+    return 1;
+}
+
 static PyObject *
 _parse_object_unicode(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx, Py_ssize_t *next_idx_ptr)
 {
@@ -715,9 +856,14 @@ _parse_object_unicode(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx, Py_ss
     PyObject *key = NULL;
     int has_pairs_hook = (s->object_pairs_hook != Py_None);
     Py_ssize_t next_idx;
+    Py_ssize_t depth = s->depth - 1;
+    int track = scanner_track_shape(s, depth);
+    PyObject *shape = track ? scanner_get_shape(s, depth) : NULL;
+    PyObject *keys = NULL;
+    Py_ssize_t nkeys = 0;
 
     if (PyUnicode_READY(pystr) == -1)
-        return NULL;
+        goto bail;
 
     str = PyUnicode_DATA(pystr);
     kind = PyUnicode_KIND(pystr);
@@ -725,10 +871,12 @@ _parse_object_unicode(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx, Py_ss
 
     if (has_pairs_hook)
         rval = PyList_New(0);
+    else if (shape != NULL)
+        rval = _PyDict_NewPresized(PyTuple_GET_SIZE(shape));
     else
         rval = PyDict_New();
     if (rval == NULL)
-        return NULL;
+        goto bail;
 
     /* skip whitespace after { */
     while (idx <= end_idx && IS_WHITESPACE(PyUnicode_READ(kind,str, idx))) idx++;
@@ -738,24 +886,36 @@ _parse_object_unicode(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx, Py_ss
         while (1) {
             PyObject *memokey;
 
-            /* read key */
-            if (idx > end_idx || PyUnicode_READ(kind, str, idx) != '"') {
-                raise_errmsg("Expecting property name enclosed in double quotes", pystr, idx);
-                goto bail;
-            }
-            key = scanstring_unicode(pystr, idx + 1, s->strict, &next_idx);
-            if (key == NULL)
-                goto bail;
-            memokey = PyDict_GetItem(s->memo, key);
-            if (memokey != NULL) {
-                Py_INCREF(memokey);
-                Py_DECREF(key);
-                key = memokey;
+            /* read key, which is likely the next key of the shape */
+            if (keys == NULL && shape != NULL &&
+                nkeys < PyTuple_GET_SIZE(shape) &&
+                match_key_unicode(kind, str, end_idx, idx,
+                                  PyTuple_GET_ITEM(shape, nkeys), &next_idx)) {
+                key = PyTuple_GET_ITEM(shape, nkeys);
+                Py_INCREF(key);
             }
             else {
-                if (PyDict_SetItem(s->memo, key, key) < 0)
+                if (idx > end_idx || PyUnicode_READ(kind, str, idx) != '"') {
+                    raise_errmsg("Expecting property name enclosed in double quotes", pystr, idx);
+                    goto bail;
+                }
+                key = scanstring_unicode(pystr, idx + 1, s->strict, &next_idx);
+                if (key == NULL)
+                    goto bail;
+                memokey = PyDict_GetItem(s->memo, key);
+                if (memokey != NULL) {
+                    Py_INCREF(memokey);
+                    Py_DECREF(key);
+                    key = memokey;
+                }
+                else {
+                    if (PyDict_SetItem(s->memo, key, key) < 0)
+                        goto bail;
+                }
+                if (track && shape_add_key(&keys, shape, nkeys, key) < 0)
                     goto bail;
             }
+            nkeys++;
             idx = next_idx;
 
             /* skip whitespace between key and : delimiter, read :, skip whitespace */
@@ -811,6 +971,17 @@ _parse_object_unicode(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx, Py_ss
 
     *next_idx_ptr = idx + 1;
 
+    if (keys != NULL) {
+        /* the keys differ from the shape: they are the new shape */
+        if (scanner_set_shape(s, depth, keys) < 0)
+            goto bail;
+        Py_CLEAR(keys);
+    }
+    else if (shape != NULL && nkeys > 0) {
+        s->shape_misses[depth] = 0;
+    }
+    Py_XDECREF(shape);
+
     if (has_pairs_hook) {
         val = PyObject_CallFunctionObjArgs(s->object_pairs_hook, rval, NULL);
         Py_DECREF(rval);
@@ -825,6 +996,8 @@ _parse_object_unicode(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx, Py_ss
     }
     return rval;
 bail:
+    Py_XDECREF(shape);
+    Py_XDECREF(keys);
     Py_XDECREF(key);
     Py_XDECREF(val);
     Py_XDECREF(rval);
@@ -1089,7 +1262,9 @@ scan_once_unicode(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx, Py_ssize_
             if (Py_EnterRecursiveCall(" while decoding a JSON object "
                                       "from a unicode string"))
                 return NULL;
+            s->depth++;
             res = _parse_object_unicode(s, pystr, idx + 1, next_idx_ptr);
+            s->depth--;
             Py_LeaveRecursiveCall();
             return res;
         case '[':
@@ -1161,120 +1336,1209 @@ scan_once_unicode(PyScannerObject *s, PyObject *pystr, Py_ssize_t idx, Py_ssize_
     return _match_number_unicode(s, pystr, idx, next_idx_ptr);
 }
 
-static PyObject *
-scanner_call(PyObject *self, PyObject *args, PyObject *kwds)
+/* Decoding of UTF-8 encoded bytes.  The functions below mirror the ones
+   working on str above, but read the document directly from a char buffer
+   of known length, so that no intermediate str is built. */
+
+static void
+raise_errmsg_bytes(const char *msg, const char *str, Py_ssize_t len, Py_ssize_t end)
 {
-    /* Python callable interface to scan_once_{str,unicode} */
-    PyObject *pystr;
-    PyObject *rval;
-    Py_ssize_t idx;
-    Py_ssize_t next_idx = -1;
-    static char *kwlist[] = {"string", "idx", NULL};
-    PyScannerObject *s;
-    assert(PyScanner_Check(self));
-    s = (PyScannerObject *)self;
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "On:scan_once", kwlist, &pystr, &idx))
-        return NULL;
+    /* Like raise_errmsg(), the document being the UTF-8 buffer str and end
+       a byte offset into it */
+    PyObject *doc;
+    PyObject *prefix;
+    doc = PyUnicode_DecodeUTF8(str, len, "replace");
+    if (doc == NULL)
+        return;
+    prefix = PyUnicode_DecodeUTF8(str, Py_MIN(end, len), "replace");
+    if (prefix == NULL) {
+        Py_DECREF(doc);
+        return;
+    }
+    raise_errmsg(msg, doc, PyUnicode_GET_LENGTH(prefix));
+    Py_DECREF(prefix);
+    Py_DECREF(doc);
+}
 
-    if (PyUnicode_Check(pystr)) {
-        rval = scan_once_unicode(s, pystr, idx, &next_idx);
-    }
-    else {
-        PyErr_Format(PyExc_TypeError,
-                 "first argument must be a string, not %.80s",
-                 Py_TYPE(pystr)->tp_name);
-        return NULL;
+static int
+decode_hex4(const char *p)
+{
+    /* Return the value of the 4 hex digits at p, or -1 */
+    int c = 0;
+    int i;
+    for (i = 0; i < 4; i++) {
+        char digit = p[i];
+        c <<= 4;
+        if (digit >= '0' && digit <= '9')
+            c |= digit - '0';
+        else if (digit >= 'a' && digit <= 'f')
+            c |= digit - 'a' + 10;
+        else if (digit >= 'A' && digit <= 'F')
+            c |= digit - 'A' + 10;
+        else
+            return -1;
     }
-    PyDict_Clear(s->memo);
-    if (rval == NULL)
-        return NULL;
-    return _build_rval_index_tuple(rval, next_idx);
+    return c;
 }
 
 static PyObject *
-scanner_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+scanstring_bytes(const char *str, Py_ssize_t len, Py_ssize_t end, int strict, Py_ssize_t *next_end_ptr)
 {
-    PyScannerObject *s;
-    PyObject *ctx;
-    PyObject *strict;
-    static char *kwlist[] = {"context", NULL};
+    /* Read the JSON string from the UTF-8 buffer str of len bytes.
+    end is the index of the first byte after the quote.
+    if strict is zero then literal control characters are allowed
+    *next_end_ptr is a return-by-reference index of the byte
+        after the end quote
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O:make_scanner", kwlist, &ctx))
-        return NULL;
+    Return value is a new PyUnicode
+    */
+    _PyUnicodeWriter writer;
+    PyObject *chunk;
+    Py_ssize_t begin = end - 1;
+    Py_ssize_t next;
+    int escaped = 0;
 
-    s = (PyScannerObject *)type->tp_alloc(type, 0);
-    if (s == NULL) {
-        return NULL;
+    _PyUnicodeWriter_Init(&writer);
+    writer.overallocate = 1;
+    while (1) {
+        /* Find the end of the string or the next escape */
+        unsigned char c = 0;
+        Py_UCS4 uc;
+        for (next = end; next < len; next++) {
+            c = (unsigned char)str[next];
+            if (c == '"' || c == '\\') {
+                break;
+            }
+            else if (strict && c <= 0x1f) {
+                raise_errmsg_bytes("Invalid control character at", str, len, next);
+                goto bail;
+            }
+        }
+        if (next == len) {
+            raise_errmsg_bytes("Unterminated string starting at", str, len, begin);
+            goto bail;
+        }
+        if (c == '"' && !escaped) {
+            /* No escape: decode the string at once */
+            *next_end_ptr = next + 1;
+            return PyUnicode_DecodeUTF8(str + end, next - end, "surrogatepass");
+        }
+        escaped = 1;
+        /* Pick up this chunk if it's not zero length */
+        if (next != end) {
+            chunk = PyUnicode_DecodeUTF8(str + end, next - end, "surrogatepass");
+            if (chunk == NULL)
+                goto bail;
+            if (_PyUnicodeWriter_WriteStr(&writer, chunk) < 0) {
+                Py_DECREF(chunk);
+                goto bail;
+            }
+            Py_DECREF(chunk);
+        }
+        next++;
+        if (c == '"') {
+            end = next;
+            break;
+        }
+        if (next == len) {
+            raise_errmsg_bytes("Unterminated string starting at", str, len, begin);
+            goto bail;
+        }
+        c = (unsigned char)str[next];
+        if (c != 'u') {
+            /* Non-unicode backslash escapes */
+            end = next + 1;
+            switch (c) {
+                case '"': break;
+                case '\\': break;
+                case '/': break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                default: c = 0;
+            }
+            if (c == 0) {
+                raise_errmsg_bytes("Invalid \\escape", str, len, end - 2);
+                goto bail;
+            }
+            uc = c;
+        }
+        else {
+            int digits;
+            next++;
+            end = next + 4;
+            if (end >= len) {
+                raise_errmsg_bytes("Invalid \\uXXXX escape", str, len, next - 1);
+                goto bail;
+            }
+            digits = decode_hex4(str + next);
+            if (digits < 0) {
+                raise_errmsg_bytes("Invalid \\uXXXX escape", str, len, end - 5);
+                goto bail;
+            }
+            uc = digits;
+            /* Surrogate pair */
+            if (Py_UNICODE_IS_HIGH_SURROGATE(uc) && end + 6 < len &&
+                str[end] == '\\' && str[end + 1] == 'u') {
+                digits = decode_hex4(str + end + 2);
+                if (digits < 0) {
+                    raise_errmsg_bytes("Invalid \\uXXXX escape", str, len, end + 1);
+                    goto bail;
+                }
+                if (Py_UNICODE_IS_LOW_SURROGATE(digits)) {
+                    uc = Py_UNICODE_JOIN_SURROGATES(uc, digits);
+                    end += 6;
+                }
+            }
+        }
+        if (_PyUnicodeWriter_WriteChar(&writer, uc) < 0)
+            goto bail;
     }
 
-    s->memo = PyDict_New();
-    if (s->memo == NULL)
-        goto bail;
+    *next_end_ptr = end;
+    return _PyUnicodeWriter_Finish(&writer);
+bail:
+    *next_end_ptr = -1;
+    _PyUnicodeWriter_Dealloc(&writer);
+    return NULL;
+}
 
-    /* All of these will fail "gracefully" so we don't need to verify them */
-    strict = PyObject_GetAttrString(ctx, "strict");
-    if (strict == NULL)
-        goto bail;
-    s->strict = PyObject_IsTrue(strict);
-    Py_DECREF(strict);
-    if (s->strict < 0)
-        goto bail;
-    s->object_hook = PyObject_GetAttrString(ctx, "object_hook");
-    if (s->object_hook == NULL)
-        goto bail;
-    s->object_pairs_hook = PyObject_GetAttrString(ctx, "object_pairs_hook");
-    if (s->object_pairs_hook == NULL)
-        goto bail;
-    s->parse_float = PyObject_GetAttrString(ctx, "parse_float");
-    if (s->parse_float == NULL)
-        goto bail;
-    s->parse_int = PyObject_GetAttrString(ctx, "parse_int");
-    if (s->parse_int == NULL)
-        goto bail;
-    s->parse_constant = PyObject_GetAttrString(ctx, "parse_constant");
-    if (s->parse_constant == NULL)
+static PyObject *
+_parse_object_bytes(PyScannerObject *s, const char *str, Py_ssize_t len, Py_ssize_t idx, Py_ssize_t *next_idx_ptr)
+{
+    /* Read a JSON object from the UTF-8 buffer str of len bytes.
+    idx is the index of the first byte after the opening curly brace.
+    *next_idx_ptr is a return-by-reference index to the first byte after
+        the closing curly brace.
+
+    Returns a new PyObject (usually a dict, but object_hook can change that)
+    */
+    Py_ssize_t end_idx = len - 1;
+    PyObject *val = NULL;
+    PyObject *rval = NULL;
+    PyObject *key = NULL;
+    int has_pairs_hook = (s->object_pairs_hook != Py_None);
+    Py_ssize_t next_idx;
+    Py_ssize_t depth = s->depth - 1;
+    int track = scanner_track_shape(s, depth);
+    PyObject *shape = track ? scanner_get_shape(s, depth) : NULL;
+    PyObject *keys = NULL;
+    Py_ssize_t nkeys = 0;
+
+    if (has_pairs_hook)
+        rval = PyList_New(0);
+    else if (shape != NULL)
+        rval = _PyDict_NewPresized(PyTuple_GET_SIZE(shape));
+    else
+        rval = PyDict_New();
+    if (rval == NULL)
         goto bail;
 
-    return (PyObject *)s;
+    /* skip whitespace after { */
+    while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
 
-bail:
-    Py_DECREF(s);
-    return NULL;
-}
+    /* only loop if the object is non-empty */
+    if (idx > end_idx || str[idx] != '}') {
+        while (1) {
+            PyObject *memokey;
 
-PyDoc_STRVAR(scanner_doc, "JSON scanner object");
+            /* read key, which is likely the next key of the shape */
+            if (keys == NULL && shape != NULL &&
+                nkeys < PyTuple_GET_SIZE(shape) &&
+                match_key_bytes(str, len, idx,
+                                PyTuple_GET_ITEM(shape, nkeys), &next_idx)) {
+                key = PyTuple_GET_ITEM(shape, nkeys);
+                Py_INCREF(key);
+            }
+            else {
+                if (idx > end_idx || str[idx] != '"') {
+                    raise_errmsg_bytes("Expecting property name enclosed in double quotes", str, len, idx);
+                    goto bail;
+                }
+                key = scanstring_bytes(str, len, idx + 1, s->strict, &next_idx);
+                if (key == NULL)
+                    goto bail;
+                memokey = PyDict_GetItem(s->memo, key);
+                if (memokey != NULL) {
+                    Py_INCREF(memokey);
+                    Py_DECREF(key);
+                    key = memokey;
+                }
+                else {
+                    if (PyDict_SetItem(s->memo, key, key) < 0)
+                        goto bail;
+                }
+                if (track && shape_add_key(&keys, shape, nkeys, key) < 0)
+                    goto bail;
+            }
+            nkeys++;
+            idx = next_idx;
 
-static
-PyTypeObject PyScannerType = {
-    PyVarObject_HEAD_INIT(NULL, 0)
-    "_json.Scanner",       /* tp_name */
-    sizeof(PyScannerObject), /* tp_basicsize */
-    0,                    /* tp_itemsize */
-    scanner_dealloc, /* tp_dealloc */
-    0,                    /* tp_print */
-    0,                    /* tp_getattr */
-    0,                    /* tp_setattr */
+            /* skip whitespace between key and : delimiter, read :, skip whitespace */
+            while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
+            if (idx > end_idx || str[idx] != ':') {
+                raise_errmsg_bytes("Expecting ':' delimiter", str, len, idx);
+                goto bail;
+            }
+            idx++;
+            while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
+
+            /* read any JSON term */
+            val = scan_once_bytes(s, str, len, idx, &next_idx);
+            if (val == NULL)
+                goto bail;
+
+            if (has_pairs_hook) {
+                PyObject *item = PyTuple_Pack(2, key, val);
+                if (item == NULL)
+                    goto bail;
+                Py_CLEAR(key);
+                Py_CLEAR(val);
+                if (PyList_Append(rval, item) == -1) {
+                    Py_DECREF(item);
+                    goto bail;
+                }
+                Py_DECREF(item);
+            }
+            else {
+                if (PyDict_SetItem(rval, key, val) < 0)
+                    goto bail;
+                Py_CLEAR(key);
+                Py_CLEAR(val);
+            }
+            idx = next_idx;
+
+            /* skip whitespace before } or , */
+            while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
+
+            /* bail if the object is closed or we didn't get the , delimiter */
+            if (idx <= end_idx && str[idx] == '}')
+                break;
+            if (idx > end_idx || str[idx] != ',') {
+                raise_errmsg_bytes("Expecting ',' delimiter", str, len, idx);
+                goto bail;
+            }
+            idx++;
+
+            /* skip whitespace after , delimiter */
+            while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
+        }
+    }
+
+    *next_idx_ptr = idx + 1;
+
+    if (keys != NULL) {
+        /* the keys differ from the shape: they are the new shape */
+        if (scanner_set_shape(s, depth, keys) < 0)
+            goto bail;
+        Py_CLEAR(keys);
+    }
+    else if (shape != NULL && nkeys > 0) {
+        s->shape_misses[depth] = 0;
+    }
+    Py_XDECREF(shape);
+
+    if (has_pairs_hook) {
+        val = PyObject_CallFunctionObjArgs(s->object_pairs_hook, rval, NULL);
+        Py_DECREF(rval);
+        return val;
+    }
+
+    /* if object_hook is not None: rval = object_hook(rval) */
+    if (s->object_hook != Py_None) {
+        val = PyObject_CallFunctionObjArgs(s->object_hook, rval, NULL);
+        Py_DECREF(rval);
+        return val;
+    }
+    return rval;
+bail:
+    Py_XDECREF(shape);
+    Py_XDECREF(keys);
+    Py_XDECREF(key);
+    Py_XDECREF(val);
+    Py_XDECREF(rval);
+    return NULL;
+}
+
+static PyObject *
+_parse_array_bytes(PyScannerObject *s, const char *str, Py_ssize_t len, Py_ssize_t idx, Py_ssize_t *next_idx_ptr)
+{
+    /* Read a JSON array from the UTF-8 buffer str of len bytes.
+    idx is the index of the first byte after the opening brace.
+    *next_idx_ptr is a return-by-reference index to the first byte after
+        the closing brace.
+
+    Returns a new PyList
+    */
+    Py_ssize_t end_idx = len - 1;
+    PyObject *val = NULL;
+    PyObject *rval;
+    Py_ssize_t next_idx;
+
+    rval = PyList_New(0);
+    if (rval == NULL)
+        return NULL;
+
+    /* skip whitespace after [ */
+    while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
+
+    /* only loop if the array is non-empty */
+    if (idx > end_idx || str[idx] != ']') {
+        while (1) {
+
+            /* read any JSON term  */
+            val = scan_once_bytes(s, str, len, idx, &next_idx);
+            if (val == NULL)
+                goto bail;
+
+            if (PyList_Append(rval, val) == -1)
+                goto bail;
+
+            Py_CLEAR(val);
+            idx = next_idx;
+
+            /* skip whitespace between term and , */
+            while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
+
+            /* bail if the array is closed or we didn't get the , delimiter */
+            if (idx <= end_idx && str[idx] == ']')
+                break;
+            if (idx > end_idx || str[idx] != ',') {
+                raise_errmsg_bytes("Expecting ',' delimiter", str, len, idx);
+                goto bail;
+            }
+            idx++;
+
+            /* skip whitespace after , */
+            while (idx <= end_idx && IS_WHITESPACE(str[idx])) idx++;
+        }
+    }
+
+    /* verify that idx < end_idx, str[idx] should be ']' */
+    if (idx > end_idx || str[idx] != ']') {
+        raise_errmsg_bytes("Expecting value", str, len, end_idx);
+        goto bail;
+    }
+    *next_idx_ptr = idx + 1;
+    return rval;
+bail:
+    Py_XDECREF(val);
+    Py_DECREF(rval);
+    return NULL;
+}
+
+static PyObject *
+_match_number_bytes(PyScannerObject *s, const char *str, Py_ssize_t len, Py_ssize_t start, Py_ssize_t *next_idx_ptr)
+{
+    /* Read a JSON number from the UTF-8 buffer str of len bytes.
+    start is the index of the first byte of the number
+    *next_idx_ptr is a return-by-reference index to the first byte after
+        the number.
+
+    Returns a new PyObject representation of that number:
+        PyLong, or PyFloat.
+        May return other types if parse_int or parse_float are set
+    */
+    Py_ssize_t end_idx = len - 1;
+    Py_ssize_t idx = start;
+    int is_float = 0;
+    PyObject *rval;
+    PyObject *numstr;
+    PyObject *custom_func;
+
+    /* read a sign if it's there, make sure it's not the end of the string */
+    if (str[idx] == '-') {
+        idx++;
+        if (idx > end_idx) {
+            raise_errmsg_bytes("Expecting value", str, len, start);
+            return NULL;
+        }
+    }
+
+    /* read as many integer digits as we find as long as it doesn't start with 0 */
+    if (str[idx] >= '1' && str[idx] <= '9') {
+        idx++;
+        while (idx <= end_idx && str[idx] >= '0' && str[idx] <= '9') idx++;
+    }
+    /* if it starts with 0 we only expect one integer digit */
+    else if (str[idx] == '0') {
+        idx++;
+    }
+    /* no integer digits, error */
+    else {
+        raise_errmsg_bytes("Expecting value", str, len, start);
+        return NULL;
+    }
+
+    /* if the next char is '.' followed by a digit then read all float digits */
+    if (idx < end_idx && str[idx] == '.' && str[idx + 1] >= '0' && str[idx + 1] <= '9') {
+        is_float = 1;
+        idx += 2;
+        while (idx <= end_idx && str[idx] >= '0' && str[idx] <= '9') idx++;
+    }
+
+    /* if the next char is 'e' or 'E' then maybe read the exponent (or backtrack) */
+    if (idx < end_idx && (str[idx] == 'e' || str[idx] == 'E')) {
+        Py_ssize_t e_start = idx;
+        idx++;
+
+        /* read an exponent sign if present */
+        if (idx < end_idx && (str[idx] == '-' || str[idx] == '+')) idx++;
+
+        /* read all digits */
+        while (idx <= end_idx && str[idx] >= '0' && str[idx] <= '9') idx++;
+
+        /* if we got a digit, then parse as float. if not, backtrack */
+        if (str[idx - 1] >= '0' && str[idx - 1] <= '9') {
+            is_float = 1;
+        }
+        else {
+            idx = e_start;
+        }
+    }
+
+    if (is_float && s->parse_float != (PyObject *)&PyFloat_Type)
+        custom_func = s->parse_float;
+    else if (!is_float && s->parse_int != (PyObject *) &PyLong_Type)
+        custom_func = s->parse_int;
+    else
+        custom_func = NULL;
+
+    *next_idx_ptr = idx;
+    if (custom_func) {
+        /* copy the section we determined to be a number */
+        numstr = PyUnicode_DecodeASCII(str + start, idx - start, NULL);
+        if (numstr == NULL)
+            return NULL;
+        rval = PyObject_CallFunctionObjArgs(custom_func, numstr, NULL);
+    }
+    else if (!is_float && idx - start <= 18) {
+        /* Small integers fit in a long long */
+        long long value = 0;
+        Py_ssize_t i = (str[start] == '-') ? start + 1 : start;
+        for (; i < idx; i++)
+            value = value * 10 + (str[i] - '0');
+        return PyLong_FromLongLong(str[start] == '-' ? -value : value);
+    }
+    else {
+        numstr = PyBytes_FromStringAndSize(str + start, idx - start);
+        if (numstr == NULL)
+            return NULL;
+        if (is_float)
+            rval = PyFloat_FromString(numstr);
+        else
+            rval = PyLong_FromString(PyBytes_AS_STRING(numstr), NULL, 10);
+    }
+    Py_DECREF(numstr);
+    return rval;
+}
+
+static PyObject *
+scan_once_bytes(PyScannerObject *s, const char *str, Py_ssize_t length, Py_ssize_t idx, Py_ssize_t *next_idx_ptr)
+{
+    /* Read one JSON term (of any kind) from the UTF-8 buffer str of length
+    bytes.
+    idx is the index of the first byte of the term
+    *next_idx_ptr is a return-by-reference index to the first byte after
+        the term.
+
+    Returns a new PyObject representation of the term.
+    */
+    PyObject *res;
+
+    if (idx >= length) {
+        raise_errmsg_bytes("Expecting value", str, length, idx);
+        return NULL;
+    }
+
+    switch (str[idx]) {
+        case '"':
+            /* string */
+            return scanstring_bytes(str, length, idx + 1, s->strict, next_idx_ptr);
+        case '{':
+            /* object */
+            if (Py_EnterRecursiveCall(" while decoding a JSON object "
+                                      "from a bytes object"))
+                return NULL;
+            s->depth++;
+            res = _parse_object_bytes(s, str, length, idx + 1, next_idx_ptr);
+            s->depth--;
+            Py_LeaveRecursiveCall();
+            return res;
+        case '[':
+            /* array */
+            if (Py_EnterRecursiveCall(" while decoding a JSON array "
+                                      "from a bytes object"))
+                return NULL;
+            res = _parse_array_bytes(s, str, length, idx + 1, next_idx_ptr);
+            Py_LeaveRecursiveCall();
+            return res;
+        case 'n':
+            /* null */
+            if ((idx + 3 < length) && memcmp(str + idx + 1, "ull", 3) == 0) {
+                *next_idx_ptr = idx + 4;
+                Py_RETURN_NONE;
+            }
+            break;
+        case 't':
+            /* true */
+            if ((idx + 3 < length) && memcmp(str + idx + 1, "rue", 3) == 0) {
+                *next_idx_ptr = idx + 4;
+                Py_RETURN_TRUE;
+            }
+            break;
+        case 'f':
+            /* false */
+            if ((idx + 4 < length) && memcmp(str + idx + 1, "alse", 4) == 0) {
+                *next_idx_ptr = idx + 5;
+                Py_RETURN_FALSE;
+            }
+            break;
+        case 'N':
+            /* NaN */
+            if ((idx + 2 < length) && memcmp(str + idx + 1, "aN", 2) == 0) {
+                return _parse_constant(s, "NaN", idx, next_idx_ptr);
+            }
+            break;
+        case 'I':
+            /* Infinity */
+            if ((idx + 7 < length) && memcmp(str + idx + 1, "nfinity", 7) == 0) {
+                return _parse_constant(s, "Infinity", idx, next_idx_ptr);
+            }
+            break;
+        case '-':
+            /* -Infinity */
+            if ((idx + 8 < length) && memcmp(str + idx + 1, "Infinity", 8) == 0) {
+                return _parse_constant(s, "-Infinity", idx, next_idx_ptr);
+            }
+            break;
+    }
+    /* Didn't find a string, object, array, or named constant. Look for a number. */
+    return _match_number_bytes(s, str, length, idx, next_idx_ptr);
+}
+
+static PyObject *
+scanner_call(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    /* Python callable interface to scan_once_{str,unicode} */
+    PyObject *pystr;
+    PyObject *rval;
+    Py_ssize_t idx;
+    Py_ssize_t next_idx = -1;
+    static char *kwlist[] = {"string", "idx", NULL};
+    PyScannerObject *s;
+    assert(PyScanner_Check(self));
+    s = (PyScannerObject *)self;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "On:scan_once", kwlist, &pystr, &idx))
+        return NULL;
+
+    if (PyUnicode_Check(pystr)) {
+        rval = scan_once_unicode(s, pystr, idx, &next_idx);
+    }
+    else {
+        PyErr_Format(PyExc_TypeError,
+                 "first argument must be a string, not %.80s",
+                 Py_TYPE(pystr)->tp_name);
+        return NULL;
+    }
+    PyDict_Clear(s->memo);
+    if (rval == NULL)
+        return NULL;
+    return _build_rval_index_tuple(rval, next_idx);
+}
+
+static PyObject *
+scanner_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyScannerObject *s;
+    PyObject *ctx;
+    PyObject *strict;
+    static char *kwlist[] = {"context", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O:make_scanner", kwlist, &ctx))
+        return NULL;
+
+    s = (PyScannerObject *)type->tp_alloc(type, 0);
+    if (s == NULL) {
+        return NULL;
+    }
+
+    s->memo = PyDict_New();
+    if (s->memo == NULL)
+        goto bail;
+
+    /* All of these will fail "gracefully" so we don't need to verify them */
+    strict = PyObject_GetAttrString(ctx, "strict");
+    if (strict == NULL)
+        goto bail;
+    s->strict = PyObject_IsTrue(strict);
+    Py_DECREF(strict);
+    if (s->strict < 0)
+        goto bail;
+    s->object_hook = PyObject_GetAttrString(ctx, "object_hook");
+    if (s->object_hook == NULL)
+        goto bail;
+    s->object_pairs_hook = PyObject_GetAttrString(ctx, "object_pairs_hook");
+    if (s->object_pairs_hook == NULL)
+        goto bail;
+    s->parse_float = PyObject_GetAttrString(ctx, "parse_float");
+    if (s->parse_float == NULL)
+        goto bail;
+    s->parse_int = PyObject_GetAttrString(ctx, "parse_int");
+    if (s->parse_int == NULL)
+        goto bail;
+    s->parse_constant = PyObject_GetAttrString(ctx, "parse_constant");
+    if (s->parse_constant == NULL)
+        goto bail;
+
+    return (PyObject *)s;
+
+bail:
+    Py_DECREF(s);
+    return NULL;
+}
+
+PyDoc_STRVAR(scanner_doc, "JSON scanner object");
+
+static
+PyTypeObject PyScannerType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_json.Scanner",       /* tp_name */
+    sizeof(PyScannerObject), /* tp_basicsize */
+    0,                    /* tp_itemsize */
+    scanner_dealloc, /* tp_dealloc */
+    0,                    /* tp_print */
+    0,                    /* tp_getattr */
+    0,                    /* tp_setattr */
+    0,                    /* tp_compare */
+    0,                    /* tp_repr */
+    0,                    /* tp_as_number */
+    0,                    /* tp_as_sequence */
+    0,                    /* tp_as_mapping */
+    0,                    /* tp_hash */
+    scanner_call,         /* tp_call */
+    0,                    /* tp_str */
+    0,/* PyObject_GenericGetAttr, */                    /* tp_getattro */
+    0,/* PyObject_GenericSetAttr, */                    /* tp_setattro */
+    0,                    /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,   /* tp_flags */
+    scanner_doc,          /* tp_doc */
+    scanner_traverse,                    /* tp_traverse */
+    scanner_clear,                    /* tp_clear */
+    0,                    /* tp_richcompare */
+    0,                    /* tp_weaklistoffset */
+    0,                    /* tp_iter */
+    0,                    /* tp_iternext */
+    0,                    /* tp_methods */
+    scanner_members,                    /* tp_members */
+    0,                    /* tp_getset */
+    0,                    /* tp_base */
+    0,                    /* tp_dict */
+    0,                    /* tp_descr_get */
+    0,                    /* tp_descr_set */
+    0,                    /* tp_dictoffset */
+    0,                    /* tp_init */
+    0,/* PyType_GenericAlloc, */        /* tp_alloc */
+    scanner_new,          /* tp_new */
+    0,/* PyObject_GC_Del, */              /* tp_free */
+};
+
+/* Incremental decoder: splits a stream of UTF-8 bytes fed in chunks of any
+   size into complete JSON values, and decodes each of them once with
+   scan_once_bytes().  Only the bytes of the value being read are kept
+   between two chunks. */
+
+enum {
+    ITEMS_START,    /* expecting the opening bracket */
+    ITEMS_FIRST,    /* expecting the first element or the closing bracket */
+    ITEMS_NEXT,     /* expecting an element after a comma */
+    ITEMS_AFTER,    /* expecting a comma or the closing bracket */
+    ITEMS_END       /* the array is closed */
+};
+
+typedef struct _PyBytesDecoderObject {
+    PyObject_HEAD
+    PyScannerObject *scanner;
+    PyObject *values;           /* decoded values not returned yet */
+    char *buf;                  /* pending bytes of the previous chunks */
+    Py_ssize_t buf_len;
+    Py_ssize_t buf_size;
+    Py_ssize_t pos;             /* scan position in the pending bytes */
+    Py_ssize_t value_start;     /* start of the current value, or -1 */
+    Py_ssize_t consumed;        /* bytes which are no longer needed */
+    char *stack;                /* brackets opened by the current value */
+    Py_ssize_t depth;
+    Py_ssize_t stack_size;
+    char items;
+    char state;
+    char in_string;
+    char escape;
+    char in_scalar;
+    char started;
+    char closed;
+    char busy;
+} PyBytesDecoderObject;
+
+static PyMemberDef bytes_decoder_members[] = {
+    {"items", T_BOOL, offsetof(PyBytesDecoderObject, items), READONLY, "items"},
+    {NULL}
+};
+
+/* Bytes which open or close a string, an array or an object */
+static const char json_structural[256] = {
+    ['"'] = 1, ['['] = 1, [']'] = 1, ['{'] = 1, ['}'] = 1,
+};
+
+#define IS_SCALAR_END(c) \
+    (IS_WHITESPACE(c) || json_structural[(unsigned char)(c)] || (c) == ',')
+
+static int
+bytes_decoder_emit(PyBytesDecoderObject *s, const char *data, Py_ssize_t end)
+{
+    /* Decode the value between value_start and end, and consume it even if
+       it is invalid so that decoding can go on after it */
+    const char *str = data + s->value_start;
+    Py_ssize_t len = end - s->value_start;
+    Py_ssize_t next_idx;
+    PyObject *val;
+    int rc;
+
+    s->value_start = -1;
+    s->consumed = end;
+    s->depth = 0;
+    s->in_string = s->escape = s->in_scalar = 0;
+    if (s->items)
+        s->state = ITEMS_AFTER;
+
+    val = scan_once_bytes(s->scanner, str, len, 0, &next_idx);
+    if (val == NULL)
+        return -1;
+    if (next_idx != len) {
+        Py_DECREF(val);
+        raise_errmsg_bytes("Extra data", str, len, next_idx);
+        return -1;
+    }
+    rc = PyList_Append(s->values, val);
+    Py_DECREF(val);
+    return rc;
+}
+
+static int
+bytes_decoder_push(PyBytesDecoderObject *s, char c)
+{
+    if (s->depth == s->stack_size) {
+        Py_ssize_t size = s->stack_size ? s->stack_size * 2 : 32;
+        char *stack = PyMem_Realloc(s->stack, size);
+        if (stack == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        s->stack = stack;
+        s->stack_size = size;
+    }
+    s->stack[s->depth++] = c;
+    return 0;
+}
+
+static int
+bytes_decoder_scan(PyBytesDecoderObject *s, const char *data, Py_ssize_t len)
+{
+    /* Decode the values which end before len */
+    Py_ssize_t pos = s->pos;
+    const char *msg;
+    char c;
+    int rc = 0;
+
+    while (pos < len) {
+        if (s->value_start < 0) {
+            /* between two values */
+            c = data[pos];
+            if (IS_WHITESPACE(c)) {
+                pos++;
+                continue;
+            }
+            if (s->items) {
+                if (s->state == ITEMS_START) {
+                    if (c != '[') {
+                        msg = "Expecting JSON array";
+                        goto framing_error;
+                    }
+                    s->state = ITEMS_FIRST;
+                    pos++;
+                    continue;
+                }
+                if (c == ']' &&
+                    (s->state == ITEMS_FIRST || s->state == ITEMS_AFTER)) {
+                    s->state = ITEMS_END;
+                    pos++;
+                    continue;
+                }
+                if (s->state == ITEMS_AFTER) {
+                    if (c != ',') {
+                        msg = "Expecting ',' delimiter";
+                        goto framing_error;
+                    }
+                    s->state = ITEMS_NEXT;
+                    pos++;
+                    continue;
+                }
+                if (s->state == ITEMS_END) {
+                    msg = "Extra data";
+                    goto framing_error;
+                }
+            }
+            if (c == ']' || c == '}' || c == ',') {
+                msg = "Expecting value";
+                goto framing_error;
+            }
+            s->value_start = pos++;
+            if (c == '"') {
+                s->in_string = 1;
+            }
+            else if (c == '[' || c == '{') {
+                if (bytes_decoder_push(s, c) < 0)
+                    goto error;
+            }
+            else {
+                s->in_scalar = 1;
+            }
+        }
+        else if (s->in_string) {
+            if (s->escape) {
+                s->escape = 0;
+                pos++;
+            }
+            for (; pos < len; pos++) {
+                c = data[pos];
+                if (c == '"')
+                    break;
+                if (c == '\\' && ++pos == len) {
+                    s->escape = 1;
+                    break;
+                }
+            }
+            if (pos >= len)
+                break;
+            s->in_string = 0;
+            pos++;
+            if (s->depth == 0 && bytes_decoder_emit(s, data, pos) < 0)
+                goto error;
+        }
+        else if (s->in_scalar) {
+            while (pos < len && !IS_SCALAR_END(data[pos]))
+                pos++;
+            if (pos == len)
+                break;
+            if (bytes_decoder_emit(s, data, pos) < 0)
+                goto error;
+        }
+        else {
+            /* inside an array or an object */
+            while (pos < len && !json_structural[(unsigned char)data[pos]])
+                pos++;
+            if (pos == len)
+                break;
+            c = data[pos++];
+            if (c == '"') {
+                s->in_string = 1;
+                continue;
+            }
+            if (c == '[' || c == '{') {
+                if (bytes_decoder_push(s, c) < 0)
+                    goto error;
+                continue;
+            }
+            if (s->stack[s->depth - 1] == (c == ']' ? '[' : '{'))
+                s->depth--;
+            else
+                /* mismatched bracket, left to the parser to report */
+                s->depth = 0;
+            if (s->depth == 0 && bytes_decoder_emit(s, data, pos) < 0)
+                goto error;
+        }
+    }
+    goto done;
+
+framing_error:
+    raise_errmsg_bytes(msg, data + s->consumed, pos + 1 - s->consumed,
+                       pos - s->consumed);
+    pos++;
+error:
+    rc = -1;
+done:
+    s->pos = pos;
+    s->consumed = (s->value_start >= 0) ? s->value_start : pos;
+    return rc;
+}
+
+static int
+bytes_decoder_finish(PyBytesDecoderObject *s, const char *data, Py_ssize_t len)
+{
+    /* Decode the value left at the end of the stream */
+    if (s->value_start >= 0) {
+        /* an incomplete array, object or string fails to decode */
+        int rc = bytes_decoder_emit(s, data, len);
+        s->pos = s->consumed = len;
+        if (rc < 0)
+            return -1;
+    }
+    if (s->items && s->state != ITEMS_END) {
+        raise_errmsg_bytes(s->state == ITEMS_AFTER ?
+                           "Expecting ',' delimiter" : "Expecting value",
+                           data + s->consumed, len - s->consumed,
+                           len - s->consumed);
+        return -1;
+    }
+    return 0;
+}
+
+static int
+bytes_decoder_reserve(PyBytesDecoderObject *s, Py_ssize_t size)
+{
+    char *buf;
+    if (size <= s->buf_size)
+        return 0;
+    if (size < s->buf_size * 2)
+        size = s->buf_size * 2;
+    buf = PyMem_Realloc(s->buf, size);
+    if (buf == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    s->buf = buf;
+    s->buf_size = size;
+    return 0;
+}
+
+static PyObject *
+bytes_decoder_run(PyBytesDecoderObject *s, const char *chunk, Py_ssize_t n, int final)
+{
+    const char *data;
+    Py_ssize_t len, tail;
+    PyObject *values, *rval;
+    int rc = 0;
+
+    if (s->closed) {
+        PyErr_SetString(PyExc_ValueError, "the decoder is closed");
+        return NULL;
+    }
+    if (s->busy) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "the decoder cannot be fed from a hook");
+        return NULL;
+    }
+
+    if (s->buf_len == 0) {
+        /* Nothing pending: decode the chunk in place */
+        data = chunk;
+        len = n;
+    }
+    else {
+        if (bytes_decoder_reserve(s, s->buf_len + n) < 0)
+            return NULL;
+        memcpy(s->buf + s->buf_len, chunk, n);
+        s->buf_len += n;
+        data = s->buf;
+        len = s->buf_len;
+    }
+
+    if (!s->started) {
+        /* Skip a byte order mark, which may be split across chunks */
+        if (len >= 3 || final || memcmp(data, "\xef\xbb\xbf", len) != 0) {
+            s->started = 1;
+            if (len >= 3 && memcmp(data, "\xef\xbb\xbf", 3) == 0)
+                s->pos = s->consumed = 3;
+        }
+    }
+    if (s->started) {
+        s->busy = 1;
+        rc = bytes_decoder_scan(s, data, len);
+        if (rc == 0 && final)
+            rc = bytes_decoder_finish(s, data, len);
+        s->busy = 0;
+        /* The keys are shared between the values of a chunk only */
+        PyDict_Clear(s->scanner->memo);
+    }
+
+    /* Keep the bytes of the incomplete value for the next chunk */
+    tail = len - s->consumed;
+    if (data == s->buf) {
+        memmove(s->buf, s->buf + s->consumed, tail);
+    }
+    else if (tail > 0) {
+        if (bytes_decoder_reserve(s, tail) < 0)
+            return NULL;
+        memcpy(s->buf, data + s->consumed, tail);
+    }
+    s->buf_len = tail;
+    s->pos -= s->consumed;
+    if (s->value_start >= 0)
+        s->value_start -= s->consumed;
+    s->consumed = 0;
+    if (final || (tail == 0 && s->buf_size > 65536)) {
+        PyMem_Free(s->buf);
+        s->buf = NULL;
+        s->buf_size = s->buf_len = 0;
+        s->closed = final;
+    }
+    if (rc < 0)
+        return NULL;
+
+    values = PyList_New(0);
+    if (values == NULL)
+        return NULL;
+    rval = s->values;
+    s->values = values;
+    return rval;
+}
+
+PyDoc_STRVAR(bytes_decoder_feed_doc,
+"feed(data) -> list\n"
+"\n"
+"Decode a chunk of UTF-8 encoded JSON and return the list of the values\n"
+"completed by it.  The values decoded before an error are returned by the\n"
+"next call.");
+
+static PyObject *
+bytes_decoder_feed(PyObject *self, PyObject *arg)
+{
+    PyBytesDecoderObject *s = (PyBytesDecoderObject *)self;
+    Py_buffer view;
+    PyObject *rval;
+
+    if (PyObject_GetBuffer(arg, &view, PyBUF_SIMPLE) < 0)
+        return NULL;
+    rval = bytes_decoder_run(s, view.buf, view.len, 0);
+    PyBuffer_Release(&view);
+    return rval;
+}
+
+PyDoc_STRVAR(bytes_decoder_close_doc,
+"close() -> list\n"
+"\n"
+"Signal the end of the stream and return the last values.  Raise\n"
+"JSONDecodeError if the stream ends in the middle of a value.");
+
+static PyObject *
+bytes_decoder_close(PyObject *self, PyObject *Py_UNUSED(ignored))
+{
+    return bytes_decoder_run((PyBytesDecoderObject *)self, "", 0, 1);
+}
+
+static PyMethodDef bytes_decoder_methods[] = {
+    {"feed", (PyCFunction)bytes_decoder_feed, METH_O, bytes_decoder_feed_doc},
+    {"close", (PyCFunction)bytes_decoder_close, METH_NOARGS,
+     bytes_decoder_close_doc},
+    {NULL, NULL}
+};
+
+static PyObject *
+bytes_decoder_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyBytesDecoderObject *s;
+    PyObject *ctx;
+    PyObject *scanner_args;
+    int items = 0;
+    static char *kwlist[] = {"context", "items", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|p:make_bytes_decoder",
+                                     kwlist, &ctx, &items))
+        return NULL;
+
+    s = (PyBytesDecoderObject *)type->tp_alloc(type, 0);
+    if (s == NULL)
+        return NULL;
+    s->items = items;
+    s->state = ITEMS_START;
+    s->value_start = -1;
+
+    /* The scanner holds the options of the context and the key memo */
+    scanner_args = PyTuple_Pack(1, ctx);
+    if (scanner_args == NULL)
+        goto bail;
+    s->scanner = (PyScannerObject *)scanner_new(&PyScannerType, scanner_args, NULL);
+    Py_DECREF(scanner_args);
+    if (s->scanner == NULL)
+        goto bail;
+    s->values = PyList_New(0);
+    if (s->values == NULL)
+        goto bail;
+    return (PyObject *)s;
+
+bail:
+    Py_DECREF(s);
+    return NULL;
+}
+
+static int
+bytes_decoder_traverse(PyObject *self, visitproc visit, void *arg)
+{
+    PyBytesDecoderObject *s = (PyBytesDecoderObject *)self;
+    Py_VISIT(s->scanner);
+    Py_VISIT(s->values);
+    return 0;
+}
+
+static int
+bytes_decoder_clear(PyObject *self)
+{
+    PyBytesDecoderObject *s = (PyBytesDecoderObject *)self;
+    Py_CLEAR(s->scanner);
+    Py_CLEAR(s->values);
+    return 0;
+}
+
+static void
+bytes_decoder_dealloc(PyObject *self)
+{
+    PyBytesDecoderObject *s = (PyBytesDecoderObject *)self;
+    PyObject_GC_UnTrack(self);
+    bytes_decoder_clear(self);
+    PyMem_Free(s->buf);
+    PyMem_Free(s->stack);
+    Py_TYPE(self)->tp_free(self);
+}
+
+PyDoc_STRVAR(bytes_decoder_doc,
+"make_bytes_decoder(context, items=False)\n"
+"\n"
+"Incremental decoder of a stream of UTF-8 encoded JSON values, using the\n"
+"options of the JSONDecoder context.  If items is true, the stream holds\n"
+"a single array whose elements are returned one by one.");
+
+static
+PyTypeObject PyBytesDecoderType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_json.BytesDecoder",       /* tp_name */
+    sizeof(PyBytesDecoderObject), /* tp_basicsize */
+    0,                    /* tp_itemsize */
+    bytes_decoder_dealloc, /* tp_dealloc */
+    0,                    /* tp_print */
+    0,                    /* tp_getattr */
+    0,                    /* tp_setattr */
     0,                    /* tp_compare */
     0,                    /* tp_repr */
     0,                    /* tp_as_number */
     0,                    /* tp_as_sequence */
     0,                    /* tp_as_mapping */
     0,                    /* tp_hash */
-    scanner_call,         /* tp_call */
+    0,                    /* tp_call */
     0,                    /* tp_str */
-    0,/* PyObject_GenericGetAttr, */                    /* tp_getattro */
-    0,/* PyObject_GenericSetAttr, */                    /* tp_setattro */
+    0,                    /* tp_getattro */
+    0,                    /* tp_setattro */
     0,                    /* tp_as_buffer */
     Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,   /* tp_flags */
-    scanner_doc,          /* tp_doc */
-    scanner_traverse,                    /* tp_traverse */
-    scanner_clear,                    /* tp_clear */
+    bytes_decoder_doc,    /* tp_doc */
+    bytes_decoder_traverse, /* tp_traverse */
+    bytes_decoder_clear,  /* tp_clear */
     0,                    /* tp_richcompare */
     0,                    /* tp_weaklistoffset */
     0,                    /* tp_iter */
     0,                    /* tp_iternext */
-    0,                    /* tp_methods */
-    scanner_members,                    /* tp_members */
+    bytes_decoder_methods, /* tp_methods */
+    bytes_decoder_members, /* tp_members */
     0,                    /* tp_getset */
     0,                    /* tp_base */
     0,                    /* tp_dict */
@@ -1282,9 +2546,9 @@ PyTypeObject PyScannerType = {
     0,                    /* tp_descr_set */
     0,                    /* tp_dictoffset */
     0,                    /* tp_init */
-    0,/* PyType_GenericAlloc, */        /* tp_alloc */
-    scanner_new,          /* tp_new */
-    0,/* PyObject_GC_Del, */              /* tp_free */
+    0,                    /* tp_alloc */
+    bytes_decoder_new,    /* tp_new */
+    0,                    /* tp_free */
 };
 
 static PyObject *
@@ -1341,30 +2605,348 @@ encoder_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
     return (PyObject *)s;
 }
 
+/* The encoder writes UTF-8 into a single bytes object.  If a write()
+   callable is given, the output is handed to it in chunks of about
+   WRITER_CHUNK_SIZE bytes instead of growing the buffer. */
+
+#define WRITER_CHUNK_SIZE 65536
+
+struct _JSONWriter {
+    PyObject *bytes;    /* output buffer */
+    Py_ssize_t len;     /* bytes used in the buffer */
+    PyObject *write;    /* borrowed, or NULL */
+};
+
+static int
+writer_init(_JSONWriter *w, PyObject *write)
+{
+    w->len = 0;
+    w->write = write;
+    w->bytes = PyBytes_FromStringAndSize(NULL,
+                                         write != NULL ? WRITER_CHUNK_SIZE : 512);
+    return w->bytes == NULL ? -1 : 0;
+}
+
+static int
+writer_flush(_JSONWriter *w)
+{
+    /* Pass the content of the buffer to write() */
+    PyObject *chunk, *res;
+    if (w->len == 0)
+        return 0;
+    chunk = PyBytes_FromStringAndSize(PyBytes_AS_STRING(w->bytes), w->len);
+    if (chunk == NULL)
+        return -1;
+    w->len = 0;
+    res = PyObject_CallFunctionObjArgs(w->write, chunk, NULL);
+    Py_DECREF(chunk);
+    if (res == NULL)
+        return -1;
+    Py_DECREF(res);
+    return 0;
+}
+
+static char *
+writer_reserve(_JSONWriter *w, Py_ssize_t n)
+{
+    /* Return a pointer to n free bytes at the end of the output.  The
+       caller adds the bytes it uses to w->len. */
+    Py_ssize_t size = PyBytes_GET_SIZE(w->bytes);
+    if (size - w->len < n) {
+        if (w->write != NULL && writer_flush(w) < 0)
+            return NULL;
+        if (size - w->len < n) {
+            if (n > PY_SSIZE_T_MAX - w->len) {
+                PyErr_NoMemory();
+                return NULL;
+            }
+            if (size <= PY_SSIZE_T_MAX / 2 && w->len + n < size * 2)
+                size *= 2;
+            else
+                size = w->len + n;
+            if (_PyBytes_Resize(&w->bytes, size) < 0)
+                return NULL;
+        }
+    }
+    return PyBytes_AS_STRING(w->bytes) + w->len;
+}
+
+static int
+writer_write(_JSONWriter *w, const char *str, Py_ssize_t n)
+{
+    char *p = writer_reserve(w, n);
+    if (p == NULL)
+        return -1;
+    memcpy(p, str, n);
+    w->len += n;
+    return 0;
+}
+
+static int
+writer_write_unicode(_JSONWriter *w, PyObject *str)
+{
+    /* Write an already encoded JSON fragment */
+    PyObject *utf8;
+    int rval;
+    if (PyUnicode_READY(str) == -1)
+        return -1;
+    if (PyUnicode_IS_ASCII(str))
+        return writer_write(w, (const char *)PyUnicode_1BYTE_DATA(str),
+                            PyUnicode_GET_LENGTH(str));
+    utf8 = _PyUnicode_AsUTF8String(str, "surrogatepass");
+    if (utf8 == NULL)
+        return -1;
+    rval = writer_write(w, PyBytes_AS_STRING(utf8), PyBytes_GET_SIZE(utf8));
+    Py_DECREF(utf8);
+    return rval;
+}
+
+static void
+writer_destroy(_JSONWriter *w)
+{
+    Py_CLEAR(w->bytes);
+}
+
+static PyObject *
+writer_finish_bytes(_JSONWriter *w)
+{
+    if (w->write != NULL) {
+        if (writer_flush(w) < 0) {
+            writer_destroy(w);
+            return NULL;
+        }
+        writer_destroy(w);
+        Py_RETURN_NONE;
+    }
+    if (_PyBytes_Resize(&w->bytes, w->len) < 0)
+        return NULL;
+    return w->bytes;
+}
+
+static PyObject *
+writer_finish_unicode(_JSONWriter *w)
+{
+    PyObject *rval = PyUnicode_DecodeUTF8(PyBytes_AS_STRING(w->bytes), w->len,
+                                          "surrogatepass");
+    writer_destroy(w);
+    return rval;
+}
+
+static int
+encoder_write_string(PyEncoderObject *s, _JSONWriter *w, PyObject *pystr)
+{
+    /* Write the JSON representation of a string, escaped like
+       encode_basestring_ascii() or encode_basestring() do */
+    int ascii_only = (s->fast_encode == (PyCFunction)py_encode_basestring_ascii);
+    Py_ssize_t i, input_chars, output_size;
+    const void *input;
+    int kind;
+    unsigned char *output;
+    Py_ssize_t chars;
+
+    if (s->fast_encode == NULL) {
+        PyObject *encoded = encoder_encode_string(s, pystr);
+        int rval;
+        if (encoded == NULL)
+            return -1;
+        rval = writer_write_unicode(w, encoded);
+        Py_DECREF(encoded);
+        return rval;
+    }
+
+    if (PyUnicode_READY(pystr) == -1)
+        return -1;
+    input_chars = PyUnicode_GET_LENGTH(pystr);
+    input = PyUnicode_DATA(pystr);
+    kind = PyUnicode_KIND(pystr);
+
+    /* Compute the output size */
+    for (i = 0, output_size = 2; i < input_chars; i++) {
+        Py_UCS4 c = PyUnicode_READ(kind, input, i);
+        Py_ssize_t d;
+        if (S_CHAR(c) || (c == 0x7f && !ascii_only)) {
+            d = 1;
+        }
+        else if (c < 0x80 || ascii_only) {
+            switch(c) {
+            case '\\': case '"': case '\b': case '\f':
+            case '\n': case '\r': case '\t':
+                d = 2; break;
+            default:
+                d = c >= 0x10000 ? 12 : 6;
+            }
+        }
+        else {
+            d = c < 0x800 ? 2 : c < 0x10000 ? 3 : 4;
+        }
+        if (output_size > PY_SSIZE_T_MAX - d) {
+            PyErr_SetString(PyExc_OverflowError, "string is too long to escape");
+            return -1;
+        }
+        output_size += d;
+    }
+
+    output = (unsigned char *)writer_reserve(w, output_size);
+    if (output == NULL)
+        return -1;
+    chars = 0;
+    output[chars++] = '"';
+    if (output_size == input_chars + 2 && kind == PyUnicode_1BYTE_KIND) {
+        /* Nothing to escape */
+        memcpy(output + 1, input, input_chars);
+        chars += input_chars;
+    }
+    else {
+        for (i = 0; i < input_chars; i++) {
+            Py_UCS4 c = PyUnicode_READ(kind, input, i);
+            if (S_CHAR(c) || (c == 0x7f && !ascii_only)) {
+                output[chars++] = c;
+            }
+            else if (c < 0x80 || ascii_only) {
+                chars = ascii_escape_unichar(c, output, chars);
+            }
+            else if (c < 0x800) {
+                output[chars++] = 0xc0 | (c >> 6);
+                output[chars++] = 0x80 | (c & 0x3f);
+            }
+            else if (c < 0x10000) {
+                /* lone surrogates are written as by "surrogatepass" */
+                output[chars++] = 0xe0 | (c >> 12);
+                output[chars++] = 0x80 | ((c >> 6) & 0x3f);
+                output[chars++] = 0x80 | (c & 0x3f);
+            }
+            else {
+                output[chars++] = 0xf0 | (c >> 18);
+                output[chars++] = 0x80 | ((c >> 12) & 0x3f);
+                output[chars++] = 0x80 | ((c >> 6) & 0x3f);
+                output[chars++] = 0x80 | (c & 0x3f);
+            }
+        }
+    }
+    output[chars++] = '"';
+    assert(chars == output_size);
+    w->len += output_size;
+    return 0;
+}
+
+static int
+encoder_write_long(_JSONWriter *w, PyObject *obj)
+{
+    /* Write the decimal representation of an int */
+    int overflow;
+    long long value = PyLong_AsLongLongAndOverflow(obj, &overflow);
+    if (value == -1 && PyErr_Occurred())
+        return -1;
+    if (!overflow) {
+        char digits[24];
+        char *end = digits + sizeof(digits);
+        char *p = end;
+        unsigned long long u = value < 0 ? 0ULL - (unsigned long long)value
+                                         : (unsigned long long)value;
+        do {
+            *--p = '0' + (char)(u % 10);
+            u /= 10;
+        } while (u);
+        if (value < 0)
+            *--p = '-';
+        return writer_write(w, p, end - p);
+    }
+    else {
+        PyObject *encoded = PyLong_Type.tp_str(obj);
+        int rval;
+        if (encoded == NULL)
+            return -1;
+        rval = writer_write_unicode(w, encoded);
+        Py_DECREF(encoded);
+        return rval;
+    }
+}
+
+static int
+encoder_write_float(PyEncoderObject *s, _JSONWriter *w, PyObject *obj)
+{
+    /* Write the JSON representation of a float */
+    double d = PyFloat_AS_DOUBLE(obj);
+    char *repr;
+    int rval;
+    if (!Py_IS_FINITE(d)) {
+        PyObject *encoded = encoder_encode_float(s, obj);
+        if (encoded == NULL)
+            return -1;
+        rval = writer_write_unicode(w, encoded);
+        Py_DECREF(encoded);
+        return rval;
+    }
+    /* Same as float.__repr__() */
+    repr = PyOS_double_to_string(d, 'r', 0, Py_DTSF_ADD_DOT_0, NULL);
+    if (repr == NULL)
+        return -1;
+    rval = writer_write(w, repr, strlen(repr));
+    PyMem_Free(repr);
+    return rval;
+}
+
 static PyObject *
 encoder_call(PyObject *self, PyObject *args, PyObject *kwds)
 {
     /* Python callable interface to encode_listencode_obj */
     static char *kwlist[] = {"obj", "_current_indent_level", NULL};
     PyObject *obj;
+    PyObject *rval;
     Py_ssize_t indent_level;
     PyEncoderObject *s;
-    _PyAccu acc;
+    _JSONWriter w;
 
     assert(PyEncoder_Check(self));
     s = (PyEncoderObject *)self;
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "On:_iterencode", kwlist,
         &obj, &indent_level))
         return NULL;
-    if (_PyAccu_Init(&acc))
+    if (writer_init(&w, NULL))
+        return NULL;
+    if (encoder_listencode_obj(s, &w, obj, indent_level)) {
+        writer_destroy(&w);
+        return NULL;
+    }
+    rval = writer_finish_unicode(&w);
+    if (rval == NULL)
+        return NULL;
+    return PyTuple_Pack(1, rval);
+}
+
+PyDoc_STRVAR(encoder_encode_bytes_doc,
+"encode_bytes(obj, write=None) -> bytes\n"
+"\n"
+"Return the UTF-8 encoded JSON representation of obj.  If write is given,\n"
+"pass the output to it in chunks of bytes and return None.");
+
+static PyObject *
+encoder_encode_bytes(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"obj", "write", NULL};
+    PyObject *obj;
+    PyObject *write = Py_None;
+    PyEncoderObject *s = (PyEncoderObject *)self;
+    _JSONWriter w;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O:encode_bytes", kwlist,
+        &obj, &write))
+        return NULL;
+    if (writer_init(&w, write != Py_None ? write : NULL))
         return NULL;
-    if (encoder_listencode_obj(s, &acc, obj, indent_level)) {
-        _PyAccu_Destroy(&acc);
+    if (encoder_listencode_obj(s, &w, obj, 0)) {
+        writer_destroy(&w);
         return NULL;
     }
-    return _PyAccu_FinishAsList(&acc);
+    return writer_finish_bytes(&w);
 }
 
+static PyMethodDef encoder_methods[] = {
+    {"encode_bytes", (PyCFunction)encoder_encode_bytes,
+     METH_VARARGS | METH_KEYWORDS, encoder_encode_bytes_doc},
+    {NULL, NULL}
+};
+
 static PyObject *
 _encoded_const(PyObject *obj)
 {
@@ -1446,58 +3028,42 @@ encoder_encode_string(PyEncoderObject *s, PyObject *obj)
 }
 
 static int
-_steal_accumulate(_PyAccu *acc, PyObject *stolen)
-{
-    /* Append stolen and then decrement its reference count */
-    int rval = _PyAccu_Accumulate(acc, stolen);
-    Py_DECREF(stolen);
-    return rval;
-}
-
-static int
-encoder_listencode_obj(PyEncoderObject *s, _PyAccu *acc,
+encoder_listencode_obj(PyEncoderObject *s, _JSONWriter *w,
                        PyObject *obj, Py_ssize_t indent_level)
 {
     /* Encode Python object obj to a JSON term */
     PyObject *newobj;
     int rv;
 
-    if (obj == Py_None || obj == Py_True || obj == Py_False) {
-        PyObject *cstr = _encoded_const(obj);
-        if (cstr == NULL)
-            return -1;
-        return _steal_accumulate(acc, cstr);
+    if (obj == Py_None) {
+        return writer_write(w, "null", 4);
     }
-    else if (PyUnicode_Check(obj))
-    {
-        PyObject *encoded = encoder_encode_string(s, obj);
-        if (encoded == NULL)
-            return -1;
-        return _steal_accumulate(acc, encoded);
+    else if (obj == Py_True) {
+        return writer_write(w, "true", 4);
+    }
+    else if (obj == Py_False) {
+        return writer_write(w, "false", 5);
+    }
+    else if (PyUnicode_Check(obj)) {
+        return encoder_write_string(s, w, obj);
     }
     else if (PyLong_Check(obj)) {
-        PyObject *encoded = PyLong_Type.tp_str(obj);
-        if (encoded == NULL)
-            return -1;
-        return _steal_accumulate(acc, encoded);
+        return encoder_write_long(w, obj);
     }
     else if (PyFloat_Check(obj)) {
-        PyObject *encoded = encoder_encode_float(s, obj);
-        if (encoded == NULL)
-            return -1;
-        return _steal_accumulate(acc, encoded);
+        return encoder_write_float(s, w, obj);
     }
     else if (PyList_Check(obj) || PyTuple_Check(obj)) {
         if (Py_EnterRecursiveCall(" while encoding a JSON object"))
             return -1;
-        rv = encoder_listencode_list(s, acc, obj, indent_level);
+        rv = encoder_listencode_list(s, w, obj, indent_level);
         Py_LeaveRecursiveCall();
         return rv;
     }
     else if (PyDict_Check(obj)) {
         if (Py_EnterRecursiveCall(" while encoding a JSON object"))
             return -1;
-        rv = encoder_listencode_dict(s, acc, obj, indent_level);
+        rv = encoder_listencode_dict(s, w, obj, indent_level);
         Py_LeaveRecursiveCall();
         return rv;
     }
@@ -1531,7 +3097,7 @@ encoder_listencode_obj(PyEncoderObject *s, _PyAccu *acc,
             Py_XDECREF(ident);
             return -1;
         }
-        rv = encoder_listencode_obj(s, acc, newobj, indent_level);
+        rv = encoder_listencode_obj(s, w, newobj, indent_level);
         Py_LeaveRecursiveCall();
 
         Py_DECREF(newobj);
@@ -1551,29 +3117,140 @@ encoder_listencode_obj(PyEncoderObject *s, _PyAccu *acc,
 }
 
 static int
-encoder_listencode_dict(PyEncoderObject *s, _PyAccu *acc,
+encoder_listencode_item(PyEncoderObject *s, _JSONWriter *w,
+                        PyObject *key, PyObject *value, int first,
+                        Py_ssize_t indent_level)
+{
+    /* Encode a key and its value.  Return 1 if the item is skipped. */
+    PyObject *kstr;
+    int rv;
+
+    if (PyUnicode_Check(key)) {
+        Py_INCREF(key);
+        kstr = key;
+    }
+    else if (PyFloat_Check(key)) {
+        kstr = encoder_encode_float(s, key);
+        if (kstr == NULL)
+            return -1;
+    }
+    else if (key == Py_True || key == Py_False || key == Py_None) {
+                    /* This must come before the PyLong_Check because
+                       True and False are also 1 and 0.*/
+        kstr = _encoded_const(key);
+        if (kstr == NULL)
+            return -1;
+    }
+    else if (PyLong_Check(key)) {
+        kstr = PyLong_Type.tp_str(key);
+        if (kstr == NULL)
+            return -1;
+    }
+    else if (s->skipkeys) {
+        return 1;
+    }
+    else {
+        PyErr_Format(PyExc_TypeError,
+                     "keys must be str, int, float, bool or None, "
+                     "not %.100s", key->ob_type->tp_name);
+        return -1;
+    }
+
+    if (!first && writer_write_unicode(w, s->item_separator)) {
+        Py_DECREF(kstr);
+        return -1;
+    }
+    rv = encoder_write_string(s, w, kstr);
+    Py_DECREF(kstr);
+    if (rv)
+        return -1;
+    if (writer_write_unicode(w, s->key_separator))
+        return -1;
+    return encoder_listencode_obj(s, w, value, indent_level);
+}
+
+static int
+compare_str_items(const void *a, const void *b)
+{
+    /* Order the (key, value) pairs of an array by their str keys */
+    PyObject *u = ((PyObject *const *)a)[0];
+    PyObject *v = ((PyObject *const *)b)[0];
+    if (PyUnicode_KIND(u) == PyUnicode_1BYTE_KIND &&
+            PyUnicode_KIND(v) == PyUnicode_1BYTE_KIND) {
+        Py_ssize_t len_u = PyUnicode_GET_LENGTH(u);
+        Py_ssize_t len_v = PyUnicode_GET_LENGTH(v);
+        int cmp = memcmp(PyUnicode_1BYTE_DATA(u), PyUnicode_1BYTE_DATA(v),
+                         Py_MIN(len_u, len_v));
+        if (cmp != 0)
+            return cmp;
+        return (len_u > len_v) - (len_u < len_v);
+    }
+    return PyUnicode_Compare(u, v);
+}
+
+static int
+encoder_listencode_dict_items(PyEncoderObject *s, _JSONWriter *w,
+                              PyObject *dct, Py_ssize_t indent_level)
+{
+    /* Encode the items of an exact dict from a C array of (key, value)
+       pairs.  Return 1 if the keys must be sorted but are not all str. */
+    Py_ssize_t size = PyDict_GET_SIZE(dct);
+    Py_ssize_t pos = 0, n = 0, i;
+    PyObject *key, *value;
+    PyObject **items;
+    int first = 1;
+    int rv = 0;
+
+    items = PyMem_New(PyObject *, 2 * size);
+    if (items == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    while (n < size && PyDict_Next(dct, &pos, &key, &value)) {
+        if (s->sort_keys && !PyUnicode_CheckExact(key)) {
+            rv = 1;
+            goto done;
+        }
+        Py_INCREF(key);
+        Py_INCREF(value);
+        items[2 * n] = key;
+        items[2 * n + 1] = value;
+        n++;
+    }
+    if (s->sort_keys)
+        qsort(items, n, 2 * sizeof(PyObject *), compare_str_items);
+
+    for (i = 0; i < n; i++) {
+        rv = encoder_listencode_item(s, w, items[2 * i], items[2 * i + 1],
+                                     first, indent_level);
+        if (rv < 0)
+            goto done;
+        if (rv == 0)
+            first = 0;
+    }
+    rv = 0;
+
+done:
+    for (i = 0; i < 2 * n; i++)
+        Py_DECREF(items[i]);
+    PyMem_Free(items);
+    return rv;
+}
+
+static int
+encoder_listencode_dict(PyEncoderObject *s, _JSONWriter *w,
                         PyObject *dct, Py_ssize_t indent_level)
 {
     /* Encode Python dict dct a JSON term */
-    static PyObject *open_dict = NULL;
-    static PyObject *close_dict = NULL;
-    static PyObject *empty_dict = NULL;
-    PyObject *kstr = NULL;
     PyObject *ident = NULL;
     PyObject *it = NULL;
     PyObject *items;
     PyObject *item = NULL;
-    Py_ssize_t idx;
+    int first = 1;
+    int rv;
 
-    if (open_dict == NULL || close_dict == NULL || empty_dict == NULL) {
-        open_dict = PyUnicode_InternFromString("{");
-        close_dict = PyUnicode_InternFromString("}");
-        empty_dict = PyUnicode_InternFromString("{}");
-        if (open_dict == NULL || close_dict == NULL || empty_dict == NULL)
-            return -1;
-    }
     if (PyDict_GET_SIZE(dct) == 0)  /* Fast path */
-        return _PyAccu_Accumulate(acc, empty_dict);
+        return writer_write(w, "{}", 2);
 
     if (s->markers != Py_None) {
         int has_key;
@@ -1591,7 +3268,7 @@ encoder_listencode_dict(PyEncoderObject *s, _PyAccu *acc,
         }
     }
 
-    if (_PyAccu_Accumulate(acc, open_dict))
+    if (writer_write(w, "{", 1))
         goto bail;
 
     if (s->indent != Py_None) {
@@ -1604,6 +3281,15 @@ encoder_listencode_dict(PyEncoderObject *s, _PyAccu *acc,
         */
     }
 
+    if (PyDict_CheckExact(dct)) {
+        rv = encoder_listencode_dict_items(s, w, dct, indent_level);
+        if (rv < 0)
+            goto bail;
+        if (rv == 0)
+            goto end;
+        /* sorting mixed keys is left to list.sort() */
+    }
+
     items = PyMapping_Items(dct);
     if (items == NULL)
         goto bail;
@@ -1615,74 +3301,25 @@ encoder_listencode_dict(PyEncoderObject *s, _PyAccu *acc,
     Py_DECREF(items);
     if (it == NULL)
         goto bail;
-    idx = 0;
     while ((item = PyIter_Next(it)) != NULL) {
-        PyObject *encoded, *key, *value;
         if (!PyTuple_Check(item) || PyTuple_GET_SIZE(item) != 2) {
             PyErr_SetString(PyExc_ValueError, "items must return 2-tuples");
             goto bail;
         }
-        key = PyTuple_GET_ITEM(item, 0);
-        if (PyUnicode_Check(key)) {
-            Py_INCREF(key);
-            kstr = key;
-        }
-        else if (PyFloat_Check(key)) {
-            kstr = encoder_encode_float(s, key);
-            if (kstr == NULL)
-                goto bail;
-        }
-        else if (key == Py_True || key == Py_False || key == Py_None) {
-                        /* This must come before the PyLong_Check because
-                           True and False are also 1 and 0.*/
-            kstr = _encoded_const(key);
-            if (kstr == NULL)
-                goto bail;
-        }
-        else if (PyLong_Check(key)) {
-            kstr = PyLong_Type.tp_str(key);
-            if (kstr == NULL) {
-                goto bail;
-            }
-        }
-        else if (s->skipkeys) {
-            Py_DECREF(item);
-            continue;
-        }
-        else {
-            PyErr_Format(PyExc_TypeError,
-                         "keys must be str, int, float, bool or None, "
-                         "not %.100s", key->ob_type->tp_name);
-            goto bail;
-        }
-
-        if (idx) {
-            if (_PyAccu_Accumulate(acc, s->item_separator))
-                goto bail;
-        }
-
-        encoded = encoder_encode_string(s, kstr);
-        Py_CLEAR(kstr);
-        if (encoded == NULL)
-            goto bail;
-        if (_PyAccu_Accumulate(acc, encoded)) {
-            Py_DECREF(encoded);
-            goto bail;
-        }
-        Py_DECREF(encoded);
-        if (_PyAccu_Accumulate(acc, s->key_separator))
+        rv = encoder_listencode_item(s, w, PyTuple_GET_ITEM(item, 0),
+                                     PyTuple_GET_ITEM(item, 1),
+                                     first, indent_level);
+        if (rv < 0)
             goto bail;
-
-        value = PyTuple_GET_ITEM(item, 1);
-        if (encoder_listencode_obj(s, acc, value, indent_level))
-            goto bail;
-        idx += 1;
-        Py_DECREF(item);
+        if (rv == 0)
+            first = 0;
+        Py_CLEAR(item);
     }
     if (PyErr_Occurred())
         goto bail;
     Py_CLEAR(it);
 
+end:
     if (ident != NULL) {
         if (PyDict_DelItem(s->markers, ident))
             goto bail;
@@ -1694,45 +3331,34 @@ encoder_listencode_dict(PyEncoderObject *s, _PyAccu *acc,
 
         yield '\n' + (' ' * (_indent * _current_indent_level))
     }*/
-    if (_PyAccu_Accumulate(acc, close_dict))
+    if (writer_write(w, "}", 1))
         goto bail;
     return 0;
 
 bail:
     Py_XDECREF(it);
     Py_XDECREF(item);
-    Py_XDECREF(kstr);
     Py_XDECREF(ident);
     return -1;
 }
 
 
 static int
-encoder_listencode_list(PyEncoderObject *s, _PyAccu *acc,
+encoder_listencode_list(PyEncoderObject *s, _JSONWriter *w,
                         PyObject *seq, Py_ssize_t indent_level)
 {
     /* Encode Python list seq to a JSON term */
-    static PyObject *open_array = NULL;
-    static PyObject *close_array = NULL;
-    static PyObject *empty_array = NULL;
     PyObject *ident = NULL;
     PyObject *s_fast = NULL;
     Py_ssize_t i;
 
-    if (open_array == NULL || close_array == NULL || empty_array == NULL) {
-        open_array = PyUnicode_InternFromString("[");
-        close_array = PyUnicode_InternFromString("]");
-        empty_array = PyUnicode_InternFromString("[]");
-        if (open_array == NULL || close_array == NULL || empty_array == NULL)
-            return -1;
-    }
     ident = NULL;
     s_fast = PySequence_Fast(seq, "_iterencode_list needs a sequence");
     if (s_fast == NULL)
         return -1;
     if (PySequence_Fast_GET_SIZE(s_fast) == 0) {
         Py_DECREF(s_fast);
-        return _PyAccu_Accumulate(acc, empty_array);
+        return writer_write(w, "[]", 2);
     }
 
     if (s->markers != Py_None) {
@@ -1751,7 +3377,7 @@ encoder_listencode_list(PyEncoderObject *s, _PyAccu *acc,
         }
     }
 
-    if (_PyAccu_Accumulate(acc, open_array))
+    if (writer_write(w, "[", 1))
         goto bail;
     if (s->indent != Py_None) {
         /* TODO: DOES NOT RUN */
@@ -1765,10 +3391,10 @@ encoder_listencode_list(PyEncoderObject *s, _PyAccu *acc,
     for (i = 0; i < PySequence_Fast_GET_SIZE(s_fast); i++) {
         PyObject *obj = PySequence_Fast_GET_ITEM(s_fast, i);
         if (i) {
-            if (_PyAccu_Accumulate(acc, s->item_separator))
+            if (writer_write_unicode(w, s->item_separator))
                 goto bail;
         }
-        if (encoder_listencode_obj(s, acc, obj, indent_level))
+        if (encoder_listencode_obj(s, w, obj, indent_level))
             goto bail;
     }
     if (ident != NULL) {
@@ -1783,7 +3409,7 @@ encoder_listencode_list(PyEncoderObject *s, _PyAccu *acc,
 
         yield '\n' + (' ' * (_indent * _current_indent_level))
     }*/
-    if (_PyAccu_Accumulate(acc, close_array))
+    if (writer_write(w, "]", 1))
         goto bail;
     Py_DECREF(s_fast);
     return 0;
@@ -1865,7 +3491,7 @@ PyTypeObject PyEncoderType = {
     0,                    /* tp_weaklistoffset */
     0,                    /* tp_iter */
     0,                    /* tp_iternext */
-    0,                    /* tp_methods */
+    encoder_methods,      /* tp_methods */
     encoder_members,      /* tp_members */
     0,                    /* tp_getset */
     0,                    /* tp_base */
@@ -1920,6 +3546,8 @@ PyInit__json(void)
         goto fail;
     if (PyType_Ready(&PyEncoderType) < 0)
         goto fail;
+    if (PyType_Ready(&PyBytesDecoderType) < 0)
+        goto fail;
     Py_INCREF((PyObject*)&PyScannerType);
     if (PyModule_AddObject(m, "make_scanner", (PyObject*)&PyScannerType) < 0) {
         Py_DECREF((PyObject*)&PyScannerType);
@@ -1930,6 +3558,11 @@ PyInit__json(void)
         Py_DECREF((PyObject*)&PyEncoderType);
         goto fail;
     }
+    Py_INCREF((PyObject*)&PyBytesDecoderType);
+    if (PyModule_AddObject(m, "make_bytes_decoder", (PyObject*)&PyBytesDecoderType) < 0) {
+        Py_DECREF((PyObject*)&PyBytesDecoderType);
+        goto fail;
+    }
     return m;
   fail:
     Py_DECREF(m);
@@ -22,7 +22,7 @@ class _pickle.UnpicklerMemoProxy "UnpicklerMemoProxyObject *" "&UnpicklerMemoPro
 
 /* Bump this when new opcodes are added to the pickle protocol. */
 enum {
-    HIGHEST_PROTOCOL = 4,
+    HIGHEST_PROTOCOL = 5,
     DEFAULT_PROTOCOL = 3
 };
 
@@ -99,7 +99,12 @@ enum opcode {
     NEWOBJ_EX        = '\x92',
     STACK_GLOBAL     = '\x93',
     MEMOIZE          = '\x94',
-    FRAME            = '\x95'
+    FRAME            = '\x95',
+
+    /* Protocol 5 */
+    BYTEARRAY8       = '\x96',
+    NEXT_BUFFER      = '\x97',
+    READONLY_BUFFER  = '\x98'
 };
 
 enum {
@@ -121,7 +126,10 @@ enum {
 
     FRAME_SIZE_MIN = 4,
     FRAME_SIZE_TARGET = 64 * 1024,
-    FRAME_HEADER_SIZE = 9
+    FRAME_HEADER_SIZE = 9,
+
+    /* Largest frame for which the Unpickler presizes the memo */
+    FRAME_MEMO_HINT_MAX = 1024 * 1024
 };
 
 /*************************************************************************/
@@ -635,6 +643,14 @@ typedef struct PicklerObject {
     int fix_imports;            /* Indicate whether Pickler should fix
                                    the name of globals for Python 2.x. */
     PyObject *fast_memo;
+    PyObject *buffer_callback;  /* Callback for out-of-band buffers, or NULL */
+    Py_ssize_t chunk_size;      /* Number of items per independently
+                                   decodable chunk of a top-level list or
+                                   dict, 0 to pickle them as usual. */
+    PyObject *chunk_container;  /* Borrowed reference to the container
+                                   being chunked, or NULL. */
+    Py_ssize_t output_offset;   /* Bytes of the current pickle already
+                                   flushed to the file. */
 } PicklerObject;
 
 typedef struct UnpicklerObject {
@@ -661,6 +677,11 @@ typedef struct UnpicklerObject {
     PyObject *read;             /* read() method of the input stream. */
     PyObject *readline;         /* readline() method of the input stream. */
     PyObject *peek;             /* peek() method of the input stream, or NULL */
+    PyObject *readinto;         /* readinto() method of the input stream, or
+                                   NULL */
+    PyObject *buffers;          /* iterator of out-of-band buffers, or NULL */
+    PyObject *mmap_file;        /* file mapped by load() instead of read(),
+                                   or NULL */
 
     char *encoding;             /* Name of the encoding to be used for
                                    decoding strings pickled using Python
@@ -995,6 +1016,7 @@ _Pickler_FlushToFile(PicklerObject *self)
     output = _Pickler_GetString(self);
     if (output == NULL)
         return -1;
+    self->output_offset += PyBytes_GET_SIZE(output);
 
     result = _Pickle_FastCall(self->write, output);
     Py_XDECREF(result);
@@ -1103,6 +1125,10 @@ _Pickler_New(void)
     self->fast_nesting = 0;
     self->fix_imports = 0;
     self->fast_memo = NULL;
+    self->buffer_callback = NULL;
+    self->chunk_size = 0;
+    self->chunk_container = NULL;
+    self->output_offset = 0;
     self->max_output_len = WRITE_BUF_SIZE;
     self->output_len = 0;
 
@@ -1146,6 +1172,42 @@ _Pickler_SetProtocol(PicklerObject *self, PyObject *protocol, int fix_imports)
     return 0;
 }
 
+/* Returns -1 (with an exception set) on failure, 0 on success. This may
+   be called once on a freshly created Pickler, after the protocol is set. */
+static int
+_Pickler_SetBufferCallback(PicklerObject *self, PyObject *buffer_callback)
+{
+    if (buffer_callback == Py_None) {
+        buffer_callback = NULL;
+    }
+    if (buffer_callback != NULL && self->proto < 5) {
+        PyErr_SetString(PyExc_ValueError,
+                        "buffer_callback needs protocol >= 5");
+        return -1;
+    }
+
+    Py_XINCREF(buffer_callback);
+    self->buffer_callback = buffer_callback;
+    return 0;
+}
+
+/* Returns -1 (with an exception set) on failure, 0 on success. This may
+   be called once on a freshly created Pickler. */
+static int
+_Pickler_SetChunkSize(PicklerObject *self, Py_ssize_t chunk_size)
+{
+    if (chunk_size < 0) {
+        PyErr_SetString(PyExc_ValueError, "chunk_size must be >= 0");
+        return -1;
+    }
+    if (chunk_size > 0 && self->proto < 4) {
+        PyErr_SetString(PyExc_ValueError, "chunk_size needs protocol >= 4");
+        return -1;
+    }
+    self->chunk_size = chunk_size;
+    return 0;
+}
+
 /* Returns -1 (with an exception set) on failure, 0 on success. This may
    be called once on a freshly created Pickler. */
 static int
@@ -1326,6 +1388,85 @@ _Unpickler_ReadImpl(UnpicklerObject *self, char **s, Py_ssize_t n)
         (n))                                                 \
      : _Unpickler_ReadImpl(self, (s), (n)))
 
+/* Read exactly `n` bytes from the unpickler's data source into `buf`.
+
+   Unlike _Unpickler_Read(), large payloads read from a file object are
+   not copied through an intermediate bytes object: they are read with
+   readinto() straight into their destination, if the file supports it.
+
+   Returns -1 (with an exception set) on failure, `n` on success. */
+static Py_ssize_t
+_Unpickler_ReadInto(UnpicklerObject *self, char *buf, Py_ssize_t n)
+{
+    Py_ssize_t in_buffer, read_size;
+    PyObject *buf_obj, *read_size_obj;
+
+    assert(n != READ_WHOLE_LINE);
+
+    /* Read from available buffer data, if any */
+    in_buffer = self->input_len - self->next_read_idx;
+    if (in_buffer >= n || (in_buffer > 0 && self->read == NULL)) {
+        char *s;
+        if (_Unpickler_Read(self, &s, n) < 0)
+            return -1;
+        memcpy(buf, s, n);
+        return n;
+    }
+    if (self->read == NULL)
+        return bad_readline();
+    if (in_buffer > 0) {
+        memcpy(buf, self->input_buffer + self->next_read_idx, in_buffer);
+        self->next_read_idx += in_buffer;
+    }
+    if (_Unpickler_SkipConsumed(self) < 0)
+        return -1;
+
+    if (self->readinto == NULL) {
+        /* Fall back to read() and copy into the destination */
+        PyObject *data, *len = PyLong_FromSsize_t(n - in_buffer);
+        if (len == NULL)
+            return -1;
+        data = _Pickle_FastCall(self->read, len);
+        if (data == NULL)
+            return -1;
+        if (!PyBytes_Check(data)) {
+            PyErr_Format(PyExc_ValueError,
+                         "read() returned non-bytes object (%R)",
+                         Py_TYPE(data));
+            Py_DECREF(data);
+            return -1;
+        }
+        if (PyBytes_GET_SIZE(data) < n - in_buffer) {
+            Py_DECREF(data);
+            return bad_readline();
+        }
+        memcpy(buf + in_buffer, PyBytes_AS_STRING(data), n - in_buffer);
+        Py_DECREF(data);
+        return n;
+    }
+
+    /* Call readinto() into the destination */
+    buf_obj = PyMemoryView_FromMemory(buf + in_buffer, n - in_buffer,
+                                      PyBUF_WRITE);
+    if (buf_obj == NULL)
+        return -1;
+    read_size_obj = _Pickle_FastCall(self->readinto, buf_obj);
+    if (read_size_obj == NULL)
+        return -1;
+    read_size = PyLong_AsSsize_t(read_size_obj);
+    Py_DECREF(read_size_obj);
+    if (read_size < 0) {
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(PyExc_ValueError,
+                            "readinto() returned negative size");
+        }
+        return -1;
+    }
+    if (read_size < n - in_buffer)
+        return bad_readline();
+    return n;
+}
+
 static Py_ssize_t
 _Unpickler_CopyLine(UnpicklerObject *self, char *line, Py_ssize_t len,
                     char **result)
@@ -1394,6 +1535,27 @@ _Unpickler_ResizeMemoList(UnpicklerObject *self, size_t new_size)
     return 0;
 }
 
+/* Make room in the memo for `n` more objects past the current ones, so
+   that memoizing them needs no further resize.  Returns -1 (with an
+   exception set) on failure, 0 on success. */
+static int
+_Unpickler_ReserveMemo(UnpicklerObject *self, size_t n)
+{
+    size_t needed = self->memo_len + n;
+
+    if (n > PY_SSIZE_T_MAX / sizeof(PyObject *) - self->memo_len) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (needed <= self->memo_size)
+        return 0;
+    /* Keep growing geometrically so a series of reservations stays
+       amortized O(1). */
+    if (needed < self->memo_size * 2)
+        needed = self->memo_size * 2;
+    return _Unpickler_ResizeMemoList(self, needed);
+}
+
 /* Returns NULL if idx is out of bounds. */
 static PyObject *
 _Unpickler_MemoGet(UnpicklerObject *self, size_t idx)
@@ -1412,7 +1574,8 @@ _Unpickler_MemoPut(UnpicklerObject *self, size_t idx, PyObject *value)
     PyObject *old_item;
 
     if (idx >= self->memo_size) {
-        if (_Unpickler_ResizeMemoList(self, idx * 2) < 0)
+        /* The memo is empty after being replaced by an empty dict */
+        if (_Unpickler_ResizeMemoList(self, idx ? idx * 2 : 32) < 0)
             return -1;
         assert(idx < self->memo_size);
     }
@@ -1475,6 +1638,9 @@ _Unpickler_New(void)
     self->read = NULL;
     self->readline = NULL;
     self->peek = NULL;
+    self->readinto = NULL;
+    self->buffers = NULL;
+    self->mmap_file = NULL;
     self->encoding = NULL;
     self->errors = NULL;
     self->marks = NULL;
@@ -1504,11 +1670,17 @@ _Unpickler_SetInputStream(UnpicklerObject *self, PyObject *file)
 {
     _Py_IDENTIFIER(peek);
     _Py_IDENTIFIER(read);
+    _Py_IDENTIFIER(readinto);
     _Py_IDENTIFIER(readline);
 
     if (_PyObject_LookupAttrId(file, &PyId_peek, &self->peek) < 0) {
         return -1;
     }
+    /* readinto() is optional: large payloads are read() otherwise */
+    if (_PyObject_LookupAttrId(file, &PyId_readinto, &self->readinto) < 0) {
+        Py_CLEAR(self->peek);
+        return -1;
+    }
     (void)_PyObject_LookupAttrId(file, &PyId_read, &self->read);
     (void)_PyObject_LookupAttrId(file, &PyId_readline, &self->readline);
     if (self->readline == NULL || self->read == NULL) {
@@ -1519,6 +1691,7 @@ _Unpickler_SetInputStream(UnpicklerObject *self, PyObject *file)
         Py_CLEAR(self->read);
         Py_CLEAR(self->readline);
         Py_CLEAR(self->peek);
+        Py_CLEAR(self->readinto);
         return -1;
     }
     return 0;
@@ -1545,6 +1718,35 @@ _Unpickler_SetInputEncoding(UnpicklerObject *self,
     return 0;
 }
 
+/* Returns -1 (with an exception set) on failure, 0 on success. This may
+   be called once on a freshly created Unpickler. */
+static int
+_Unpickler_SetBuffers(UnpicklerObject *self, PyObject *buffers)
+{
+    if (buffers == NULL || buffers == Py_None) {
+        self->buffers = NULL;
+    }
+    else {
+        self->buffers = PyObject_GetIter(buffers);
+        if (self->buffers == NULL) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Returns -1 (with an exception set) on failure, 0 on success. This may
+   be called once on a freshly created Unpickler. */
+static int
+_Unpickler_SetMappedFile(UnpicklerObject *self, PyObject *file, int use_mmap)
+{
+    if (use_mmap) {
+        Py_INCREF(file);
+        self->mmap_file = file;
+    }
+    return 0;
+}
+
 /* Generate a GET opcode for an object stored in the memo. */
 static int
 memo_get(PicklerObject *self, PyObject *key)
@@ -1611,7 +1813,8 @@ memo_put(PicklerObject *self, PyObject *obj)
     if (PyMemoTable_Set(self->memo, obj, idx) < 0)
         return -1;
 
-    if (self->proto >= 4) {
+    /* Chunks restart memo numbering at 0, which MEMOIZE can't express */
+    if (self->proto >= 4 && self->chunk_container == NULL) {
         if (_Pickler_Write(self, &memoize_op, 1) < 0)
             return -1;
         return 0;
@@ -2182,6 +2385,7 @@ _Pickler_write_bytes(PicklerObject *self,
             return -1;
         }
         Py_DECREF(result);
+        self->output_offset += data_size;
 
         /* Reinitialize the buffer for subsequent calls to _Pickler_Write. */
         if (_Pickler_ClearBuffer(self) < 0) {
@@ -2200,6 +2404,53 @@ _Pickler_write_bytes(PicklerObject *self,
     return 0;
 }
 
+static int
+_save_bytes_data(PicklerObject *self, PyObject *obj, const char *data,
+                 Py_ssize_t size)
+{
+    char header[9];
+    Py_ssize_t len;
+
+    assert(self->proto >= 3);
+    if (size < 0)
+        return -1;
+
+    if (size <= 0xff) {
+        header[0] = SHORT_BINBYTES;
+        header[1] = (unsigned char)size;
+        len = 2;
+    }
+    else if ((size_t)size <= 0xffffffffUL) {
+        header[0] = BINBYTES;
+        header[1] = (unsigned char)(size & 0xff);
+        header[2] = (unsigned char)((size >> 8) & 0xff);
+        header[3] = (unsigned char)((size >> 16) & 0xff);
+        header[4] = (unsigned char)((size >> 24) & 0xff);
+        len = 5;
+    }
+    else if (self->proto >= 4) {
+        header[0] = BINBYTES8;
+        _write_size64(header + 1, size);
+        len = 9;
+    }
+    else {
+        PyErr_SetString(PyExc_OverflowError,
+                        "cannot serialize a bytes object larger than 4 GiB");
+        return -1;          /* string too large */
+    }
+
+    if (_Pickler_write_bytes(self, header, len, data, size,
+                             PyBytes_Check(obj) ? obj : NULL) < 0) {
+        return -1;
+    }
+
+    if (memo_put(self, obj) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
 static int
 save_bytes(PicklerObject *self, PyObject *obj)
 {
@@ -2246,49 +2497,107 @@ save_bytes(PicklerObject *self, PyObject *obj)
         return status;
     }
     else {
-        Py_ssize_t size;
-        char header[9];
-        Py_ssize_t len;
+        return _save_bytes_data(self, obj, PyBytes_AS_STRING(obj),
+                                PyBytes_GET_SIZE(obj));
+    }
+}
 
-        size = PyBytes_GET_SIZE(obj);
-        if (size < 0)
-            return -1;
+static int
+_save_bytearray_data(PicklerObject *self, PyObject *obj, const char *data,
+                     Py_ssize_t size)
+{
+    char header[9];
+    Py_ssize_t len;
 
-        if (size <= 0xff) {
-            header[0] = SHORT_BINBYTES;
-            header[1] = (unsigned char)size;
-            len = 2;
+    assert(self->proto >= 5);
+    if (size < 0)
+        return -1;
+
+    header[0] = BYTEARRAY8;
+    _write_size64(header + 1, size);
+    len = 9;
+
+    if (_Pickler_write_bytes(self, header, len, data, size, NULL) < 0) {
+        return -1;
+    }
+
+    if (memo_put(self, obj) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Older protocols have no opcode for bytearrays, which are then reduced
+   with bytearray.__reduce_ex__(). */
+static int
+save_bytearray(PicklerObject *self, PyObject *obj)
+{
+    assert(self->proto >= 5);
+    return _save_bytearray_data(self, obj, PyByteArray_AS_STRING(obj),
+                                PyByteArray_GET_SIZE(obj));
+}
+
+static int
+save_picklebuffer(PicklerObject *self, PyObject *obj)
+{
+    const Py_buffer *view;
+    int in_band = 1;
+
+    if (self->proto < 5) {
+        PickleState *st = _Pickle_GetGlobalState();
+        PyErr_SetString(st->PicklingError,
+                        "PickleBuffer can only pickled with protocol >= 5");
+        return -1;
+    }
+    view = PyPickleBuffer_GetBuffer(obj);
+    if (view == NULL) {
+        return -1;
+    }
+    if (view->suboffsets != NULL || !PyBuffer_IsContiguous(view, 'A')) {
+        PickleState *st = _Pickle_GetGlobalState();
+        PyErr_SetString(st->PicklingError,
+                        "PickleBuffer can not be pickled when "
+                        "pointing to a non-contiguous buffer");
+        return -1;
+    }
+    if (self->buffer_callback != NULL) {
+        PyObject *ret = PyObject_CallFunctionObjArgs(self->buffer_callback,
+                                                     obj, NULL);
+        if (ret == NULL) {
+            return -1;
         }
-        else if ((size_t)size <= 0xffffffffUL) {
-            header[0] = BINBYTES;
-            header[1] = (unsigned char)(size & 0xff);
-            header[2] = (unsigned char)((size >> 8) & 0xff);
-            header[3] = (unsigned char)((size >> 16) & 0xff);
-            header[4] = (unsigned char)((size >> 24) & 0xff);
-            len = 5;
+        in_band = PyObject_IsTrue(ret);
+        Py_DECREF(ret);
+        if (in_band == -1) {
+            return -1;
         }
-        else if (self->proto >= 4) {
-            header[0] = BINBYTES8;
-            _write_size64(header + 1, size);
-            len = 9;
+    }
+    if (in_band) {
+        /* Write data in-band */
+        if (view->readonly) {
+            return _save_bytes_data(self, obj, (const char *)view->buf,
+                                    view->len);
         }
         else {
-            PyErr_SetString(PyExc_OverflowError,
-                            "cannot serialize a bytes object larger than 4 GiB");
-            return -1;          /* string too large */
+            return _save_bytearray_data(self, obj, (const char *)view->buf,
+                                        view->len);
         }
-
-        if (_Pickler_write_bytes(self, header, len,
-                                 PyBytes_AS_STRING(obj), size, obj) < 0)
-        {
+    }
+    else {
+        /* Write data out-of-band */
+        const char next_buffer_op = NEXT_BUFFER;
+        if (_Pickler_Write(self, &next_buffer_op, 1) < 0) {
             return -1;
         }
-
-        if (memo_put(self, obj) < 0)
-            return -1;
-
-        return 0;
+        if (view->readonly) {
+            const char readonly_buffer_op = READONLY_BUFFER;
+            if (_Pickler_Write(self, &readonly_buffer_op, 1) < 0) {
+                return -1;
+            }
+        }
     }
+    return 0;
 }
 
 /* A copy of PyUnicode_EncodeRawUnicodeEscape() that also translates
@@ -4000,10 +4309,25 @@ save(PicklerObject *self, PyObject *obj, int pers_save)
         goto done;
     }
 
+    if (obj == self->chunk_container) {
+        PickleState *st = _Pickle_GetGlobalState();
+        PyErr_SetString(st->PicklingError,
+                        "can't pickle a reference to a chunked container");
+        goto error;
+    }
+
     if (type == &PyBytes_Type) {
         status = save_bytes(self, obj);
         goto done;
     }
+    else if (type == &PyByteArray_Type && self->proto >= 5) {
+        status = save_bytearray(self, obj);
+        goto done;
+    }
+    else if (type == &PyPickleBuffer_Type) {
+        status = save_picklebuffer(self, obj);
+        goto done;
+    }
     else if (type == &PyUnicode_Type) {
         status = save_unicode(self, obj);
         goto done;
@@ -4146,11 +4470,158 @@ save(PicklerObject *self, PyObject *obj, int pers_save)
     return status;
 }
 
+/* A chunked pickle is an ordinary pickle of a list or dict whose items
+   are split into chunks.  Each chunk is an APPENDS or SETITEMS group that
+   starts a new frame with an empty memo, so that it can be decoded on its
+   own (see pickle.load_chunk()).  Objects shared by items of different
+   chunks are pickled once per chunk, and aren't shared once loaded.
+
+   The index of the chunks ends the pickle, as a BINBYTES8 object popped
+   right before STOP, so that loaders skip it and the pickle can be
+   followed by others in the same file: an (offset, length) pair of 8-byte
+   little-endian integers per chunk, relative to the start of the pickle,
+   then a trailer holding the offset of the index, the number of chunks,
+   the protocol, the opcode creating the container and CHUNK_MAGIC. */
+#define CHUNK_MAGIC "PKLCHK"
+#define CHUNK_TRAILER_SIZE 24
+
+static int
+dump_chunked(PicklerObject *self, PyObject *obj)
+{
+    const char mark_op = MARK;
+    const char tail[2] = {POP, STOP};
+    char container_op, items_op;
+    size_t *index = NULL;
+    Py_ssize_t nchunks = 0, allocated = 0;
+    Py_ssize_t i = 0, dict_pos = 0, dict_size = 0, count, index_offset;
+    PyObject *key, *value;
+    char header[9];
+    char trailer[CHUNK_TRAILER_SIZE];
+    int is_list = PyList_CheckExact(obj);
+
+    if (is_list) {
+        container_op = EMPTY_LIST;
+        items_op = APPENDS;
+    }
+    else {
+        container_op = EMPTY_DICT;
+        items_op = SETITEMS;
+        dict_size = PyDict_GET_SIZE(obj);
+    }
+    /* The container itself isn't memoized: a chunk referring to it
+       couldn't be decoded on its own. */
+    if (_Pickler_Write(self, &container_op, 1) < 0)
+        return -1;
+
+    for (;;) {
+        Py_ssize_t chunk_start;
+
+        if (is_list ? i >= PyList_GET_SIZE(obj) : i >= dict_size)
+            break;
+        if (nchunks == allocated) {
+            allocated = allocated * 2 + 16;
+            if (!PyMem_Resize(index, size_t, allocated * 2)) {
+                PyErr_NoMemory();
+                goto error;
+            }
+        }
+
+        if (_Pickler_CommitFrame(self) < 0)
+            goto error;
+        PyMemoTable_Clear(self->memo);
+        self->chunk_container = obj;
+        chunk_start = self->output_offset + self->output_len;
+        if (_Pickler_Write(self, &mark_op, 1) < 0)
+            goto error;
+
+        if (is_list) {
+            for (count = 0; count < self->chunk_size &&
+                            i < PyList_GET_SIZE(obj); count++, i++) {
+                PyObject *item = PyList_GET_ITEM(obj, i);
+                int status;
+
+                Py_INCREF(item);
+                status = save(self, item, 0);
+                Py_DECREF(item);
+                if (status < 0)
+                    goto error;
+            }
+        }
+        else {
+            for (count = 0; count < self->chunk_size &&
+                            PyDict_Next(obj, &dict_pos, &key, &value);
+                 count++, i++) {
+                int status;
+
+                Py_INCREF(key);
+                Py_INCREF(value);
+                status = save(self, key, 0);
+                if (status == 0)
+                    status = save(self, value, 0);
+                Py_DECREF(key);
+                Py_DECREF(value);
+                if (status < 0)
+                    goto error;
+                if (PyDict_GET_SIZE(obj) != dict_size) {
+                    PyErr_Format(
+                        PyExc_RuntimeError,
+                        "dictionary changed size during iteration");
+                    goto error;
+                }
+            }
+        }
+
+        if (_Pickler_Write(self, &items_op, 1) < 0 ||
+            _Pickler_CommitFrame(self) < 0)
+            goto error;
+        self->chunk_container = NULL;
+        index[2 * nchunks] = (size_t)chunk_start;
+        index[2 * nchunks + 1] =
+            (size_t)(self->output_offset + self->output_len - chunk_start);
+        nchunks++;
+    }
+    PyMemoTable_Clear(self->memo);
+
+    /* Write the index outside of any frame, so that it ends the data */
+    if (_Pickler_CommitFrame(self) < 0)
+        goto error;
+    self->framing = 0;
+    header[0] = BINBYTES8;
+    _write_size64(header + 1, (size_t)(nchunks * 16 + CHUNK_TRAILER_SIZE));
+    if (_Pickler_Write(self, header, 9) < 0)
+        goto error;
+    index_offset = self->output_offset + self->output_len;
+    for (i = 0; i < nchunks * 2; i++) {
+        char qdata[8];
+
+        _write_size64(qdata, index[i]);
+        if (_Pickler_Write(self, qdata, 8) < 0)
+            goto error;
+    }
+    _write_size64(trailer, (size_t)index_offset);
+    _write_size64(trailer + 8, (size_t)nchunks);
+    trailer[16] = (unsigned char)self->proto;
+    trailer[17] = container_op;
+    memcpy(trailer + 18, CHUNK_MAGIC, 6);
+    if (_Pickler_Write(self, trailer, CHUNK_TRAILER_SIZE) < 0 ||
+        _Pickler_Write(self, tail, 2) < 0)
+        goto error;
+
+    PyMem_Free(index);
+    return 0;
+
+  error:
+    self->chunk_container = NULL;
+    PyMem_Free(index);
+    return -1;
+}
+
 static int
 dump(PicklerObject *self, PyObject *obj)
 {
     const char stop_op = STOP;
 
+    self->output_offset = 0;
     if (self->proto >= 2) {
         char header[2];
 
@@ -4163,6 +4634,14 @@ dump(PicklerObject *self, PyObject *obj)
             self->framing = 1;
     }
 
+    if (self->chunk_size > 0 &&
+        (PyList_CheckExact(obj) || PyDict_CheckExact(obj))) {
+        int status = dump_chunked(self, obj);
+
+        self->framing = 0;
+        return status;
+    }
+
     if (save(self, obj, 0) < 0 ||
         _Pickler_Write(self, &stop_op, 1) < 0 ||
         _Pickler_CommitFrame(self) < 0)
@@ -4274,6 +4753,7 @@ Pickler_dealloc(PicklerObject *self)
     Py_XDECREF(self->pers_func);
     Py_XDECREF(self->dispatch_table);
     Py_XDECREF(self->fast_memo);
+    Py_XDECREF(self->buffer_callback);
 
     PyMemoTable_Del(self->memo);
 
@@ -4287,6 +4767,7 @@ Pickler_traverse(PicklerObject *self, visitproc visit, void *arg)
     Py_VISIT(self->pers_func);
     Py_VISIT(self->dispatch_table);
     Py_VISIT(self->fast_memo);
+    Py_VISIT(self->buffer_callback);
     return 0;
 }
 
@@ -4298,6 +4779,7 @@ Pickler_clear(PicklerObject *self)
     Py_CLEAR(self->pers_func);
     Py_CLEAR(self->dispatch_table);
     Py_CLEAR(self->fast_memo);
+    Py_CLEAR(self->buffer_callback);
 
     if (self->memo != NULL) {
         PyMemoTable *memo = self->memo;
@@ -4315,11 +4797,13 @@ _pickle.Pickler.__init__
   file: object
   protocol: object = NULL
   fix_imports: bool = True
+  buffer_callback: object = None
+  chunk_size: Py_ssize_t = 0
 
 This takes a binary file for writing a pickle data stream.
 
 The optional *protocol* argument tells the pickler to use the given
-protocol; supported protocols are 0, 1, 2, 3 and 4.  The default
+protocol; supported protocols are 0, 1, 2, 3, 4 and 5.  The default
 protocol is 3; a backward-incompatible protocol designed for Python 3.
 
 Specifying a negative protocol version selects the highest protocol
@@ -4334,12 +4818,32 @@ this interface.
 If *fix_imports* is True and protocol is less than 3, pickle will try
 to map the new Python 3 names to the old module names used in Python
 2, so that the pickle data stream is readable with Python 2.
+
+If *buffer_callback* is None (the default), buffer views are
+serialized into *file* as part of the pickle stream.
+
+If *buffer_callback* is not None, then it can be called any number
+of times with a buffer view.  If the callback returns a false value
+(such as None), the given buffer is out-of-band; otherwise the
+buffer is serialized in-band, i.e. inside the pickle stream.
+
+It is an error if *buffer_callback* is not None and *protocol* is
+None or smaller than 5.
+
+If *chunk_size* is positive, a list or dict passed to dump() is pickled
+in chunks of *chunk_size* items that can be decoded independently of
+each other with pickle.load_chunk(), for instance by several processes.
+Items may not refer to the container itself, and objects shared by
+items of different chunks are no longer shared once loaded.  The pickle
+can still be loaded as usual.  This needs *protocol* 4 or higher.
 [clinic start generated code]*/
 
 static int
 _pickle_Pickler___init___impl(PicklerObject *self, PyObject *file,
-                              PyObject *protocol, int fix_imports)
-/*[clinic end generated code: output=b5f31078dab17fb0 input=4faabdbc763c2389]*/
+                              PyObject *protocol, int fix_imports,
+                              PyObject *buffer_callback,
+                              Py_ssize_t chunk_size)
+/*[clinic end generated code: output=0146be1000c2a232 input=3f09f8dc99124f85]*/
 {
     _Py_IDENTIFIER(persistent_id);
     _Py_IDENTIFIER(dispatch_table);
@@ -4354,6 +4858,12 @@ _pickle_Pickler___init___impl(PicklerObject *self, PyObject *file,
     if (_Pickler_SetOutputStream(self, file) < 0)
         return -1;
 
+    if (_Pickler_SetBufferCallback(self, buffer_callback) < 0)
+        return -1;
+
+    if (_Pickler_SetChunkSize(self, chunk_size) < 0)
+        return -1;
+
     /* memo and output_buffer may have already been created in _Pickler_New */
     if (self->memo == NULL) {
         self->memo = PyMemoTable_New();
@@ -5142,17 +5652,111 @@ load_counted_binbytes(UnpicklerObject *self, int nbytes)
         return -1;
     }
 
-    if (_Unpickler_Read(self, &s, size) < 0)
-        return -1;
+    /* Don't allocate for a truncated in-memory pickle */
+    if (self->read == NULL && size > self->input_len - self->next_read_idx)
+        return bad_readline();
 
-    bytes = PyBytes_FromStringAndSize(s, size);
+    bytes = PyBytes_FromStringAndSize(NULL, size);
     if (bytes == NULL)
         return -1;
+    if (_Unpickler_ReadInto(self, PyBytes_AS_STRING(bytes), size) < 0) {
+        Py_DECREF(bytes);
+        return -1;
+    }
 
     PDATA_PUSH(self->stack, bytes, -1);
     return 0;
 }
 
+static int
+load_counted_bytearray(UnpicklerObject *self)
+{
+    PyObject *bytearray;
+    Py_ssize_t size;
+    char *s;
+
+    if (_Unpickler_Read(self, &s, 8) < 0) {
+        return -1;
+    }
+
+    size = calc_binsize(s, 8);
+    if (size < 0) {
+        PyErr_Format(PyExc_OverflowError,
+                     "BYTEARRAY8 exceeds system's maximum size of %zd bytes",
+                     PY_SSIZE_T_MAX);
+        return -1;
+    }
+
+    if (self->read == NULL && size > self->input_len - self->next_read_idx)
+        return bad_readline();
+
+    bytearray = PyByteArray_FromStringAndSize(NULL, size);
+    if (bytearray == NULL) {
+        return -1;
+    }
+    if (_Unpickler_ReadInto(self, PyByteArray_AS_STRING(bytearray), size) < 0) {
+        Py_DECREF(bytearray);
+        return -1;
+    }
+
+    PDATA_PUSH(self->stack, bytearray, -1);
+    return 0;
+}
+
+static int
+load_next_buffer(UnpicklerObject *self)
+{
+    PyObject *buf;
+
+    if (self->buffers == NULL) {
+        PickleState *st = _Pickle_GetGlobalState();
+        PyErr_SetString(st->UnpicklingError,
+                        "pickle stream refers to out-of-band data "
+                        "but no *buffers* argument was given");
+        return -1;
+    }
+    buf = PyIter_Next(self->buffers);
+    if (buf == NULL) {
+        if (!PyErr_Occurred()) {
+            PickleState *st = _Pickle_GetGlobalState();
+            PyErr_SetString(st->UnpicklingError,
+                            "not enough out-of-band buffers");
+        }
+        return -1;
+    }
+
+    PDATA_PUSH(self->stack, buf, -1);
+    return 0;
+}
+
+static int
+load_readonly_buffer(UnpicklerObject *self)
+{
+    Py_ssize_t len = Py_SIZE(self->stack);
+    PyObject *obj, *view;
+
+    if (len <= self->stack->fence) {
+        return Pdata_stack_underflow(self->stack);
+    }
+
+    obj = self->stack->data[len - 1];
+    view = PyMemoryView_FromObject(obj);
+    if (view == NULL) {
+        return -1;
+    }
+    if (!PyMemoryView_GET_BUFFER(view)->readonly) {
+        /* Original object is writable */
+        PyMemoryView_GET_BUFFER(view)->readonly = 1;
+        self->stack->data[len - 1] = view;
+        Py_DECREF(obj);
+    }
+    else {
+        /* Original object is read-only, no need to replace it */
+        Py_DECREF(view);
+    }
+    return 0;
+}
+
 static int
 load_unicode(UnpicklerObject *self)
 {
@@ -6190,6 +6794,56 @@ load_additems(UnpicklerObject *self)
     return 0;
 }
 
+/* Fast path of load_build() for instances of plain classes: no
+   __setstate__, generic attribute lookup and no instance dict yet.  The
+   dict is created directly from the class's shared keys and filled from
+   the state dict without going through attribute lookups.  Returns 1 if
+   the state was set, 0 if the generic path must be taken and -1 on
+   error. */
+static int
+load_build_plain(PyObject *inst, PyObject *state)
+{
+    PyTypeObject *tp = Py_TYPE(inst);
+    PyObject **dictptr, *descr, *dict;
+    PyObject *d_key, *d_value;
+    Py_hash_t hash;
+    Py_ssize_t i;
+    _Py_IDENTIFIER(__setstate__);
+    _Py_IDENTIFIER(__dict__);
+
+    if (!PyDict_CheckExact(state) ||
+        tp->tp_getattro != PyObject_GenericGetAttr)
+        return 0;
+    dictptr = _PyObject_GetDictPtr(inst);
+    if (dictptr == NULL || *dictptr != NULL)
+        return 0;
+    /* Without an instance dict, the type is the only place where
+       __setstate__ could be found. */
+    if (_PyType_LookupId(tp, &PyId___setstate__) != NULL)
+        return 0;
+    descr = _PyType_LookupId(tp, &PyId___dict__);
+    if (descr == NULL || Py_TYPE(descr) != &PyGetSetDescr_Type)
+        return 0;
+
+    dict = PyObject_GenericGetDict(inst, NULL);
+    if (dict == NULL)
+        return -1;
+    i = 0;
+    while (_PyDict_Next(state, &i, &d_key, &d_value, &hash)) {
+        Py_INCREF(d_key);
+        if (PyUnicode_CheckExact(d_key))
+            PyUnicode_InternInPlace(&d_key);
+        if (_PyDict_SetItem_KnownHash(dict, d_key, d_value, hash) < 0) {
+            Py_DECREF(d_key);
+            Py_DECREF(dict);
+            return -1;
+        }
+        Py_DECREF(d_key);
+    }
+    Py_DECREF(dict);
+    return 1;
+}
+
 static int
 load_build(UnpicklerObject *self)
 {
@@ -6210,6 +6864,12 @@ load_build(UnpicklerObject *self)
 
     inst = self->stack->data[Py_SIZE(self->stack) - 1];
 
+    status = load_build_plain(inst, state);
+    if (status != 0) {
+        Py_DECREF(state);
+        return status < 0 ? -1 : 0;
+    }
+
     if (_PyObject_LookupAttrId(inst, &PyId___setstate__, &setstate) < 0) {
         Py_DECREF(state);
         return -1;
@@ -6406,6 +7066,15 @@ load_frame(UnpicklerObject *self)
 
     /* Rewind to start of frame */
     self->next_read_idx -= frame_len;
+
+    /* Every memoized object takes at least two opcodes, so the frame
+       can't add more than frame_len / 2 memo entries.  Reserving them now
+       replaces the repeated resizing of a growing memo by one resize per
+       frame.  Unusually large frames mostly hold a few large objects and
+       are left to grow the memo as needed. */
+    if (frame_len <= FRAME_MEMO_HINT_MAX &&
+        _Unpickler_ReserveMemo(self, (size_t)frame_len / 2) < 0)
+        return -1;
     return 0;
 }
 
@@ -6452,6 +7121,9 @@ load(UnpicklerObject *self)
         OP_ARG(SHORT_BINBYTES, load_counted_binbytes, 1)
         OP_ARG(BINBYTES, load_counted_binbytes, 4)
         OP_ARG(BINBYTES8, load_counted_binbytes, 8)
+        OP(BYTEARRAY8, load_counted_bytearray)
+        OP(NEXT_BUFFER, load_next_buffer)
+        OP(READONLY_BUFFER, load_readonly_buffer)
         OP_ARG(SHORT_BINSTRING, load_counted_binstring, 1)
         OP_ARG(BINSTRING, load_counted_binstring, 4)
         OP(STRING, load_string)
@@ -6537,6 +7209,136 @@ load(UnpicklerObject *self)
     return value;
 }
 
+/* Map self->mmap_file for reading.  Returns the mapping with *pos set to
+   the current file position, NULL without an exception set if the file
+   can't be mapped (pipes, sockets, empty files...) or NULL with an
+   exception set on error. */
+static PyObject *
+_Unpickler_MapFile(UnpicklerObject *self, Py_ssize_t *pos)
+{
+    PyObject *file = self->mmap_file;
+    PyObject *module, *fd, *res, *mapping;
+    _Py_IDENTIFIER(fileno);
+    _Py_IDENTIFIER(tell);
+    _Py_IDENTIFIER(mmap);
+    _Py_IDENTIFIER(ACCESS_READ);
+
+    fd = _PyObject_CallMethodId(file, &PyId_fileno, NULL);
+    if (fd == NULL)
+        goto fallback;
+    res = _PyObject_CallMethodId(file, &PyId_tell, NULL);
+    if (res == NULL) {
+        Py_DECREF(fd);
+        goto fallback;
+    }
+    *pos = PyLong_AsSsize_t(res);
+    Py_DECREF(res);
+    if (*pos == -1 && PyErr_Occurred()) {
+        Py_DECREF(fd);
+        return NULL;
+    }
+
+    module = PyImport_ImportModule("mmap");
+    if (module == NULL) {
+        Py_DECREF(fd);
+        goto fallback;
+    }
+    mapping = NULL;
+    res = _PyObject_GetAttrId(module, &PyId_ACCESS_READ);
+    if (res != NULL) {
+        PyObject *func = _PyObject_GetAttrId(module, &PyId_mmap);
+        PyObject *args = Py_BuildValue("(Oi)", fd, 0);
+        PyObject *kwargs = Py_BuildValue("{sO}", "access", res);
+
+        if (func != NULL && args != NULL && kwargs != NULL)
+            mapping = PyObject_Call(func, args, kwargs);
+        Py_XDECREF(func);
+        Py_XDECREF(args);
+        Py_XDECREF(kwargs);
+        Py_DECREF(res);
+    }
+    Py_DECREF(module);
+    Py_DECREF(fd);
+    if (mapping == NULL)
+        goto fallback;
+    if (*pos < 0 || *pos > PyObject_Size(mapping)) {
+        Py_DECREF(mapping);
+        return NULL;
+    }
+    return mapping;
+
+  fallback:
+    if (PyErr_ExceptionMatches(PyExc_OSError) ||
+        PyErr_ExceptionMatches(PyExc_ValueError) ||
+        PyErr_ExceptionMatches(PyExc_AttributeError) ||
+        PyErr_ExceptionMatches(PyExc_ImportError))
+        PyErr_Clear();
+    return NULL;
+}
+
+/* Load a pickle from a read-only mapping of self->mmap_file, which avoids
+   copying the input through read(), and move the file past the pickle.
+   Streams that can't be mapped are read as usual. */
+static PyObject *
+load_mapped(UnpicklerObject *self)
+{
+    PyObject *mapping, *value, *res;
+    PyObject *read, *readline, *peek, *readinto;
+    Py_ssize_t pos, end;
+    _Py_IDENTIFIER(seek);
+
+    mapping = _Unpickler_MapFile(self, &pos);
+    if (mapping == NULL) {
+        if (PyErr_Occurred())
+            return NULL;
+        return load(self);
+    }
+    if (_Unpickler_SetStringInput(self, mapping) < 0) {
+        Py_DECREF(mapping);
+        return NULL;
+    }
+    Py_DECREF(mapping);
+    self->next_read_idx = pos;
+
+    /* Running past the end of the mapping is the end of the file: don't
+       let the reading functions fall back to the stream. */
+    read = self->read;
+    readline = self->readline;
+    peek = self->peek;
+    readinto = self->readinto;
+    self->read = self->readline = self->peek = self->readinto = NULL;
+
+    value = load(self);
+    end = self->next_read_idx;
+
+    /* load() may have reentered __init__() through find_class() or
+       persistent_load(): keep what it installed in that case. */
+#define RESTORE(field) \
+    if (self->field == NULL) self->field = field; else Py_XDECREF(field)
+    RESTORE(read);
+    RESTORE(readline);
+    RESTORE(peek);
+    RESTORE(readinto);
+#undef RESTORE
+
+    /* Unmaps the file */
+    PyBuffer_Release(&self->buffer);
+    self->input_buffer = NULL;
+    self->input_len = 0;
+    self->next_read_idx = 0;
+    self->prefetched_idx = 0;
+
+    if (value != NULL) {
+        res = _PyObject_CallMethodId(self->mmap_file, &PyId_seek, "n", end);
+        if (res == NULL) {
+            Py_DECREF(value);
+            return NULL;
+        }
+        Py_DECREF(res);
+    }
+    return value;
+}
+
 /*[clinic input]
 
 _pickle.Unpickler.load
@@ -6566,6 +7368,8 @@ _pickle_Unpickler_load_impl(UnpicklerObject *self)
         return NULL;
     }
 
+    if (unpickler->mmap_file != NULL)
+        return load_mapped(unpickler);
     return load(unpickler);
 }
 
@@ -6709,6 +7513,9 @@ Unpickler_dealloc(UnpicklerObject *self)
     Py_XDECREF(self->readline);
     Py_XDECREF(self->read);
     Py_XDECREF(self->peek);
+    Py_XDECREF(self->readinto);
+    Py_XDECREF(self->buffers);
+    Py_XDECREF(self->mmap_file);
     Py_XDECREF(self->stack);
     Py_XDECREF(self->pers_func);
     if (self->buffer.buf != NULL) {
@@ -6731,6 +7538,9 @@ Unpickler_traverse(UnpicklerObject *self, visitproc visit, void *arg)
     Py_VISIT(self->readline);
     Py_VISIT(self->read);
     Py_VISIT(self->peek);
+    Py_VISIT(self->readinto);
+    Py_VISIT(self->buffers);
+    Py_VISIT(self->mmap_file);
     Py_VISIT(self->stack);
     Py_VISIT(self->pers_func);
     return 0;
@@ -6742,6 +7552,9 @@ Unpickler_clear(UnpicklerObject *self)
     Py_CLEAR(self->readline);
     Py_CLEAR(self->read);
     Py_CLEAR(self->peek);
+    Py_CLEAR(self->readinto);
+    Py_CLEAR(self->buffers);
+    Py_CLEAR(self->mmap_file);
     Py_CLEAR(self->stack);
     Py_CLEAR(self->pers_func);
     if (self->buffer.buf != NULL) {
@@ -6771,6 +7584,8 @@ _pickle.Unpickler.__init__
   fix_imports: bool = True
   encoding: str = 'ASCII'
   errors: str = 'strict'
+  buffers: object = None
+  use_mmap: bool = False
 
 This takes a binary file for reading a pickle data stream.
 
@@ -6792,13 +7607,23 @@ map the old Python 2 names to the new names used in Python 3.  The
 instances pickled by Python 2; these default to 'ASCII' and 'strict',
 respectively.  The *encoding* can be 'bytes' to read these 8-bit
 string instances as bytes objects.
+
+If *buffers* is not None, it should be an iterable of buffer-enabled
+objects that is consumed each time the pickle stream references an
+out-of-band buffer view.  Such buffers have been given in order to
+the *buffer_callback* of a Pickler object.
+
+If *use_mmap* is true and *file* is a regular file, load() maps it
+into memory and parses the pickle in place instead of read()ing it,
+then seeks the file past the pickle.  Other files are read as usual.
 [clinic start generated code]*/
 
 static int
 _pickle_Unpickler___init___impl(UnpicklerObject *self, PyObject *file,
                                 int fix_imports, const char *encoding,
-                                const char *errors)
-/*[clinic end generated code: output=e2c8ce748edc57b0 input=f9b7da04f5f4f335]*/
+                                const char *errors, PyObject *buffers,
+                                int use_mmap)
+/*[clinic end generated code: output=a750571cbb055882 input=17b5f443a2e9d054]*/
 {
     _Py_IDENTIFIER(persistent_load);
 
@@ -6812,6 +7637,12 @@ _pickle_Unpickler___init___impl(UnpicklerObject *self, PyObject *file,
     if (_Unpickler_SetInputEncoding(self, encoding, errors) < 0)
         return -1;
 
+    if (_Unpickler_SetBuffers(self, buffers) < 0)
+        return -1;
+
+    if (_Unpickler_SetMappedFile(self, file, use_mmap) < 0)
+        return -1;
+
     self->fix_imports = fix_imports;
 
     if (init_method_ref((PyObject *)self, &PyId_persistent_load,
@@ -7190,6 +8021,8 @@ _pickle.dump
   protocol: object = NULL
   *
   fix_imports: bool = True
+  buffer_callback: object = None
+  chunk_size: Py_ssize_t = 0
 
 Write a pickled representation of obj to the open file object file.
 
@@ -7197,7 +8030,7 @@ This is equivalent to ``Pickler(file, protocol).dump(obj)``, but may
 be more efficient.
 
 The optional *protocol* argument tells the pickler to use the given
-protocol supported protocols are 0, 1, 2, 3 and 4.  The default
+protocol; supported protocols are 0, 1, 2, 3, 4 and 5.  The default
 protocol is 3; a backward-incompatible protocol designed for Python 3.
 
 Specifying a negative protocol version selects the highest protocol
@@ -7212,12 +8045,20 @@ this interface.
 If *fix_imports* is True and protocol is less than 3, pickle will try
 to map the new Python 3 names to the old module names used in Python
 2, so that the pickle data stream is readable with Python 2.
+
+If *buffer_callback* is None (the default), buffer views are serialized
+into *file* as part of the pickle stream.  It is an error if
+*buffer_callback* is not None and *protocol* is None or smaller than 5.
+
+If *chunk_size* is positive, a list or dict *obj* is pickled in
+independently decodable chunks of *chunk_size* items, see Pickler.
 [clinic start generated code]*/
 
 static PyObject *
 _pickle_dump_impl(PyObject *module, PyObject *obj, PyObject *file,
-                  PyObject *protocol, int fix_imports)
-/*[clinic end generated code: output=a4774d5fde7d34de input=830f8a64cef6f042]*/
+                  PyObject *protocol, int fix_imports,
+                  PyObject *buffer_callback, Py_ssize_t chunk_size)
+/*[clinic end generated code: output=3137c3912b81f53c input=eedfd9b1a44eaec4]*/
 {
     PicklerObject *pickler = _Pickler_New();
 
@@ -7230,6 +8071,12 @@ _pickle_dump_impl(PyObject *module, PyObject *obj, PyObject *file,
     if (_Pickler_SetOutputStream(pickler, file) < 0)
         goto error;
 
+    if (_Pickler_SetBufferCallback(pickler, buffer_callback) < 0)
+        goto error;
+
+    if (_Pickler_SetChunkSize(pickler, chunk_size) < 0)
+        goto error;
+
     if (dump(pickler, obj) < 0)
         goto error;
 
@@ -7252,11 +8099,13 @@ _pickle.dumps
   protocol: object = NULL
   *
   fix_imports: bool = True
+  buffer_callback: object = None
+  chunk_size: Py_ssize_t = 0
 
 Return the pickled representation of the object as a bytes object.
 
 The optional *protocol* argument tells the pickler to use the given
-protocol; supported protocols are 0, 1, 2, 3 and 4.  The default
+protocol; supported protocols are 0, 1, 2, 3, 4 and 5.  The default
 protocol is 3; a backward-incompatible protocol designed for Python 3.
 
 Specifying a negative protocol version selects the highest protocol
@@ -7266,12 +8115,20 @@ version of Python needed to read the pickle produced.
 If *fix_imports* is True and *protocol* is less than 3, pickle will
 try to map the new Python 3 names to the old module names used in
 Python 2, so that the pickle data stream is readable with Python 2.
+
+If *buffer_callback* is None (the default), buffer views are serialized
+into the returned bytes object.  It is an error if *buffer_callback* is
+not None and *protocol* is None or smaller than 5.
+
+If *chunk_size* is positive, a list or dict *obj* is pickled in
+independently decodable chunks of *chunk_size* items, see Pickler.
 [clinic start generated code]*/
 
 static PyObject *
 _pickle_dumps_impl(PyObject *module, PyObject *obj, PyObject *protocol,
-                   int fix_imports)
-/*[clinic end generated code: output=d75d5cda456fd261 input=293dbeda181580b7]*/
+                   int fix_imports, PyObject *buffer_callback,
+                   Py_ssize_t chunk_size)
+/*[clinic end generated code: output=d548c9e138243e15 input=a445b532f84f56f1]*/
 {
     PyObject *result;
     PicklerObject *pickler = _Pickler_New();
@@ -7282,6 +8139,12 @@ _pickle_dumps_impl(PyObject *module, PyObject *obj, PyObject *protocol,
     if (_Pickler_SetProtocol(pickler, protocol, fix_imports) < 0)
         goto error;
 
+    if (_Pickler_SetBufferCallback(pickler, buffer_callback) < 0)
+        goto error;
+
+    if (_Pickler_SetChunkSize(pickler, chunk_size) < 0)
+        goto error;
+
     if (dump(pickler, obj) < 0)
         goto error;
 
@@ -7303,6 +8166,8 @@ _pickle.load
   fix_imports: bool = True
   encoding: str = 'ASCII'
   errors: str = 'strict'
+  buffers: object = None
+  use_mmap: bool = False
 
 Read and return an object from the pickle data stored in a file.
 
@@ -7327,12 +8192,19 @@ map the old Python 2 names to the new names used in Python 3.  The
 instances pickled by Python 2; these default to 'ASCII' and 'strict',
 respectively.  The *encoding* can be 'bytes' to read these 8-bit
 string instances as bytes objects.
+
+If *buffers* is not None, it is an iterable of the out-of-band buffers
+referenced by the pickle stream.
+
+If *use_mmap* is true and *file* is a regular file, it is mapped into
+memory and parsed in place instead of being read().
 [clinic start generated code]*/
 
 static PyObject *
 _pickle_load_impl(PyObject *module, PyObject *file, int fix_imports,
-                  const char *encoding, const char *errors)
-/*[clinic end generated code: output=69e298160285199e input=01b44dd3fc07afa7]*/
+                  const char *encoding, const char *errors,
+                  PyObject *buffers, int use_mmap)
+/*[clinic end generated code: output=55a381eb865cda24 input=baa1dc74e8d51f94]*/
 {
     PyObject *result;
     UnpicklerObject *unpickler = _Unpickler_New();
@@ -7346,9 +8218,18 @@ _pickle_load_impl(PyObject *module, PyObject *file, int fix_imports,
     if (_Unpickler_SetInputEncoding(unpickler, encoding, errors) < 0)
         goto error;
 
+    if (_Unpickler_SetBuffers(unpickler, buffers) < 0)
+        goto error;
+
+    if (_Unpickler_SetMappedFile(unpickler, file, use_mmap) < 0)
+        goto error;
+
     unpickler->fix_imports = fix_imports;
 
-    result = load(unpickler);
+    if (unpickler->mmap_file != NULL)
+        result = load_mapped(unpickler);
+    else
+        result = load(unpickler);
     Py_DECREF(unpickler);
     return result;
 
@@ -7366,6 +8247,7 @@ _pickle.loads
   fix_imports: bool = True
   encoding: str = 'ASCII'
   errors: str = 'strict'
+  buffers: object = None
 
 Read and return an object from the given pickle data.
 
@@ -7381,12 +8263,16 @@ map the old Python 2 names to the new names used in Python 3.  The
 instances pickled by Python 2; these default to 'ASCII' and 'strict',
 respectively.  The *encoding* can be 'bytes' to read these 8-bit
 string instances as bytes objects.
+
+If *buffers* is not None, it is an iterable of the out-of-band buffers
+referenced by the pickle stream.
 [clinic start generated code]*/
 
 static PyObject *
 _pickle_loads_impl(PyObject *module, PyObject *data, int fix_imports,
-                   const char *encoding, const char *errors)
-/*[clinic end generated code: output=1e7cb2343f2c440f input=70605948a719feb9]*/
+                   const char *encoding, const char *errors,
+                   PyObject *buffers)
+/*[clinic end generated code: output=82ac1e6b588e6d02 input=91b5a6a35559fce6]*/
 {
     PyObject *result;
     UnpicklerObject *unpickler = _Unpickler_New();
@@ -7400,6 +8286,9 @@ _pickle_loads_impl(PyObject *module, PyObject *data, int fix_imports,
     if (_Unpickler_SetInputEncoding(unpickler, encoding, errors) < 0)
         goto error;
 
+    if (_Unpickler_SetBuffers(unpickler, buffers) < 0)
+        goto error;
+
     unpickler->fix_imports = fix_imports;
 
     result = load(unpickler);
@@ -7499,6 +8388,10 @@ PyInit__pickle(void)
     Py_INCREF(&Unpickler_Type);
     if (PyModule_AddObject(m, "Unpickler", (PyObject *)&Unpickler_Type) < 0)
         return NULL;
+    Py_INCREF(&PyPickleBuffer_Type);
+    if (PyModule_AddObject(m, "PickleBuffer",
+                           (PyObject *)&PyPickleBuffer_Type) < 0)
+        return NULL;
 
     st = _Pickle_GetState(m);
 
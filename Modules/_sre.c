@@ -196,14 +196,48 @@ char_loc_ignore(SRE_CODE pattern, SRE_CODE ch)
         || (SRE_CODE) sre_upper_locale(ch) == pattern;
 }
 
+/* test a character against a 256-bit CHARSET bitmap */
+#define SRE_BITMAP_MATCH(bitmap, ch) \
+    ((ch) < 256 && \
+     ((bitmap)[(ch)/SRE_CODE_BITS] & (1u << ((ch) & (SRE_CODE_BITS-1)))))
+
+/* Follow the transition on ch from a node of the Aho-Corasick automaton
+   of an SRE_INFO_LITERALS block.  A node is <fail> <outlen> <nedges>
+   followed by (<char> <node>) edges sorted by character, and nodes are
+   given by their offset from the root node. */
+LOCAL(SRE_CODE)
+sre_literals_next(const SRE_CODE *nodes, SRE_CODE node, SRE_CODE ch)
+{
+    for (;;) {
+        const SRE_CODE *edges = nodes + node + 3;
+        SRE_CODE lo = 0, hi = nodes[node + 2];
+
+        while (lo < hi) {
+            SRE_CODE mid = lo + (hi - lo) / 2;
+            if (edges[2 * mid] < ch)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo < nodes[node + 2] && edges[2 * lo] == ch)
+            return edges[2 * lo + 1];
+        if (node == 0)
+            return 0;
+        node = nodes[node];
+    }
+}
+
 
 /* helpers */
 
+/* The data stack is grown while matching, possibly without holding the
+   GIL, so it uses the raw memory allocator. */
+
 static void
 data_stack_dealloc(SRE_STATE* state)
 {
     if (state->data_stack) {
-        PyMem_FREE(state->data_stack);
+        PyMem_RawFree(state->data_stack);
         state->data_stack = NULL;
     }
     state->data_stack_size = state->data_stack_base = 0;
@@ -219,7 +253,7 @@ data_stack_grow(SRE_STATE* state, Py_ssize_t size)
         void* stack;
         cursize = minsize+minsize/4+1024;
         TRACE(("allocate/grow stack %" PY_FORMAT_SIZE_T "d\n", cursize));
-        stack = PyMem_REALLOC(state->data_stack, cursize);
+        stack = PyMem_RawRealloc(state->data_stack, cursize);
         if (!stack) {
             data_stack_dealloc(state);
             return SRE_ERROR_MEMORY;
@@ -230,6 +264,209 @@ data_stack_grow(SRE_STATE* state, Py_ssize_t size)
     return 0;
 }
 
+/* Thread lists of the linear-time matcher.  A pattern compiled with
+   SRE_FLAG_LINEAR is run by keeping, for each position of the string,
+   the list of threads waiting on a character instruction or on the final
+   MATCH, in priority order, each with its own capture slots.  A program
+   instruction is added at most once per position, so matching takes
+   O(len(string) * len(program)) time. */
+
+typedef struct {
+    Py_ssize_t n; /* number of threads */
+    Py_ssize_t* pcs; /* instruction of each thread */
+    Py_ssize_t* caps; /* ncaps capture slots for each thread */
+} SRE_LINEAR_LIST;
+
+typedef struct SRE_LINEAR_T {
+    Py_ssize_t ncaps; /* 2 per group, then the match start and lastindex */
+    Py_ssize_t gen; /* generation of the list being built */
+    Py_ssize_t* visited; /* generation each instruction was last added in */
+    Py_ssize_t* cur; /* capture slots of the thread being added */
+    Py_ssize_t* best; /* capture slots of the best match so far */
+    Py_ssize_t* stack; /* pending branches and capture slots to restore */
+    Py_ssize_t naccepts; /* number of LINEAR_MATCH instructions */
+    Py_ssize_t* accepts; /* their offsets, in order */
+    SRE_LINEAR_LIST lists[2];
+} SRE_LINEAR;
+
+static void
+linear_dealloc(SRE_LINEAR* linear)
+{
+    /* the lists and buffers are allocated along with the structure */
+    PyMem_Free(linear);
+}
+
+static SRE_LINEAR*
+linear_new(SRE_CODE* code)
+{
+    /* allocate the thread lists for a (validated) linear program */
+    SRE_LINEAR* linear;
+    SRE_CODE* prog;
+    Py_ssize_t size, pc, ninstr = 0, nthreads = 0, naccepts = 0;
+    Py_ssize_t ncaps, total;
+    Py_ssize_t* p;
+
+    if (code[0] == SRE_OP_INFO)
+        code += 1 + code[1];
+    size = code[0];
+    ncaps = 2 * (Py_ssize_t) code[1] + 2;
+    prog = code + 2;
+    for (pc = 0; pc < size; ninstr++) {
+        switch (prog[pc]) {
+        case SRE_OP_LINEAR_MATCH:
+            nthreads++;
+            naccepts++;
+            pc++;
+            break;
+        case SRE_OP_LINEAR_CHAR:
+            nthreads++;
+            /* fall through */
+        case SRE_OP_LINEAR_AT:
+            pc += 2 + prog[pc + 1];
+            break;
+        case SRE_OP_LINEAR_SPLIT:
+        case SRE_OP_LINEAR_UNTIL:
+            pc += 3;
+            break;
+        default:
+            pc += 2;
+            break;
+        }
+    }
+
+    /* visited, cur, best, the stack (one branch per SPLIT, two restores
+       per SAVE, and the first thread), the accepts and the two lists */
+    if (nthreads > (PY_SSIZE_T_MAX / (Py_ssize_t) sizeof(Py_ssize_t) -
+                    size - 5 * ninstr - 2) / (2 * ncaps + 4))
+        return NULL;
+    total = size + 2 * ncaps + 2 * (2 * ninstr + 1) + naccepts +
+            2 * nthreads * (ncaps + 1);
+    linear = PyMem_Malloc(sizeof(SRE_LINEAR) + total * sizeof(Py_ssize_t));
+    if (!linear)
+        return NULL;
+    p = (Py_ssize_t*) (linear + 1);
+    linear->ncaps = ncaps;
+    linear->gen = 0;
+    linear->visited = p;
+    memset(p, 0, size * sizeof(Py_ssize_t));
+    p += size;
+    linear->cur = p;
+    p += ncaps;
+    linear->best = p;
+    p += ncaps;
+    linear->stack = p;
+    p += 2 * (2 * ninstr + 1);
+    linear->naccepts = 0;
+    linear->accepts = p;
+    p += naccepts;
+    for (pc = 0; pc < size; ) {
+        switch (prog[pc]) {
+        case SRE_OP_LINEAR_MATCH:
+            linear->accepts[linear->naccepts++] = pc;
+            pc++;
+            break;
+        case SRE_OP_LINEAR_CHAR:
+        case SRE_OP_LINEAR_AT:
+            pc += 2 + prog[pc + 1];
+            break;
+        case SRE_OP_LINEAR_SPLIT:
+        case SRE_OP_LINEAR_UNTIL:
+            pc += 3;
+            break;
+        default:
+            pc += 2;
+            break;
+        }
+    }
+    linear->lists[0].pcs = p;
+    p += nthreads;
+    linear->lists[0].caps = p;
+    p += nthreads * ncaps;
+    linear->lists[1].pcs = p;
+    p += nthreads;
+    linear->lists[1].caps = p;
+    return linear;
+}
+
+static int
+linear_acquire(SRE_STATE* state, PatternObject* pattern)
+{
+    /* take the spare thread lists of the pattern, or allocate new ones */
+    if (pattern->linear) {
+        state->linear = pattern->linear;
+        pattern->linear = NULL;
+    }
+    else {
+        state->linear = linear_new(PatternObject_GetCode(pattern));
+        if (!state->linear)
+            return -1;
+    }
+    Py_INCREF(pattern);
+    state->linear_owner = pattern;
+    return 0;
+}
+
+static void
+linear_release(SRE_STATE* state)
+{
+    /* give the thread lists back to the pattern, unless it already got
+       others back */
+    if (state->linear) {
+        if (state->linear_owner->linear == NULL)
+            state->linear_owner->linear = state->linear;
+        else
+            linear_dealloc(state->linear);
+        state->linear = NULL;
+        Py_CLEAR(state->linear_owner);
+    }
+}
+
+/* Matching over at least SRE_RELEASE_GIL_SIZE characters releases the GIL
+   if the string cannot change meanwhile: str, bytes and read-only buffers.
+   The matcher then only takes it back to run signal handlers, in the main
+   thread.  Since findall() and the like search again after each match,
+   the GIL is only released when the previous call on the same state went
+   through as many characters, so that dense matches do not pay for it. */
+
+#define SRE_RELEASE_GIL_SIZE 8192
+
+LOCAL(void*)
+state_release_gil(SRE_STATE* state)
+{
+    Py_ssize_t size = SRE_RELEASE_GIL_SIZE * state->charsize;
+
+    if (state->release_gil && state->scanned >= size &&
+        (char*) state->end - (char*) state->start >= size)
+        state->thread_state = PyEval_SaveThread();
+    return state->start;
+}
+
+LOCAL(void)
+state_acquire_gil(SRE_STATE* state, void* start, Py_ssize_t status)
+{
+    if (state->thread_state) {
+        PyEval_RestoreThread(state->thread_state);
+        state->thread_state = NULL;
+    }
+    state->scanned = (char*) (status > 0 ? state->ptr : state->end) -
+                     (char*) start;
+}
+
+LOCAL(int)
+sre_check_signals(SRE_STATE* state)
+{
+    int res;
+
+    if (!state->thread_state)
+        return PyErr_CheckSignals();
+    if (!_PyOS_SignalPending())
+        return 0;
+    PyEval_RestoreThread(state->thread_state);
+    res = PyErr_CheckSignals();
+    state->thread_state = PyEval_SaveThread();
+    return res;
+}
+
 /* generate 8-bit version */
 
 #define SRE_CHAR Py_UCS1
@@ -448,11 +685,19 @@ state_init(SRE_STATE* state, PatternObject* pattern, PyObject* string,
     state->charsize = charsize;
     state->match_all = 0;
     state->must_advance = 0;
+    state->release_gil = !isbytes || state->buffer.readonly;
+
+    if ((pattern->flags & SRE_FLAG_LINEAR) &&
+        linear_acquire(state, pattern) < 0) {
+        PyErr_NoMemory();
+        goto err;
+    }
 
     state->beginning = ptr;
 
     state->start = (void*) ((char*) ptr + start * state->charsize);
     state->end = (void*) ((char*) ptr + end * state->charsize);
+    state->scanned = (end - start) * state->charsize;
 
     Py_INCREF(string);
     state->string = string;
@@ -463,6 +708,7 @@ state_init(SRE_STATE* state, PatternObject* pattern, PyObject* string,
   err:
     PyMem_Del(state->mark);
     state->mark = NULL;
+    linear_release(state);
     if (state->buffer.buf)
         PyBuffer_Release(&state->buffer);
     return NULL;
@@ -477,6 +723,7 @@ state_fini(SRE_STATE* state)
     data_stack_dealloc(state);
     PyMem_Del(state->mark);
     state->mark = NULL;
+    linear_release(state);
 }
 
 /* calculate offset from start of string */
@@ -557,29 +804,68 @@ pattern_dealloc(PatternObject* self)
     Py_XDECREF(self->pattern);
     Py_XDECREF(self->groupindex);
     Py_XDECREF(self->indexgroup);
+    linear_dealloc(self->linear);
     PyObject_DEL(self);
 }
 
+LOCAL(Py_ssize_t)
+sre_linear(SRE_STATE* state, SRE_CODE* pattern, int search, char* accepted)
+{
+    Py_ssize_t status;
+    void* start = state_release_gil(state);
+
+    if (state->charsize == 1)
+        status = sre_ucs1_linear(state, pattern, search, accepted);
+    else if (state->charsize == 2)
+        status = sre_ucs2_linear(state, pattern, search, accepted);
+    else {
+        assert(state->charsize == 4);
+        status = sre_ucs4_linear(state, pattern, search, accepted);
+    }
+    state_acquire_gil(state, start, status);
+    return status;
+}
+
 LOCAL(Py_ssize_t)
 sre_match(SRE_STATE* state, SRE_CODE* pattern)
 {
+    Py_ssize_t status;
+    void* start;
+
+    if (state->linear)
+        return sre_linear(state, pattern, 0, NULL);
+    start = state_release_gil(state);
     if (state->charsize == 1)
-        return sre_ucs1_match(state, pattern, 1);
-    if (state->charsize == 2)
-        return sre_ucs2_match(state, pattern, 1);
-    assert(state->charsize == 4);
-    return sre_ucs4_match(state, pattern, 1);
+        status = sre_ucs1_match(state, pattern, 1);
+    else if (state->charsize == 2)
+        status = sre_ucs2_match(state, pattern, 1);
+    else {
+        assert(state->charsize == 4);
+        status = sre_ucs4_match(state, pattern, 1);
+    }
+    state_acquire_gil(state, start, status);
+    return status;
 }
 
 LOCAL(Py_ssize_t)
 sre_search(SRE_STATE* state, SRE_CODE* pattern)
 {
+    Py_ssize_t status;
+    void* start;
+
+    if (state->linear)
+        return sre_linear(state, pattern, 1, NULL);
+    start = state_release_gil(state);
     if (state->charsize == 1)
-        return sre_ucs1_search(state, pattern);
-    if (state->charsize == 2)
-        return sre_ucs2_search(state, pattern);
-    assert(state->charsize == 4);
-    return sre_ucs4_search(state, pattern);
+        status = sre_ucs1_search(state, pattern);
+    else if (state->charsize == 2)
+        status = sre_ucs2_search(state, pattern);
+    else {
+        assert(state->charsize == 4);
+        status = sre_ucs4_search(state, pattern);
+    }
+    state_acquire_gil(state, start, status);
+    return status;
 }
 
 /*[clinic input]
@@ -1244,6 +1530,7 @@ pattern_repr(PatternObject *obj)
         {"re.VERBOSE", SRE_FLAG_VERBOSE},
         {"re.DEBUG", SRE_FLAG_DEBUG},
         {"re.ASCII", SRE_FLAG_ASCII},
+        {"re.LINEAR", SRE_FLAG_LINEAR},
     };
     PyObject *result = NULL;
     PyObject *flag_items;
@@ -1353,6 +1640,7 @@ _sre_compile_impl(PyObject *module, PyObject *pattern, int flags,
     self->pattern = NULL;
     self->groupindex = NULL;
     self->indexgroup = NULL;
+    self->linear = NULL;
 
     self->codesize = n;
 
@@ -1413,6 +1701,77 @@ _sre_compile_impl(PyObject *module, PyObject *pattern, int flags,
     return (PyObject*) self;
 }
 
+/*[clinic input]
+_sre.set_matches
+
+    pattern: object(subclass_of='&Pattern_Type')
+    string: object
+    pos: Py_ssize_t = 0
+    endpos: Py_ssize_t(c_default="PY_SSIZE_T_MAX") = sys.maxsize
+    *
+    anchored: bool = False
+    fullmatch: bool = False
+
+Return the indices of the LINEAR_MATCH instructions the pattern reaches.
+
+The pattern must have been compiled for the linear-time matcher, and a
+single pass is made over the string.  With anchored, matches must start
+at pos; with fullmatch, they must also end at endpos.
+[clinic start generated code]*/
+
+static PyObject *
+_sre_set_matches_impl(PyObject *module, PyObject *pattern, PyObject *string,
+                      Py_ssize_t pos, Py_ssize_t endpos, int anchored,
+                      int fullmatch)
+/*[clinic end generated code: output=0baee382c5946634 input=0e12c29b52dd1995]*/
+{
+    PatternObject* self = (PatternObject*) pattern;
+    SRE_STATE state;
+    SRE_CODE* code = PatternObject_GetCode(self);
+    Py_ssize_t status, i;
+    PyObject* result = NULL;
+    char* accepted;
+
+    if (!(self->flags & SRE_FLAG_LINEAR)) {
+        PyErr_SetString(PyExc_ValueError,
+                        "pattern not compiled for linear-time matching");
+        return NULL;
+    }
+    if (!state_init(&state, self, string, pos, endpos))
+        return NULL;
+
+    accepted = PyMem_Calloc(state.linear->naccepts, 1);
+    if (!accepted) {
+        state_fini(&state);
+        return PyErr_NoMemory();
+    }
+    state.match_all = fullmatch != 0;
+    status = sre_linear(&state, code, !anchored, accepted);
+    if (status < 0) {
+        pattern_error(status);
+        goto done;
+    }
+
+    result = PyList_New(status);
+    if (!result)
+        goto done;
+    for (i = 0, status = 0; i < state.linear->naccepts; i++) {
+        if (accepted[i]) {
+            PyObject* item = PyLong_FromSsize_t(i);
+            if (!item) {
+                Py_CLEAR(result);
+                goto done;
+            }
+            PyList_SET_ITEM(result, status++, item);
+        }
+    }
+
+  done:
+    PyMem_Free(accepted);
+    state_fini(&state);
+    return result;
+}
+
 /* -------------------------------------------------------------------- */
 /* Code validation */
 
@@ -1565,6 +1924,53 @@ _validate_charset(SRE_CODE *code, SRE_CODE *end)
     return 1;
 }
 
+static int
+_validate_literals(SRE_CODE *code, SRE_CODE *end)
+{
+    /* <maxlen> <bitmap> <nodes>, see sre_literals_next().  Edges and
+       failure links must point to nodes, and failure links must go back
+       so that following them ends. */
+    SRE_CODE maxlen, node, i;
+    SRE_CODE *nodes;
+    uintptr_t size;
+    unsigned char *starts;
+    int ok = 0;
+
+    if (1 + 256/SRE_CODE_BITS + 3 > (uintptr_t)(end - code))
+        FAIL;
+    maxlen = code[0];
+    nodes = code + 1 + 256/SRE_CODE_BITS;
+    size = end - nodes;
+    starts = PyMem_Calloc(size, 1);
+    if (starts == NULL)
+        FAIL;
+    for (node = 0; node < size; node += 3 + 2 * nodes[node + 2]) {
+        if (node > size - 3 || nodes[node + 2] > (size - 3 - node) / 2)
+            goto done;
+        starts[node] = 1;
+    }
+#define IS_NODE(n) ((n) < size && starts[n])
+    for (node = 0; node < size; node += 3 + 2 * nodes[node + 2]) {
+        if (node == 0 ? nodes[0] != 0 :
+                        nodes[node] >= node || !IS_NODE(nodes[node]))
+            goto done;
+        if (nodes[node + 1] > maxlen)
+            goto done;
+        for (i = 0; i < nodes[node + 2]; i++) {
+            SRE_CODE *edge = nodes + node + 3 + 2 * i;
+            if (i > 0 && edge[0] <= edge[-2])
+                goto done;
+            if (!IS_NODE(edge[1]))
+                goto done;
+        }
+    }
+#undef IS_NODE
+    ok = 1;
+  done:
+    PyMem_Free(starts);
+    return ok;
+}
+
 static int
 _validate_inner(SRE_CODE *code, SRE_CODE *end, Py_ssize_t groups)
 {
@@ -1653,8 +2059,8 @@ _validate_inner(SRE_CODE *code, SRE_CODE *end, Py_ssize_t groups)
             {
                 /* A minimal info field is
                    <INFO> <1=skip> <2=flags> <3=min> <4=max>;
-                   If SRE_INFO_PREFIX or SRE_INFO_CHARSET is in the flags,
-                   more follows. */
+                   If SRE_INFO_PREFIX, SRE_INFO_CHARSET or SRE_INFO_LITERALS
+                   is in the flags, more follows. */
                 SRE_CODE flags, i;
                 SRE_CODE *newcode;
                 GET_SKIP;
@@ -1665,11 +2071,13 @@ _validate_inner(SRE_CODE *code, SRE_CODE *end, Py_ssize_t groups)
                 /* Check that only valid flags are present */
                 if ((flags & ~(SRE_INFO_PREFIX |
                                SRE_INFO_LITERAL |
-                               SRE_INFO_CHARSET)) != 0)
+                               SRE_INFO_CHARSET |
+                               SRE_INFO_LITERALS)) != 0)
                     FAIL;
-                /* PREFIX and CHARSET are mutually exclusive */
-                if ((flags & SRE_INFO_PREFIX) &&
-                    (flags & SRE_INFO_CHARSET))
+                /* PREFIX, CHARSET and LITERALS are mutually exclusive */
+                if (((flags & SRE_INFO_PREFIX) != 0) +
+                    ((flags & SRE_INFO_CHARSET) != 0) +
+                    ((flags & SRE_INFO_LITERALS) != 0) > 1)
                     FAIL;
                 /* LITERAL implies PREFIX */
                 if ((flags & SRE_INFO_LITERAL) &&
@@ -1702,6 +2110,11 @@ _validate_inner(SRE_CODE *code, SRE_CODE *end, Py_ssize_t groups)
                         FAIL;
                     code = newcode;
                 }
+                else if (flags & SRE_INFO_LITERALS) {
+                    if (!_validate_literals(code, newcode))
+                        FAIL;
+                    code = newcode;
+                }
                 else if (code != newcode) {
                   VTRACE(("code=%p, newcode=%p\n", code, newcode));
                     FAIL;
@@ -1871,10 +2284,161 @@ _validate_outer(SRE_CODE *code, SRE_CODE *end, Py_ssize_t groups)
     return _validate_inner(code, end-1, groups);
 }
 
+static int
+_validate_linear_char(SRE_CODE *code, SRE_CODE *end, int at,
+                      Py_ssize_t groups)
+{
+    /* the operator of a LINEAR_CHAR or LINEAR_AT instruction: exactly one
+       single-character operator, or one AT */
+    uintptr_t len;
+
+    if (code >= end)
+        FAIL;
+    switch (code[0]) {
+    case SRE_OP_AT:
+    case SRE_OP_LITERAL:
+    case SRE_OP_NOT_LITERAL:
+    case SRE_OP_LITERAL_IGNORE:
+    case SRE_OP_NOT_LITERAL_IGNORE:
+    case SRE_OP_LITERAL_UNI_IGNORE:
+    case SRE_OP_NOT_LITERAL_UNI_IGNORE:
+    case SRE_OP_LITERAL_LOC_IGNORE:
+    case SRE_OP_NOT_LITERAL_LOC_IGNORE:
+        len = 2;
+        break;
+    case SRE_OP_ANY:
+    case SRE_OP_ANY_ALL:
+        len = 1;
+        break;
+    case SRE_OP_IN:
+    case SRE_OP_IN_IGNORE:
+    case SRE_OP_IN_UNI_IGNORE:
+    case SRE_OP_IN_LOC_IGNORE:
+        if (end - code < 2)
+            FAIL;
+        len = 1 + (uintptr_t)code[1];
+        break;
+    default:
+        FAIL;
+    }
+    if ((code[0] == SRE_OP_AT) != at || len != (uintptr_t)(end - code))
+        FAIL;
+    return _validate_inner(code, end, groups);
+}
+
+static int
+_validate_linear(SRE_CODE *code, SRE_CODE *end, Py_ssize_t groups)
+{
+    /* [<INFO> ...] <size> <groups> <program>, see SRE(linear)().  All
+       jump targets must be instructions, and the program must end with
+       LINEAR_MATCH. */
+    SRE_CODE *prog;
+    uintptr_t size, pc, n = 0;
+    unsigned char *starts;
+    int ok = 0;
+
+    if (groups < 0 || (size_t)groups > SRE_MAXGROUPS)
+        FAIL;
+    if (code < end && code[0] == SRE_OP_INFO) {
+        if (end - code < 2 || code[1] > (uintptr_t)(end - code) - 1)
+            FAIL;
+        if (!_validate_inner(code, code + 1 + code[1], groups))
+            FAIL;
+        code += 1 + code[1];
+    }
+    if (end - code < 3 || code[0] != (uintptr_t)(end - code) - 2 ||
+        code[1] != (SRE_CODE)groups)
+        FAIL;
+    size = code[0];
+    prog = code + 2;
+    starts = PyMem_Calloc(size, 1);
+    if (starts == NULL)
+        FAIL;
+    for (pc = 0; pc < size; pc += n) {
+        switch (prog[pc]) {
+        case SRE_OP_LINEAR_MATCH:
+            n = 1;
+            break;
+        case SRE_OP_LINEAR_CHAR:
+        case SRE_OP_LINEAR_AT:
+            if (size - pc < 2 || prog[pc + 1] > size - pc - 2)
+                goto done;
+            n = 2 + prog[pc + 1];
+            if (!_validate_linear_char(prog + pc + 2, prog + pc + n,
+                                       prog[pc] == SRE_OP_LINEAR_AT, groups))
+                goto done;
+            break;
+        case SRE_OP_LINEAR_SPLIT:
+        case SRE_OP_LINEAR_UNTIL:
+            n = 3;
+            break;
+        case SRE_OP_LINEAR_JUMP:
+        case SRE_OP_LINEAR_SAVE:
+            n = 2;
+            break;
+        default:
+            goto done;
+        }
+        if (n > size - pc)
+            goto done;
+        starts[pc] = 1;
+    }
+    /* the last instruction was one code long */
+    if (n != 1 || prog[size - 1] != SRE_OP_LINEAR_MATCH)
+        goto done;
+#define IS_INSTRUCTION(target) ((target) < size && starts[target])
+    for (pc = 0; pc < size; pc += n) {
+        switch (prog[pc]) {
+        case SRE_OP_LINEAR_MATCH:
+            n = 1;
+            break;
+        case SRE_OP_LINEAR_CHAR:
+        case SRE_OP_LINEAR_AT:
+            n = 2 + prog[pc + 1];
+            break;
+        case SRE_OP_LINEAR_SPLIT:
+            if (!IS_INSTRUCTION(prog[pc + 1]) ||
+                !IS_INSTRUCTION(prog[pc + 2]))
+                goto done;
+            n = 3;
+            break;
+        case SRE_OP_LINEAR_JUMP:
+            /* the back edge of a loop goes to its SPLIT */
+            if (!IS_INSTRUCTION(prog[pc + 1]) ||
+                (prog[pc + 1] <= pc &&
+                 prog[prog[pc + 1]] != SRE_OP_LINEAR_SPLIT))
+                goto done;
+            n = 2;
+            break;
+        case SRE_OP_LINEAR_UNTIL:
+            /* <UNTIL> <SPLIT of the iteration> <exit> */
+            if (!IS_INSTRUCTION(prog[pc + 1]) || prog[pc + 1] >= pc ||
+                prog[prog[pc + 1]] != SRE_OP_LINEAR_SPLIT ||
+                !IS_INSTRUCTION(prog[pc + 2]) || prog[pc + 2] <= pc)
+                goto done;
+            n = 3;
+            break;
+        case SRE_OP_LINEAR_SAVE:
+            if (prog[pc + 1] >= 2 * (uintptr_t)groups)
+                goto done;
+            n = 2;
+            break;
+        }
+    }
+#undef IS_INSTRUCTION
+    ok = 1;
+  done:
+    PyMem_Free(starts);
+    return ok;
+}
+
 static int
 _validate(PatternObject *self)
 {
-    if (!_validate_outer(self->code, self->code+self->codesize, self->groups))
+    if (self->flags & SRE_FLAG_LINEAR ?
+        !_validate_linear(self->code, self->code+self->codesize,
+                          self->groups) :
+        !_validate_outer(self->code, self->code+self->codesize, self->groups))
     {
         PyErr_SetString(PyExc_RuntimeError, "invalid SRE code");
         return 0;
@@ -2416,12 +2980,20 @@ _sre_SRE_Scanner_match_impl(ScannerObject *self)
 
     if (state->start == NULL)
         Py_RETURN_NONE;
+    if (self->executing) {
+        /* another thread is matching with the GIL released */
+        PyErr_SetString(PyExc_ValueError,
+                        "regular expression scanner already executing");
+        return NULL;
+    }
 
     state_reset(state);
 
     state->ptr = state->start;
 
+    self->executing = 1;
     status = sre_match(state, PatternObject_GetCode(self->pattern));
+    self->executing = 0;
     if (PyErr_Occurred())
         return NULL;
 
@@ -2454,12 +3026,20 @@ _sre_SRE_Scanner_search_impl(ScannerObject *self)
 
     if (state->start == NULL)
         Py_RETURN_NONE;
+    if (self->executing) {
+        /* another thread is matching with the GIL released */
+        PyErr_SetString(PyExc_ValueError,
+                        "regular expression scanner already executing");
+        return NULL;
+    }
 
     state_reset(state);
 
     state->ptr = state->start;
 
+    self->executing = 1;
     status = sre_search(state, PatternObject_GetCode(self->pattern));
+    self->executing = 0;
     if (PyErr_Occurred())
         return NULL;
 
@@ -2486,6 +3066,7 @@ pattern_scanner(PatternObject *self, PyObject *string, Py_ssize_t pos, Py_ssize_
     if (!scanner)
         return NULL;
     scanner->pattern = NULL;
+    scanner->executing = 0;
 
     /* create search state object */
     if (!state_init(&scanner->state, self, string, pos, endpos)) {
@@ -2758,6 +3339,7 @@ static PyTypeObject Scanner_Type = {
 
 static PyMethodDef _functions[] = {
     _SRE_COMPILE_METHODDEF
+    _SRE_SET_MATCHES_METHODDEF
     _SRE_GETCODESIZE_METHODDEF
     _SRE_ASCII_ISCASED_METHODDEF
     _SRE_UNICODE_ISCASED_METHODDEF
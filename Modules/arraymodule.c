@@ -2004,10 +2004,55 @@ array__array_reconstructor_impl(PyObject *module, PyTypeObject *arraytype,
         return NULL;
     }
     if (!PyBytes_Check(items)) {
-        PyErr_Format(PyExc_TypeError,
-            "fourth argument should be bytes, not %.200s",
-            Py_TYPE(items)->tp_name);
-        return NULL;
+        /* Protocol 5 pickles pass the array memory as a bytes-like object,
+           such as a bytearray or an out-of-band buffer. */
+        Py_buffer buffer;
+        if (!PyObject_CheckBuffer(items)) {
+            PyErr_Format(PyExc_TypeError,
+                "fourth argument should be bytes, not %.200s",
+                Py_TYPE(items)->tp_name);
+            return NULL;
+        }
+        if (mformat_code != typecode_to_mformat_code((char)typecode) &&
+            mformat_code != UNKNOWN_FORMAT) {
+            PyObject *bytes = PyBytes_FromObject(items);
+            if (bytes == NULL)
+                return NULL;
+            result = array__array_reconstructor_impl(
+                module, arraytype, typecode, mformat_code, bytes);
+            Py_DECREF(bytes);
+            return result;
+        }
+        /* Fast path: copy the buffer into a new array without going
+           through an intermediate bytes object. */
+        converted_items = PyList_New(0);
+        if (converted_items == NULL)
+            return NULL;
+        result = make_array(arraytype, (char)typecode, converted_items);
+        Py_DECREF(converted_items);
+        if (result == NULL)
+            return NULL;
+        if (PyObject_GetBuffer(items, &buffer, PyBUF_SIMPLE) < 0) {
+            Py_DECREF(result);
+            return NULL;
+        }
+        if (buffer.len % descr->itemsize != 0) {
+            PyBuffer_Release(&buffer);
+            Py_DECREF(result);
+            PyErr_SetString(PyExc_ValueError,
+                            "bytes length not a multiple of item size");
+            return NULL;
+        }
+        if (array_resize((arrayobject *)result,
+                         buffer.len / descr->itemsize) == -1) {
+            PyBuffer_Release(&buffer);
+            Py_DECREF(result);
+            return NULL;
+        }
+        if (buffer.len > 0)
+            memcpy(((arrayobject *)result)->ob_item, buffer.buf, buffer.len);
+        PyBuffer_Release(&buffer);
+        return result;
     }
 
     /* Fast path: No decoding has to be done. */
@@ -2242,7 +2287,14 @@ array_array___reduce_ex__(arrayobject *self, PyObject *value)
         return result;
     }
 
-    array_str = array_array_tobytes_impl(self);
+    if (protocol >= 5) {
+        /* Let the pickler write the array memory directly, or hand it to
+           its buffer_callback as an out-of-band buffer. */
+        array_str = PyPickleBuffer_FromObject((PyObject *)self);
+    }
+    else {
+        array_str = array_array_tobytes_impl(self);
+    }
     if (array_str == NULL) {
         Py_DECREF(dict);
         return NULL;
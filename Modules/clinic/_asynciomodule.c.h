@@ -253,28 +253,30 @@ _asyncio_Future__repr_info(FutureObj *self, PyObject *Py_UNUSED(ignored))
 }
 
 PyDoc_STRVAR(_asyncio_Task___init____doc__,
-"Task(coro, *, loop=None)\n"
+"Task(coro, *, loop=None, eager_start=False)\n"
 "--\n"
 "\n"
 "A coroutine wrapped in a Future.");
 
 static int
-_asyncio_Task___init___impl(TaskObj *self, PyObject *coro, PyObject *loop);
+_asyncio_Task___init___impl(TaskObj *self, PyObject *coro, PyObject *loop,
+                            int eager_start);
 
 static int
 _asyncio_Task___init__(PyObject *self, PyObject *args, PyObject *kwargs)
 {
     int return_value = -1;
-    static const char * const _keywords[] = {"coro", "loop", NULL};
-    static _PyArg_Parser _parser = {"O|$O:Task", _keywords, 0};
+    static const char * const _keywords[] = {"coro", "loop", "eager_start", NULL};
+    static _PyArg_Parser _parser = {"O|$Op:Task", _keywords, 0};
     PyObject *coro;
     PyObject *loop = Py_None;
+    int eager_start = 0;
 
     if (!_PyArg_ParseTupleAndKeywordsFast(args, kwargs, &_parser,
-        &coro, &loop)) {
+        &coro, &loop, &eager_start)) {
         goto exit;
     }
-    return_value = _asyncio_Task___init___impl((TaskObj *)self, coro, loop);
+    return_value = _asyncio_Task___init___impl((TaskObj *)self, coro, loop, eager_start);
 
 exit:
     return return_value;
@@ -500,6 +502,533 @@ PyDoc_STRVAR(_asyncio_Task_set_exception__doc__,
 #define _ASYNCIO_TASK_SET_EXCEPTION_METHODDEF    \
     {"set_exception", (PyCFunction)_asyncio_Task_set_exception, METH_O, _asyncio_Task_set_exception__doc__},
 
+#if defined(HAVE_EPOLL)
+
+PyDoc_STRVAR(epollcore_new__doc__,
+"EpollCore()\n"
+"--\n"
+"\n"
+"Event loop core monitoring file descriptors with epoll.\n"
+"\n"
+"Each file descriptor has at most one reader and one writer handle.\n"
+"select() returns the handles of the file descriptors which are ready,\n"
+"without building a list of events and mapping it back to the handles.");
+
+static PyObject *
+epollcore_new_impl(PyTypeObject *type);
+
+static PyObject *
+epollcore_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    PyObject *return_value = NULL;
+
+    if ((type == &EpollCoreType) &&
+        !_PyArg_NoPositional("EpollCore", args)) {
+        goto exit;
+    }
+    if ((type == &EpollCoreType) &&
+        !_PyArg_NoKeywords("EpollCore", kwargs)) {
+        goto exit;
+    }
+    return_value = epollcore_new_impl(type);
+
+exit:
+    return return_value;
+}
+
+#endif /* defined(HAVE_EPOLL) */
+
+#if defined(HAVE_EPOLL)
+
+PyDoc_STRVAR(_asyncio_EpollCore_fileno__doc__,
+"fileno($self, /)\n"
+"--\n"
+"\n"
+"Return the epoll file descriptor.");
+
+#define _ASYNCIO_EPOLLCORE_FILENO_METHODDEF    \
+    {"fileno", (PyCFunction)_asyncio_EpollCore_fileno, METH_NOARGS, _asyncio_EpollCore_fileno__doc__},
+
+static PyObject *
+_asyncio_EpollCore_fileno_impl(EpollCoreObj *self);
+
+static PyObject *
+_asyncio_EpollCore_fileno(EpollCoreObj *self, PyObject *Py_UNUSED(ignored))
+{
+    return _asyncio_EpollCore_fileno_impl(self);
+}
+
+#endif /* defined(HAVE_EPOLL) */
+
+#if defined(HAVE_EPOLL)
+
+PyDoc_STRVAR(_asyncio_EpollCore_close__doc__,
+"close($self, /)\n"
+"--\n"
+"\n"
+"Close the epoll file descriptor and release the handles.");
+
+#define _ASYNCIO_EPOLLCORE_CLOSE_METHODDEF    \
+    {"close", (PyCFunction)_asyncio_EpollCore_close, METH_NOARGS, _asyncio_EpollCore_close__doc__},
+
+static PyObject *
+_asyncio_EpollCore_close_impl(EpollCoreObj *self);
+
+static PyObject *
+_asyncio_EpollCore_close(EpollCoreObj *self, PyObject *Py_UNUSED(ignored))
+{
+    return _asyncio_EpollCore_close_impl(self);
+}
+
+#endif /* defined(HAVE_EPOLL) */
+
+#if defined(HAVE_EPOLL)
+
+PyDoc_STRVAR(_asyncio_EpollCore_add_reader__doc__,
+"add_reader($self, fd, handle, /)\n"
+"--\n"
+"\n"
+"Make handle the reader of fd and return the previous reader, or None.");
+
+#define _ASYNCIO_EPOLLCORE_ADD_READER_METHODDEF    \
+    {"add_reader", (PyCFunction)_asyncio_EpollCore_add_reader, METH_FASTCALL, _asyncio_EpollCore_add_reader__doc__},
+
+static PyObject *
+_asyncio_EpollCore_add_reader_impl(EpollCoreObj *self, int fd,
+                                   PyObject *handle);
+
+static PyObject *
+_asyncio_EpollCore_add_reader(EpollCoreObj *self, PyObject *const *args, Py_ssize_t nargs)
+{
+    PyObject *return_value = NULL;
+    int fd;
+    PyObject *handle;
+
+    if (!_PyArg_ParseStack(args, nargs, "O&O:add_reader",
+        epollcore_fd_converter, &fd, &handle)) {
+        goto exit;
+    }
+    return_value = _asyncio_EpollCore_add_reader_impl(self, fd, handle);
+
+exit:
+    return return_value;
+}
+
+#endif /* defined(HAVE_EPOLL) */
+
+#if defined(HAVE_EPOLL)
+
+PyDoc_STRVAR(_asyncio_EpollCore_remove_reader__doc__,
+"remove_reader($self, fd, /)\n"
+"--\n"
+"\n"
+"Stop monitoring fd for reading and return its reader, or None.");
+
+#define _ASYNCIO_EPOLLCORE_REMOVE_READER_METHODDEF    \
+    {"remove_reader", (PyCFunction)_asyncio_EpollCore_remove_reader, METH_O, _asyncio_EpollCore_remove_reader__doc__},
+
+static PyObject *
+_asyncio_EpollCore_remove_reader_impl(EpollCoreObj *self, int fd);
+
+static PyObject *
+_asyncio_EpollCore_remove_reader(EpollCoreObj *self, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    int fd;
+
+    if (!PyArg_Parse(arg, "O&:remove_reader", epollcore_fd_converter, &fd)) {
+        goto exit;
+    }
+    return_value = _asyncio_EpollCore_remove_reader_impl(self, fd);
+
+exit:
+    return return_value;
+}
+
+#endif /* defined(HAVE_EPOLL) */
+
+#if defined(HAVE_EPOLL)
+
+PyDoc_STRVAR(_asyncio_EpollCore_add_writer__doc__,
+"add_writer($self, fd, handle, /)\n"
+"--\n"
+"\n"
+"Make handle the writer of fd and return the previous writer, or None.");
+
+#define _ASYNCIO_EPOLLCORE_ADD_WRITER_METHODDEF    \
+    {"add_writer", (PyCFunction)_asyncio_EpollCore_add_writer, METH_FASTCALL, _asyncio_EpollCore_add_writer__doc__},
+
+static PyObject *
+_asyncio_EpollCore_add_writer_impl(EpollCoreObj *self, int fd,
+                                   PyObject *handle);
+
+static PyObject *
+_asyncio_EpollCore_add_writer(EpollCoreObj *self, PyObject *const *args, Py_ssize_t nargs)
+{
+    PyObject *return_value = NULL;
+    int fd;
+    PyObject *handle;
+
+    if (!_PyArg_ParseStack(args, nargs, "O&O:add_writer",
+        epollcore_fd_converter, &fd, &handle)) {
+        goto exit;
+    }
+    return_value = _asyncio_EpollCore_add_writer_impl(self, fd, handle);
+
+exit:
+    return return_value;
+}
+
+#endif /* defined(HAVE_EPOLL) */
+
+#if defined(HAVE_EPOLL)
+
+PyDoc_STRVAR(_asyncio_EpollCore_remove_writer__doc__,
+"remove_writer($self, fd, /)\n"
+"--\n"
+"\n"
+"Stop monitoring fd for writing and return its writer, or None.");
+
+#define _ASYNCIO_EPOLLCORE_REMOVE_WRITER_METHODDEF    \
+    {"remove_writer", (PyCFunction)_asyncio_EpollCore_remove_writer, METH_O, _asyncio_EpollCore_remove_writer__doc__},
+
+static PyObject *
+_asyncio_EpollCore_remove_writer_impl(EpollCoreObj *self, int fd);
+
+static PyObject *
+_asyncio_EpollCore_remove_writer(EpollCoreObj *self, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    int fd;
+
+    if (!PyArg_Parse(arg, "O&:remove_writer", epollcore_fd_converter, &fd)) {
+        goto exit;
+    }
+    return_value = _asyncio_EpollCore_remove_writer_impl(self, fd);
+
+exit:
+    return return_value;
+}
+
+#endif /* defined(HAVE_EPOLL) */
+
+#if defined(HAVE_EPOLL)
+
+PyDoc_STRVAR(_asyncio_EpollCore_get_key__doc__,
+"get_key($self, fd, /)\n"
+"--\n"
+"\n"
+"Return the selectors.SelectorKey of fd.\n"
+"\n"
+"The data of the key is the (reader, writer) pair.  Raise KeyError if fd\n"
+"is not monitored.");
+
+#define _ASYNCIO_EPOLLCORE_GET_KEY_METHODDEF    \
+    {"get_key", (PyCFunction)_asyncio_EpollCore_get_key, METH_O, _asyncio_EpollCore_get_key__doc__},
+
+static PyObject *
+_asyncio_EpollCore_get_key_impl(EpollCoreObj *self, int fd);
+
+static PyObject *
+_asyncio_EpollCore_get_key(EpollCoreObj *self, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    int fd;
+
+    if (!PyArg_Parse(arg, "O&:get_key", epollcore_fd_converter, &fd)) {
+        goto exit;
+    }
+    return_value = _asyncio_EpollCore_get_key_impl(self, fd);
+
+exit:
+    return return_value;
+}
+
+#endif /* defined(HAVE_EPOLL) */
+
+#if defined(HAVE_EPOLL)
+
+PyDoc_STRVAR(_asyncio_EpollCore_select__doc__,
+"select($self, /, timeout=None)\n"
+"--\n"
+"\n"
+"Wait until some file descriptors are ready, or the timeout expires.\n"
+"\n"
+"Return the list of the handles of the ready readers and writers.  The\n"
+"file descriptors of cancelled handles are no longer monitored.  The\n"
+"timeout is in seconds, None waits forever.");
+
+#define _ASYNCIO_EPOLLCORE_SELECT_METHODDEF    \
+    {"select", (PyCFunction)_asyncio_EpollCore_select, METH_FASTCALL|METH_KEYWORDS, _asyncio_EpollCore_select__doc__},
+
+static PyObject *
+_asyncio_EpollCore_select_impl(EpollCoreObj *self, PyObject *timeout_obj);
+
+static PyObject *
+_asyncio_EpollCore_select(EpollCoreObj *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames)
+{
+    PyObject *return_value = NULL;
+    static const char * const _keywords[] = {"timeout", NULL};
+    static _PyArg_Parser _parser = {"|O:select", _keywords, 0};
+    PyObject *timeout_obj = Py_None;
+
+    if (!_PyArg_ParseStackAndKeywords(args, nargs, kwnames, &_parser,
+        &timeout_obj)) {
+        goto exit;
+    }
+    return_value = _asyncio_EpollCore_select_impl(self, timeout_obj);
+
+exit:
+    return return_value;
+}
+
+#endif /* defined(HAVE_EPOLL) */
+
+PyDoc_STRVAR(streambuffer_new__doc__,
+"StreamBuffer()\n"
+"--\n"
+"\n"
+"Buffer of the data received by a StreamReader.\n"
+"\n"
+"Data is appended at the end and consumed from the front without moving\n"
+"the rest of it.  get_buffer() and buffer_updated() let a transport\n"
+"receive data directly into the buffer.  The buffer interface exposes\n"
+"the data.");
+
+static PyObject *
+streambuffer_new_impl(PyTypeObject *type);
+
+static PyObject *
+streambuffer_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    PyObject *return_value = NULL;
+
+    if ((type == &StreamBufferType) &&
+        !_PyArg_NoPositional("StreamBuffer", args)) {
+        goto exit;
+    }
+    if ((type == &StreamBufferType) &&
+        !_PyArg_NoKeywords("StreamBuffer", kwargs)) {
+        goto exit;
+    }
+    return_value = streambuffer_new_impl(type);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(_asyncio_StreamBuffer_extend__doc__,
+"extend($self, data, /)\n"
+"--\n"
+"\n"
+"Append data to the end of the buffer.");
+
+#define _ASYNCIO_STREAMBUFFER_EXTEND_METHODDEF    \
+    {"extend", (PyCFunction)_asyncio_StreamBuffer_extend, METH_O, _asyncio_StreamBuffer_extend__doc__},
+
+static PyObject *
+_asyncio_StreamBuffer_extend_impl(StreamBufferObj *self, Py_buffer *data);
+
+static PyObject *
+_asyncio_StreamBuffer_extend(StreamBufferObj *self, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    Py_buffer data = {NULL, NULL};
+
+    if (!PyArg_Parse(arg, "y*:extend", &data)) {
+        goto exit;
+    }
+    return_value = _asyncio_StreamBuffer_extend_impl(self, &data);
+
+exit:
+    /* Cleanup for data */
+    if (data.obj) {
+       PyBuffer_Release(&data);
+    }
+
+    return return_value;
+}
+
+PyDoc_STRVAR(_asyncio_StreamBuffer_take__doc__,
+"take($self, n, /)\n"
+"--\n"
+"\n"
+"Remove and return the first n bytes, or all of them if there are fewer.");
+
+#define _ASYNCIO_STREAMBUFFER_TAKE_METHODDEF    \
+    {"take", (PyCFunction)_asyncio_StreamBuffer_take, METH_O, _asyncio_StreamBuffer_take__doc__},
+
+static PyObject *
+_asyncio_StreamBuffer_take_impl(StreamBufferObj *self, Py_ssize_t n);
+
+static PyObject *
+_asyncio_StreamBuffer_take(StreamBufferObj *self, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    Py_ssize_t n;
+
+    if (!PyArg_Parse(arg, "n:take", &n)) {
+        goto exit;
+    }
+    return_value = _asyncio_StreamBuffer_take_impl(self, n);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(_asyncio_StreamBuffer_clear__doc__,
+"clear($self, /)\n"
+"--\n"
+"\n"
+"Remove all the data.");
+
+#define _ASYNCIO_STREAMBUFFER_CLEAR_METHODDEF    \
+    {"clear", (PyCFunction)_asyncio_StreamBuffer_clear, METH_NOARGS, _asyncio_StreamBuffer_clear__doc__},
+
+static PyObject *
+_asyncio_StreamBuffer_clear_impl(StreamBufferObj *self);
+
+static PyObject *
+_asyncio_StreamBuffer_clear(StreamBufferObj *self, PyObject *Py_UNUSED(ignored))
+{
+    return _asyncio_StreamBuffer_clear_impl(self);
+}
+
+PyDoc_STRVAR(_asyncio_StreamBuffer_find__doc__,
+"find($self, sub, start=0, /)\n"
+"--\n"
+"\n"
+"Return the lowest index of sub at or after start, or -1 if not found.");
+
+#define _ASYNCIO_STREAMBUFFER_FIND_METHODDEF    \
+    {"find", (PyCFunction)_asyncio_StreamBuffer_find, METH_FASTCALL, _asyncio_StreamBuffer_find__doc__},
+
+static Py_ssize_t
+_asyncio_StreamBuffer_find_impl(StreamBufferObj *self, Py_buffer *sub,
+                                Py_ssize_t start);
+
+static PyObject *
+_asyncio_StreamBuffer_find(StreamBufferObj *self, PyObject *const *args, Py_ssize_t nargs)
+{
+    PyObject *return_value = NULL;
+    Py_buffer sub = {NULL, NULL};
+    Py_ssize_t start = 0;
+    Py_ssize_t _return_value;
+
+    if (!_PyArg_ParseStack(args, nargs, "y*|n:find",
+        &sub, &start)) {
+        goto exit;
+    }
+    _return_value = _asyncio_StreamBuffer_find_impl(self, &sub, start);
+    if ((_return_value == -1) && PyErr_Occurred()) {
+        goto exit;
+    }
+    return_value = PyLong_FromSsize_t(_return_value);
+
+exit:
+    /* Cleanup for sub */
+    if (sub.obj) {
+       PyBuffer_Release(&sub);
+    }
+
+    return return_value;
+}
+
+PyDoc_STRVAR(_asyncio_StreamBuffer_startswith__doc__,
+"startswith($self, prefix, start=0, /)\n"
+"--\n"
+"\n"
+"Return True if the data at start begins with prefix.");
+
+#define _ASYNCIO_STREAMBUFFER_STARTSWITH_METHODDEF    \
+    {"startswith", (PyCFunction)_asyncio_StreamBuffer_startswith, METH_FASTCALL, _asyncio_StreamBuffer_startswith__doc__},
+
+static PyObject *
+_asyncio_StreamBuffer_startswith_impl(StreamBufferObj *self,
+                                      Py_buffer *prefix, Py_ssize_t start);
+
+static PyObject *
+_asyncio_StreamBuffer_startswith(StreamBufferObj *self, PyObject *const *args, Py_ssize_t nargs)
+{
+    PyObject *return_value = NULL;
+    Py_buffer prefix = {NULL, NULL};
+    Py_ssize_t start = 0;
+
+    if (!_PyArg_ParseStack(args, nargs, "y*|n:startswith",
+        &prefix, &start)) {
+        goto exit;
+    }
+    return_value = _asyncio_StreamBuffer_startswith_impl(self, &prefix, start);
+
+exit:
+    /* Cleanup for prefix */
+    if (prefix.obj) {
+       PyBuffer_Release(&prefix);
+    }
+
+    return return_value;
+}
+
+PyDoc_STRVAR(_asyncio_StreamBuffer_get_buffer__doc__,
+"get_buffer($self, sizehint, /)\n"
+"--\n"
+"\n"
+"Return a memoryview of the free space after the data.\n"
+"\n"
+"The view holds at least sizehint bytes, or 64 KiB if sizehint is not\n"
+"positive.  Call buffer_updated() once data was written to it.  The data\n"
+"can\'t be extended until the view is released.");
+
+#define _ASYNCIO_STREAMBUFFER_GET_BUFFER_METHODDEF    \
+    {"get_buffer", (PyCFunction)_asyncio_StreamBuffer_get_buffer, METH_O, _asyncio_StreamBuffer_get_buffer__doc__},
+
+static PyObject *
+_asyncio_StreamBuffer_get_buffer_impl(StreamBufferObj *self,
+                                      Py_ssize_t sizehint);
+
+static PyObject *
+_asyncio_StreamBuffer_get_buffer(StreamBufferObj *self, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    Py_ssize_t sizehint;
+
+    if (!PyArg_Parse(arg, "n:get_buffer", &sizehint)) {
+        goto exit;
+    }
+    return_value = _asyncio_StreamBuffer_get_buffer_impl(self, sizehint);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(_asyncio_StreamBuffer_buffer_updated__doc__,
+"buffer_updated($self, nbytes, /)\n"
+"--\n"
+"\n"
+"Append the nbytes written at the start of the free space to the data.");
+
+#define _ASYNCIO_STREAMBUFFER_BUFFER_UPDATED_METHODDEF    \
+    {"buffer_updated", (PyCFunction)_asyncio_StreamBuffer_buffer_updated, METH_O, _asyncio_StreamBuffer_buffer_updated__doc__},
+
+static PyObject *
+_asyncio_StreamBuffer_buffer_updated_impl(StreamBufferObj *self,
+                                          Py_ssize_t nbytes);
+
+static PyObject *
+_asyncio_StreamBuffer_buffer_updated(StreamBufferObj *self, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    Py_ssize_t nbytes;
+
+    if (!PyArg_Parse(arg, "n:buffer_updated", &nbytes)) {
+        goto exit;
+    }
+    return_value = _asyncio_StreamBuffer_buffer_updated_impl(self, nbytes);
+
+exit:
+    return return_value;
+}
+
 PyDoc_STRVAR(_asyncio__get_running_loop__doc__,
 "_get_running_loop($module, /)\n"
 "--\n"
@@ -711,4 +1240,70 @@ _asyncio__leave_task(PyObject *module, PyObject *const *args, Py_ssize_t nargs,
 exit:
     return return_value;
 }
-/*[clinic end generated code: output=b6148b0134e7a819 input=a9049054013a1b77]*/
+
+PyDoc_STRVAR(_asyncio__swap_current_task__doc__,
+"_swap_current_task($module, /, loop, task)\n"
+"--\n"
+"\n"
+"Make task the current task of loop and return the previous one.\n"
+"\n"
+"A task of None leaves loop without a current task.");
+
+#define _ASYNCIO__SWAP_CURRENT_TASK_METHODDEF    \
+    {"_swap_current_task", (PyCFunction)_asyncio__swap_current_task, METH_FASTCALL|METH_KEYWORDS, _asyncio__swap_current_task__doc__},
+
+static PyObject *
+_asyncio__swap_current_task_impl(PyObject *module, PyObject *loop,
+                                 PyObject *task);
+
+static PyObject *
+_asyncio__swap_current_task(PyObject *module, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames)
+{
+    PyObject *return_value = NULL;
+    static const char * const _keywords[] = {"loop", "task", NULL};
+    static _PyArg_Parser _parser = {"OO:_swap_current_task", _keywords, 0};
+    PyObject *loop;
+    PyObject *task;
+
+    if (!_PyArg_ParseStackAndKeywords(args, nargs, kwnames, &_parser,
+        &loop, &task)) {
+        goto exit;
+    }
+    return_value = _asyncio__swap_current_task_impl(module, loop, task);
+
+exit:
+    return return_value;
+}
+
+#ifndef _ASYNCIO_EPOLLCORE_FILENO_METHODDEF
+    #define _ASYNCIO_EPOLLCORE_FILENO_METHODDEF
+#endif /* !defined(_ASYNCIO_EPOLLCORE_FILENO_METHODDEF) */
+
+#ifndef _ASYNCIO_EPOLLCORE_CLOSE_METHODDEF
+    #define _ASYNCIO_EPOLLCORE_CLOSE_METHODDEF
+#endif /* !defined(_ASYNCIO_EPOLLCORE_CLOSE_METHODDEF) */
+
+#ifndef _ASYNCIO_EPOLLCORE_ADD_READER_METHODDEF
+    #define _ASYNCIO_EPOLLCORE_ADD_READER_METHODDEF
+#endif /* !defined(_ASYNCIO_EPOLLCORE_ADD_READER_METHODDEF) */
+
+#ifndef _ASYNCIO_EPOLLCORE_REMOVE_READER_METHODDEF
+    #define _ASYNCIO_EPOLLCORE_REMOVE_READER_METHODDEF
+#endif /* !defined(_ASYNCIO_EPOLLCORE_REMOVE_READER_METHODDEF) */
+
+#ifndef _ASYNCIO_EPOLLCORE_ADD_WRITER_METHODDEF
+    #define _ASYNCIO_EPOLLCORE_ADD_WRITER_METHODDEF
+#endif /* !defined(_ASYNCIO_EPOLLCORE_ADD_WRITER_METHODDEF) */
+
+#ifndef _ASYNCIO_EPOLLCORE_REMOVE_WRITER_METHODDEF
+    #define _ASYNCIO_EPOLLCORE_REMOVE_WRITER_METHODDEF
+#endif /* !defined(_ASYNCIO_EPOLLCORE_REMOVE_WRITER_METHODDEF) */
+
+#ifndef _ASYNCIO_EPOLLCORE_GET_KEY_METHODDEF
+    #define _ASYNCIO_EPOLLCORE_GET_KEY_METHODDEF
+#endif /* !defined(_ASYNCIO_EPOLLCORE_GET_KEY_METHODDEF) */
+
+#ifndef _ASYNCIO_EPOLLCORE_SELECT_METHODDEF
+    #define _ASYNCIO_EPOLLCORE_SELECT_METHODDEF
+#endif /* !defined(_ASYNCIO_EPOLLCORE_SELECT_METHODDEF) */
+/*[clinic end generated code: output=4633fb2fedb0770e input=a9049054013a1b77]*/
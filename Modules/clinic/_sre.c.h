@@ -514,6 +514,48 @@ exit:
     return return_value;
 }
 
+PyDoc_STRVAR(_sre_set_matches__doc__,
+"set_matches($module, /, pattern, string, pos=0, endpos=sys.maxsize, *,\n"
+"            anchored=False, fullmatch=False)\n"
+"--\n"
+"\n"
+"Return the indices of the LINEAR_MATCH instructions the pattern reaches.\n"
+"\n"
+"The pattern must have been compiled for the linear-time matcher, and a\n"
+"single pass is made over the string.  With anchored, matches must start\n"
+"at pos; with fullmatch, they must also end at endpos.");
+
+#define _SRE_SET_MATCHES_METHODDEF    \
+    {"set_matches", (PyCFunction)_sre_set_matches, METH_FASTCALL|METH_KEYWORDS, _sre_set_matches__doc__},
+
+static PyObject *
+_sre_set_matches_impl(PyObject *module, PyObject *pattern, PyObject *string,
+                      Py_ssize_t pos, Py_ssize_t endpos, int anchored,
+                      int fullmatch);
+
+static PyObject *
+_sre_set_matches(PyObject *module, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames)
+{
+    PyObject *return_value = NULL;
+    static const char * const _keywords[] = {"pattern", "string", "pos", "endpos", "anchored", "fullmatch", NULL};
+    static _PyArg_Parser _parser = {"O!O|nn$pp:set_matches", _keywords, 0};
+    PyObject *pattern;
+    PyObject *string;
+    Py_ssize_t pos = 0;
+    Py_ssize_t endpos = PY_SSIZE_T_MAX;
+    int anchored = 0;
+    int fullmatch = 0;
+
+    if (!_PyArg_ParseStackAndKeywords(args, nargs, kwnames, &_parser,
+        &Pattern_Type, &pattern, &string, &pos, &endpos, &anchored, &fullmatch)) {
+        goto exit;
+    }
+    return_value = _sre_set_matches_impl(module, pattern, string, pos, endpos, anchored, fullmatch);
+
+exit:
+    return return_value;
+}
+
 PyDoc_STRVAR(_sre_SRE_Match_expand__doc__,
 "expand($self, /, template)\n"
 "--\n"
@@ -765,4 +807,4 @@ _sre_SRE_Scanner_search(ScannerObject *self, PyObject *Py_UNUSED(ignored))
 {
     return _sre_SRE_Scanner_search_impl(self);
 }
-/*[clinic end generated code: output=4b807104b65c1e0e input=a9049054013a1b77]*/
+/*[clinic end generated code: output=0a369bb2a1e450d2 input=a9049054013a1b77]*/
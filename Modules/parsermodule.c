@@ -916,7 +916,7 @@ build_node_children(PyObject *tuple, node *root, int *line_num)
                 Py_DECREF(elem);
                 return NULL;
             }
-            strn = (char *)PyObject_MALLOC(len + 1);
+            strn = (char *)PyMem_RawMalloc(len + 1);
             if (strn == NULL) {
                 Py_DECREF(temp);
                 Py_DECREF(elem);
@@ -940,13 +940,13 @@ build_node_children(PyObject *tuple, node *root, int *line_num)
         err = PyNode_AddChild(root, type, strn, *line_num, 0);
         if (err == E_NOMEM) {
             Py_DECREF(elem);
-            PyObject_FREE(strn);
+            PyMem_RawFree(strn);
             PyErr_NoMemory();
             return NULL;
         }
         if (err == E_OVERFLOW) {
             Py_DECREF(elem);
-            PyObject_FREE(strn);
+            PyMem_RawFree(strn);
             PyErr_SetString(PyExc_ValueError,
                             "unsupported number of child nodes");
             return NULL;
@@ -1032,7 +1032,7 @@ build_node_tree(PyObject *tuple)
                     Py_DECREF(tuple);
                     return NULL;
                 }
-                res->n_str = (char *)PyObject_MALLOC(len + 1);
+                res->n_str = (char *)PyMem_RawMalloc(len + 1);
                 if (res->n_str == NULL) {
                     PyNode_Free(res);
                     Py_DECREF(encoding);
@@ -1632,6 +1632,16 @@ _PyOS_IsMainThread(void)
     return PyThread_get_thread_ident() == main_thread;
 }
 
+/* Return nonzero if PyErr_CheckSignals() has handlers to run in the
+   current thread.  Unlike PyErr_CheckSignals(), this can be called
+   without holding the GIL. */
+int
+_PyOS_SignalPending(void)
+{
+    return _Py_atomic_load(&is_tripped) &&
+           PyThread_get_thread_ident() == main_thread;
+}
+
 #ifdef MS_WINDOWS
 void *_PyOS_SigintEvent(void)
 {
@@ -523,6 +523,19 @@ static PyTypeObject sock_type;
 #include <sys/poll.h>
 #endif
 
+#ifdef HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
+
+/* The splice() and _sendfile() methods move data between file descriptors
+   in the kernel, waiting for them with poll() */
+#if defined(HAVE_POLL) && defined(HAVE_PIPE2) && defined(SPLICE_F_MOVE)
+#define HAVE_SOCK_SPLICE
+#endif
+#if defined(HAVE_POLL) && defined(HAVE_SENDFILE) && defined(HAVE_SYS_SENDFILE_H)
+#define HAVE_SOCK_SENDFILE
+#endif
+
 /* Largest value to try to store in a socklen_t (used when handling
    ancillary data).  POSIX requires socklen_t to hold at least
    (2**31)-1 and recommends against storing larger values, but
@@ -4149,6 +4162,529 @@ Like send(data, flags) but allows specifying the destination address.\n\
 For IP sockets, the address is a pair (hostaddr, port).");
 
 
+/* The recvmmsg_into() and sendmmsg() methods.  recvmmsg() and sendmmsg()
+   came along with the MSG_WAITFORONE flag. */
+#ifdef MSG_WAITFORONE
+
+/* Maximum number of datagrams handled by a single call (UIO_MAXIOV) */
+#define MMSG_MAX 1024
+
+struct sock_mmsg {
+    struct mmsghdr *msgvec;
+    unsigned int vlen;
+    int flags;
+    int result;
+};
+
+static int
+sock_recvmmsg_impl(PySocketSockObject *s, void *data)
+{
+    struct sock_mmsg *ctx = data;
+
+    ctx->result = recvmmsg(s->sock_fd, ctx->msgvec, ctx->vlen, ctx->flags,
+                           NULL);
+    return (ctx->result >= 0);
+}
+
+static int
+sock_sendmmsg_impl(PySocketSockObject *s, void *data)
+{
+    struct sock_mmsg *ctx = data;
+
+    ctx->result = sendmmsg(s->sock_fd, ctx->msgvec, ctx->vlen, ctx->flags);
+    return (ctx->result >= 0);
+}
+
+/* Get the sizes argument of recvmmsg_into() and sendmmsg(), a buffer of C
+   ints.  Return 0 on success, or -1 with an exception set. */
+static int
+get_mmsg_sizes(PyObject *obj, Py_buffer *view, int writable,
+               const char *funcname)
+{
+    const char *format;
+
+    if (PyObject_GetBuffer(obj, view, PyBUF_FORMAT | PyBUF_ND |
+                           (writable ? PyBUF_WRITABLE : 0)) < 0)
+        return -1;
+    format = view->format;
+    if (format[0] == '@')
+        format++;
+    if (view->itemsize != sizeof(int) ||
+        (strcmp(format, "i") != 0 && strcmp(format, "I") != 0)) {
+        PyErr_Format(PyExc_TypeError,
+                     "%s() argument 'sizes' must be a buffer of C ints, "
+                     "such as array('i'), not '%.200s'",
+                     funcname, Py_TYPE(obj)->tp_name);
+        PyBuffer_Release(view);
+        return -1;
+    }
+    return 0;
+}
+
+
+/* s.recvmmsg_into(buffer, size, sizes[, addresses[, flags]]) method */
+
+static PyObject *
+sock_recvmmsg_into(PySocketSockObject *s, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"buffer", "size", "sizes", "addresses", "flags",
+                             0};
+    Py_buffer pbuf, sizesbuf, addrbuf;
+    PyObject *sizes, *addresses = Py_None;
+    Py_ssize_t size, count, i;
+    int flags = 0;
+    struct mmsghdr *msgvec = NULL;
+    struct iovec *iovs = NULL;
+    struct sock_mmsg ctx;
+    PyObject *retval = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "w*nO|Oi:recvmmsg_into",
+                                     kwlist, &pbuf, &size, &sizes,
+                                     &addresses, &flags))
+        return NULL;
+    sizesbuf.obj = NULL;
+    addrbuf.obj = NULL;
+
+    if (size <= 0) {
+        PyErr_SetString(PyExc_ValueError,
+                        "recvmmsg_into() size must be positive");
+        goto finally;
+    }
+    if (get_mmsg_sizes(sizes, &sizesbuf, 1, "recvmmsg_into") < 0)
+        goto finally;
+    if (addresses != Py_None &&
+        PyObject_GetBuffer(addresses, &addrbuf, PyBUF_WRITABLE) < 0) {
+        addrbuf.obj = NULL;
+        goto finally;
+    }
+    if (!IS_SELECTABLE(s)) {
+        select_error();
+        goto finally;
+    }
+
+    count = Py_MIN(pbuf.len / size, sizesbuf.len / (Py_ssize_t)sizeof(int));
+    if (addrbuf.obj != NULL)
+        count = Py_MIN(count, addrbuf.len / (Py_ssize_t)sizeof(sock_addr_t));
+    count = Py_MIN(count, MMSG_MAX);
+    if (count == 0) {
+        retval = PyLong_FromLong(0);
+        goto finally;
+    }
+
+    msgvec = PyMem_New(struct mmsghdr, count);
+    iovs = PyMem_New(struct iovec, count);
+    if (msgvec == NULL || iovs == NULL) {
+        PyErr_NoMemory();
+        goto finally;
+    }
+    memset(msgvec, 0, count * sizeof(struct mmsghdr));
+    for (i = 0; i < count; i++) {
+        iovs[i].iov_base = (char *)pbuf.buf + i * size;
+        iovs[i].iov_len = size;
+        msgvec[i].msg_hdr.msg_iov = &iovs[i];
+        msgvec[i].msg_hdr.msg_iovlen = 1;
+        if (addrbuf.obj != NULL) {
+            msgvec[i].msg_hdr.msg_name = (char *)addrbuf.buf +
+                                         i * sizeof(sock_addr_t);
+            msgvec[i].msg_hdr.msg_namelen = sizeof(sock_addr_t);
+        }
+    }
+
+    /* Wait for the first datagram only, then take those already queued */
+    ctx.msgvec = msgvec;
+    ctx.vlen = (unsigned int)count;
+    ctx.flags = flags | MSG_WAITFORONE;
+    if (sock_call(s, 0, sock_recvmmsg_impl, &ctx) < 0)
+        goto finally;
+
+    for (i = 0; i < ctx.result; i++)
+        ((int *)sizesbuf.buf)[i] = (int)msgvec[i].msg_len;
+    retval = PyLong_FromLong(ctx.result);
+
+finally:
+    PyMem_Free(msgvec);
+    PyMem_Free(iovs);
+    if (addrbuf.obj != NULL)
+        PyBuffer_Release(&addrbuf);
+    if (sizesbuf.obj != NULL)
+        PyBuffer_Release(&sizesbuf);
+    PyBuffer_Release(&pbuf);
+    return retval;
+}
+
+PyDoc_STRVAR(recvmmsg_into_doc,
+"recvmmsg_into(buffer, size, sizes[, addresses[, flags]]) -> count\n\
+\n\
+Receive several datagrams with a single system call, without creating\n\
+an object per datagram.  The buffer is divided into slots of size\n\
+bytes: datagram i is stored at offset i * size, truncated to size bytes,\n\
+and its length in sizes[i].  sizes must be a writable buffer of C ints,\n\
+such as array('i').  If addresses is given, it must be a writable buffer\n\
+in which the address of the sender of datagram i is stored, as a socket\n\
+address structure, at offset i * SOCKADDR_SIZE.\n\
+\n\
+At most len(buffer) // size datagrams are received, fewer if sizes or\n\
+addresses are too short.  Block until at least one datagram is\n\
+available, then return the number of datagrams received, without waiting\n\
+for more.  See recv() for documentation about the flags.");
+
+
+/* s.sendmmsg(buffer, size, sizes[, addresses[, flags]]) method */
+
+static PyObject *
+sock_sendmmsg(PySocketSockObject *s, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"buffer", "size", "sizes", "addresses", "flags",
+                             0};
+    Py_buffer pbuf, sizesbuf, addrbuf;
+    PyObject *sizes, *addresses = Py_None;
+    Py_ssize_t size, count, i;
+    int flags = 0;
+    socklen_t addrlen = 0;
+    struct mmsghdr *msgvec = NULL;
+    struct iovec *iovs = NULL;
+    struct sock_mmsg ctx;
+    PyObject *retval = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "y*nO|Oi:sendmmsg",
+                                     kwlist, &pbuf, &size, &sizes,
+                                     &addresses, &flags))
+        return NULL;
+    sizesbuf.obj = NULL;
+    addrbuf.obj = NULL;
+
+    if (size <= 0) {
+        PyErr_SetString(PyExc_ValueError, "sendmmsg() size must be positive");
+        goto finally;
+    }
+    if (get_mmsg_sizes(sizes, &sizesbuf, 0, "sendmmsg") < 0)
+        goto finally;
+    count = sizesbuf.len / sizeof(int);
+    for (i = 0; i < count; i++) {
+        int len = ((int *)sizesbuf.buf)[i];
+        /* i * size cannot overflow once i <= pbuf.len / size */
+        if (len < 0 || len > size || i > pbuf.len / size ||
+            len > pbuf.len - i * size) {
+            PyErr_Format(PyExc_ValueError,
+                         "sendmmsg() datagram %zd out of the buffer", i);
+            goto finally;
+        }
+    }
+    if (addresses != Py_None) {
+        if (PyObject_GetBuffer(addresses, &addrbuf, PyBUF_SIMPLE) < 0) {
+            addrbuf.obj = NULL;
+            goto finally;
+        }
+        if (addrbuf.len / (Py_ssize_t)sizeof(sock_addr_t) < count) {
+            PyErr_SetString(PyExc_ValueError,
+                            "sendmmsg() addresses buffer too small");
+            goto finally;
+        }
+        if (!getsockaddrlen(s, &addrlen))
+            goto finally;
+    }
+    if (!IS_SELECTABLE(s)) {
+        select_error();
+        goto finally;
+    }
+
+    count = Py_MIN(count, MMSG_MAX);
+    if (count == 0) {
+        retval = PyLong_FromLong(0);
+        goto finally;
+    }
+
+    msgvec = PyMem_New(struct mmsghdr, count);
+    iovs = PyMem_New(struct iovec, count);
+    if (msgvec == NULL || iovs == NULL) {
+        PyErr_NoMemory();
+        goto finally;
+    }
+    memset(msgvec, 0, count * sizeof(struct mmsghdr));
+    for (i = 0; i < count; i++) {
+        iovs[i].iov_base = (char *)pbuf.buf + i * size;
+        iovs[i].iov_len = ((int *)sizesbuf.buf)[i];
+        msgvec[i].msg_hdr.msg_iov = &iovs[i];
+        msgvec[i].msg_hdr.msg_iovlen = 1;
+        if (addrbuf.obj != NULL) {
+            msgvec[i].msg_hdr.msg_name = (char *)addrbuf.buf +
+                                         i * sizeof(sock_addr_t);
+            msgvec[i].msg_hdr.msg_namelen = addrlen;
+        }
+    }
+
+    ctx.msgvec = msgvec;
+    ctx.vlen = (unsigned int)count;
+    ctx.flags = flags;
+    if (sock_call(s, 1, sock_sendmmsg_impl, &ctx) < 0)
+        goto finally;
+    retval = PyLong_FromLong(ctx.result);
+
+finally:
+    PyMem_Free(msgvec);
+    PyMem_Free(iovs);
+    if (addrbuf.obj != NULL)
+        PyBuffer_Release(&addrbuf);
+    if (sizesbuf.obj != NULL)
+        PyBuffer_Release(&sizesbuf);
+    PyBuffer_Release(&pbuf);
+    return retval;
+}
+
+PyDoc_STRVAR(sendmmsg_doc,
+"sendmmsg(buffer, size, sizes[, addresses[, flags]]) -> count\n\
+\n\
+Send several datagrams with a single system call.  The buffer is divided\n\
+into slots of size bytes, as by recvmmsg_into(): datagram i is made of\n\
+the sizes[i] bytes at offset i * size.  sizes must be a buffer of C ints,\n\
+such as array('i'), and gives the number of datagrams.  If addresses is\n\
+given, datagram i is sent to the socket address structure at offset\n\
+i * SOCKADDR_SIZE of it, such as stored by recvmmsg_into().\n\
+\n\
+Return the number of datagrams sent, which can be less than len(sizes).\n\
+See send() for documentation about the flags.");
+
+#endif    /* MSG_WAITFORONE */
+
+
+#if defined(HAVE_SOCK_SPLICE) || defined(HAVE_SOCK_SENDFILE)
+/* Wait until fd is ready for reading or writing, for at most timeout
+   (forever if negative).  Called without the GIL.  Return 1 if fd is
+   ready, 0 on timeout, or -1 with errno set. */
+static int
+sock_transfer_wait(SOCKET_T fd, int writing, _PyTime_t timeout)
+{
+    struct pollfd pollfd;
+    _PyTime_t ms;
+    int n;
+
+    pollfd.fd = fd;
+    pollfd.events = writing ? POLLOUT : POLLIN;
+    if (timeout >= 0) {
+        ms = _PyTime_AsMilliseconds(timeout, _PyTime_ROUND_CEILING);
+        assert(ms <= INT_MAX);
+    }
+    else {
+#ifdef INFTIM
+        ms = INFTIM;
+#else
+        ms = -1;
+#endif
+    }
+    n = poll(&pollfd, 1, (int)ms);
+    if (n < 0)
+        return -1;
+    return n > 0;
+}
+#endif
+
+
+#ifdef HAVE_SOCK_SPLICE
+/* Size requested for the pipe of splice(), and largest transfer through
+   it per system call */
+#define SPLICE_PIPE_SIZE (1024 * 1024)
+
+/* s.splice(dst[, count]) method */
+
+static PyObject *
+sock_splice(PySocketSockObject *s, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"dst", "count", 0};
+    PyObject *dst, *count_obj = Py_None;
+    Py_ssize_t count = PY_SSIZE_T_MAX;
+    Py_ssize_t moved = 0, total = 0, n;
+    _PyTime_t dst_timeout = -1;
+    int dstfd, pipefd[2], writing, r;
+    int err = 0, timed_out = 0, async_err = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O:splice", kwlist,
+                                     &dst, &count_obj))
+        return NULL;
+
+    if (count_obj != Py_None) {
+        count = PyNumber_AsSsize_t(count_obj, PyExc_OverflowError);
+        if (count == -1 && PyErr_Occurred())
+            return NULL;
+        if (count < 0) {
+            PyErr_SetString(PyExc_ValueError, "negative count in splice");
+            return NULL;
+        }
+    }
+    if (PyObject_TypeCheck(dst, &sock_type)) {
+        dstfd = (int)((PySocketSockObject *)dst)->sock_fd;
+        dst_timeout = ((PySocketSockObject *)dst)->sock_timeout;
+    }
+    else {
+        dstfd = PyObject_AsFileDescriptor(dst);
+        if (dstfd < 0)
+            return NULL;
+    }
+    if (s->sock_timeout == 0 || dst_timeout == 0) {
+        PyErr_SetString(PyExc_ValueError,
+                        "non-blocking sockets are not supported");
+        return NULL;
+    }
+
+    if (pipe2(pipefd, O_CLOEXEC) < 0)
+        return s->errorhandler();
+#ifdef F_SETPIPE_SZ
+    /* Only a hint: a smaller pipe just takes more system calls */
+    (void)fcntl(pipefd[1], F_SETPIPE_SZ, SPLICE_PIPE_SIZE);
+#endif
+
+    /* Fill the pipe from the socket, then drain it into dst, until count
+       bytes or the end of the stream have been reached */
+    Py_BEGIN_ALLOW_THREADS
+    while (moved < count || total < moved) {
+        writing = (total < moved);
+        if (!writing) {
+            n = splice(s->sock_fd, NULL, pipefd[1], NULL,
+                       Py_MIN(count - moved, SPLICE_PIPE_SIZE), SPLICE_F_MOVE);
+            if (n == 0)
+                break;
+            if (n > 0) {
+                moved += n;
+                continue;
+            }
+        }
+        else {
+            n = splice(pipefd[0], NULL, dstfd, NULL, moved - total,
+                       SPLICE_F_MOVE);
+            if (n >= 0) {
+                total += n;
+                continue;
+            }
+        }
+        if (errno == EAGAIN) {
+            r = sock_transfer_wait(writing ? dstfd : s->sock_fd, writing,
+                                   writing ? dst_timeout : s->sock_timeout);
+            if (r > 0)
+                continue;
+            if (r == 0) {
+                timed_out = 1;
+                break;
+            }
+        }
+        err = errno;
+        if (err != EINTR)
+            break;
+        err = 0;
+        Py_BLOCK_THREADS
+        async_err = PyErr_CheckSignals();
+        Py_UNBLOCK_THREADS
+        if (async_err)
+            break;
+    }
+    Py_END_ALLOW_THREADS
+
+    close(pipefd[0]);
+    close(pipefd[1]);
+    if (async_err)
+        return NULL;
+    if (timed_out) {
+        PyErr_SetString(socket_timeout, "timed out");
+        return NULL;
+    }
+    if (err) {
+        errno = err;
+        return s->errorhandler();
+    }
+    return PyLong_FromSsize_t(total);
+}
+
+PyDoc_STRVAR(splice_doc,
+"splice(dst[, count]) -> count\n\
+\n\
+Move up to count bytes from the socket to dst, or until the end of the\n\
+stream if count is not given, without copying them to user space.  dst\n\
+is another socket, a pipe or a file, as an object or a file descriptor.\n\
+The data goes through a pipe with the splice() system call, and the GIL\n\
+is released during the whole transfer.  Return the number of bytes\n\
+written to dst.\n\
+\n\
+The timeouts of both sockets apply to each wait for data to read or for\n\
+room to write it.  Non-blocking sockets are not supported.  If an error\n\
+occurs, the data already read from the socket but not yet written to dst\n\
+is lost.");
+#endif    /* HAVE_SOCK_SPLICE */
+
+
+#ifdef HAVE_SOCK_SENDFILE
+/* Largest transfer of a single sendfile() call on Linux */
+#define SENDFILE_CHUNK 0x7ffff000
+
+/* s._sendfile(fd, offset, count) method */
+
+static PyObject *
+sock_sendfile_fd(PySocketSockObject *s, PyObject *args)
+{
+    int fd, r;
+    long long offset_arg;
+    off_t offset;
+    Py_ssize_t count, total = 0, n;
+    int err = 0, timed_out = 0, async_err = 0;
+
+    if (!PyArg_ParseTuple(args, "iLn:_sendfile", &fd, &offset_arg, &count))
+        return NULL;
+    offset = (off_t)offset_arg;
+
+    Py_BEGIN_ALLOW_THREADS
+    while (count < 0 || total < count) {
+        n = sendfile(s->sock_fd, fd, &offset,
+                     count < 0 ? SENDFILE_CHUNK
+                               : Py_MIN(count - total, SENDFILE_CHUNK));
+        if (n == 0)
+            break;
+        if (n > 0) {
+            total += n;
+            continue;
+        }
+        if (errno == EAGAIN && s->sock_timeout != 0) {
+            r = sock_transfer_wait(s->sock_fd, 1, s->sock_timeout);
+            if (r > 0)
+                continue;
+            if (r == 0) {
+                timed_out = 1;
+                break;
+            }
+        }
+        err = errno;
+        if (err != EINTR)
+            break;
+        err = 0;
+        Py_BLOCK_THREADS
+        async_err = PyErr_CheckSignals();
+        Py_UNBLOCK_THREADS
+        if (async_err)
+            break;
+    }
+    Py_END_ALLOW_THREADS
+
+    if (async_err)
+        return NULL;
+    /* An error after some data was sent is reported by the next call */
+    if (total == 0) {
+        if (timed_out) {
+            PyErr_SetString(socket_timeout, "timed out");
+            return NULL;
+        }
+        if (err) {
+            errno = err;
+            return s->errorhandler();
+        }
+    }
+    return PyLong_FromSsize_t(total);
+}
+
+PyDoc_STRVAR(sendfile_fd_doc,
+"_sendfile(fd, offset, count) -> sent\n\
+\n\
+Send count bytes of the file descriptor fd from offset, or up to the end\n\
+of the file if count is negative, with sendfile().  The GIL is released\n\
+during the whole transfer.  Used by sendfile().");
+#endif    /* HAVE_SOCK_SENDFILE */
+
+
 /* The sendmsg() and recvmsg[_into]() methods require a working
    CMSG_LEN().  See the comment near get_CMSG_LEN(). */
 #ifdef CMSG_LEN
@@ -4744,6 +5280,20 @@ static PyMethodDef sock_methods[] = {
                       sendall_doc},
     {"sendto",            (PyCFunction)sock_sendto, METH_VARARGS,
                       sendto_doc},
+#ifdef MSG_WAITFORONE
+    {"recvmmsg_into",     (PyCFunction)sock_recvmmsg_into,
+                      METH_VARARGS | METH_KEYWORDS, recvmmsg_into_doc},
+    {"sendmmsg",          (PyCFunction)sock_sendmmsg,
+                      METH_VARARGS | METH_KEYWORDS, sendmmsg_doc},
+#endif
+#ifdef HAVE_SOCK_SPLICE
+    {"splice",            (PyCFunction)sock_splice,
+                      METH_VARARGS | METH_KEYWORDS, splice_doc},
+#endif
+#ifdef HAVE_SOCK_SENDFILE
+    {"_sendfile",         (PyCFunction)sock_sendfile_fd, METH_VARARGS,
+                      sendfile_fd_doc},
+#endif
     {"setblocking",       (PyCFunction)sock_setblocking, METH_O,
                       setblocking_doc},
     {"getblocking",   (PyCFunction)sock_getblocking, METH_NOARGS,
@@ -7337,6 +7887,10 @@ PyInit__socket(void)
 #ifdef MSG_FASTOPEN
     PyModule_AddIntMacro(m, MSG_FASTOPEN);
 #endif
+#ifdef MSG_WAITFORONE
+    /* Size of the address slots of recvmmsg_into() and sendmmsg() */
+    PyModule_AddIntConstant(m, "SOCKADDR_SIZE", sizeof(sock_addr_t));
+#endif
 
     /* Protocol level and numbers, usable for [gs]etsockopt */
 #ifdef  SOL_SOCKET
@@ -34,6 +34,8 @@ typedef struct {
     int flags; /* flags used when compiling pattern source */
     PyObject *weakreflist; /* List of weak references */
     int isbytes; /* pattern type (1 - bytes, 0 - string, -1 - None) */
+    /* spare thread lists of the linear-time matcher (or NULL) */
+    struct SRE_LINEAR_T *linear;
     /* pattern code */
     Py_ssize_t codesize;
     SRE_CODE code[1];
@@ -83,12 +85,23 @@ typedef struct {
     size_t data_stack_base;
     /* current repeat context */
     SRE_REPEAT *repeat;
+    /* thread lists of the linear-time matcher (NULL if not used), and
+       the pattern they are given back to */
+    struct SRE_LINEAR_T *linear;
+    PatternObject *linear_owner;
+    /* the string is immutable, so the GIL can be released while matching,
+       the number of bytes the previous call went through, and the thread
+       state saved while the GIL is released */
+    int release_gil;
+    Py_ssize_t scanned;
+    PyThreadState *thread_state;
 } SRE_STATE;
 
 typedef struct {
     PyObject_HEAD
     PyObject* pattern;
     SRE_STATE state;
+    int executing;
 } ScannerObject;
 
 #endif
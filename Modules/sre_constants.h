@@ -11,7 +11,7 @@
  * See the _sre.c file for information on usage and redistribution.
  */
 
-#define SRE_MAGIC 20171005
+#define SRE_MAGIC 20261018
 #define SRE_OP_FAILURE 0
 #define SRE_OP_SUCCESS 1
 #define SRE_OP_ANY 2
@@ -83,6 +83,13 @@
 #define SRE_CATEGORY_UNI_NOT_WORD 15
 #define SRE_CATEGORY_UNI_LINEBREAK 16
 #define SRE_CATEGORY_UNI_NOT_LINEBREAK 17
+#define SRE_OP_LINEAR_MATCH 0
+#define SRE_OP_LINEAR_CHAR 1
+#define SRE_OP_LINEAR_AT 2
+#define SRE_OP_LINEAR_SPLIT 3
+#define SRE_OP_LINEAR_JUMP 4
+#define SRE_OP_LINEAR_SAVE 5
+#define SRE_OP_LINEAR_UNTIL 6
 #define SRE_FLAG_TEMPLATE 1
 #define SRE_FLAG_IGNORECASE 2
 #define SRE_FLAG_LOCALE 4
@@ -92,6 +99,8 @@
 #define SRE_FLAG_VERBOSE 64
 #define SRE_FLAG_DEBUG 128
 #define SRE_FLAG_ASCII 256
+#define SRE_FLAG_LINEAR 512
 #define SRE_INFO_PREFIX 1
 #define SRE_INFO_LITERAL 2
 #define SRE_INFO_CHARSET 4
+#define SRE_INFO_LITERALS 8
@@ -219,8 +219,24 @@ SRE(count)(SRE_STATE* state, SRE_CODE* pattern, Py_ssize_t maxcount)
     case SRE_OP_IN:
         /* repeated set */
         TRACE(("|%p|%p|COUNT IN\n", pattern, ptr));
-        while (ptr < end && SRE(charset)(state, pattern + 2, *ptr))
-            ptr++;
+        if (pattern[2] == SRE_OP_CHARSET &&
+            pattern[3 + 256/SRE_CODE_BITS] == SRE_OP_FAILURE) {
+            /* the set is a single bitmap */
+            SRE_CODE *bitmap = pattern + 3;
+            while (ptr < end && SRE_BITMAP_MATCH(bitmap, (SRE_CODE) *ptr))
+                ptr++;
+        }
+        else if (pattern[2] == SRE_OP_RANGE &&
+                 pattern[5] == SRE_OP_FAILURE) {
+            /* the set is a single range */
+            SRE_CODE lo = pattern[3], width = pattern[4] - pattern[3];
+            while (ptr < end && (SRE_CODE) *ptr - lo <= width)
+                ptr++;
+        }
+        else {
+            while (ptr < end && SRE(charset)(state, pattern + 2, *ptr))
+                ptr++;
+        }
         break;
 
     case SRE_OP_ANY:
@@ -333,6 +349,43 @@ SRE(count)(SRE_STATE* state, SRE_CODE* pattern, Py_ssize_t maxcount)
     return ptr - (SRE_CHAR*) state->ptr;
 }
 
+LOCAL(SRE_CHAR*)
+SRE(literals_find)(SRE_CODE* literals, SRE_CHAR* ptr, SRE_CHAR* end)
+{
+    /* find the leftmost occurrence of one of the literal strings of an
+       SRE_INFO_LITERALS block.  the Aho-Corasick automaton is run until
+       no literal can start before the leftmost occurrence found */
+
+    SRE_CODE maxlen = literals[0];
+    SRE_CODE* bitmap = literals + 1;
+    SRE_CODE* nodes = literals + 1 + 256/SRE_CODE_BITS;
+    SRE_CHAR* scan = ptr;
+    SRE_CHAR* found = NULL;
+    SRE_CODE node = 0;
+
+    while (ptr < end) {
+        if (node == 0) {
+            /* skip characters no literal starts with */
+            while (ptr < end &&
+#if SIZEOF_SRE_CHAR > 1
+                   (SRE_CODE) *ptr < 256 &&
+#endif
+                   !SRE_BITMAP_MATCH(bitmap, (SRE_CODE) *ptr))
+                ptr++;
+            if (ptr >= end)
+                break;
+        }
+        node = sre_literals_next(nodes, node, (SRE_CODE) *ptr++);
+        if (nodes[node + 1] &&
+            nodes[node + 1] <= (SRE_CODE) (ptr - scan) &&
+            (found == NULL || ptr - nodes[node + 1] < found))
+            found = ptr - nodes[node + 1];
+        if (found != NULL && ptr - found >= (Py_ssize_t) maxlen - 1)
+            break;
+    }
+    return found;
+}
+
 #if 0 /* not used in this release */
 LOCAL(int)
 SRE(info)(SRE_STATE* state, SRE_CODE* pattern)
@@ -584,7 +637,7 @@ entrance:
 
     for (;;) {
         ++sigcount;
-        if ((0 == (sigcount & 0xfff)) && PyErr_CheckSignals())
+        if ((0 == (sigcount & 0xfff)) && sre_check_signals(state))
             RETURN_ERROR(SRE_ERROR_INTERRUPTED);
 
         switch (*ctx->pattern++) {
@@ -988,11 +1041,9 @@ entrance:
                    ctx->pattern[1], ctx->pattern[2]));
 
             /* install new repeat context */
-            ctx->u.rep = (SRE_REPEAT*) PyObject_MALLOC(sizeof(*ctx->u.rep));
-            if (!ctx->u.rep) {
-                PyErr_NoMemory();
-                RETURN_FAILURE;
-            }
+            ctx->u.rep = (SRE_REPEAT*) PyMem_RawMalloc(sizeof(*ctx->u.rep));
+            if (!ctx->u.rep)
+                RETURN_ERROR(SRE_ERROR_MEMORY);
             ctx->u.rep->count = -1;
             ctx->u.rep->pattern = ctx->pattern;
             ctx->u.rep->prev = state->repeat;
@@ -1002,7 +1053,7 @@ entrance:
             state->ptr = ctx->ptr;
             DO_JUMP(JUMP_REPEAT, jump_repeat, ctx->pattern+ctx->pattern[0]);
             state->repeat = ctx->u.rep->prev;
-            PyObject_FREE(ctx->u.rep);
+            PyMem_RawFree(ctx->u.rep);
 
             if (ret) {
                 RETURN_ON_ERROR(ret);
@@ -1378,6 +1429,7 @@ SRE(search)(SRE_STATE* state, SRE_CODE* pattern)
     SRE_CODE* prefix = NULL;
     SRE_CODE* charset = NULL;
     SRE_CODE* overlap = NULL;
+    SRE_CODE* literals = NULL;
     int flags = 0;
 
     if (ptr > end)
@@ -1413,6 +1465,10 @@ SRE(search)(SRE_STATE* state, SRE_CODE* pattern)
             /* pattern starts with a character from a known set */
             /* <charset> */
             charset = pattern + 5;
+        else if (flags & SRE_INFO_LITERALS)
+            /* pattern starts with one of a set of literal strings */
+            /* <maxlen> <bitmap> <automaton> */
+            literals = pattern + 5;
 
         pattern += 1 + pattern[1];
     }
@@ -1431,10 +1487,16 @@ SRE(search)(SRE_STATE* state, SRE_CODE* pattern)
         end = (SRE_CHAR *)state->end;
         state->must_advance = 0;
         while (ptr < end) {
+#if SIZEOF_SRE_CHAR == 1
+            ptr = (SRE_CHAR *)memchr(ptr, c, end - ptr);
+            if (ptr == NULL)
+                return 0;
+#else
             while (*ptr != c) {
                 if (++ptr >= end)
                     return 0;
             }
+#endif
             TRACE(("|%p|%p|SEARCH LITERAL\n", pattern, ptr));
             state->start = ptr;
             state->ptr = ptr + prefix_skip;
@@ -1464,10 +1526,17 @@ SRE(search)(SRE_STATE* state, SRE_CODE* pattern)
 #endif
         while (ptr < end) {
             SRE_CHAR c = (SRE_CHAR) prefix[0];
+#if SIZEOF_SRE_CHAR == 1
+            ptr = (SRE_CHAR *)memchr(ptr, c, end - ptr);
+            if (ptr == NULL)
+                return 0;
+            ptr++;
+#else
             while (*ptr++ != c) {
                 if (ptr >= end)
                     return 0;
             }
+#endif
             if (ptr >= end)
                 return 0;
 
@@ -1500,13 +1569,42 @@ SRE(search)(SRE_STATE* state, SRE_CODE* pattern)
         return 0;
     }
 
+    if (literals) {
+        /* pattern starts with one of a set of literal strings.  try to
+           match where the leftmost one occurs */
+        end = (SRE_CHAR *)state->end;
+        state->must_advance = 0;
+        while (ptr < end) {
+            SRE_CHAR* found = SRE(literals_find)(literals, ptr, end);
+            if (found == NULL)
+                return 0;
+            TRACE(("|%p|%p|SEARCH LITERALS\n", pattern, found));
+            state->start = state->ptr = found;
+            status = SRE(match)(state, pattern, 0);
+            if (status != 0)
+                return status;
+            ptr = found + 1;
+            RESET_CAPTURE_GROUP();
+        }
+        return 0;
+    }
+
     if (charset) {
         /* pattern starts with a character from a known set */
+        int bitmap_only = (charset[0] == SRE_OP_CHARSET &&
+                           charset[1 + 256/SRE_CODE_BITS] == SRE_OP_FAILURE);
         end = (SRE_CHAR *)state->end;
         state->must_advance = 0;
         for (;;) {
-            while (ptr < end && !SRE(charset)(state, charset, *ptr))
-                ptr++;
+            if (bitmap_only) {
+                while (ptr < end &&
+                       !SRE_BITMAP_MATCH(charset + 1, (SRE_CODE) *ptr))
+                    ptr++;
+            }
+            else {
+                while (ptr < end && !SRE(charset)(state, charset, *ptr))
+                    ptr++;
+            }
             if (ptr >= end)
                 return 0;
             TRACE(("|%p|%p|SEARCH CHARSET\n", pattern, ptr));
@@ -1537,6 +1635,322 @@ SRE(search)(SRE_STATE* state, SRE_CODE* pattern)
     return status;
 }
 
+LOCAL(int)
+SRE(linear_char)(SRE_STATE* state, SRE_CODE* code, SRE_CODE ch)
+{
+    /* check a character against the single-character operator of a
+       LINEAR_CHAR instruction */
+
+    switch (code[0]) {
+    case SRE_OP_LITERAL:
+        return ch == code[1];
+    case SRE_OP_NOT_LITERAL:
+        return ch != code[1];
+    case SRE_OP_LITERAL_IGNORE:
+        return (SRE_CODE) sre_lower_ascii(ch) == code[1];
+    case SRE_OP_NOT_LITERAL_IGNORE:
+        return (SRE_CODE) sre_lower_ascii(ch) != code[1];
+    case SRE_OP_LITERAL_UNI_IGNORE:
+        return (SRE_CODE) sre_lower_unicode(ch) == code[1];
+    case SRE_OP_NOT_LITERAL_UNI_IGNORE:
+        return (SRE_CODE) sre_lower_unicode(ch) != code[1];
+    case SRE_OP_LITERAL_LOC_IGNORE:
+        return char_loc_ignore(code[1], ch);
+    case SRE_OP_NOT_LITERAL_LOC_IGNORE:
+        return !char_loc_ignore(code[1], ch);
+    case SRE_OP_ANY:
+        return !SRE_IS_LINEBREAK(ch);
+    case SRE_OP_ANY_ALL:
+        return 1;
+    case SRE_OP_IN:
+        return SRE(charset)(state, code + 2, ch);
+    case SRE_OP_IN_IGNORE:
+        return SRE(charset)(state, code + 2, (SRE_CODE) sre_lower_ascii(ch));
+    case SRE_OP_IN_UNI_IGNORE:
+        return SRE(charset)(state, code + 2,
+                            (SRE_CODE) sre_lower_unicode(ch));
+    case SRE_OP_IN_LOC_IGNORE:
+        return SRE(charset_loc_ignore)(state, code + 2, ch);
+    }
+    return 0;
+}
+
+LOCAL(void)
+SRE(linear_add)(SRE_STATE* state, SRE_CODE* prog, SRE_LINEAR_LIST* list,
+                Py_ssize_t pc, SRE_CHAR* ptr)
+{
+    /* add the thread starting at instruction pc to the list, following
+       jumps, splits, capture saves and assertions at ptr up to the
+       character instructions (or MATCH) it can reach.  the capture
+       slots of the thread are taken from linear->cur, which is restored
+       before returning */
+
+    SRE_LINEAR* linear = state->linear;
+    Py_ssize_t* cur = linear->cur;
+    Py_ssize_t* stack = linear->stack;
+    Py_ssize_t ncaps = linear->ncaps;
+    Py_ssize_t lastindex = ncaps - 1;
+    Py_ssize_t pos = ptr - (SRE_CHAR*) state->beginning;
+    Py_ssize_t sp = 0, slot;
+
+    /* stack entries are <slot> <value> pairs: a slot to restore, or -1
+       and an instruction to continue from */
+    stack[sp++] = -1;
+    stack[sp++] = pc;
+    while (sp > 0) {
+        pc = stack[--sp];
+        slot = stack[--sp];
+        if (slot >= 0) {
+            cur[slot] = pc;
+            continue;
+        }
+        for (;;) {
+            /* the end of an iteration of a repeat: if the iteration
+               matched the empty string, its first instruction was
+               already reached at this position, and the repeat ends as
+               in SRE(match).  these aren't marked as visited, since the
+               way taken depends on where the iteration started */
+            if (prog[pc] == SRE_OP_LINEAR_JUMP && prog[pc + 1] <= pc) {
+                /* the back edge of a loop */
+                if (linear->visited[prog[pc + 1]] == linear->gen)
+                    pc += 2;
+                else
+                    pc = prog[pc + 1];
+                continue;
+            }
+            if (prog[pc] == SRE_OP_LINEAR_UNTIL) {
+                /* the end of an optional iteration of a bounded repeat */
+                if (linear->visited[prog[pc + 1]] == linear->gen)
+                    pc = prog[pc + 2];
+                else
+                    pc += 3;
+                continue;
+            }
+            if (linear->visited[pc] == linear->gen)
+                break;
+            linear->visited[pc] = linear->gen;
+            switch (prog[pc]) {
+            case SRE_OP_LINEAR_JUMP:
+                pc = prog[pc + 1];
+                continue;
+            case SRE_OP_LINEAR_SPLIT:
+                stack[sp++] = -1;
+                stack[sp++] = prog[pc + 2];
+                pc = prog[pc + 1];
+                continue;
+            case SRE_OP_LINEAR_SAVE:
+                slot = prog[pc + 1];
+                stack[sp++] = slot;
+                stack[sp++] = cur[slot];
+                cur[slot] = pos;
+                if (slot & 1) {
+                    stack[sp++] = lastindex;
+                    stack[sp++] = cur[lastindex];
+                    cur[lastindex] = slot / 2 + 1;
+                }
+                pc += 2;
+                continue;
+            case SRE_OP_LINEAR_AT:
+                if (!SRE(at)(state, ptr, prog[pc + 3]))
+                    break;
+                pc += 2 + prog[pc + 1];
+                continue;
+            default:
+                /* LINEAR_CHAR or LINEAR_MATCH */
+                list->pcs[list->n] = pc;
+                memcpy(list->caps + list->n * ncaps, cur,
+                       ncaps * sizeof(Py_ssize_t));
+                list->n++;
+                break;
+            }
+            break;
+        }
+    }
+}
+
+LOCAL(Py_ssize_t)
+SRE(linear)(SRE_STATE* state, SRE_CODE* pattern, int search, char* accepted)
+{
+    /* run a program compiled for the linear-time matcher.  all threads
+       advance over the string in lockstep, and a thread is dropped when
+       a thread of higher priority already reached the same instruction
+       at the same position, so the leftmost match found is the one a
+       backtracking match would find.
+
+       if accepted is not NULL, accepted[i] is set for each LINEAR_MATCH
+       instruction i any thread reaches instead, and the number of them
+       newly set is returned */
+
+    SRE_LINEAR* linear = state->linear;
+    SRE_CHAR* beginning = (SRE_CHAR*) state->beginning;
+    SRE_CHAR* start = (SRE_CHAR*) state->start;
+    SRE_CHAR* end = (SRE_CHAR*) state->end;
+    SRE_CHAR* ptr = start;
+    SRE_CHAR* match_end = NULL;
+    SRE_CODE* prefix = NULL;
+    SRE_CODE* charset = NULL;
+    SRE_CODE* literals = NULL;
+    SRE_CODE* prog;
+    Py_ssize_t prefix_len = 0;
+    SRE_LINEAR_LIST* clist;
+    SRE_LINEAR_LIST* nlist;
+    Py_ssize_t* cur = linear->cur;
+    Py_ssize_t* best = linear->best;
+    Py_ssize_t ncaps = linear->ncaps;
+    Py_ssize_t minlen = 0;
+    Py_ssize_t groups, i;
+    Py_ssize_t naccepted = 0;
+    unsigned int sigcount = 0;
+
+    if (ptr > end)
+        return 0;
+
+    if (pattern[0] == SRE_OP_INFO) {
+        /* <INFO> <1=skip> <2=flags> <3=min> <4=max> <5=prefix info> */
+        if (search && accepted == NULL && (pattern[2] & SRE_INFO_LITERAL))
+            /* the pattern is a literal string without groups, which
+               SRE(search) finds without running the program */
+            return SRE(search)(state, pattern);
+        minlen = pattern[3];
+        if (pattern[2] & SRE_INFO_PREFIX) {
+            prefix_len = pattern[5];
+            prefix = pattern + 7;
+        }
+        else if (pattern[2] & SRE_INFO_CHARSET)
+            charset = pattern + 5;
+        else if (pattern[2] & SRE_INFO_LITERALS)
+            literals = pattern + 5;
+        pattern += 1 + pattern[1];
+    }
+    if (end - ptr < minlen)
+        return 0;
+
+    /* <size> <groups> <program> */
+    groups = pattern[1];
+    prog = pattern + 2;
+
+    clist = &linear->lists[0];
+    nlist = &linear->lists[1];
+    clist->n = 0;
+    linear->gen++;
+    for (;;) {
+        if (match_end == NULL && (search || ptr == start)) {
+            if (clist->n == 0 && search) {
+                /* no thread left: skip to where a match can start */
+                if (prefix_len > 0) {
+                    SRE_CHAR c = (SRE_CHAR) prefix[0];
+#if SIZEOF_SRE_CHAR < 4
+                    if ((SRE_CODE) c != prefix[0])
+                        break;
+#endif
+                    for (;;) {
+#if SIZEOF_SRE_CHAR == 1
+                        ptr = (SRE_CHAR *)memchr(ptr, c, end - ptr);
+                        if (ptr == NULL) {
+                            ptr = end;
+                            break;
+                        }
+#else
+                        while (ptr < end && *ptr != c)
+                            ptr++;
+#endif
+                        if (end - ptr < prefix_len)
+                            break;
+                        for (i = 1; i < prefix_len; i++)
+                            if ((SRE_CODE) ptr[i] != prefix[i])
+                                break;
+                        if (i == prefix_len)
+                            break;
+                        ptr++;
+                    }
+                }
+                else if (charset) {
+                    while (ptr < end && !SRE(charset)(state, charset, *ptr))
+                        ptr++;
+                }
+                else if (literals) {
+                    ptr = SRE(literals_find)(literals, ptr, end);
+                    if (ptr == NULL)
+                        break;
+                }
+                if (end - ptr < minlen)
+                    break;
+            }
+            for (i = 0; i < ncaps; i++)
+                cur[i] = -1;
+            cur[ncaps - 2] = ptr - beginning;
+            SRE(linear_add)(state, prog, clist, 0, ptr);
+        }
+        if (clist->n == 0) {
+            if (match_end != NULL || !search || ptr >= end)
+                break;
+            ptr++;
+            linear->gen++;
+            continue;
+        }
+
+        if ((0 == (++sigcount & 0xfff)) && sre_check_signals(state))
+            return SRE_ERROR_INTERRUPTED;
+
+        nlist->n = 0;
+        linear->gen++;
+        for (i = 0; i < clist->n; i++) {
+            Py_ssize_t pc = clist->pcs[i];
+            Py_ssize_t* caps = clist->caps + i * ncaps;
+            if (prog[pc] == SRE_OP_LINEAR_MATCH) {
+                if ((state->match_all && ptr != end) ||
+                    (state->must_advance && ptr == start))
+                    continue;
+                if (accepted != NULL) {
+                    /* find which LINEAR_MATCH this is */
+                    Py_ssize_t lo = 0, hi = linear->naccepts - 1;
+                    while (lo < hi) {
+                        Py_ssize_t mid = lo + (hi - lo) / 2;
+                        if (linear->accepts[mid] < pc)
+                            lo = mid + 1;
+                        else
+                            hi = mid;
+                    }
+                    if (!accepted[lo]) {
+                        accepted[lo] = 1;
+                        if (++naccepted == linear->naccepts)
+                            return naccepted;
+                    }
+                    continue;
+                }
+                /* threads of lower priority are dropped */
+                memcpy(best, caps, ncaps * sizeof(Py_ssize_t));
+                match_end = ptr;
+                break;
+            }
+            if (ptr < end &&
+                SRE(linear_char)(state, prog + pc + 2, (SRE_CODE) *ptr)) {
+                memcpy(cur, caps, ncaps * sizeof(Py_ssize_t));
+                SRE(linear_add)(state, prog, nlist,
+                                pc + 2 + prog[pc + 1], ptr + 1);
+            }
+        }
+        if (ptr >= end)
+            break;
+        ptr++;
+        clist = nlist;
+        nlist = &linear->lists[clist == &linear->lists[0]];
+    }
+
+    if (accepted != NULL)
+        return naccepted;
+    if (match_end == NULL)
+        return 0;
+
+    state->start = beginning + best[ncaps - 2];
+    state->ptr = match_end;
+    for (i = 0; i < 2 * groups; i++)
+        state->mark[i] = best[i] >= 0 ? beginning + best[i] : NULL;
+    state->lastmark = 2 * groups - 1;
+    state->lastindex = best[ncaps - 1];
+    return 1;
+}
+
 #undef SRE_CHAR
 #undef SIZEOF_SRE_CHAR
 #undef SRE
@@ -2,6 +2,7 @@
 
 #include "Python.h"
 #include "code.h"
+#include "marshal.h"
 #include "structmember.h"
 
 /* Holder for co_extra information */
@@ -278,7 +279,6 @@ static PyMemberDef code_memberlist[] = {
     {"co_stacksize",T_INT,              OFF(co_stacksize),      READONLY},
     {"co_flags",        T_INT,          OFF(co_flags),          READONLY},
     {"co_code",         T_OBJECT,       OFF(co_code),           READONLY},
-    {"co_consts",       T_OBJECT,       OFF(co_consts),         READONLY},
     {"co_names",        T_OBJECT,       OFF(co_names),          READONLY},
     {"co_varnames",     T_OBJECT,       OFF(co_varnames),       READONLY},
     {"co_freevars",     T_OBJECT,       OFF(co_freevars),       READONLY},
@@ -290,6 +290,23 @@ static PyMemberDef code_memberlist[] = {
     {NULL}      /* Sentinel */
 };
 
+/* co_consts may hold code objects that marshal has not read yet, which are
+   replaced in the tuple itself before it is handed out, see
+   _PyLazyCode_LoadConsts(). */
+static PyObject *
+code_getconsts(PyCodeObject *co, void *closure)
+{
+    if (_PyLazyCode_LoadConsts(co->co_consts) < 0)
+        return NULL;
+    Py_INCREF(co->co_consts);
+    return co->co_consts;
+}
+
+static PyGetSetDef code_getsetlist[] = {
+    {"co_consts", (getter)code_getconsts, NULL, NULL},
+    {NULL}      /* Sentinel */
+};
+
 /* Helper for code_new: return a shallow copy of a tuple that is
    guaranteed to contain exact strings, by converting string subclasses
    to exact strings and complaining if a non-string is found. */
@@ -651,6 +668,9 @@ code_richcompare(PyObject *self, PyObject *other, int op)
     if (eq <= 0) goto unequal;
 
     /* compare constants */
+    if (_PyLazyCode_LoadConsts(co->co_consts) < 0 ||
+        _PyLazyCode_LoadConsts(cp->co_consts) < 0)
+        return NULL;
     consts1 = _PyCode_ConstantKey(co->co_consts);
     if (!consts1)
         return NULL;
@@ -700,6 +720,7 @@ code_hash(PyCodeObject *co)
     if (h0 == -1) return -1;
     h1 = PyObject_Hash(co->co_code);
     if (h1 == -1) return -1;
+    if (_PyLazyCode_LoadConsts(co->co_consts) < 0) return -1;
     h2 = PyObject_Hash(co->co_consts);
     if (h2 == -1) return -1;
     h3 = PyObject_Hash(co->co_names);
@@ -754,7 +775,7 @@ PyTypeObject PyCode_Type = {
     0,                                  /* tp_iternext */
     code_methods,                       /* tp_methods */
     code_memberlist,                    /* tp_members */
-    0,                                  /* tp_getset */
+    code_getsetlist,                    /* tp_getset */
     0,                                  /* tp_base */
     0,                                  /* tp_dict */
     0,                                  /* tp_descr_get */
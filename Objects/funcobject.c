@@ -5,6 +5,7 @@
 #include "internal/mem.h"
 #include "internal/pystate.h"
 #include "code.h"
+#include "marshal.h"
 #include "structmember.h"
 
 PyObject *
@@ -20,12 +21,23 @@ PyFunction_NewWithQualName(PyObject *code, PyObject *globals, PyObject *qualname
             return NULL;
     }
 
+    if (_PyLazyCode_Check(code)) {
+        /* A nested code object that marshal has not read yet */
+        code = _PyLazyCode_Load(code);
+        if (code == NULL)
+            return NULL;
+    }
+    else {
+        Py_INCREF(code);
+    }
+
     op = PyObject_GC_New(PyFunctionObject, &PyFunction_Type);
-    if (op == NULL)
+    if (op == NULL) {
+        Py_DECREF(code);
         return NULL;
+    }
 
     op->func_weakreflist = NULL;
-    Py_INCREF(code);
     op->func_code = code;
     Py_INCREF(globals);
     op->func_globals = globals;
@@ -4,10 +4,13 @@
 #include "node.h"
 #include "errcode.h"
 
+/* Nodes and their strings use the raw memory allocator: parsetok() may
+   build the tree without holding the GIL. */
+
 node *
 PyNode_New(int type)
 {
-    node *n = (node *) PyObject_MALLOC(1 * sizeof(node));
+    node *n = (node *) PyMem_RawMalloc(1 * sizeof(node));
     if (n == NULL)
         return NULL;
     n->n_type = type;
@@ -62,7 +65,7 @@ fancy_roundup(int n)
  * Win98).
  *
  * In a run of compileall across the 2.3a0 Lib directory, Andrew MacIntyre
- * reported that, with this scheme, 89% of PyObject_REALLOC calls in
+ * reported that, with this scheme, 89% of realloc calls in
  * PyNode_AddChild passed 1 for the size, and 9% passed 4.  So this usually
  * wastes very little memory, but is very effective at sidestepping
  * platform-realloc disasters on vulnerable platforms.
@@ -95,7 +98,7 @@ PyNode_AddChild(node *n1, int type, char *str, int lineno, int col_offset)
             return E_NOMEM;
         }
         n = n1->n_child;
-        n = (node *) PyObject_REALLOC(n,
+        n = (node *) PyMem_RawRealloc(n,
                                       required_capacity * sizeof(node));
         if (n == NULL)
             return E_NOMEM;
@@ -122,7 +125,7 @@ PyNode_Free(node *n)
 {
     if (n != NULL) {
         freechildren(n);
-        PyObject_FREE(n);
+        PyMem_RawFree(n);
     }
 }
 
@@ -143,9 +146,9 @@ freechildren(node *n)
     for (i = NCH(n); --i >= 0; )
         freechildren(CHILD(n, i));
     if (n->n_child != NULL)
-        PyObject_FREE(n->n_child);
+        PyMem_RawFree(n->n_child);
     if (STR(n) != NULL)
-        PyObject_FREE(STR(n));
+        PyMem_RawFree(STR(n));
 }
 
 static Py_ssize_t
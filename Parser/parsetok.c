@@ -10,6 +10,11 @@
 #include "errcode.h"
 #include "graminit.h"
 
+/* Tokenizing and parsing a string needs no Python objects, so parsetok()
+   releases the GIL for sources of at least this many bytes.  This lets
+   other threads, e.g. compileall workers, run meanwhile.  Smaller inputs
+   are not worth the cost of a GIL switch. */
+#define PARSE_NOGIL_THRESHOLD 4096
 
 /* Forward */
 static node *parsetok(struct tok_state *, grammar *, int, perrdetail *, int *);
@@ -198,6 +203,11 @@ parsetok(struct tok_state *tok, grammar *g, int start, perrdetail *err_ret,
         ps->p_flags |= CO_FUTURE_BARRY_AS_BDFL;
 #endif
 
+#ifndef PGEN
+    if (tok->fp == NULL && strlen(tok->inp) >= PARSE_NOGIL_THRESHOLD)
+        tok->tstate = PyEval_SaveThread();
+#endif
+
     for (;;) {
         char *a, *b;
         int type;
@@ -226,7 +236,7 @@ parsetok(struct tok_state *tok, grammar *g, int start, perrdetail *err_ret,
         else
             started = 1;
         len = (a != NULL && b != NULL) ? b - a : 0;
-        str = (char *) PyObject_MALLOC(len + 1);
+        str = (char *) PyMem_RawMalloc(len + 1);
         if (str == NULL) {
             err_ret->error = E_NOMEM;
             break;
@@ -239,13 +249,13 @@ parsetok(struct tok_state *tok, grammar *g, int start, perrdetail *err_ret,
         if (type == NOTEQUAL) {
             if (!(ps->p_flags & CO_FUTURE_BARRY_AS_BDFL) &&
                             strcmp(str, "!=")) {
-                PyObject_FREE(str);
+                PyMem_RawFree(str);
                 err_ret->error = E_SYNTAX;
                 break;
             }
             else if ((ps->p_flags & CO_FUTURE_BARRY_AS_BDFL) &&
                             strcmp(str, "<>")) {
-                PyObject_FREE(str);
+                PyMem_RawFree(str);
                 err_ret->expected = NOTEQUAL;
                 err_ret->error = E_SYNTAX;
                 break;
@@ -265,13 +275,20 @@ parsetok(struct tok_state *tok, grammar *g, int start, perrdetail *err_ret,
                                tok->lineno, col_offset,
                                &(err_ret->expected))) != E_OK) {
             if (err_ret->error != E_DONE) {
-                PyObject_FREE(str);
+                PyMem_RawFree(str);
                 err_ret->token = type;
             }
             break;
         }
     }
 
+#ifndef PGEN
+    if (tok->tstate != NULL) {
+        PyEval_RestoreThread(tok->tstate);
+        tok->tstate = NULL;
+    }
+#endif
+
     if (err_ret->error == E_DONE) {
         n = ps->p_tree;
         ps->p_tree = NULL;
@@ -331,16 +348,16 @@ parsetok(struct tok_state *tok, grammar *g, int start, perrdetail *err_ret,
             }
         }
     } else if (tok->encoding != NULL) {
-        /* 'nodes->n_str' uses PyObject_*, while 'tok->encoding' was
+        /* 'nodes->n_str' uses PyMem_Raw*, while 'tok->encoding' was
          * allocated using PyMem_
          */
         node* r = PyNode_New(encoding_decl);
         if (r)
-            r->n_str = PyObject_MALLOC(strlen(tok->encoding)+1);
+            r->n_str = PyMem_RawMalloc(strlen(tok->encoding)+1);
         if (!r || !r->n_str) {
             err_ret->error = E_NOMEM;
             if (r)
-                PyObject_FREE(r);
+                PyMem_RawFree(r);
             n = NULL;
             goto done;
         }
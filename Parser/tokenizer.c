@@ -44,8 +44,7 @@ extern char *PyOS_Readline(FILE *, FILE *, const char *);
 
 /* Forward */
 static struct tok_state *tok_new(void);
-static int tok_nextc(struct tok_state *tok);
-static void tok_backup(struct tok_state *tok, int c);
+static int tok_underflow(struct tok_state *tok);
 
 
 /* Token names */
@@ -147,6 +146,7 @@ tok_new(void)
     tok->filename = NULL;
     tok->decoding_readline = NULL;
     tok->decoding_buffer = NULL;
+    tok->tstate = NULL;
 #endif
 
     return tok;
@@ -906,14 +906,16 @@ PyTokenizer_Free(struct tok_state *tok)
     PyMem_FREE(tok);
 }
 
-/* Get next char, updating state; error code goes into tok->done */
+/* Refill the line buffer and return its first char, updating state;
+   error code goes into tok->done.  Called by tok_nextc() when the
+   buffer is exhausted. */
 
 static int
-tok_nextc(struct tok_state *tok)
+tok_underflow(struct tok_state *tok)
 {
     for (;;) {
         if (tok->cur != tok->inp) {
-            return Py_CHARMASK(*tok->cur++); /* Fast path */
+            return Py_CHARMASK(*tok->cur++);
         }
         if (tok->done != E_OK)
             return EOF;
@@ -1105,9 +1107,22 @@ tok_nextc(struct tok_state *tok)
 }
 
 
+/* Get next char.  The line buffer always holds the rest of the current
+   line, so the common case is inlined and only refilling the buffer
+   costs a call. */
+
+Py_LOCAL_INLINE(int)
+tok_nextc(struct tok_state *tok)
+{
+    if (tok->cur != tok->inp) {
+        return Py_CHARMASK(*tok->cur++); /* Fast path */
+    }
+    return tok_underflow(tok);
+}
+
 /* Back-up one character */
 
-static void
+Py_LOCAL_INLINE(void)
 tok_backup(struct tok_state *tok, int c)
 {
     if (c != EOF) {
@@ -1303,6 +1318,8 @@ indenterror(struct tok_state *tok)
 #else
 /* Verify that the identifier follows PEP 3131.
    All identifier strings are guaranteed to be "ready" unicode objects.
+   This needs the GIL, which is temporarily reacquired if parsetok()
+   released it.
  */
 static int
 verify_identifier(struct tok_state *tok)
@@ -1311,6 +1328,8 @@ verify_identifier(struct tok_state *tok)
     int result;
     if (tok->decoding_erred)
         return 0;
+    if (tok->tstate != NULL)
+        PyEval_RestoreThread(tok->tstate);
     s = PyUnicode_DecodeUTF8(tok->start, tok->cur - tok->start, NULL);
     if (s == NULL || PyUnicode_READY(s) == -1) {
         if (PyErr_ExceptionMatches(PyExc_UnicodeDecodeError)) {
@@ -1319,12 +1338,16 @@ verify_identifier(struct tok_state *tok)
         } else {
             tok->done = E_ERROR;
         }
-        return 0;
+        result = 0;
     }
-    result = PyUnicode_IsIdentifier(s);
-    Py_DECREF(s);
-    if (result == 0)
-        tok->done = E_IDENTIFIER;
+    else {
+        result = PyUnicode_IsIdentifier(s);
+        if (result == 0)
+            tok->done = E_IDENTIFIER;
+    }
+    Py_XDECREF(s);
+    if (tok->tstate != NULL)
+        tok->tstate = PyEval_SaveThread();
     return result;
 }
 #endif
@@ -1473,6 +1496,12 @@ tok_get(struct tok_state *tok, char **p_start, char **p_end)
 
     /* Skip comment */
     if (c == '#') {
+        /* Fast path: jump to the end of the line if it is buffered */
+        char *eol = memchr(tok->cur, '\n', tok->inp - tok->cur);
+        if (eol != NULL) {
+            tok->cur = eol;
+            c = tok_nextc(tok);
+        }
         while (c != EOF && c != '\n') {
             c = tok_nextc(tok);
         }
@@ -1745,6 +1774,16 @@ tok_get(struct tok_state *tok, char **p_start, char **p_end)
 
         /* Get rest of string */
         while (end_quote_size != quote_size) {
+            /* Fast path: skip the ordinary characters of the buffered
+               line in one go */
+            char *p = tok->cur;
+            while (p < tok->inp && *p != quote && *p != '\\' && *p != '\n') {
+                p++;
+            }
+            if (p != tok->cur) {
+                tok->cur = p;
+                end_quote_size = 0;
+            }
             c = tok_nextc(tok);
             if (c == EOF) {
                 if (quote_size == 3) {
@@ -58,6 +58,8 @@ struct tok_state {
 #ifndef PGEN
     PyObject *decoding_readline; /* open(...).readline */
     PyObject *decoding_buffer;
+    PyThreadState *tstate;      /* Saved thread state while the GIL is
+                                   released by parsetok(), or NULL */
 #endif
     const char* enc;        /* Encoding for the current str. */
     const char* str;
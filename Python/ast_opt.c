@@ -3,6 +3,24 @@
 #include "Python-ast.h"
 
 
+enum {
+    OPTIMIZE_SCOPE_MODULE,
+    OPTIMIZE_SCOPE_CLASS,
+    OPTIMIZE_SCOPE_FUNCTION,
+};
+
+typedef struct {
+    int optimize;
+    /* kind of the innermost scope being folded */
+    int scope;
+    /* names of module-level Final constants which are never rebound,
+       or NULL if the module has none */
+    PyObject *final_names;
+    /* values of the Final constants whose definition has been folded */
+    PyObject *finals;
+} _PyASTOptimizeState;
+
+
 /* TODO: is_const and get_const_value are copied from Python/compile.c.
    It should be deduped in the future.  Maybe, we can include this file
    from compile.c?
@@ -75,7 +93,7 @@ unary_not(PyObject *v)
 }
 
 static int
-fold_unaryop(expr_ty node, PyArena *arena, int optimize)
+fold_unaryop(expr_ty node, PyArena *arena, _PyASTOptimizeState *state)
 {
     expr_ty arg = node->v.UnaryOp.operand;
 
@@ -252,7 +270,7 @@ safe_mod(PyObject *v, PyObject *w)
 }
 
 static int
-fold_binop(expr_ty node, PyArena *arena, int optimize)
+fold_binop(expr_ty node, PyArena *arena, _PyASTOptimizeState *state)
 {
     expr_ty lhs, rhs;
     lhs = node->v.BinOp.left;
@@ -334,7 +352,7 @@ make_const_tuple(asdl_seq *elts)
 }
 
 static int
-fold_tuple(expr_ty node, PyArena *arena, int optimize)
+fold_tuple(expr_ty node, PyArena *arena, _PyASTOptimizeState *state)
 {
     PyObject *newval;
 
@@ -346,7 +364,7 @@ fold_tuple(expr_ty node, PyArena *arena, int optimize)
 }
 
 static int
-fold_subscr(expr_ty node, PyArena *arena, int optimize)
+fold_subscr(expr_ty node, PyArena *arena, _PyASTOptimizeState *state)
 {
     PyObject *newval;
     expr_ty arg, idx;
@@ -374,7 +392,7 @@ fold_subscr(expr_ty node, PyArena *arena, int optimize)
    in "for" loop and comprehensions.
 */
 static int
-fold_iter(expr_ty arg, PyArena *arena, int optimize)
+fold_iter(expr_ty arg, PyArena *arena, _PyASTOptimizeState *state)
 {
     PyObject *newval;
     if (arg->kind == List_kind) {
@@ -393,7 +411,7 @@ fold_iter(expr_ty arg, PyArena *arena, int optimize)
 }
 
 static int
-fold_compare(expr_ty node, PyArena *arena, int optimize)
+fold_compare(expr_ty node, PyArena *arena, _PyASTOptimizeState *state)
 {
     asdl_int_seq *ops;
     asdl_seq *args;
@@ -407,29 +425,506 @@ fold_compare(expr_ty node, PyArena *arena, int optimize)
     i = asdl_seq_LEN(ops) - 1;
     int op = asdl_seq_GET(ops, i);
     if (op == In || op == NotIn) {
-        if (!fold_iter((expr_ty)asdl_seq_GET(args, i), arena, optimize)) {
+        if (!fold_iter((expr_ty)asdl_seq_GET(args, i), arena, state)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Module-level names annotated as Final, e.g.
+
+       LIMIT: Final = 100
+
+   are treated as constants inside the functions of the module, provided
+   the value folds to a constant and the name is not bound anywhere else in
+   the module (including nested scopes, "global" and "del" statements).
+   Only the functions are rewritten: module and class bodies keep looking
+   the name up at runtime.
+*/
+
+static int
+is_final_annotation(expr_ty e)
+{
+    if (e->kind == Subscript_kind) {
+        e = e->v.Subscript.value;       /* Final[int] */
+    }
+    if (e->kind == Name_kind) {
+        return _PyUnicode_EqualToASCIIString(e->v.Name.id, "Final");
+    }
+    if (e->kind == Attribute_kind) {    /* typing.Final */
+        return _PyUnicode_EqualToASCIIString(e->v.Attribute.attr, "Final");
+    }
+    return 0;
+}
+
+static int
+is_final_definition(stmt_ty s)
+{
+    return (s->kind == AnnAssign_kind &&
+            s->v.AnnAssign.simple &&
+            s->v.AnnAssign.value != NULL &&
+            s->v.AnnAssign.target->kind == Name_kind &&
+            is_final_annotation(s->v.AnnAssign.annotation));
+}
+
+/* Count a binding of name if it is one of the candidates in counts. */
+static int
+count_binding(PyObject *counts, PyObject *name)
+{
+    PyObject *count = PyDict_GetItemWithError(counts, name);
+    if (count == NULL) {
+        return !PyErr_Occurred();
+    }
+    count = PyLong_FromLong(PyLong_AS_LONG(count) + 1);
+    if (count == NULL) {
+        return 0;
+    }
+    int res = PyDict_SetItem(counts, name, count);
+    Py_DECREF(count);
+    return res == 0;
+}
+
+static int count_bindings_stmt(stmt_ty s, PyObject *counts);
+static int count_bindings_expr(expr_ty e, PyObject *counts);
+static int count_bindings_slice(slice_ty s, PyObject *counts);
+
+#define COUNT(FUNC, ARG) \
+    if ((ARG) != NULL && !FUNC((ARG), counts)) \
+        return 0;
+
+#define COUNT_SEQ(FUNC, TYPE, ARG) { \
+    int i; \
+    asdl_seq *seq = (ARG); /* avoid variable capture */ \
+    for (i = 0; i < asdl_seq_LEN(seq); i++) { \
+        COUNT(FUNC, (TYPE)asdl_seq_GET(seq, i)); \
+    } \
+}
+
+static int
+count_bindings_arg(arg_ty a, PyObject *counts)
+{
+    COUNT(count_bindings_expr, a->annotation);
+    return count_binding(counts, a->arg);
+}
+
+static int
+count_bindings_arguments(arguments_ty a, PyObject *counts)
+{
+    COUNT_SEQ(count_bindings_arg, arg_ty, a->args);
+    COUNT(count_bindings_arg, a->vararg);
+    COUNT_SEQ(count_bindings_arg, arg_ty, a->kwonlyargs);
+    COUNT_SEQ(count_bindings_expr, expr_ty, a->kw_defaults);
+    COUNT(count_bindings_arg, a->kwarg);
+    COUNT_SEQ(count_bindings_expr, expr_ty, a->defaults);
+    return 1;
+}
+
+static int
+count_bindings_comprehension(comprehension_ty c, PyObject *counts)
+{
+    COUNT(count_bindings_expr, c->target);
+    COUNT(count_bindings_expr, c->iter);
+    COUNT_SEQ(count_bindings_expr, expr_ty, c->ifs);
+    return 1;
+}
+
+static int
+count_bindings_keyword(keyword_ty k, PyObject *counts)
+{
+    COUNT(count_bindings_expr, k->value);
+    return 1;
+}
+
+static int
+count_bindings_alias(alias_ty a, PyObject *counts)
+{
+    PyObject *name;
+    int res;
+
+    if (a->asname != NULL) {
+        return count_binding(counts, a->asname);
+    }
+    if (_PyUnicode_EqualToASCIIString(a->name, "*")) {
+        /* A star import may bind any name: no candidate is safe. */
+        PyDict_Clear(counts);
+        return 1;
+    }
+    /* "import a.b.c" binds "a" */
+    Py_ssize_t dot = PyUnicode_FindChar(a->name, '.', 0,
+                                        PyUnicode_GET_LENGTH(a->name), 1);
+    if (dot == -2) {
+        return 0;
+    }
+    if (dot == -1) {
+        return count_binding(counts, a->name);
+    }
+    name = PyUnicode_Substring(a->name, 0, dot);
+    if (name == NULL) {
+        return 0;
+    }
+    res = count_binding(counts, name);
+    Py_DECREF(name);
+    return res;
+}
+
+static int
+count_bindings_excepthandler(excepthandler_ty h, PyObject *counts)
+{
+    COUNT(count_bindings_expr, h->v.ExceptHandler.type);
+    if (h->v.ExceptHandler.name != NULL &&
+        !count_binding(counts, h->v.ExceptHandler.name)) {
+        return 0;
+    }
+    COUNT_SEQ(count_bindings_stmt, stmt_ty, h->v.ExceptHandler.body);
+    return 1;
+}
+
+static int
+count_bindings_withitem(withitem_ty w, PyObject *counts)
+{
+    COUNT(count_bindings_expr, w->context_expr);
+    COUNT(count_bindings_expr, w->optional_vars);
+    return 1;
+}
+
+static int
+count_bindings_names(asdl_seq *names, PyObject *counts)
+{
+    int i;
+    for (i = 0; i < asdl_seq_LEN(names); i++) {
+        if (!count_binding(counts, (PyObject *)asdl_seq_GET(names, i))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int
+count_bindings_expr(expr_ty e, PyObject *counts)
+{
+    switch (e->kind) {
+    case BoolOp_kind:
+        COUNT_SEQ(count_bindings_expr, expr_ty, e->v.BoolOp.values);
+        break;
+    case BinOp_kind:
+        COUNT(count_bindings_expr, e->v.BinOp.left);
+        COUNT(count_bindings_expr, e->v.BinOp.right);
+        break;
+    case UnaryOp_kind:
+        COUNT(count_bindings_expr, e->v.UnaryOp.operand);
+        break;
+    case Lambda_kind:
+        COUNT(count_bindings_arguments, e->v.Lambda.args);
+        COUNT(count_bindings_expr, e->v.Lambda.body);
+        break;
+    case IfExp_kind:
+        COUNT(count_bindings_expr, e->v.IfExp.test);
+        COUNT(count_bindings_expr, e->v.IfExp.body);
+        COUNT(count_bindings_expr, e->v.IfExp.orelse);
+        break;
+    case Dict_kind:
+        COUNT_SEQ(count_bindings_expr, expr_ty, e->v.Dict.keys);
+        COUNT_SEQ(count_bindings_expr, expr_ty, e->v.Dict.values);
+        break;
+    case Set_kind:
+        COUNT_SEQ(count_bindings_expr, expr_ty, e->v.Set.elts);
+        break;
+    case ListComp_kind:
+        COUNT(count_bindings_expr, e->v.ListComp.elt);
+        COUNT_SEQ(count_bindings_comprehension, comprehension_ty,
+                  e->v.ListComp.generators);
+        break;
+    case SetComp_kind:
+        COUNT(count_bindings_expr, e->v.SetComp.elt);
+        COUNT_SEQ(count_bindings_comprehension, comprehension_ty,
+                  e->v.SetComp.generators);
+        break;
+    case DictComp_kind:
+        COUNT(count_bindings_expr, e->v.DictComp.key);
+        COUNT(count_bindings_expr, e->v.DictComp.value);
+        COUNT_SEQ(count_bindings_comprehension, comprehension_ty,
+                  e->v.DictComp.generators);
+        break;
+    case GeneratorExp_kind:
+        COUNT(count_bindings_expr, e->v.GeneratorExp.elt);
+        COUNT_SEQ(count_bindings_comprehension, comprehension_ty,
+                  e->v.GeneratorExp.generators);
+        break;
+    case Await_kind:
+        COUNT(count_bindings_expr, e->v.Await.value);
+        break;
+    case Yield_kind:
+        COUNT(count_bindings_expr, e->v.Yield.value);
+        break;
+    case YieldFrom_kind:
+        COUNT(count_bindings_expr, e->v.YieldFrom.value);
+        break;
+    case Compare_kind:
+        COUNT(count_bindings_expr, e->v.Compare.left);
+        COUNT_SEQ(count_bindings_expr, expr_ty, e->v.Compare.comparators);
+        break;
+    case Call_kind:
+        COUNT(count_bindings_expr, e->v.Call.func);
+        COUNT_SEQ(count_bindings_expr, expr_ty, e->v.Call.args);
+        COUNT_SEQ(count_bindings_keyword, keyword_ty, e->v.Call.keywords);
+        break;
+    case FormattedValue_kind:
+        COUNT(count_bindings_expr, e->v.FormattedValue.value);
+        COUNT(count_bindings_expr, e->v.FormattedValue.format_spec);
+        break;
+    case JoinedStr_kind:
+        COUNT_SEQ(count_bindings_expr, expr_ty, e->v.JoinedStr.values);
+        break;
+    case Attribute_kind:
+        COUNT(count_bindings_expr, e->v.Attribute.value);
+        break;
+    case Subscript_kind:
+        COUNT(count_bindings_expr, e->v.Subscript.value);
+        COUNT(count_bindings_slice, e->v.Subscript.slice);
+        break;
+    case Starred_kind:
+        COUNT(count_bindings_expr, e->v.Starred.value);
+        break;
+    case Name_kind:
+        if (e->v.Name.ctx != Load) {
+            return count_binding(counts, e->v.Name.id);
+        }
+        break;
+    case List_kind:
+        COUNT_SEQ(count_bindings_expr, expr_ty, e->v.List.elts);
+        break;
+    case Tuple_kind:
+        COUNT_SEQ(count_bindings_expr, expr_ty, e->v.Tuple.elts);
+        break;
+    default:
+        break;
+    }
+    return 1;
+}
+
+static int
+count_bindings_slice(slice_ty s, PyObject *counts)
+{
+    switch (s->kind) {
+    case Slice_kind:
+        COUNT(count_bindings_expr, s->v.Slice.lower);
+        COUNT(count_bindings_expr, s->v.Slice.upper);
+        COUNT(count_bindings_expr, s->v.Slice.step);
+        break;
+    case ExtSlice_kind:
+        COUNT_SEQ(count_bindings_slice, slice_ty, s->v.ExtSlice.dims);
+        break;
+    case Index_kind:
+        COUNT(count_bindings_expr, s->v.Index.value);
+        break;
+    default:
+        break;
+    }
+    return 1;
+}
+
+static int
+count_bindings_stmt(stmt_ty s, PyObject *counts)
+{
+    switch (s->kind) {
+    case FunctionDef_kind:
+        COUNT(count_bindings_arguments, s->v.FunctionDef.args);
+        COUNT_SEQ(count_bindings_stmt, stmt_ty, s->v.FunctionDef.body);
+        COUNT_SEQ(count_bindings_expr, expr_ty,
+                  s->v.FunctionDef.decorator_list);
+        COUNT(count_bindings_expr, s->v.FunctionDef.returns);
+        return count_binding(counts, s->v.FunctionDef.name);
+    case AsyncFunctionDef_kind:
+        COUNT(count_bindings_arguments, s->v.AsyncFunctionDef.args);
+        COUNT_SEQ(count_bindings_stmt, stmt_ty, s->v.AsyncFunctionDef.body);
+        COUNT_SEQ(count_bindings_expr, expr_ty,
+                  s->v.AsyncFunctionDef.decorator_list);
+        COUNT(count_bindings_expr, s->v.AsyncFunctionDef.returns);
+        return count_binding(counts, s->v.AsyncFunctionDef.name);
+    case ClassDef_kind:
+        COUNT_SEQ(count_bindings_expr, expr_ty, s->v.ClassDef.bases);
+        COUNT_SEQ(count_bindings_keyword, keyword_ty, s->v.ClassDef.keywords);
+        COUNT_SEQ(count_bindings_stmt, stmt_ty, s->v.ClassDef.body);
+        COUNT_SEQ(count_bindings_expr, expr_ty, s->v.ClassDef.decorator_list);
+        return count_binding(counts, s->v.ClassDef.name);
+    case Return_kind:
+        COUNT(count_bindings_expr, s->v.Return.value);
+        break;
+    case Delete_kind:
+        COUNT_SEQ(count_bindings_expr, expr_ty, s->v.Delete.targets);
+        break;
+    case Assign_kind:
+        COUNT_SEQ(count_bindings_expr, expr_ty, s->v.Assign.targets);
+        COUNT(count_bindings_expr, s->v.Assign.value);
+        break;
+    case AugAssign_kind:
+        COUNT(count_bindings_expr, s->v.AugAssign.target);
+        COUNT(count_bindings_expr, s->v.AugAssign.value);
+        break;
+    case AnnAssign_kind:
+        COUNT(count_bindings_expr, s->v.AnnAssign.target);
+        COUNT(count_bindings_expr, s->v.AnnAssign.annotation);
+        COUNT(count_bindings_expr, s->v.AnnAssign.value);
+        break;
+    case For_kind:
+        COUNT(count_bindings_expr, s->v.For.target);
+        COUNT(count_bindings_expr, s->v.For.iter);
+        COUNT_SEQ(count_bindings_stmt, stmt_ty, s->v.For.body);
+        COUNT_SEQ(count_bindings_stmt, stmt_ty, s->v.For.orelse);
+        break;
+    case AsyncFor_kind:
+        COUNT(count_bindings_expr, s->v.AsyncFor.target);
+        COUNT(count_bindings_expr, s->v.AsyncFor.iter);
+        COUNT_SEQ(count_bindings_stmt, stmt_ty, s->v.AsyncFor.body);
+        COUNT_SEQ(count_bindings_stmt, stmt_ty, s->v.AsyncFor.orelse);
+        break;
+    case While_kind:
+        COUNT(count_bindings_expr, s->v.While.test);
+        COUNT_SEQ(count_bindings_stmt, stmt_ty, s->v.While.body);
+        COUNT_SEQ(count_bindings_stmt, stmt_ty, s->v.While.orelse);
+        break;
+    case If_kind:
+        COUNT(count_bindings_expr, s->v.If.test);
+        COUNT_SEQ(count_bindings_stmt, stmt_ty, s->v.If.body);
+        COUNT_SEQ(count_bindings_stmt, stmt_ty, s->v.If.orelse);
+        break;
+    case With_kind:
+        COUNT_SEQ(count_bindings_withitem, withitem_ty, s->v.With.items);
+        COUNT_SEQ(count_bindings_stmt, stmt_ty, s->v.With.body);
+        break;
+    case AsyncWith_kind:
+        COUNT_SEQ(count_bindings_withitem, withitem_ty, s->v.AsyncWith.items);
+        COUNT_SEQ(count_bindings_stmt, stmt_ty, s->v.AsyncWith.body);
+        break;
+    case Raise_kind:
+        COUNT(count_bindings_expr, s->v.Raise.exc);
+        COUNT(count_bindings_expr, s->v.Raise.cause);
+        break;
+    case Try_kind:
+        COUNT_SEQ(count_bindings_stmt, stmt_ty, s->v.Try.body);
+        COUNT_SEQ(count_bindings_excepthandler, excepthandler_ty,
+                  s->v.Try.handlers);
+        COUNT_SEQ(count_bindings_stmt, stmt_ty, s->v.Try.orelse);
+        COUNT_SEQ(count_bindings_stmt, stmt_ty, s->v.Try.finalbody);
+        break;
+    case Assert_kind:
+        COUNT(count_bindings_expr, s->v.Assert.test);
+        COUNT(count_bindings_expr, s->v.Assert.msg);
+        break;
+    case Import_kind:
+        COUNT_SEQ(count_bindings_alias, alias_ty, s->v.Import.names);
+        break;
+    case ImportFrom_kind:
+        COUNT_SEQ(count_bindings_alias, alias_ty, s->v.ImportFrom.names);
+        break;
+    case Global_kind:
+        return count_bindings_names(s->v.Global.names, counts);
+    case Nonlocal_kind:
+        return count_bindings_names(s->v.Nonlocal.names, counts);
+    case Expr_kind:
+        COUNT(count_bindings_expr, s->v.Expr.value);
+        break;
+    default:
+        break;
+    }
+    return 1;
+}
+
+#undef COUNT
+#undef COUNT_SEQ
+
+/* Find the Final definitions at the top level of the module body whose
+   names are bound exactly once, and store them in state->final_names. */
+static int
+find_final_names(asdl_seq *stmts, _PyASTOptimizeState *state)
+{
+    PyObject *counts = NULL, *names = NULL, *name, *count;
+    Py_ssize_t i, pos;
+
+    for (i = 0; i < asdl_seq_LEN(stmts); i++) {
+        stmt_ty s = (stmt_ty)asdl_seq_GET(stmts, i);
+        if (!is_final_definition(s)) {
+            continue;
+        }
+        if (counts == NULL && (counts = PyDict_New()) == NULL) {
             return 0;
         }
+        if (PyDict_SetItem(counts, s->v.AnnAssign.target->v.Name.id,
+                           _PyLong_Zero) < 0) {
+            goto error;
+        }
+    }
+    if (counts == NULL) {
+        return 1;
+    }
+    for (i = 0; i < asdl_seq_LEN(stmts); i++) {
+        if (!count_bindings_stmt((stmt_ty)asdl_seq_GET(stmts, i), counts)) {
+            goto error;
+        }
+    }
+
+    names = PySet_New(NULL);
+    if (names == NULL) {
+        goto error;
+    }
+    pos = 0;
+    while (PyDict_Next(counts, &pos, &name, &count)) {
+        if (PyLong_AS_LONG(count) == 1 && PySet_Add(names, name) < 0) {
+            goto error;
+        }
+    }
+    Py_DECREF(counts);
+    if (PySet_GET_SIZE(names) == 0) {
+        Py_DECREF(names);
+        return 1;
     }
+    state->final_names = names;
     return 1;
+
+error:
+    Py_XDECREF(counts);
+    Py_XDECREF(names);
+    return 0;
 }
 
-static int astfold_mod(mod_ty node_, PyArena *ctx_, int optimize_);
-static int astfold_stmt(stmt_ty node_, PyArena *ctx_, int optimize_);
-static int astfold_expr(expr_ty node_, PyArena *ctx_, int optimize_);
-static int astfold_arguments(arguments_ty node_, PyArena *ctx_, int optimize_);
-static int astfold_comprehension(comprehension_ty node_, PyArena *ctx_, int optimize_);
-static int astfold_keyword(keyword_ty node_, PyArena *ctx_, int optimize_);
-static int astfold_slice(slice_ty node_, PyArena *ctx_, int optimize_);
-static int astfold_arg(arg_ty node_, PyArena *ctx_, int optimize_);
-static int astfold_withitem(withitem_ty node_, PyArena *ctx_, int optimize_);
-static int astfold_excepthandler(excepthandler_ty node_, PyArena *ctx_, int optimize_);
+/* Called after the value of a module-level Final definition was folded. */
+static int
+register_final(stmt_ty s, _PyASTOptimizeState *state)
+{
+    PyObject *name = s->v.AnnAssign.target->v.Name.id;
+    expr_ty value = s->v.AnnAssign.value;
+    int contains;
+
+    if (!is_const(value)) {
+        return 1;
+    }
+    contains = PySet_Contains(state->final_names, name);
+    if (contains <= 0) {
+        return contains == 0;
+    }
+    if (state->finals == NULL && (state->finals = PyDict_New()) == NULL) {
+        return 0;
+    }
+    return PyDict_SetItem(state->finals, name, get_const_value(value)) == 0;
+}
+
+static int astfold_mod(mod_ty node_, PyArena *ctx_, _PyASTOptimizeState *state_);
+static int astfold_stmt(stmt_ty node_, PyArena *ctx_, _PyASTOptimizeState *state_);
+static int astfold_expr(expr_ty node_, PyArena *ctx_, _PyASTOptimizeState *state_);
+static int astfold_arguments(arguments_ty node_, PyArena *ctx_, _PyASTOptimizeState *state_);
+static int astfold_comprehension(comprehension_ty node_, PyArena *ctx_, _PyASTOptimizeState *state_);
+static int astfold_keyword(keyword_ty node_, PyArena *ctx_, _PyASTOptimizeState *state_);
+static int astfold_slice(slice_ty node_, PyArena *ctx_, _PyASTOptimizeState *state_);
+static int astfold_arg(arg_ty node_, PyArena *ctx_, _PyASTOptimizeState *state_);
+static int astfold_withitem(withitem_ty node_, PyArena *ctx_, _PyASTOptimizeState *state_);
+static int astfold_excepthandler(excepthandler_ty node_, PyArena *ctx_, _PyASTOptimizeState *state_);
 #define CALL(FUNC, TYPE, ARG) \
-    if (!FUNC((ARG), ctx_, optimize_)) \
+    if (!FUNC((ARG), ctx_, state_)) \
         return 0;
 
 #define CALL_OPT(FUNC, TYPE, ARG) \
-    if ((ARG) != NULL && !FUNC((ARG), ctx_, optimize_)) \
+    if ((ARG) != NULL && !FUNC((ARG), ctx_, state_)) \
         return 0;
 
 #define CALL_SEQ(FUNC, TYPE, ARG) { \
@@ -437,7 +932,7 @@ static int astfold_excepthandler(excepthandler_ty node_, PyArena *ctx_, int opti
     asdl_seq *seq = (ARG); /* avoid variable capture */ \
     for (i = 0; i < asdl_seq_LEN(seq); i++) { \
         TYPE elt = (TYPE)asdl_seq_GET(seq, i); \
-        if (elt != NULL && !FUNC(elt, ctx_, optimize_)) \
+        if (elt != NULL && !FUNC(elt, ctx_, state_)) \
             return 0; \
     } \
 }
@@ -447,7 +942,7 @@ static int astfold_excepthandler(excepthandler_ty node_, PyArena *ctx_, int opti
     asdl_int_seq *seq = (ARG); /* avoid variable capture */ \
     for (i = 0; i < asdl_seq_LEN(seq); i++) { \
         TYPE elt = (TYPE)asdl_seq_GET(seq, i); \
-        if (!FUNC(elt, ctx_, optimize_)) \
+        if (!FUNC(elt, ctx_, state_)) \
             return 0; \
     } \
 }
@@ -465,13 +960,27 @@ isdocstring(stmt_ty s)
 }
 
 static int
-astfold_body(asdl_seq *stmts, PyArena *ctx_, int optimize_)
+astfold_body(asdl_seq *stmts, PyArena *ctx_, _PyASTOptimizeState *state_)
 {
     if (!asdl_seq_LEN(stmts)) {
         return 1;
     }
     int docstring = isdocstring((stmt_ty)asdl_seq_GET(stmts, 0));
-    CALL_SEQ(astfold_stmt, stmt_ty, stmts);
+    if (state_->scope == OPTIMIZE_SCOPE_MODULE && state_->final_names) {
+        /* Final constants become visible to the functions defined
+           after them. */
+        int i;
+        for (i = 0; i < asdl_seq_LEN(stmts); i++) {
+            stmt_ty st = (stmt_ty)asdl_seq_GET(stmts, i);
+            CALL(astfold_stmt, stmt_ty, st);
+            if (is_final_definition(st) && !register_final(st, state_)) {
+                return 0;
+            }
+        }
+    }
+    else {
+        CALL_SEQ(astfold_stmt, stmt_ty, stmts);
+    }
     if (docstring) {
         return 1;
     }
@@ -492,10 +1001,13 @@ astfold_body(asdl_seq *stmts, PyArena *ctx_, int optimize_)
 }
 
 static int
-astfold_mod(mod_ty node_, PyArena *ctx_, int optimize_)
+astfold_mod(mod_ty node_, PyArena *ctx_, _PyASTOptimizeState *state_)
 {
     switch (node_->kind) {
     case Module_kind:
+        if (!find_final_names(node_->v.Module.body, state_)) {
+            return 0;
+        }
         CALL(astfold_body, asdl_seq, node_->v.Module.body);
         break;
     case Interactive_kind:
@@ -514,7 +1026,7 @@ astfold_mod(mod_ty node_, PyArena *ctx_, int optimize_)
 }
 
 static int
-astfold_expr(expr_ty node_, PyArena *ctx_, int optimize_)
+astfold_expr(expr_ty node_, PyArena *ctx_, _PyASTOptimizeState *state_)
 {
     switch (node_->kind) {
     case BoolOp_kind:
@@ -529,10 +1041,14 @@ astfold_expr(expr_ty node_, PyArena *ctx_, int optimize_)
         CALL(astfold_expr, expr_ty, node_->v.UnaryOp.operand);
         CALL(fold_unaryop, expr_ty, node_);
         break;
-    case Lambda_kind:
+    case Lambda_kind: {
+        int scope = state_->scope;
         CALL(astfold_arguments, arguments_ty, node_->v.Lambda.args);
+        state_->scope = OPTIMIZE_SCOPE_FUNCTION;
         CALL(astfold_expr, expr_ty, node_->v.Lambda.body);
+        state_->scope = scope;
         break;
+    }
     case IfExp_kind:
         CALL(astfold_expr, expr_ty, node_->v.IfExp.test);
         CALL(astfold_expr, expr_ty, node_->v.IfExp.body);
@@ -608,7 +1124,20 @@ astfold_expr(expr_ty node_, PyArena *ctx_, int optimize_)
         break;
     case Name_kind:
         if (_PyUnicode_EqualToASCIIString(node_->v.Name.id, "__debug__")) {
-            return make_const(node_, PyBool_FromLong(!optimize_), ctx_);
+            return make_const(node_, PyBool_FromLong(!state_->optimize), ctx_);
+        }
+        if (state_->finals && node_->v.Name.ctx == Load &&
+            state_->scope == OPTIMIZE_SCOPE_FUNCTION)
+        {
+            PyObject *value = PyDict_GetItemWithError(state_->finals,
+                                                      node_->v.Name.id);
+            if (value != NULL) {
+                Py_INCREF(value);
+                return make_const(node_, value, ctx_);
+            }
+            if (PyErr_Occurred()) {
+                return 0;
+            }
         }
         break;
     default:
@@ -618,7 +1147,7 @@ astfold_expr(expr_ty node_, PyArena *ctx_, int optimize_)
 }
 
 static int
-astfold_slice(slice_ty node_, PyArena *ctx_, int optimize_)
+astfold_slice(slice_ty node_, PyArena *ctx_, _PyASTOptimizeState *state_)
 {
     switch (node_->kind) {
     case Slice_kind:
@@ -639,14 +1168,14 @@ astfold_slice(slice_ty node_, PyArena *ctx_, int optimize_)
 }
 
 static int
-astfold_keyword(keyword_ty node_, PyArena *ctx_, int optimize_)
+astfold_keyword(keyword_ty node_, PyArena *ctx_, _PyASTOptimizeState *state_)
 {
     CALL(astfold_expr, expr_ty, node_->value);
     return 1;
 }
 
 static int
-astfold_comprehension(comprehension_ty node_, PyArena *ctx_, int optimize_)
+astfold_comprehension(comprehension_ty node_, PyArena *ctx_, _PyASTOptimizeState *state_)
 {
     CALL(astfold_expr, expr_ty, node_->target);
     CALL(astfold_expr, expr_ty, node_->iter);
@@ -657,7 +1186,7 @@ astfold_comprehension(comprehension_ty node_, PyArena *ctx_, int optimize_)
 }
 
 static int
-astfold_arguments(arguments_ty node_, PyArena *ctx_, int optimize_)
+astfold_arguments(arguments_ty node_, PyArena *ctx_, _PyASTOptimizeState *state_)
 {
     CALL_SEQ(astfold_arg, arg_ty, node_->args);
     CALL_OPT(astfold_arg, arg_ty, node_->vararg);
@@ -669,32 +1198,39 @@ astfold_arguments(arguments_ty node_, PyArena *ctx_, int optimize_)
 }
 
 static int
-astfold_arg(arg_ty node_, PyArena *ctx_, int optimize_)
+astfold_arg(arg_ty node_, PyArena *ctx_, _PyASTOptimizeState *state_)
 {
     CALL_OPT(astfold_expr, expr_ty, node_->annotation);
     return 1;
 }
 
 static int
-astfold_stmt(stmt_ty node_, PyArena *ctx_, int optimize_)
+astfold_stmt(stmt_ty node_, PyArena *ctx_, _PyASTOptimizeState *state_)
 {
+    int scope = state_->scope;
     switch (node_->kind) {
     case FunctionDef_kind:
         CALL(astfold_arguments, arguments_ty, node_->v.FunctionDef.args);
+        state_->scope = OPTIMIZE_SCOPE_FUNCTION;
         CALL(astfold_body, asdl_seq, node_->v.FunctionDef.body);
+        state_->scope = scope;
         CALL_SEQ(astfold_expr, expr_ty, node_->v.FunctionDef.decorator_list);
         CALL_OPT(astfold_expr, expr_ty, node_->v.FunctionDef.returns);
         break;
     case AsyncFunctionDef_kind:
         CALL(astfold_arguments, arguments_ty, node_->v.AsyncFunctionDef.args);
+        state_->scope = OPTIMIZE_SCOPE_FUNCTION;
         CALL(astfold_body, asdl_seq, node_->v.AsyncFunctionDef.body);
+        state_->scope = scope;
         CALL_SEQ(astfold_expr, expr_ty, node_->v.AsyncFunctionDef.decorator_list);
         CALL_OPT(astfold_expr, expr_ty, node_->v.AsyncFunctionDef.returns);
         break;
     case ClassDef_kind:
         CALL_SEQ(astfold_expr, expr_ty, node_->v.ClassDef.bases);
         CALL_SEQ(astfold_keyword, keyword_ty, node_->v.ClassDef.keywords);
+        state_->scope = OPTIMIZE_SCOPE_CLASS;
         CALL(astfold_body, asdl_seq, node_->v.ClassDef.body);
+        state_->scope = scope;
         CALL_SEQ(astfold_expr, expr_ty, node_->v.ClassDef.decorator_list);
         break;
     case Return_kind:
@@ -772,7 +1308,7 @@ astfold_stmt(stmt_ty node_, PyArena *ctx_, int optimize_)
 }
 
 static int
-astfold_excepthandler(excepthandler_ty node_, PyArena *ctx_, int optimize_)
+astfold_excepthandler(excepthandler_ty node_, PyArena *ctx_, _PyASTOptimizeState *state_)
 {
     switch (node_->kind) {
     case ExceptHandler_kind:
@@ -786,7 +1322,7 @@ astfold_excepthandler(excepthandler_ty node_, PyArena *ctx_, int optimize_)
 }
 
 static int
-astfold_withitem(withitem_ty node_, PyArena *ctx_, int optimize_)
+astfold_withitem(withitem_ty node_, PyArena *ctx_, _PyASTOptimizeState *state_)
 {
     CALL(astfold_expr, expr_ty, node_->context_expr);
     CALL_OPT(astfold_expr, expr_ty, node_->optional_vars);
@@ -801,7 +1337,10 @@ astfold_withitem(withitem_ty node_, PyArena *ctx_, int optimize_)
 int
 _PyAST_Optimize(mod_ty mod, PyArena *arena, int optimize)
 {
-    int ret = astfold_mod(mod, arena, optimize);
+    _PyASTOptimizeState state = {optimize, OPTIMIZE_SCOPE_MODULE, NULL, NULL};
+    int ret = astfold_mod(mod, arena, &state);
     assert(ret || PyErr_Occurred());
+    Py_XDECREF(state.final_names);
+    Py_XDECREF(state.finals);
     return ret;
 }
@@ -2122,6 +2122,16 @@ cmpop(cmpop_ty op)
 static int
 compiler_jump_if(struct compiler *c, expr_ty e, basicblock *next, int cond)
 {
+    int constant = expr_constant(e);
+    if (constant >= 0) {
+        /* The test is known at compile time: either always jump or
+           never jump, without evaluating anything. */
+        if (constant == cond) {
+            ADDOP_JABS(c, JUMP_ABSOLUTE, next);
+            NEXT_BLOCK(c);
+        }
+        return 1;
+    }
     switch (e->kind) {
     case UnaryOp_kind:
         if (e->v.UnaryOp.op == Not)
@@ -2219,8 +2229,14 @@ static int
 compiler_ifexp(struct compiler *c, expr_ty e)
 {
     basicblock *end, *next;
+    int constant;
 
     assert(e->kind == IfExp_kind);
+    constant = expr_constant(e->v.IfExp.test);
+    if (constant >= 0) {
+        VISIT(c, expr, constant ? e->v.IfExp.body : e->v.IfExp.orelse);
+        return 1;
+    }
     end = compiler_new_block(c);
     if (end == NULL)
         return 0;
@@ -5478,6 +5494,146 @@ dump_basicblock(const basicblock *b)
 }
 #endif
 
+/* Return the block which is executed when control reaches b, if it does
+   nothing but return a constant. */
+static basicblock *
+exit_block(basicblock *b)
+{
+    while (b != NULL && b->b_iused == 0)
+        b = b->b_next;
+    if (b == NULL || b->b_iused != 2 ||
+        b->b_instr[0].i_opcode != LOAD_CONST ||
+        b->b_instr[1].i_opcode != RETURN_VALUE)
+        return NULL;
+    return b;
+}
+
+/* Replace unconditional jumps to a "return constant" block by a copy of
+   that block.  This saves a jump at runtime and often leaves the exit
+   block unreachable, e.g. when all the branches of an if statement
+   return.  The copies keep the line number of the exit block so that
+   tracing still reports the line of the implicit return. */
+static int
+inline_exit_blocks(struct compiler *c)
+{
+    basicblock *b, *exit;
+    struct instr *last, load, ret;
+    int off;
+
+    for (b = c->u->u_blocks; b != NULL; b = b->b_list) {
+        if (b->b_iused == 0)
+            continue;
+        last = &b->b_instr[b->b_iused - 1];
+        if (last->i_opcode != JUMP_ABSOLUTE && last->i_opcode != JUMP_FORWARD)
+            continue;
+        exit = exit_block(last->i_target);
+        if (exit == NULL)
+            continue;
+        load = exit->b_instr[0];
+        ret = exit->b_instr[1];
+        *last = load;
+        off = compiler_next_instr(c, b);
+        if (off < 0)
+            return 0;
+        b->b_instr[off] = ret;
+        b->b_return = 1;
+    }
+    return 1;
+}
+
+/* Return 1 if control never flows past the instruction. */
+static int
+is_terminator(struct instr *i)
+{
+    switch (i->i_opcode) {
+    case JUMP_ABSOLUTE:
+    case JUMP_FORWARD:
+    case CONTINUE_LOOP:
+    case BREAK_LOOP:
+    case RETURN_VALUE:
+    case RAISE_VARARGS:
+        return 1;
+    }
+    return 0;
+}
+
+/* Return 1 if the instruction changes the frame's block stack.  Such
+   instructions are kept even when unreachable, because frame.f_lineno
+   assignment relies on SETUP_* and POP_BLOCK being balanced in the
+   bytecode. */
+static int
+is_block_op(struct instr *i)
+{
+    switch (i->i_opcode) {
+    case SETUP_LOOP:
+    case SETUP_EXCEPT:
+    case SETUP_FINALLY:
+    case SETUP_WITH:
+    case SETUP_ASYNC_WITH:
+    case POP_BLOCK:
+    case POP_EXCEPT:
+    case END_FINALLY:
+        return 1;
+    }
+    return 0;
+}
+
+/* Empty the basic blocks which can't be reached from the entry block,
+   such as the implicit "return None" after a body ending with a return,
+   or the branches dropped by compiler_jump_if() for constant tests. */
+static int
+eliminate_unreachable_blocks(struct compiler *c, basicblock *entryblock,
+                             int nblocks)
+{
+    basicblock *b, **stack, **sp;
+    int i;
+
+    stack = (basicblock **)PyObject_Malloc(sizeof(basicblock *) * nblocks);
+    if (!stack) {
+        PyErr_NoMemory();
+        return 0;
+    }
+    sp = stack;
+    entryblock->b_seen = 1;
+    *sp++ = entryblock;
+    while (sp != stack) {
+        b = *--sp;
+        for (i = 0; i < b->b_iused; i++) {
+            struct instr *instr = &b->b_instr[i];
+            if ((instr->i_jrel || instr->i_jabs) && !instr->i_target->b_seen) {
+                instr->i_target->b_seen = 1;
+                *sp++ = instr->i_target;
+            }
+            if (is_terminator(instr))
+                break;
+        }
+        if (i == b->b_iused && b->b_next != NULL && !b->b_next->b_seen) {
+            b->b_next->b_seen = 1;
+            *sp++ = b->b_next;
+        }
+    }
+    PyObject_Free(stack);
+
+    for (b = c->u->u_blocks; b != NULL; b = b->b_list) {
+        if (b->b_seen) {
+            /* dfs() relies on b_seen being cleared. */
+            b->b_seen = 0;
+            continue;
+        }
+        for (i = 0; i < b->b_iused; i++) {
+            if (is_block_op(&b->b_instr[i]))
+                break;
+        }
+        if (i == b->b_iused && b->b_instr != NULL) {
+            PyObject_Free((void *)b->b_instr);
+            b->b_instr = NULL;
+            b->b_ialloc = 0;
+            b->b_iused = 0;
+        }
+    }
+    return 1;
+}
+
 static PyCodeObject *
 assemble(struct compiler *c, int addNone)
 {
@@ -5513,6 +5669,10 @@ assemble(struct compiler *c, int addNone)
     }
     if (!assemble_init(&a, nblocks, c->u->u_firstlineno))
         goto error;
+    if (!inline_exit_blocks(c))
+        goto error;
+    if (!eliminate_unreachable_blocks(c, entryblock, nblocks))
+        goto error;
     dfs(c, entryblock, &a, nblocks);
 
     /* Can't modify the bytecode after computing jump offsets. */
@@ -1016,6 +1016,8 @@ update_code_filenames(PyCodeObject *co, PyObject *oldname, PyObject *newname)
         if (PyCode_Check(tmp))
             update_code_filenames((PyCodeObject *)tmp,
                                   oldname, newname);
+        else if (_PyLazyCode_Check(tmp))
+            _PyLazyCode_SetFilename(tmp, newname);
     }
 }
 
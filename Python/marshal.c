@@ -4,7 +4,10 @@
    even though dicts, lists, sets and frozensets, not commonly seen in
    code objects, are supported.
    Version 3 of this protocol properly supports circular links
-   and sharing. */
+   and sharing.  Version 5 writes the code objects nested in a code object
+   as self-contained records, so that they can be read on first use.
+   Version 6 writes the strings once, in a table at the start of the data,
+   and tuples of small ints or strings in bulk. */
 
 #define PY_SSIZE_T_CLEAN
 
@@ -12,6 +15,7 @@
 #include "longintrepr.h"
 #include "code.h"
 #include "marshal.h"
+#include "opcode.h"
 #include "../Modules/hashtable.h"
 
 /*[clinic input]
@@ -71,6 +75,12 @@ module marshal
 #define TYPE_SMALL_TUPLE        ')'
 #define TYPE_SHORT_ASCII        'z'
 #define TYPE_SHORT_ASCII_INTERNED 'Z'
+#define TYPE_LAZY_CODE          'L'
+#define TYPE_STRING_TABLE       'W'
+#define TYPE_STRING_REF         'K'
+#define TYPE_SHORT_STRING_REF   'k'
+#define TYPE_STRING_TUPLE       'Q'
+#define TYPE_SMALL_INT_TUPLE    'B'
 
 #define WFERR_OK 0
 #define WFERR_UNMARSHALLABLE 1
@@ -87,6 +97,10 @@ typedef struct {
     char *buf;
     _Py_hashtable_t *hashtable;
     int version;
+    int lazy_depth;  /* depth of the constants of the current code object */
+    _Py_hashtable_t *strings;  /* index of each string of the string
+                                  table, or NULL */
+    PyObject *string_list;     /* list of the strings of the string table */
 } WFILE;
 
 #define w_byte(c, p) do {                               \
@@ -312,6 +326,150 @@ err:
 static void
 w_complex_object(PyObject *v, char flag, WFILE *p);
 
+static void w_object(PyObject *, WFILE *);
+static int w_init_refs(WFILE *, int);
+static void w_clear_refs(WFILE *);
+
+/* Write a code object found in the constants of another one as a
+   TYPE_LAZY_CODE record: its size followed by a complete marshal stream
+   with its own references, which the reader can skip.  The record shares
+   the string table of the enclosing stream.  Versions 5 and later are
+   always written to a string, so that the size can be filled in last. */
+static void
+w_lazy_code(PyObject *v, WFILE *p)
+{
+    _Py_hashtable_t *hashtable = p->hashtable;
+    Py_ssize_t start, size;
+    unsigned char *q;
+
+    assert(p->fp == NULL);
+    w_byte(TYPE_LAZY_CODE, p);
+    w_long(0, p);
+    if (p->ptr == NULL)
+        return;
+    start = p->ptr - p->buf;
+    p->hashtable = NULL;
+    if (w_init_refs(p, p->version) < 0) {
+        PyErr_Clear();
+        p->hashtable = hashtable;
+        p->error = WFERR_NOMEMORY;
+        return;
+    }
+    w_object(v, p);
+    w_clear_refs(p);
+    p->hashtable = hashtable;
+    if (p->ptr == NULL)
+        return;
+    size = p->ptr - p->buf - start;
+    if (size > SIZE32_MAX) {
+        p->error = WFERR_UNMARSHALLABLE;
+        return;
+    }
+    q = (unsigned char *)p->buf + start - 4;
+    q[0] = (unsigned char)(size & 0xff);
+    q[1] = (unsigned char)((size >> 8) & 0xff);
+    q[2] = (unsigned char)((size >> 16) & 0xff);
+    q[3] = (unsigned char)((size >> 24) & 0xff);
+}
+
+/* Return the index of the string v in the string table, adding it if
+   needed, or -1 on error. */
+static Py_ssize_t
+w_string_index(PyObject *v, WFILE *p)
+{
+    _Py_hashtable_entry_t *entry;
+    int i;
+
+    entry = _Py_HASHTABLE_GET_ENTRY(p->strings, v);
+    if (entry != NULL) {
+        _Py_HASHTABLE_ENTRY_READ_DATA(p->strings, entry, i);
+        return i;
+    }
+    if (PyList_GET_SIZE(p->string_list) >= SIZE32_MAX) {
+        p->error = WFERR_UNMARSHALLABLE;
+        return -1;
+    }
+    i = (int)PyList_GET_SIZE(p->string_list);
+    /* The list keeps the string alive for the hashtable */
+    if (PyList_Append(p->string_list, v) < 0 ||
+        _Py_HASHTABLE_SET(p->strings, v, i) < 0) {
+        PyErr_Clear();
+        p->error = WFERR_NOMEMORY;
+        return -1;
+    }
+    return i;
+}
+
+static void
+w_string_ref(PyObject *v, WFILE *p)
+{
+    Py_ssize_t i = w_string_index(v, p);
+
+    if (i < 0)
+        return;
+    if (i < 256) {
+        w_byte(TYPE_SHORT_STRING_REF, p);
+        w_byte((unsigned char)i, p);
+    }
+    else {
+        w_byte(TYPE_STRING_REF, p);
+        w_long((long)i, p);
+    }
+}
+
+/* Write a tuple of less than 256 ints in [-128, 127] or of strings from
+   the first 65536 of the string table in bulk.  Return 0 if the tuple is
+   not one of those. */
+static int
+w_bulk_tuple(PyObject *v, char flag, WFILE *p)
+{
+    Py_ssize_t i, n = PyTuple_GET_SIZE(v);
+    PyObject *item;
+
+    if (n == 0 || n >= 256)
+        return 0;
+    item = PyTuple_GET_ITEM(v, 0);
+    if (PyLong_CheckExact(item)) {
+        unsigned char buf[256];
+        for (i = 0; i < n; i++) {
+            int overflow;
+            long x;
+            item = PyTuple_GET_ITEM(v, i);
+            if (!PyLong_CheckExact(item))
+                return 0;
+            x = PyLong_AsLongAndOverflow(item, &overflow);
+            if (overflow || x < -128 || x > 127)
+                return 0;
+            buf[i] = (unsigned char)(signed char)x;
+        }
+        W_TYPE(TYPE_SMALL_INT_TUPLE, p);
+        w_byte((unsigned char)n, p);
+        w_string((char *)buf, n, p);
+        return 1;
+    }
+    if (PyUnicode_CheckExact(item) && p->strings != NULL) {
+        unsigned char buf[2 * 256];
+        for (i = 0; i < n; i++) {
+            if (!PyUnicode_CheckExact(PyTuple_GET_ITEM(v, i)))
+                return 0;
+        }
+        for (i = 0; i < n; i++) {
+            Py_ssize_t index = w_string_index(PyTuple_GET_ITEM(v, i), p);
+            if (index < 0)
+                return 1;
+            if (index > 0xffff)
+                return 0;
+            buf[2 * i] = (unsigned char)(index & 0xff);
+            buf[2 * i + 1] = (unsigned char)(index >> 8);
+        }
+        W_TYPE(TYPE_STRING_TUPLE, p);
+        w_byte((unsigned char)n, p);
+        w_string((char *)buf, 2 * n, p);
+        return 1;
+    }
+    return 0;
+}
+
 static void
 w_object(PyObject *v, WFILE *p)
 {
@@ -340,6 +498,28 @@ w_object(PyObject *v, WFILE *p)
     else if (v == Py_True) {
         w_byte(TYPE_TRUE, p);
     }
+    else if (p->strings != NULL && PyUnicode_CheckExact(v) &&
+             Py_REFCNT(v) > 1) {
+        /* A string with a single reference cannot be seen twice */
+        w_string_ref(v, p);
+    }
+    else if (p->depth == p->lazy_depth && PyCode_Check(v)) {
+        w_lazy_code(v, p);
+    }
+    else if (_PyLazyCode_Check(v)) {
+        v = _PyLazyCode_Load(v);
+        if (v == NULL) {
+            PyErr_Clear();
+            p->error = WFERR_UNMARSHALLABLE;
+        }
+        else {
+            if (p->depth == p->lazy_depth)
+                w_lazy_code(v, p);
+            else if (!w_ref(v, &flag, p))
+                w_complex_object(v, flag, p);
+            Py_DECREF(v);
+        }
+    }
     else if (!w_ref(v, &flag, p))
         w_complex_object(v, flag, p);
 
@@ -481,6 +661,8 @@ w_complex_object(PyObject *v, char flag, WFILE *p)
         }
     }
     else if (PyTuple_CheckExact(v)) {
+        if (p->version >= 6 && w_bulk_tuple(v, flag, p))
+            return;
         n = PyTuple_Size(v);
         if (p->version >= 4 && n < 256) {
             W_TYPE(TYPE_SMALL_TUPLE, p);
@@ -547,6 +729,7 @@ w_complex_object(PyObject *v, char flag, WFILE *p)
     }
     else if (PyCode_Check(v)) {
         PyCodeObject *co = (PyCodeObject *)v;
+        int lazy_depth = p->lazy_depth;
         W_TYPE(TYPE_CODE, p);
         w_long(co->co_argcount, p);
         w_long(co->co_kwonlyargcount, p);
@@ -554,7 +737,11 @@ w_complex_object(PyObject *v, char flag, WFILE *p)
         w_long(co->co_stacksize, p);
         w_long(co->co_flags, p);
         w_object(co->co_code, p);
+        /* The items of co_consts are two levels below the code object */
+        if (p->version >= 5)
+            p->lazy_depth = p->depth + 2;
         w_object(co->co_consts, p);
+        p->lazy_depth = lazy_depth;
         w_object(co->co_names, p);
         w_object(co->co_varnames, p);
         w_object(co->co_freevars, p);
@@ -639,6 +826,16 @@ PyMarshal_WriteObjectToFile(PyObject *x, FILE *fp, int version)
 {
     char buf[BUFSIZ];
     WFILE wf;
+    if (version >= 5) {
+        /* The sizes of the lazy code records and the string table are
+           only known once everything is written */
+        PyObject *s = PyMarshal_WriteObjectToString(x, version);
+        if (s != NULL) {
+            fwrite(PyBytes_AS_STRING(s), 1, PyBytes_GET_SIZE(s), fp);
+            Py_DECREF(s);
+        }
+        return;
+    }
     memset(&wf, 0, sizeof(wf));
     wf.fp = fp;
     wf.ptr = wf.buf = buf;
@@ -661,6 +858,10 @@ typedef struct {
     char *buf;
     Py_ssize_t buf_size;
     PyObject *refs;  /* a list */
+    PyObject *source;  /* read-only memoryview of the data for loads(),
+                          used to read nested code objects lazily */
+    int lazy_depth;  /* depth of the constants of the current code object */
+    PyObject *strings;  /* the string table (a tuple), or NULL */
 } RFILE;
 
 static const char *
@@ -935,6 +1136,9 @@ r_ref(PyObject *o, int flag, RFILE *p)
     return o;
 }
 
+static PyObject *lazycode_new(PyObject *, PyObject *, Py_ssize_t, Py_ssize_t);
+static int load_escaping_lazy_consts(PyObject *, PyObject *);
+
 static PyObject *
 r_object(RFILE *p)
 {
@@ -1399,7 +1603,12 @@ r_object(RFILE *p)
             code = r_object(p);
             if (code == NULL)
                 goto code_error;
-            consts = r_object(p);
+            {
+                int lazy_depth = p->lazy_depth;
+                p->lazy_depth = p->depth + 2;
+                consts = r_object(p);
+                p->lazy_depth = lazy_depth;
+            }
             if (consts == NULL)
                 goto code_error;
             names = r_object(p);
@@ -1426,6 +1635,10 @@ r_object(RFILE *p)
             lnotab = r_object(p);
             if (lnotab == NULL)
                 goto code_error;
+            if (p->source != NULL && PyBytes_Check(code) &&
+                PyTuple_Check(consts) &&
+                load_escaping_lazy_consts(code, consts) < 0)
+                goto code_error;
 
             v = (PyObject *) PyCode_New(
                             argcount, kwonlyargcount,
@@ -1449,6 +1662,171 @@ r_object(RFILE *p)
         retval = v;
         break;
 
+    case TYPE_LAZY_CODE:
+        n = r_long(p);
+        if (n < 0 || n > SIZE32_MAX) {
+            if (!PyErr_Occurred()) {
+                PyErr_SetString(PyExc_ValueError,
+                    "bad marshal data (code size out of range)");
+            }
+            break;
+        }
+        if (p->source != NULL && p->depth == p->lazy_depth) {
+            const char *start = r_string(n, p);
+            if (start == NULL)
+                break;
+            retval = lazycode_new(p->source, p->strings,
+                start - (char *)PyMemoryView_GET_BUFFER(p->source)->buf, n);
+        }
+        else {
+            /* The record has its own references */
+            PyObject *refs = p->refs;
+            const char *end = p->ptr != NULL ? p->ptr + n : NULL;
+            int lazy_depth = p->lazy_depth;
+            p->refs = PyList_New(0);
+            if (p->refs == NULL) {
+                p->refs = refs;
+                break;
+            }
+            p->lazy_depth = 0;
+            v = r_object(p);
+            p->lazy_depth = lazy_depth;
+            Py_DECREF(p->refs);
+            p->refs = refs;
+            if (v != NULL && (!PyCode_Check(v) ||
+                              (end != NULL && p->ptr != end))) {
+                Py_DECREF(v);
+                PyErr_SetString(PyExc_ValueError,
+                    "bad marshal data (invalid code record)");
+                break;
+            }
+            retval = v;
+        }
+        break;
+
+    case TYPE_STRING_TABLE:
+        {
+            PyObject *strings;
+
+            if (p->strings != NULL) {
+                PyErr_SetString(PyExc_ValueError,
+                    "bad marshal data (nested string table)");
+                break;
+            }
+            n = r_long(p);
+            if (PyErr_Occurred())
+                break;
+            if (n < 0 || n > SIZE32_MAX) {
+                PyErr_SetString(PyExc_ValueError,
+                    "bad marshal data (string table size out of range)");
+                break;
+            }
+            strings = PyTuple_New(n);
+            if (strings == NULL)
+                break;
+            for (i = 0; i < n; i++) {
+                v = r_object(p);
+                if (v == NULL || !PyUnicode_CheckExact(v)) {
+                    if (v != NULL || !PyErr_Occurred())
+                        PyErr_SetString(PyExc_ValueError,
+                            "bad marshal data (invalid string table)");
+                    Py_XDECREF(v);
+                    Py_CLEAR(strings);
+                    break;
+                }
+                PyTuple_SET_ITEM(strings, i, v);
+            }
+            if (strings == NULL)
+                break;
+            /* The table is followed by the object using it */
+            p->strings = strings;
+            retval = r_object(p);
+            p->strings = NULL;
+            Py_DECREF(strings);
+        }
+        break;
+
+    case TYPE_SHORT_STRING_REF:
+        n = r_byte(p);
+        if (n == EOF) {
+            if (!PyErr_Occurred())
+                PyErr_SetString(PyExc_EOFError, "marshal data too short");
+            break;
+        }
+        goto _read_string_ref;
+    case TYPE_STRING_REF:
+        n = r_long(p);
+        if (PyErr_Occurred())
+            break;
+    _read_string_ref:
+        if (p->strings == NULL || n < 0 || n >= PyTuple_GET_SIZE(p->strings)) {
+            PyErr_SetString(PyExc_ValueError,
+                "bad marshal data (string index out of range)");
+            break;
+        }
+        v = PyTuple_GET_ITEM(p->strings, n);
+        Py_INCREF(v);
+        retval = v;
+        R_REF(retval);
+        break;
+
+    case TYPE_STRING_TUPLE:
+        {
+            const unsigned char *buf;
+
+            n = (unsigned char) r_byte(p);
+            if (PyErr_Occurred())
+                break;
+            buf = (const unsigned char *) r_string(2 * n, p);
+            if (buf == NULL)
+                break;
+            v = PyTuple_New(n);
+            if (v == NULL)
+                break;
+            for (i = 0; i < n; i++) {
+                Py_ssize_t index = buf[2 * i] | (buf[2 * i + 1] << 8);
+                if (p->strings == NULL ||
+                    index >= PyTuple_GET_SIZE(p->strings)) {
+                    PyErr_SetString(PyExc_ValueError,
+                        "bad marshal data (string index out of range)");
+                    Py_CLEAR(v);
+                    break;
+                }
+                v2 = PyTuple_GET_ITEM(p->strings, index);
+                Py_INCREF(v2);
+                PyTuple_SET_ITEM(v, i, v2);
+            }
+            retval = v;
+            R_REF(retval);
+        }
+        break;
+
+    case TYPE_SMALL_INT_TUPLE:
+        {
+            const signed char *buf;
+
+            n = (unsigned char) r_byte(p);
+            if (PyErr_Occurred())
+                break;
+            buf = (const signed char *) r_string(n, p);
+            if (buf == NULL)
+                break;
+            v = PyTuple_New(n);
+            if (v == NULL)
+                break;
+            for (i = 0; i < n; i++) {
+                v2 = PyLong_FromLong(buf[i]);
+                if (v2 == NULL) {
+                    Py_CLEAR(v);
+                    break;
+                }
+                PyTuple_SET_ITEM(v, i, v2);
+            }
+            retval = v;
+            R_REF(retval);
+        }
+        break;
+
     case TYPE_REF:
         n = r_long(p);
         if (n < 0 || n >= PyList_GET_SIZE(p->refs)) {
@@ -1491,6 +1869,248 @@ read_object(RFILE *p)
     return v;
 }
 
+/* Lazily read code objects.
+
+   A version 5 stream stores each code object nested in the constants of
+   another one as a TYPE_LAZY_CODE record.  When loads() reads from a
+   read-only buffer, such a record becomes a lazycodeobject which keeps a
+   view of the buffer, and the code object is only unmarshalled when a
+   function is first made from it or co_consts is looked at.  Code that is
+   never run thus costs no more than the bytes of the .pyc. */
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *source;       /* read-only memoryview of the marshal data */
+    PyObject *strings;      /* the string table of the data, or NULL */
+    Py_ssize_t offset;      /* start of the record in source */
+    Py_ssize_t size;
+    PyObject *code;         /* the code object once read, or NULL */
+    PyObject *filename;     /* co_filename to set when read, or NULL */
+} lazycodeobject;
+
+static PyObject *
+lazycode_new(PyObject *source, PyObject *strings,
+             Py_ssize_t offset, Py_ssize_t size)
+{
+    lazycodeobject *lc = PyObject_New(lazycodeobject, &_PyLazyCode_Type);
+    if (lc == NULL)
+        return NULL;
+    Py_INCREF(source);
+    lc->source = source;
+    Py_XINCREF(strings);
+    lc->strings = strings;
+    lc->offset = offset;
+    lc->size = size;
+    lc->code = NULL;
+    lc->filename = NULL;
+    return (PyObject *)lc;
+}
+
+static void
+lazycode_dealloc(lazycodeobject *lc)
+{
+    Py_DECREF(lc->source);
+    Py_XDECREF(lc->strings);
+    Py_XDECREF(lc->code);
+    Py_XDECREF(lc->filename);
+    PyObject_Del(lc);
+}
+
+static PyObject *
+lazycode_repr(lazycodeobject *lc)
+{
+    return PyUnicode_FromFormat("<lazy code object at %p, %zd bytes>",
+                                lc, lc->size);
+}
+
+PyTypeObject _PyLazyCode_Type = {
+    PyVarObject_HEAD_INIT(&PyType_Type, 0)
+    "lazy_code",
+    sizeof(lazycodeobject),
+    0,
+    (destructor)lazycode_dealloc,               /* tp_dealloc */
+    0,                                          /* tp_print */
+    0,                                          /* tp_getattr */
+    0,                                          /* tp_setattr */
+    0,                                          /* tp_reserved */
+    (reprfunc)lazycode_repr,                    /* tp_repr */
+    0,                                          /* tp_as_number */
+    0,                                          /* tp_as_sequence */
+    0,                                          /* tp_as_mapping */
+    0,                                          /* tp_hash */
+    0,                                          /* tp_call */
+    0,                                          /* tp_str */
+    PyObject_GenericGetAttr,                    /* tp_getattro */
+    0,                                          /* tp_setattro */
+    0,                                          /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                         /* tp_flags */
+};
+
+static void
+set_code_filename(PyCodeObject *co, PyObject *filename)
+{
+    Py_ssize_t i;
+
+    Py_INCREF(filename);
+    Py_XSETREF(co->co_filename, filename);
+    for (i = 0; i < PyTuple_GET_SIZE(co->co_consts); i++) {
+        PyObject *v = PyTuple_GET_ITEM(co->co_consts, i);
+        if (PyCode_Check(v))
+            set_code_filename((PyCodeObject *)v, filename);
+        else if (_PyLazyCode_Check(v))
+            _PyLazyCode_SetFilename(v, filename);
+    }
+}
+
+/* Give the code object, once read, the given co_filename; see
+   _imp._fix_co_filename(). */
+void
+_PyLazyCode_SetFilename(PyObject *op, PyObject *filename)
+{
+    lazycodeobject *lc = (lazycodeobject *)op;
+
+    assert(_PyLazyCode_Check(op));
+    if (lc->code != NULL) {
+        set_code_filename((PyCodeObject *)lc->code, filename);
+    }
+    else {
+        Py_INCREF(filename);
+        Py_XSETREF(lc->filename, filename);
+    }
+}
+
+/* Return a new reference to the code object, reading it if needed. */
+PyObject *
+_PyLazyCode_Load(PyObject *op)
+{
+    lazycodeobject *lc = (lazycodeobject *)op;
+    RFILE rf;
+    PyObject *v;
+
+    assert(_PyLazyCode_Check(op));
+    if (lc->code != NULL) {
+        Py_INCREF(lc->code);
+        return lc->code;
+    }
+    rf.fp = NULL;
+    rf.readable = NULL;
+    rf.ptr = (char *)PyMemoryView_GET_BUFFER(lc->source)->buf + lc->offset;
+    rf.end = rf.ptr + lc->size;
+    rf.buf = NULL;
+    rf.depth = 0;
+    rf.source = lc->source;
+    rf.lazy_depth = 0;
+    rf.strings = lc->strings;
+    if ((rf.refs = PyList_New(0)) == NULL)
+        return NULL;
+    v = read_object(&rf);
+    Py_DECREF(rf.refs);
+    if (v == NULL)
+        return NULL;
+    if (!PyCode_Check(v)) {
+        Py_DECREF(v);
+        PyErr_SetString(PyExc_ValueError,
+                        "bad marshal data (invalid code record)");
+        return NULL;
+    }
+    if (lc->filename != NULL) {
+        set_code_filename((PyCodeObject *)v, lc->filename);
+        Py_CLEAR(lc->filename);
+    }
+    Py_INCREF(v);
+    lc->code = v;
+    return v;
+}
+
+/* Replace the lazy code objects of a co_consts tuple by the code objects.
+   Return -1 with an exception set on error.
+
+   Tuples are immutable, but this one is only reachable through its code
+   object as long as it holds placeholders (see load_escaping_lazy_consts()),
+   and its items only change from a placeholder to the code object read
+   from it.  Nothing caches the hash of a tuple, and MAKE_FUNCTION owns the
+   reference to the placeholder pushed by LOAD_CONST, so no borrowed
+   reference is left dangling. */
+int
+_PyLazyCode_LoadConsts(PyObject *consts)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < PyTuple_GET_SIZE(consts); i++) {
+        PyObject *v = PyTuple_GET_ITEM(consts, i);
+        if (_PyLazyCode_Check(v)) {
+            PyObject *code = _PyLazyCode_Load(v);
+            if (code == NULL)
+                return -1;
+            PyTuple_SET_ITEM(consts, i, code);
+            Py_DECREF(v);
+        }
+    }
+    return 0;
+}
+
+/* Lazy code objects must only ever be seen by MAKE_FUNCTION.  Load those
+   pushed by a LOAD_CONST that is not followed by the LOAD_CONST of the
+   qualified name and MAKE_FUNCTION, as hand-made bytecode may do.
+
+   The tuple holding the others is then only reachable through its code
+   object, whose getters load them, except through the garbage collector.
+   It is untracked, which hides it from gc.get_objects() and
+   gc.get_referrers(): constants cannot form reference cycles, so the
+   collector would never free it anyway.  A placeholder can still be seen
+   on the value stack of a frame between LOAD_CONST and MAKE_FUNCTION, by
+   gc.get_referents() called from a tracer of opcodes. */
+static int
+load_escaping_lazy_consts(PyObject *code, PyObject *consts)
+{
+    const _Py_CODEUNIT *codestr = (const _Py_CODEUNIT *)PyBytes_AS_STRING(code);
+    Py_ssize_t ncodeunits = PyBytes_GET_SIZE(code) / sizeof(_Py_CODEUNIT);
+    Py_ssize_t nconsts = PyTuple_GET_SIZE(consts);
+    Py_ssize_t i, j;
+    unsigned int oparg = 0;
+
+    for (i = 0; i < ncodeunits; i++) {
+        int opcode = _Py_OPCODE(codestr[i]);
+        PyObject *v, *lazy;
+
+        oparg = (oparg << 8) | _Py_OPARG(codestr[i]);
+        if (opcode == EXTENDED_ARG)
+            continue;
+        if (opcode != LOAD_CONST || oparg >= (unsigned int)nconsts ||
+            !_PyLazyCode_Check(PyTuple_GET_ITEM(consts, oparg))) {
+            oparg = 0;
+            continue;
+        }
+        j = i + 1;
+        while (j < ncodeunits && _Py_OPCODE(codestr[j]) == EXTENDED_ARG)
+            j++;
+        if (j < ncodeunits && _Py_OPCODE(codestr[j]) == LOAD_CONST) {
+            j++;
+            while (j < ncodeunits && _Py_OPCODE(codestr[j]) == EXTENDED_ARG)
+                j++;
+            if (j < ncodeunits && _Py_OPCODE(codestr[j]) == MAKE_FUNCTION) {
+                oparg = 0;
+                continue;
+            }
+        }
+        lazy = PyTuple_GET_ITEM(consts, oparg);
+        v = _PyLazyCode_Load(lazy);
+        if (v == NULL)
+            return -1;
+        PyTuple_SET_ITEM(consts, oparg, v);
+        Py_DECREF(lazy);
+        oparg = 0;
+    }
+    for (i = 0; i < nconsts; i++) {
+        if (_PyLazyCode_Check(PyTuple_GET_ITEM(consts, i))) {
+            if (_PyObject_GC_IS_TRACKED(consts))
+                _PyObject_GC_UNTRACK(consts);
+            break;
+        }
+    }
+    return 0;
+}
+
 int
 PyMarshal_ReadShortFromFile(FILE *fp)
 {
@@ -1498,6 +2118,9 @@ PyMarshal_ReadShortFromFile(FILE *fp)
     int res;
     assert(fp);
     rf.readable = NULL;
+    rf.source = NULL;
+    rf.lazy_depth = 0;
+    rf.strings = NULL;
     rf.fp = fp;
     rf.end = rf.ptr = NULL;
     rf.buf = NULL;
@@ -1514,6 +2137,9 @@ PyMarshal_ReadLongFromFile(FILE *fp)
     long res;
     rf.fp = fp;
     rf.readable = NULL;
+    rf.source = NULL;
+    rf.lazy_depth = 0;
+    rf.strings = NULL;
     rf.ptr = rf.end = NULL;
     rf.buf = NULL;
     res = r_long(&rf);
@@ -1575,6 +2201,9 @@ PyMarshal_ReadObjectFromFile(FILE *fp)
     PyObject *result;
     rf.fp = fp;
     rf.readable = NULL;
+    rf.source = NULL;
+    rf.lazy_depth = 0;
+    rf.strings = NULL;
     rf.depth = 0;
     rf.ptr = rf.end = NULL;
     rf.buf = NULL;
@@ -1595,6 +2224,9 @@ PyMarshal_ReadObjectFromString(const char *str, Py_ssize_t len)
     PyObject *result;
     rf.fp = NULL;
     rf.readable = NULL;
+    rf.source = NULL;
+    rf.lazy_depth = 0;
+    rf.strings = NULL;
     rf.ptr = (char *)str;
     rf.end = (char *)str + len;
     rf.buf = NULL;
@@ -1609,47 +2241,107 @@ PyMarshal_ReadObjectFromString(const char *str, Py_ssize_t len)
     return result;
 }
 
+static int
+w_init_string(WFILE *wf, int version)
+{
+    memset(wf, 0, sizeof(*wf));
+    wf->str = PyBytes_FromStringAndSize((char *)NULL, 50);
+    if (wf->str == NULL)
+        return -1;
+    wf->ptr = wf->buf = PyBytes_AS_STRING((PyBytesObject *)wf->str);
+    wf->end = wf->ptr + PyBytes_Size(wf->str);
+    wf->error = WFERR_OK;
+    wf->version = version;
+    return 0;
+}
+
+/* Return the bytes written to wf, or NULL with an exception set. */
+static PyObject *
+w_finish_string(WFILE *wf)
+{
+    if (wf->str != NULL) {
+        char *base = PyBytes_AS_STRING((PyBytesObject *)wf->str);
+        if (wf->ptr - base > PY_SSIZE_T_MAX) {
+            Py_DECREF(wf->str);
+            PyErr_SetString(PyExc_OverflowError,
+                            "too much marshal data for a bytes object");
+            return NULL;
+        }
+        if (_PyBytes_Resize(&wf->str, (Py_ssize_t)(wf->ptr - base)) < 0)
+            return NULL;
+    }
+    if (wf->error != WFERR_OK) {
+        Py_XDECREF(wf->str);
+        if (wf->error == WFERR_NOMEMORY)
+            PyErr_NoMemory();
+        else
+            PyErr_SetString(PyExc_ValueError,
+              (wf->error==WFERR_UNMARSHALLABLE)?"unmarshallable object"
+               :"object too deeply nested to marshal");
+        return NULL;
+    }
+    return wf->str;
+}
+
+/* Return the TYPE_STRING_TABLE record of the strings followed by data. */
+static PyObject *
+w_string_table(PyObject *string_list, PyObject *data, int version)
+{
+    WFILE wf;
+    Py_ssize_t i, n = PyList_GET_SIZE(string_list);
+
+    if (w_init_string(&wf, version) < 0)
+        return NULL;
+    w_byte(TYPE_STRING_TABLE, &wf);
+    w_long((long)n, &wf);
+    for (i = 0; i < n; i++) {
+        wf.depth++;
+        w_complex_object(PyList_GET_ITEM(string_list, i), '\0', &wf);
+        wf.depth--;
+    }
+    w_string(PyBytes_AS_STRING(data), PyBytes_GET_SIZE(data), &wf);
+    return w_finish_string(&wf);
+}
+
 PyObject *
 PyMarshal_WriteObjectToString(PyObject *x, int version)
 {
     WFILE wf;
+    PyObject *res;
 
-    memset(&wf, 0, sizeof(wf));
-    wf.str = PyBytes_FromStringAndSize((char *)NULL, 50);
-    if (wf.str == NULL)
+    if (w_init_string(&wf, version) < 0)
         return NULL;
-    wf.ptr = wf.buf = PyBytes_AS_STRING((PyBytesObject *)wf.str);
-    wf.end = wf.ptr + PyBytes_Size(wf.str);
-    wf.error = WFERR_OK;
-    wf.version = version;
     if (w_init_refs(&wf, version)) {
         Py_DECREF(wf.str);
         return NULL;
     }
-    w_object(x, &wf);
-    w_clear_refs(&wf);
-    if (wf.str != NULL) {
-        char *base = PyBytes_AS_STRING((PyBytesObject *)wf.str);
-        if (wf.ptr - base > PY_SSIZE_T_MAX) {
+    if (version >= 6) {
+        wf.strings = _Py_hashtable_new(sizeof(PyObject *), sizeof(int),
+                                       _Py_hashtable_hash_ptr,
+                                       _Py_hashtable_compare_direct);
+        wf.string_list = PyList_New(0);
+        if (wf.strings == NULL || wf.string_list == NULL) {
+            if (wf.strings != NULL)
+                _Py_hashtable_destroy(wf.strings);
+            else
+                PyErr_NoMemory();
+            Py_XDECREF(wf.string_list);
+            w_clear_refs(&wf);
             Py_DECREF(wf.str);
-            PyErr_SetString(PyExc_OverflowError,
-                            "too much marshal data for a bytes object");
             return NULL;
         }
-        if (_PyBytes_Resize(&wf.str, (Py_ssize_t)(wf.ptr - base)) < 0)
-            return NULL;
     }
-    if (wf.error != WFERR_OK) {
-        Py_XDECREF(wf.str);
-        if (wf.error == WFERR_NOMEMORY)
-            PyErr_NoMemory();
-        else
-            PyErr_SetString(PyExc_ValueError,
-              (wf.error==WFERR_UNMARSHALLABLE)?"unmarshallable object"
-               :"object too deeply nested to marshal");
-        return NULL;
+    w_object(x, &wf);
+    w_clear_refs(&wf);
+    res = w_finish_string(&wf);
+    if (res != NULL && wf.string_list != NULL &&
+        PyList_GET_SIZE(wf.string_list) > 0) {
+        Py_SETREF(res, w_string_table(wf.string_list, res, version));
     }
-    return wf.str;
+    if (wf.strings != NULL)
+        _Py_hashtable_destroy(wf.strings);
+    Py_XDECREF(wf.string_list);
+    return res;
 }
 
 /* And an interface for Python programs... */
@@ -1734,6 +2426,9 @@ marshal_load(PyObject *module, PyObject *file)
         rf.depth = 0;
         rf.fp = NULL;
         rf.readable = file;
+        rf.source = NULL;
+        rf.lazy_depth = 0;
+        rf.strings = NULL;
         rf.ptr = rf.end = NULL;
         rf.buf = NULL;
         if ((rf.refs = PyList_New(0)) != NULL) {
@@ -1792,13 +2487,32 @@ marshal_loads_impl(PyObject *module, Py_buffer *bytes)
     PyObject* result;
     rf.fp = NULL;
     rf.readable = NULL;
+    rf.source = NULL;
+    rf.lazy_depth = 0;
+    rf.strings = NULL;
     rf.ptr = s;
     rf.end = s + n;
     rf.depth = 0;
-    if ((rf.refs = PyList_New(0)) == NULL)
+    /* Nested code objects can only be read later if the data cannot
+       change in the meantime */
+    if (bytes->readonly && bytes->obj != NULL) {
+        rf.source = PyMemoryView_FromObject(bytes->obj);
+        if (rf.source == NULL)
+            return NULL;
+        if (PyMemoryView_GET_BUFFER(rf.source)->buf != s ||
+            PyMemoryView_GET_BUFFER(rf.source)->len != n ||
+            !PyBuffer_IsContiguous(PyMemoryView_GET_BUFFER(rf.source), 'C'))
+        {
+            Py_CLEAR(rf.source);
+        }
+    }
+    if ((rf.refs = PyList_New(0)) == NULL) {
+        Py_XDECREF(rf.source);
         return NULL;
+    }
     result = read_object(&rf);
     Py_DECREF(rf.refs);
+    Py_XDECREF(rf.source);
     return result;
 }
 
@@ -1832,6 +2546,9 @@ version -- indicates the format that the module uses. Version 0 is the\n\
     historical format, version 1 shares interned strings and version 2\n\
     uses a binary format for floating point numbers.\n\
     Version 3 shares common object references (New in version 3.4).\n\
+    Version 5 stores the code objects nested in another code object as\n\
+    separate records, which loads() reads on first use.\n\
+    Version 6 writes each string once, in a table at the start.\n\
 \n\
 Functions:\n\
 \n\
@@ -1857,7 +2574,10 @@ static struct PyModuleDef marshalmodule = {
 PyMODINIT_FUNC
 PyMarshal_Init(void)
 {
-    PyObject *mod = PyModule_Create(&marshalmodule);
+    PyObject *mod;
+    if (PyType_Ready(&_PyLazyCode_Type) < 0)
+        return NULL;
+    mod = PyModule_Create(&marshalmodule);
     if (mod == NULL)
         return NULL;
     if (PyModule_AddIntConstant(mod, "version", Py_MARSHAL_VERSION) < 0) {
@@ -0,0 +1,235 @@
+"""Benchmark the compiler on the standard library.
+
+Compiles every module of the Lib/ tree from source, serially and on one
+thread per CPU, and reports the time taken and the size of the generated
+bytecode.  The throughput of the tokenizer and parser alone is measured on
+the same modules and on large generated ones.  Finally it times a few pure
+Python stdlib workloads to measure the effect of the generated code at
+runtime.
+
+Run it with two interpreters, writing the results of the first one with -w
+and comparing the second against them with -r.
+
+"""
+import json
+import os
+import sys
+import time
+import timeit
+
+
+def lib_sources(libdir):
+    """Return the (path, source bytes) of the modules in libdir."""
+    sources = []
+    for dirpath, dirnames, filenames in os.walk(libdir):
+        dirnames.sort()
+        for fn in sorted(filenames):
+            if not fn.endswith('.py'):
+                continue
+            path = os.path.join(dirpath, fn)
+            with open(path, 'rb') as f:
+                source = f.read()
+            try:
+                compile(source, path, 'exec')
+            except (SyntaxError, ValueError):
+                # bad encodings and test files with deliberate errors
+                continue
+            sources.append((path, source))
+    return sources
+
+
+def code_objects(code):
+    yield code
+    for const in code.co_consts:
+        if isinstance(const, type(code)):
+            yield from code_objects(const)
+
+
+def compile_time(sources, repeat, optimize):
+    """compile time (s)"""
+    best = None
+    for _ in range(repeat):
+        t0 = time.perf_counter()
+        for path, source in sources:
+            compile(source, path, 'exec', optimize=optimize)
+        t = time.perf_counter() - t0
+        best = t if best is None else min(best, t)
+    return best
+
+
+def threaded_compile_time(sources, repeat, optimize):
+    """threaded compile time (s)"""
+    from concurrent.futures import ThreadPoolExecutor
+    def compile_source(path_and_source):
+        path, source = path_and_source
+        return compile(source, path, 'exec', optimize=optimize)
+    best = None
+    with ThreadPoolExecutor(max_workers=os.cpu_count() or 1) as executor:
+        for _ in range(repeat):
+            t0 = time.perf_counter()
+            for code in executor.map(compile_source, sources):
+                pass
+            t = time.perf_counter() - t0
+            best = t if best is None else min(best, t)
+    return best
+
+
+def _parse_throughput(sources, repeat):
+    import parser
+    from importlib.util import decode_source
+    texts = [decode_source(source) for path, source in sources]
+    size = sum(len(source) for path, source in sources)
+    best = None
+    for _ in range(repeat):
+        t0 = time.perf_counter()
+        for text in texts:
+            parser.suite(text)
+        t = time.perf_counter() - t0
+        best = t if best is None else min(best, t)
+    return size / best / 1e6
+
+
+def parse_throughput(sources, repeat, optimize):
+    """parse throughput (MB/s)"""
+    return _parse_throughput(sources, repeat)
+
+
+def generated_sources():
+    """Return large generated modules: a constant table and a module
+    shaped like protobuf output."""
+    table = ['TABLE = {\n']
+    for i in range(20000):
+        table.append('    %d: (%r, 0x%08x, %d.%d, b"\\x%02x"),\n'
+                     % (i, 'name_%d' % i, i * 7919, i, i % 97, i % 256))
+    table.append('}\n')
+    proto = []
+    for i in range(2000):
+        proto.append(
+            '_MESSAGE_%d = _descriptor.Descriptor(\n'
+            '  name=\'Message%d\', full_name=\'pkg.Message%d\',\n'
+            '  filename=None, containing_type=None,\n'
+            '  fields=[\n'
+            '    _descriptor.FieldDescriptor(name=\'field_id\', index=0,\n'
+            '      number=1, type=5, cpp_type=1, label=1,\n'
+            '      has_default_value=False, default_value=0),\n'
+            '    _descriptor.FieldDescriptor(name=\'field_name\', index=1,\n'
+            '      number=2, type=9, cpp_type=9, label=1,\n'
+            '      has_default_value=False, default_value=_b("").decode(\'utf-8\')),\n'
+            '  ],\n'
+            '  serialized_start=%d, serialized_end=%d,\n'
+            ')\n' % (i, i, i, i * 120, i * 120 + 118))
+    return [('<table>', ''.join(table).encode()),
+            ('<protobuf>', ''.join(proto).encode())]
+
+
+def generated_parse_throughput(sources, repeat, optimize):
+    """generated parse throughput (MB/s)"""
+    return _parse_throughput(generated_sources(), repeat)
+
+
+def bytecode_size(sources, repeat, optimize):
+    """bytecode size (bytes)"""
+    total = 0
+    for path, source in sources:
+        code = compile(source, path, 'exec', optimize=optimize)
+        total += sum(len(c.co_code) for c in code_objects(code))
+    return total
+
+
+RUNTIME_SETUP = """\
+import json.encoder, textwrap, string, ipaddress, fractions, colorsys
+text = open({path!r}, encoding='utf-8').read()[:20000]
+data = [dict(a=i, b=str(i), c=[i, i * 2.5, None, True]) for i in range(200)]
+encoder = json.encoder.JSONEncoder(indent=1)  # pure Python path
+template = string.Template('$a and $b!')
+"""
+
+RUNTIME_STMT = """\
+textwrap.wrap(text, 60)
+encoder.encode(data)
+for i in range(200):
+    template.substitute(a=i, b='x')
+    ipaddress.ip_address('10.0.%d.%d' % (i, i))
+    fractions.Fraction(i, 7) + fractions.Fraction(1, 3)
+    colorsys.rgb_to_hsv(i / 200, 0.5, 0.25)
+"""
+
+
+def runtime(sources, repeat, optimize):
+    """stdlib runtime (s)"""
+    timer = timeit.Timer(RUNTIME_STMT,
+                         RUNTIME_SETUP.format(path=textwrap_path()))
+    return min(timer.repeat(repeat, 5)) / 5
+
+
+def textwrap_path():
+    import textwrap
+    return textwrap.__file__
+
+
+BENCHMARKS = (compile_time, threaded_compile_time, parse_throughput,
+              generated_parse_throughput, bytecode_size, runtime)
+
+
+def fmt(result):
+    return format(result, ',d' if isinstance(result, int) else ',.4f')
+
+
+def main(options):
+    if options.source_file:
+        with options.source_file:
+            prev_results = json.load(options.source_file)
+    else:
+        prev_results = {}
+    benchmarks = BENCHMARKS
+    if options.benchmark:
+        benchmarks = [b for b in BENCHMARKS if b.__doc__ == options.benchmark]
+        if not benchmarks:
+            print('Unknown benchmark: {!r}'.format(options.benchmark),
+                  file=sys.stderr)
+            sys.exit(1)
+    libdir = options.libdir or os.path.dirname(os.__file__)
+    sources = lib_sources(libdir)
+    print('{:,d} modules from {}, optimization level {}\n'.format(
+          len(sources), libdir, options.optimize))
+    new_results = {}
+    for benchmark in benchmarks:
+        result = benchmark(sources, options.repeat, options.optimize)
+        new_results[benchmark.__doc__] = result
+        print('{:<24}{:>16}'.format(benchmark.__doc__, fmt(result)))
+    if prev_results:
+        print('\nComparing new vs. old\n')
+        for benchmark in benchmarks:
+            name = benchmark.__doc__
+            if name not in prev_results:
+                continue
+            old_result = prev_results[name]
+            new_result = new_results[name]
+            print('{:<24}{} vs. {} ({:.1%})'.format(
+                  name, fmt(new_result), fmt(old_result),
+                  new_result / old_result))
+    if options.dest_file:
+        with options.dest_file:
+            json.dump(new_results, options.dest_file, indent=2)
+
+
+if __name__ == '__main__':
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-l', '--libdir', dest='libdir',
+                        help='directory to compile (default: the stdlib)')
+    parser.add_argument('-O', dest='optimize', action='count', default=0,
+                        help='optimization level passed to compile()')
+    parser.add_argument('-n', '--repeat', dest='repeat', type=int, default=3,
+                        help='number of repetitions, the best is kept')
+    parser.add_argument('-r', '--read', dest='source_file',
+                        type=argparse.FileType('r'),
+                        help='file to read benchmark data from to compare '
+                             'against')
+    parser.add_argument('-w', '--write', dest='dest_file',
+                        type=argparse.FileType('w'),
+                        help='file to write benchmark data to')
+    parser.add_argument('--benchmark', dest='benchmark',
+                        help='specific benchmark to run')
+    main(parser.parse_args())
@@ -0,0 +1,167 @@
+"""Benchmark sequential scans of a large file through open().
+
+Creates a large file of text lines, then measures iterating over its lines
+in binary and text mode and loops of read(n) calls of several sizes, the
+access patterns of log processors and file parsers.  Random reads of small
+blocks check that the buffer does not make random access slower.
+
+Unless --cold is given, the file stays in the page cache, so the results
+mostly measure the cost of the system calls and of the copies.  With
+--cold its pages are evicted with posix_fadvise(POSIX_FADV_DONTNEED)
+before each run.
+
+Run it with two interpreters, writing the results of the first one with -w
+and comparing the second against them with -r.
+
+"""
+import json
+import os
+import random
+import tempfile
+import time
+
+
+def make_file(directory, size):
+    """Create a file of about size MiB of text lines."""
+    fd, name = tempfile.mkstemp(dir=directory)
+    rnd = random.Random(0)
+    words = ['alpha', 'beta', 'gamma', 'delta', 'epsilon', 'zeta', 'eta',
+             'theta', 'iota', 'kappa', 'lambda', 'mu']
+    lines = [' '.join(rnd.choice(words) for _ in range(rnd.randint(2, 20)))
+             for _ in range(10000)]
+    block = ('\n'.join(lines) + '\n').encode('ascii')
+    with open(fd, 'wb') as f:
+        for _ in range(size * 1024 * 1024 // len(block) + 1):
+            f.write(block)
+    return name
+
+
+def evict(name):
+    fd = os.open(name, os.O_RDONLY)
+    try:
+        os.posix_fadvise(fd, 0, 0, os.POSIX_FADV_DONTNEED)
+    finally:
+        os.close(fd)
+
+
+def _best(func, name, options):
+    best = None
+    for _ in range(options.repeat):
+        if options.cold:
+            evict(name)
+        t0 = time.perf_counter()
+        func()
+        t = time.perf_counter() - t0
+        best = t if best is None else min(best, t)
+    return best
+
+
+def binary_lines(name, options):
+    def run():
+        with open(name, 'rb') as f:
+            for line in f:
+                pass
+    return _best(run, name, options)
+
+
+def text_lines(name, options):
+    def run():
+        with open(name, 'r', encoding='ascii') as f:
+            for line in f:
+                pass
+    return _best(run, name, options)
+
+
+def read_loop(size):
+    def bench(name, options):
+        def run():
+            with open(name, 'rb') as f:
+                read = f.read
+                while read(size):
+                    pass
+        return _best(run, name, options)
+    return bench
+
+
+def random_reads(name, options):
+    rnd = random.Random(0)
+    filesize = os.path.getsize(name)
+    offsets = [rnd.randrange(filesize) for _ in range(20000)]
+    def run():
+        with open(name, 'rb') as f:
+            for offset in offsets:
+                f.seek(offset)
+                f.read(100)
+    return _best(run, name, options)
+
+
+BENCHMARKS = {
+    'binary lines': binary_lines,
+    'text lines': text_lines,
+    'read(100)': read_loop(100),
+    'read(4096)': read_loop(4096),
+    'read(100000)': read_loop(100000),
+    'random read(100)': random_reads,
+}
+
+
+def fmt(result):
+    return '{:.4f}'.format(result)
+
+
+def main(options):
+    names = list(BENCHMARKS)
+    if options.benchmark:
+        names = [options.benchmark]
+    prev_results = {}
+    if options.source_file:
+        with options.source_file:
+            prev_results = json.load(options.source_file)
+    name = make_file(options.directory, options.size)
+    try:
+        print('{} MiB file\n'.format(os.path.getsize(name) // (1024 * 1024)))
+        new_results = {}
+        for bench in names:
+            result = BENCHMARKS[bench](name, options)
+            new_results[bench] = result
+            print('{:<24}{:>16}'.format(bench, fmt(result)))
+    finally:
+        os.unlink(name)
+    if prev_results:
+        print('\nComparing new vs. old\n')
+        for bench, new_result in new_results.items():
+            if bench not in prev_results:
+                continue
+            old_result = prev_results[bench]
+            print('{:<24}{} vs. {} ({:.1%})'.format(
+                  bench, fmt(new_result), fmt(old_result),
+                  new_result / old_result))
+    if options.dest_file:
+        with options.dest_file:
+            json.dump(new_results, options.dest_file, indent=2)
+
+
+if __name__ == '__main__':
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-d', '--directory', dest='directory',
+                        help='directory to create the file in')
+    parser.add_argument('-s', '--size', dest='size', type=int, default=2048,
+                        help='size of the file in MiB')
+    parser.add_argument('--cold', dest='cold', action='store_true',
+                        help='evict the file from the page cache before '
+                             'each run')
+    parser.add_argument('-n', '--repeat', dest='repeat', type=int, default=3,
+                        help='number of repetitions, the best is kept')
+    parser.add_argument('-r', '--read', dest='source_file',
+                        type=argparse.FileType('r'),
+                        help='file to read benchmark data from to compare '
+                             'against')
+    parser.add_argument('-w', '--write', dest='dest_file',
+                        type=argparse.FileType('w'),
+                        help='file to write benchmark data to')
+    parser.add_argument('--benchmark', dest='benchmark',
+                        choices=list(BENCHMARKS),
+                        help='specific benchmark to run')
+    main(parser.parse_args())
@@ -0,0 +1,179 @@
+"""Benchmark dispatching I/O callbacks with the asyncio event loops.
+
+Keeps a byte bouncing between the two ends of many socket pairs, so that
+every iteration of the event loop has one ready file descriptor per pair:
+
+- with reader callbacks registered by add_reader();
+- with protocols connected to socket transports.
+
+Each benchmark runs on SelectorEventLoop with an EpollSelector and on
+EpollEventLoop, whose epoll core schedules the ready handles from C.  The
+results are in events per second.
+
+Run it with two interpreters, writing the results of the first one with -w
+and comparing the second against them with -r.  Loops missing from an
+interpreter are skipped.
+
+"""
+import asyncio
+import json
+import selectors
+import socket
+import time
+
+
+class Counter:
+    count = 0
+
+
+def socket_pairs(options):
+    pairs = []
+    for _ in range(options.pairs):
+        a, b = socket.socketpair()
+        a.setblocking(False)
+        b.setblocking(False)
+        pairs.append((a, b))
+    return pairs
+
+
+def _run(loop, counter, options):
+    """Run the loop for the duration, return the events per second."""
+    loop.run_until_complete(asyncio.sleep(0.1, loop=loop))
+    start = counter.count
+    t0 = time.perf_counter()
+    loop.run_until_complete(asyncio.sleep(options.duration, loop=loop))
+    t = time.perf_counter() - t0
+    return (counter.count - start) / t
+
+
+def callbacks(loop, options):
+    counter = Counter()
+    pairs = socket_pairs(options)
+
+    def bounce(sock, peer):
+        sock.recv(1)
+        peer.send(b'x')
+        counter.count += 1
+
+    try:
+        for a, b in pairs:
+            loop.add_reader(a.fileno(), bounce, a, b)
+            loop.add_reader(b.fileno(), bounce, b, a)
+        for a, b in pairs:
+            a.send(b'x')
+        return _run(loop, counter, options)
+    finally:
+        for a, b in pairs:
+            loop.remove_reader(a.fileno())
+            loop.remove_reader(b.fileno())
+            a.close()
+            b.close()
+
+
+class Bouncer(asyncio.Protocol):
+
+    def __init__(self, counter):
+        self.counter = counter
+
+    def connection_made(self, transport):
+        self.transport = transport
+
+    def data_received(self, data):
+        self.transport.write(data)
+        self.counter.count += 1
+
+
+def protocols(loop, options):
+    counter = Counter()
+    transports = []
+    try:
+        for a, b in socket_pairs(options):
+            for sock in a, b:
+                transport, _ = loop.run_until_complete(
+                    loop.create_connection(lambda: Bouncer(counter),
+                                           sock=sock))
+                transports.append(transport)
+        for transport in transports[::2]:
+            transport.write(b'x')
+        return _run(loop, counter, options)
+    finally:
+        for transport in transports:
+            transport.close()
+        loop.run_until_complete(asyncio.sleep(0, loop=loop))
+
+
+LOOPS = {
+    'selector': lambda: asyncio.SelectorEventLoop(selectors.EpollSelector()),
+    'epoll': getattr(asyncio, 'EpollEventLoop', None),
+}
+
+BENCHMARKS = {
+    'callbacks': callbacks,
+    'protocols': protocols,
+}
+
+
+def fmt(result):
+    return '{:,.0f}/s'.format(result)
+
+
+def main(options):
+    names = list(BENCHMARKS)
+    if options.benchmark:
+        names = [options.benchmark]
+    prev_results = {}
+    if options.source_file:
+        with options.source_file:
+            prev_results = json.load(options.source_file)
+    print('{} socket pairs\n'.format(options.pairs))
+    new_results = {}
+    for bench in names:
+        for loop_name, loop_factory in LOOPS.items():
+            if loop_factory is None:
+                continue
+            name = '{} {}'.format(bench, loop_name)
+            results = []
+            for _ in range(options.repeat):
+                loop = loop_factory()
+                try:
+                    results.append(BENCHMARKS[bench](loop, options))
+                finally:
+                    loop.close()
+            new_results[name] = max(results)
+            print('{:<24}{:>16}'.format(name, fmt(new_results[name])))
+    if prev_results:
+        print('\nComparing new vs. old\n')
+        for bench, new_result in new_results.items():
+            if bench not in prev_results:
+                continue
+            old_result = prev_results[bench]
+            print('{:<24}{} vs. {} ({:.1%})'.format(
+                  bench, fmt(new_result), fmt(old_result),
+                  new_result / old_result))
+    if options.dest_file:
+        with options.dest_file:
+            json.dump(new_results, options.dest_file, indent=2)
+
+
+if __name__ == '__main__':
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-p', '--pairs', dest='pairs', type=int, default=500,
+                        help='number of socket pairs, each using two file '
+                             'descriptors')
+    parser.add_argument('-t', '--duration', dest='duration', type=float,
+                        default=1.0, help='duration of each run in seconds')
+    parser.add_argument('-n', '--repeat', dest='repeat', type=int, default=3,
+                        help='number of repetitions, the best is kept')
+    parser.add_argument('-r', '--read', dest='source_file',
+                        type=argparse.FileType('r'),
+                        help='file to read benchmark data from to compare '
+                             'against')
+    parser.add_argument('-w', '--write', dest='dest_file',
+                        type=argparse.FileType('w'),
+                        help='file to write benchmark data to')
+    parser.add_argument('--benchmark', dest='benchmark',
+                        choices=list(BENCHMARKS),
+                        help='specific benchmark to run')
+    main(parser.parse_args())
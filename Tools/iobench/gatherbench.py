@@ -0,0 +1,140 @@
+"""Benchmark fanning out coroutines with asyncio.gather().
+
+Each round gathers width coroutines, of which only one in every miss
+suspends on a future resolved by the event loop, the way lookups hitting
+a cache mostly return right away:
+
+- with the default task factory, which schedules the first step of every
+  task on the event loop;
+- with eager_task_factory, which runs the first step when the task is
+  created, so that the coroutines hitting the cache never go through the
+  event loop.
+
+Each benchmark runs with the Task implemented in C by _asyncio and with
+its pure Python fallback.  The results are in coroutines per second.
+
+Run it with two interpreters, writing the results of the first one with -w
+and comparing the second against them with -r.  Task factories missing
+from an interpreter are skipped.
+
+"""
+import asyncio
+import json
+import time
+from asyncio import tasks
+
+
+async def lookup(loop, i, miss):
+    if i % miss == 0:
+        fut = loop.create_future()
+        loop.call_soon(fut.set_result, i)
+        return await fut
+    return i
+
+
+async def fan_out(loop, options):
+    width = options.width
+    miss = options.miss
+    count = 0
+    deadline = time.perf_counter() + options.duration
+    while time.perf_counter() < deadline:
+        await asyncio.gather(*[lookup(loop, i, miss) for i in range(width)],
+                             loop=loop)
+        count += width
+    return count
+
+
+def run(task_class, eager):
+    def bench(options):
+        loop = asyncio.new_event_loop()
+        try:
+            if eager:
+                loop.set_task_factory(
+                    tasks.create_eager_task_factory(task_class))
+            else:
+                loop.set_task_factory(
+                    lambda loop, coro: task_class(coro, loop=loop))
+            t0 = time.perf_counter()
+            count = loop.run_until_complete(fan_out(loop, options))
+            t = time.perf_counter() - t0
+        finally:
+            loop.close()
+        return count / t
+    return bench
+
+
+TASKS = {
+    'c': getattr(tasks, '_CTask', None),
+    'python': tasks._PyTask,
+}
+
+BENCHMARKS = {
+    'gather': False,
+    'gather eager': True,
+}
+
+
+def fmt(result):
+    return '{:,.0f}/s'.format(result)
+
+
+def main(options):
+    names = list(BENCHMARKS)
+    if options.benchmark:
+        names = [options.benchmark]
+    prev_results = {}
+    if options.source_file:
+        with options.source_file:
+            prev_results = json.load(options.source_file)
+    print('{} coroutines per gather, 1 in {} suspending\n'.format(
+          options.width, options.miss))
+    new_results = {}
+    for bench in names:
+        eager = BENCHMARKS[bench]
+        if eager and not hasattr(tasks, 'create_eager_task_factory'):
+            continue
+        for task_name, task_class in TASKS.items():
+            if task_class is None:
+                continue
+            name = '{} {}'.format(bench, task_name)
+            func = run(task_class, eager)
+            result = max(func(options) for _ in range(options.repeat))
+            new_results[name] = result
+            print('{:<24}{:>16}'.format(name, fmt(result)))
+    if prev_results:
+        print('\nComparing new vs. old\n')
+        for bench, new_result in new_results.items():
+            if bench not in prev_results:
+                continue
+            old_result = prev_results[bench]
+            print('{:<24}{} vs. {} ({:.1%})'.format(
+                  bench, fmt(new_result), fmt(old_result),
+                  new_result / old_result))
+    if options.dest_file:
+        with options.dest_file:
+            json.dump(new_results, options.dest_file, indent=2)
+
+
+if __name__ == '__main__':
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-W', '--width', dest='width', type=int, default=100,
+                        help='number of coroutines gathered at once')
+    parser.add_argument('-m', '--miss', dest='miss', type=int, default=10,
+                        help='one coroutine in every miss suspends')
+    parser.add_argument('-t', '--duration', dest='duration', type=float,
+                        default=1.0, help='duration of each run in seconds')
+    parser.add_argument('-n', '--repeat', dest='repeat', type=int, default=3,
+                        help='number of repetitions, the best is kept')
+    parser.add_argument('-r', '--read', dest='source_file',
+                        type=argparse.FileType('r'),
+                        help='file to read benchmark data from to compare '
+                             'against')
+    parser.add_argument('-w', '--write', dest='dest_file',
+                        type=argparse.FileType('w'),
+                        help='file to write benchmark data to')
+    parser.add_argument('--benchmark', dest='benchmark',
+                        choices=list(BENCHMARKS),
+                        help='specific benchmark to run')
+    main(parser.parse_args())
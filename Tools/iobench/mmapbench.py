@@ -0,0 +1,188 @@
+"""Benchmark reading a memory-mapped file through file-like objects.
+
+Maps a large file of text lines and measures iterating over its lines and
+reading it in blocks of 64 KiB with:
+
+- BytesIO, which copies the whole mapping first;
+- the read methods of mmap itself;
+- MemoryReader, returning bytes, or memoryview slices with views=True;
+- MemoryReader.readinto(), reusing a single buffer.
+
+The mapping is advised with MADV_SEQUENTIAL when available.  The file
+stays in the page cache, so the results mostly measure the copies.
+
+Run it with two interpreters, writing the results of the first one with -w
+and comparing the second against them with -r.
+
+"""
+import io
+import json
+import mmap
+import os
+import tempfile
+import time
+
+
+BLOCK_SIZE = 64 * 1024
+
+
+def make_file(directory, size):
+    """Create a file of about size MiB of text lines."""
+    fd, name = tempfile.mkstemp(dir=directory)
+    block = b''.join(b'%08d some record with a few fields, %d\n' % (i, i * 7)
+                     for i in range(20000))
+    with open(fd, 'wb') as f:
+        for _ in range(size * 1024 * 1024 // len(block) + 1):
+            f.write(block)
+    return name
+
+
+def _best(func, repeat):
+    best = None
+    for _ in range(repeat):
+        t0 = time.perf_counter()
+        func()
+        t = time.perf_counter() - t0
+        best = t if best is None else min(best, t)
+    return best
+
+
+def bytesio_lines(m, options):
+    def run():
+        for line in io.BytesIO(m):
+            pass
+    return _best(run, options.repeat)
+
+
+def mmap_lines(m, options):
+    def run():
+        m.seek(0)
+        readline = m.readline
+        while readline():
+            pass
+    return _best(run, options.repeat)
+
+
+def reader_lines(views):
+    def bench(m, options):
+        def run():
+            with io.MemoryReader(m, views=views) as f:
+                for line in f:
+                    pass
+        return _best(run, options.repeat)
+    return bench
+
+
+def bytesio_blocks(m, options):
+    def run():
+        read = io.BytesIO(m).read
+        while read(BLOCK_SIZE):
+            pass
+    return _best(run, options.repeat)
+
+
+def mmap_blocks(m, options):
+    def run():
+        m.seek(0)
+        read = m.read
+        while read(BLOCK_SIZE):
+            pass
+    return _best(run, options.repeat)
+
+
+def reader_blocks(views):
+    def bench(m, options):
+        def run():
+            with io.MemoryReader(m, views=views) as f:
+                read = f.read
+                while read(BLOCK_SIZE):
+                    pass
+        return _best(run, options.repeat)
+    return bench
+
+
+def reader_readinto(m, options):
+    buf = bytearray(BLOCK_SIZE)
+    def run():
+        with io.MemoryReader(m) as f:
+            readinto = f.readinto
+            while readinto(buf):
+                pass
+    return _best(run, options.repeat)
+
+
+BENCHMARKS = {
+    'lines BytesIO': bytesio_lines,
+    'lines mmap': mmap_lines,
+    'lines MemoryReader': reader_lines(False),
+    'lines views': reader_lines(True),
+    'blocks BytesIO': bytesio_blocks,
+    'blocks mmap': mmap_blocks,
+    'blocks MemoryReader': reader_blocks(False),
+    'blocks views': reader_blocks(True),
+    'blocks readinto': reader_readinto,
+}
+
+
+def fmt(result):
+    return '{:.4f}'.format(result)
+
+
+def main(options):
+    names = list(BENCHMARKS)
+    if options.benchmark:
+        names = [options.benchmark]
+    prev_results = {}
+    if options.source_file:
+        with options.source_file:
+            prev_results = json.load(options.source_file)
+    name = make_file(options.directory, options.size)
+    try:
+        with open(name, 'rb') as f:
+            m = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        if hasattr(m, 'madvise'):
+            m.madvise(mmap.MADV_SEQUENTIAL)
+        print('{} MiB file\n'.format(len(m) // (1024 * 1024)))
+        new_results = {}
+        for bench in names:
+            result = BENCHMARKS[bench](m, options)
+            new_results[bench] = result
+            print('{:<24}{:>16}'.format(bench, fmt(result)))
+        m.close()
+    finally:
+        os.unlink(name)
+    if prev_results:
+        print('\nComparing new vs. old\n')
+        for bench, new_result in new_results.items():
+            if bench not in prev_results:
+                continue
+            old_result = prev_results[bench]
+            print('{:<24}{} vs. {} ({:.1%})'.format(
+                  bench, fmt(new_result), fmt(old_result),
+                  new_result / old_result))
+    if options.dest_file:
+        with options.dest_file:
+            json.dump(new_results, options.dest_file, indent=2)
+
+
+if __name__ == '__main__':
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-d', '--directory', dest='directory',
+                        help='directory to create the file in')
+    parser.add_argument('-s', '--size', dest='size', type=int, default=512,
+                        help='size of the file in MiB')
+    parser.add_argument('-n', '--repeat', dest='repeat', type=int, default=3,
+                        help='number of repetitions, the best is kept')
+    parser.add_argument('-r', '--read', dest='source_file',
+                        type=argparse.FileType('r'),
+                        help='file to read benchmark data from to compare '
+                             'against')
+    parser.add_argument('-w', '--write', dest='dest_file',
+                        type=argparse.FileType('w'),
+                        help='file to write benchmark data to')
+    parser.add_argument('--benchmark', dest='benchmark',
+                        choices=list(BENCHMARKS),
+                        help='specific benchmark to run')
+    main(parser.parse_args())
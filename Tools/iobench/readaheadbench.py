@@ -0,0 +1,214 @@
+"""Benchmark read-ahead and batched reads of regular files.
+
+Creates a large file and a directory of small files in a temporary
+directory, then measures:
+
+- a sequential read of the large file with FileIO.read(), without and
+  with read-ahead (the readahead argument of FileIO);
+- random reads of 4 KiB blocks of the large file, with a loop of
+  os.pread() calls and with a single io.read_batch() call;
+- reading every small file, with a loop opening and reading each file
+  and with a single io.read_batch() call.
+
+Unless --cached is given, the pages of the files are evicted from the
+page cache with posix_fadvise(POSIX_FADV_DONTNEED) before each run, so
+that the reads actually reach the storage.
+
+Run it with two interpreters, writing the results of the first one with -w
+and comparing the second against them with -r.
+
+"""
+import io
+import json
+import os
+import random
+import shutil
+import tempfile
+import time
+
+
+BLOCK_SIZE = 4096
+READ_SIZE = 64 * 1024
+
+
+def make_files(directory, size, nfiles, small_size):
+    big = os.path.join(directory, 'big.bin')
+    with open(big, 'wb') as f:
+        chunk = os.urandom(1024 * 1024)
+        for _ in range(size):
+            f.write(chunk)
+    small = []
+    for i in range(nfiles):
+        name = os.path.join(directory, 'small%05d.bin' % i)
+        with open(name, 'wb') as f:
+            f.write(os.urandom(small_size))
+        small.append(name)
+    return big, small
+
+
+def evict(paths):
+    if not hasattr(os, 'posix_fadvise'):
+        return
+    for path in paths:
+        fd = os.open(path, os.O_RDONLY)
+        try:
+            os.fdatasync(fd)
+            os.posix_fadvise(fd, 0, 0, os.POSIX_FADV_DONTNEED)
+        finally:
+            os.close(fd)
+
+
+def _best(func, repeat, paths, cached):
+    best = None
+    for _ in range(repeat):
+        if not cached:
+            evict(paths)
+        t0 = time.perf_counter()
+        func()
+        t = time.perf_counter() - t0
+        best = t if best is None else min(best, t)
+    return best
+
+
+def sequential_plain(big, small, options):
+    def run():
+        with io.FileIO(big) as f:
+            while f.read(READ_SIZE):
+                pass
+    return _best(run, options.repeat, [big], options.cached)
+
+
+def sequential_readahead(big, small, options):
+    def run():
+        with io.FileIO(big, readahead=options.depth) as f:
+            while f.read(READ_SIZE):
+                pass
+    return _best(run, options.repeat, [big], options.cached)
+
+
+def random_offsets(big, options):
+    rnd = random.Random(0)
+    nblocks = os.path.getsize(big) // BLOCK_SIZE
+    return [rnd.randrange(nblocks) * BLOCK_SIZE
+            for _ in range(options.blocks)]
+
+
+def random_pread(big, small, options):
+    offsets = random_offsets(big, options)
+    def run():
+        fd = os.open(big, os.O_RDONLY)
+        try:
+            for offset in offsets:
+                os.pread(fd, BLOCK_SIZE, offset)
+        finally:
+            os.close(fd)
+    return _best(run, options.repeat, [big], options.cached)
+
+
+def random_batch(big, small, options):
+    offsets = random_offsets(big, options)
+    def run():
+        fd = os.open(big, os.O_RDONLY)
+        try:
+            io.read_batch([(fd, offset, BLOCK_SIZE) for offset in offsets])
+        finally:
+            os.close(fd)
+    return _best(run, options.repeat, [big], options.cached)
+
+
+def small_loop(big, small, options):
+    def run():
+        for name in small:
+            with open(name, 'rb') as f:
+                f.read()
+    return _best(run, options.repeat, small, options.cached)
+
+
+def small_batch(big, small, options):
+    def run():
+        io.read_batch([(name, 0, -1) for name in small])
+    return _best(run, options.repeat, small, options.cached)
+
+
+BENCHMARKS = {
+    'sequential plain': sequential_plain,
+    'sequential readahead': sequential_readahead,
+    'random pread': random_pread,
+    'random read_batch': random_batch,
+    'small files loop': small_loop,
+    'small files read_batch': small_batch,
+}
+
+
+def fmt(result):
+    return '{:.4f}'.format(result)
+
+
+def main(options):
+    names = list(BENCHMARKS)
+    if options.benchmark:
+        names = [options.benchmark]
+    prev_results = {}
+    if options.source_file:
+        with options.source_file:
+            prev_results = json.load(options.source_file)
+    directory = tempfile.mkdtemp(dir=options.directory)
+    try:
+        big, small = make_files(directory, options.size, options.files,
+                                options.small_size)
+        with io.FileIO(big, readahead=options.depth) as f:
+            backend = f._readahead
+        print('{} MiB file, {} files of {} bytes, read-ahead with {}\n'.format(
+              options.size, options.files, options.small_size, backend))
+        new_results = {}
+        for name in names:
+            result = BENCHMARKS[name](big, small, options)
+            new_results[name] = result
+            print('{:<24}{:>16}'.format(name, fmt(result)))
+    finally:
+        shutil.rmtree(directory)
+    if prev_results:
+        print('\nComparing new vs. old\n')
+        for name, new_result in new_results.items():
+            if name not in prev_results:
+                continue
+            old_result = prev_results[name]
+            print('{:<24}{} vs. {} ({:.1%})'.format(
+                  name, fmt(new_result), fmt(old_result),
+                  new_result / old_result))
+    if options.dest_file:
+        with options.dest_file:
+            json.dump(new_results, options.dest_file, indent=2)
+
+
+if __name__ == '__main__':
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-d', '--directory', dest='directory',
+                        help='directory to create the files in')
+    parser.add_argument('-s', '--size', dest='size', type=int, default=256,
+                        help='size of the large file in MiB')
+    parser.add_argument('-f', '--files', dest='files', type=int,
+                        default=2000, help='number of small files')
+    parser.add_argument('--small-size', dest='small_size', type=int,
+                        default=8192, help='size of the small files')
+    parser.add_argument('-b', '--blocks', dest='blocks', type=int,
+                        default=5000, help='number of random blocks read')
+    parser.add_argument('--depth', dest='depth', type=int, default=16,
+                        help='number of chunks read ahead')
+    parser.add_argument('--cached', dest='cached', action='store_true',
+                        help='leave the files in the page cache')
+    parser.add_argument('-n', '--repeat', dest='repeat', type=int, default=3,
+                        help='number of repetitions, the best is kept')
+    parser.add_argument('-r', '--read', dest='source_file',
+                        type=argparse.FileType('r'),
+                        help='file to read benchmark data from to compare '
+                             'against')
+    parser.add_argument('-w', '--write', dest='dest_file',
+                        type=argparse.FileType('w'),
+                        help='file to write benchmark data to')
+    parser.add_argument('--benchmark', dest='benchmark',
+                        choices=list(BENCHMARKS),
+                        help='specific benchmark to run')
+    main(parser.parse_args())
@@ -0,0 +1,187 @@
+"""Benchmark proxying data between TCP connections on the loopback interface.
+
+Forwards size MiB from one connection to another, the way a proxy does:
+
+- with recv_into() and sendall() through a buffer of 64 KiB;
+- with splice(), which moves the data through a pipe in the kernel.
+
+Sending a file to a connection is also measured, with socket.sendfile()
+and with the send() fallback it uses when os.sendfile() is unavailable.
+
+The data is produced and consumed by threads of the same process, so the
+results give the throughput in MiB per second along with the CPU time
+used by the forwarding thread.  The file stays in the page cache.
+
+Run it with two interpreters, writing the results of the first one with -w
+and comparing the second against them with -r.  Benchmarks which need
+methods missing from an interpreter are skipped.
+
+"""
+import json
+import os
+import socket
+import tempfile
+import threading
+import time
+
+
+BUFFER_SIZE = 64 * 1024
+
+
+def connection_pair(listener):
+    client = socket.create_connection(listener.getsockname())
+    server, _ = listener.accept()
+    return client, server
+
+
+def produce(sock, size):
+    chunk = memoryview(os.urandom(1024 * 1024))
+    with sock:
+        for _ in range(size):
+            sock.sendall(chunk)
+
+
+def consume(sock):
+    buf = bytearray(BUFFER_SIZE)
+    recv_into = sock.recv_into
+    with sock:
+        while recv_into(buf):
+            pass
+
+
+def _measure(forward, size):
+    """Time forward(), which moves size MiB, and return MiB/s and CPU."""
+    t0 = time.perf_counter()
+    c0 = time.thread_time()
+    forward()
+    cpu = time.thread_time() - c0
+    t = time.perf_counter() - t0
+    return size / t, cpu
+
+
+def proxy(copy):
+    def bench(options):
+        with socket.socket() as listener:
+            listener.bind(('127.0.0.1', 0))
+            listener.listen()
+            src_peer, src = connection_pair(listener)
+            dst, dst_peer = connection_pair(listener)
+        threads = [threading.Thread(target=produce,
+                                    args=(src_peer, options.size)),
+                   threading.Thread(target=consume, args=(dst_peer,))]
+        for thread in threads:
+            thread.start()
+        try:
+            with src, dst:
+                return _measure(lambda: copy(src, dst), options.size)
+        finally:
+            for thread in threads:
+                thread.join()
+    return bench
+
+
+def recv_into_copy(src, dst):
+    buf = bytearray(BUFFER_SIZE)
+    view = memoryview(buf)
+    recv_into = src.recv_into
+    sendall = dst.sendall
+    while True:
+        n = recv_into(buf)
+        if not n:
+            break
+        sendall(view[:n])
+
+
+def splice_copy(src, dst):
+    src.splice(dst)
+
+
+def send_file(method):
+    def bench(options):
+        with socket.socket() as listener:
+            listener.bind(('127.0.0.1', 0))
+            listener.listen()
+            sock, peer = connection_pair(listener)
+        thread = threading.Thread(target=consume, args=(peer,))
+        thread.start()
+        try:
+            with sock, open(options.name, 'rb') as f:
+                send = getattr(sock, method)
+                return _measure(lambda: send(f), options.size)
+        finally:
+            thread.join()
+    return bench
+
+
+BENCHMARKS = {
+    'proxy recv_into': (proxy(recv_into_copy), None),
+    'proxy splice': (proxy(splice_copy), 'splice'),
+    'file send': (send_file('_sendfile_use_send'), None),
+    'file sendfile': (send_file('sendfile'), None),
+}
+
+
+def fmt(result):
+    return '{:,.0f} MiB/s, {:.3f}s CPU'.format(*result)
+
+
+def main(options):
+    names = list(BENCHMARKS)
+    if options.benchmark:
+        names = [options.benchmark]
+    prev_results = {}
+    if options.source_file:
+        with options.source_file:
+            prev_results = json.load(options.source_file)
+    fd, options.name = tempfile.mkstemp(dir=options.directory)
+    try:
+        with open(fd, 'wb') as f:
+            chunk = os.urandom(1024 * 1024)
+            for _ in range(options.size):
+                f.write(chunk)
+        print('{} MiB forwarded\n'.format(options.size))
+        new_results = {}
+        for bench in names:
+            func, method = BENCHMARKS[bench]
+            if method is not None and not hasattr(socket.socket, method):
+                continue
+            result = max(func(options) for _ in range(options.repeat))
+            new_results[bench] = result
+            print('{:<24}{:>32}'.format(bench, fmt(result)))
+    finally:
+        os.unlink(options.name)
+    if prev_results:
+        print('\nComparing new vs. old\n')
+        for bench, new_result in new_results.items():
+            if bench not in prev_results:
+                continue
+            old_result = prev_results[bench]
+            print('{:<24}{} vs. {} ({:.1%})'.format(
+                  bench, fmt(new_result), fmt(old_result),
+                  new_result[0] / old_result[0]))
+    if options.dest_file:
+        with options.dest_file:
+            json.dump(new_results, options.dest_file, indent=2)
+
+
+if __name__ == '__main__':
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-d', '--directory', dest='directory',
+                        help='directory to create the file in')
+    parser.add_argument('-s', '--size', dest='size', type=int, default=1024,
+                        help='size of the data forwarded in MiB')
+    parser.add_argument('-n', '--repeat', dest='repeat', type=int, default=3,
+                        help='number of repetitions, the best is kept')
+    parser.add_argument('-r', '--read', dest='source_file',
+                        type=argparse.FileType('r'),
+                        help='file to read benchmark data from to compare '
+                             'against')
+    parser.add_argument('-w', '--write', dest='dest_file',
+                        type=argparse.FileType('w'),
+                        help='file to write benchmark data to')
+    parser.add_argument('--benchmark', dest='benchmark',
+                        choices=list(BENCHMARKS),
+                        help='specific benchmark to run')
+    main(parser.parse_args())
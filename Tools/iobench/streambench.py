@@ -0,0 +1,172 @@
+"""Benchmark parsing data received with asyncio streams.
+
+A thread sends size MiB of messages over a socket pair, which are parsed
+on the event loop by a StreamReader:
+
+- lines of 100 bytes read with readline();
+- HTTP-like messages, the headers read with readuntil() and a body of 4 KiB
+  with readexactly();
+- the raw data read with read() in chunks of 64 KiB.
+
+Each benchmark runs with the buffer implemented in C by _asyncio and with
+its pure Python fallback.  The results are in MiB per second.
+
+Run it with two interpreters, writing the results of the first one with -w
+and comparing the second against them with -r.  Buffers missing from an
+interpreter are skipped.
+
+"""
+import asyncio
+import json
+import socket
+import threading
+import time
+from asyncio import streams
+
+
+def produce(sock, message, size):
+    count = size * 1024 * 1024 // len(message)
+    batch = message * max(1, 64 * 1024 // len(message))
+    per_batch = len(batch) // len(message)
+    with sock:
+        for _ in range(count // per_batch):
+            sock.sendall(batch)
+        sock.sendall(message * (count % per_batch))
+    return count
+
+
+def _measure(message, consume, options):
+    """Run consume() on the data sent by produce(), return MiB/s."""
+    a, b = socket.socketpair()
+    thread = threading.Thread(target=produce, args=(b, message, options.size))
+    loop = asyncio.new_event_loop()
+    try:
+        reader, writer = loop.run_until_complete(
+            asyncio.open_connection(sock=a, loop=loop))
+        t0 = time.perf_counter()
+        thread.start()
+        loop.run_until_complete(consume(reader))
+        t = time.perf_counter() - t0
+        writer.close()
+    finally:
+        thread.join()
+        loop.close()
+    return options.size / t
+
+
+LINE = b'x' * 99 + b'\n'
+BODY = b'b' * 4096
+MESSAGE = (b'HTTP/1.1 200 OK\r\n'
+           b'Server: streambench\r\n'
+           b'Content-Type: application/octet-stream\r\n'
+           b'Content-Length: 4096\r\n'
+           b'\r\n') + BODY
+
+
+def lines(options):
+    async def consume(reader):
+        readline = reader.readline
+        while await readline():
+            pass
+    return _measure(LINE, consume, options)
+
+
+def messages(options):
+    async def consume(reader):
+        readuntil = reader.readuntil
+        readexactly = reader.readexactly
+        while not reader.at_eof():
+            try:
+                headers = await readuntil(b'\r\n\r\n')
+            except asyncio.IncompleteReadError:
+                break
+            length = int(headers[headers.index(b'Content-Length: ') + 16:
+                                 headers.index(b'\r\n\r\n')])
+            await readexactly(length)
+    return _measure(MESSAGE, consume, options)
+
+
+def chunks(options):
+    async def consume(reader):
+        read = reader.read
+        while await read(64 * 1024):
+            pass
+    return _measure(BODY, consume, options)
+
+
+BUFFERS = {
+    'c': getattr(streams, '_CStreamBuffer', None),
+    'python': getattr(streams, '_PyStreamBuffer', None),
+}
+
+BENCHMARKS = {
+    'readline': lines,
+    'readuntil + readexactly': messages,
+    'read': chunks,
+}
+
+
+def fmt(result):
+    return '{:,.0f} MiB/s'.format(result)
+
+
+def main(options):
+    names = list(BENCHMARKS)
+    if options.benchmark:
+        names = [options.benchmark]
+    prev_results = {}
+    if options.source_file:
+        with options.source_file:
+            prev_results = json.load(options.source_file)
+    print('{} MiB received\n'.format(options.size))
+    new_results = {}
+    default_buffer = getattr(streams, '_StreamBuffer', None)
+    try:
+        for bench in names:
+            for buffer_name, buffer_class in BUFFERS.items():
+                if buffer_class is None:
+                    if buffer_name != 'python' or default_buffer is not None:
+                        continue
+                else:
+                    streams._StreamBuffer = buffer_class
+                name = '{} {}'.format(bench, buffer_name)
+                result = max(BENCHMARKS[bench](options)
+                             for _ in range(options.repeat))
+                new_results[name] = result
+                print('{:<32}{:>16}'.format(name, fmt(result)))
+    finally:
+        if default_buffer is not None:
+            streams._StreamBuffer = default_buffer
+    if prev_results:
+        print('\nComparing new vs. old\n')
+        for bench, new_result in new_results.items():
+            if bench not in prev_results:
+                continue
+            old_result = prev_results[bench]
+            print('{:<32}{} vs. {} ({:.1%})'.format(
+                  bench, fmt(new_result), fmt(old_result),
+                  new_result / old_result))
+    if options.dest_file:
+        with options.dest_file:
+            json.dump(new_results, options.dest_file, indent=2)
+
+
+if __name__ == '__main__':
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-s', '--size', dest='size', type=int, default=256,
+                        help='size of the data received in MiB')
+    parser.add_argument('-n', '--repeat', dest='repeat', type=int, default=3,
+                        help='number of repetitions, the best is kept')
+    parser.add_argument('-r', '--read', dest='source_file',
+                        type=argparse.FileType('r'),
+                        help='file to read benchmark data from to compare '
+                             'against')
+    parser.add_argument('-w', '--write', dest='dest_file',
+                        type=argparse.FileType('w'),
+                        help='file to write benchmark data to')
+    parser.add_argument('--benchmark', dest='benchmark',
+                        choices=list(BENCHMARKS),
+                        help='specific benchmark to run')
+    main(parser.parse_args())
@@ -0,0 +1,195 @@
+"""Benchmark receiving and sending UDP datagrams on the loopback interface.
+
+Queues datagrams of a fixed size on a non-blocking socket, then measures
+the time taken to drain them:
+
+- one at a time with recv_into() and recvfrom_into();
+- in batches with recvmmsg_into(), with and without the addresses of the
+  senders.
+
+The sending side is also measured, with sendto() in a loop and with
+sendmmsg().  The results are in datagrams per second.
+
+Run it with two interpreters, writing the results of the first one with -w
+and comparing the second against them with -r.  Benchmarks which need
+methods missing from an interpreter are skipped.
+
+"""
+import array
+import json
+import socket
+import time
+
+
+def make_pair():
+    recv = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    recv.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 4 * 1024 * 1024)
+    recv.bind(('127.0.0.1', 0))
+    send = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    send.connect(recv.getsockname())
+    return recv, send
+
+
+def receive(loop):
+    def bench(options):
+        recv, send = make_pair()
+        with recv, send:
+            recv.setblocking(False)
+            data = b'm' * options.size
+            count = 0
+            elapsed = 0.0
+            while elapsed < options.duration:
+                for _ in range(options.fill):
+                    send.send(data)
+                t0 = time.perf_counter()
+                count += loop(recv, options)
+                elapsed += time.perf_counter() - t0
+        return count / elapsed
+    return bench
+
+
+def _received(func):
+    """Call func until no datagram is left, return the number received."""
+    count = 0
+    try:
+        while True:
+            count += func()
+    except BlockingIOError:
+        pass
+    return count
+
+
+def recv_into_loop(recv, options):
+    buf = bytearray(options.size)
+    recv_into = recv.recv_into
+    return _received(lambda: recv_into(buf) and 1)
+
+
+def recvfrom_into_loop(recv, options):
+    buf = bytearray(options.size)
+    recvfrom_into = recv.recvfrom_into
+    return _received(lambda: recvfrom_into(buf) and 1)
+
+
+def recvmmsg_loop(addresses):
+    def loop(recv, options):
+        buf = bytearray(options.size * options.batch)
+        sizes = array.array('i', [0] * options.batch)
+        addrs = None
+        if addresses:
+            addrs = bytearray(socket.SOCKADDR_SIZE * options.batch)
+        recvmmsg_into = recv.recvmmsg_into
+        size = options.size
+        return _received(lambda: recvmmsg_into(buf, size, sizes, addrs))
+    return loop
+
+
+def send(loop):
+    def bench(options):
+        recv, send = make_pair()
+        with recv, send:
+            t0 = time.perf_counter()
+            count = loop(send, options)
+            t = time.perf_counter() - t0
+        return count / t
+    return bench
+
+
+def sendto_loop(sock, options):
+    data = b'm' * options.size
+    address = sock.getpeername()
+    sendto = sock.sendto
+    count = 0
+    deadline = time.perf_counter() + options.duration
+    while time.perf_counter() < deadline:
+        for _ in range(options.batch):
+            sendto(data, address)
+        count += options.batch
+    return count
+
+
+def sendmmsg_loop(sock, options):
+    buf = b'm' * options.size * options.batch
+    sizes = array.array('i', [options.size] * options.batch)
+    sendmmsg = sock.sendmmsg
+    size = options.size
+    count = 0
+    deadline = time.perf_counter() + options.duration
+    while time.perf_counter() < deadline:
+        count += sendmmsg(buf, size, sizes)
+    return count
+
+
+BENCHMARKS = {
+    'recv_into': (receive(recv_into_loop), None),
+    'recvfrom_into': (receive(recvfrom_into_loop), None),
+    'recvmmsg_into': (receive(recvmmsg_loop(False)), 'recvmmsg_into'),
+    'recvmmsg_into addresses': (receive(recvmmsg_loop(True)),
+                                'recvmmsg_into'),
+    'sendto': (send(sendto_loop), None),
+    'sendmmsg': (send(sendmmsg_loop), 'sendmmsg'),
+}
+
+
+def fmt(result):
+    return '{:,.0f}/s'.format(result)
+
+
+def main(options):
+    names = list(BENCHMARKS)
+    if options.benchmark:
+        names = [options.benchmark]
+    prev_results = {}
+    if options.source_file:
+        with options.source_file:
+            prev_results = json.load(options.source_file)
+    print('{} byte datagrams, batches of {}\n'.format(options.size,
+                                                      options.batch))
+    new_results = {}
+    for bench in names:
+        func, method = BENCHMARKS[bench]
+        if method is not None and not hasattr(socket.socket, method):
+            continue
+        result = max(func(options) for _ in range(options.repeat))
+        new_results[bench] = result
+        print('{:<24}{:>16}'.format(bench, fmt(result)))
+    if prev_results:
+        print('\nComparing new vs. old\n')
+        for bench, new_result in new_results.items():
+            if bench not in prev_results:
+                continue
+            old_result = prev_results[bench]
+            print('{:<24}{} vs. {} ({:.1%})'.format(
+                  bench, fmt(new_result), fmt(old_result),
+                  new_result / old_result))
+    if options.dest_file:
+        with options.dest_file:
+            json.dump(new_results, options.dest_file, indent=2)
+
+
+if __name__ == '__main__':
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-s', '--size', dest='size', type=int, default=100,
+                        help='size of the datagrams')
+    parser.add_argument('-b', '--batch', dest='batch', type=int, default=64,
+                        help='number of datagrams per batch')
+    parser.add_argument('-t', '--duration', dest='duration', type=float,
+                        default=1.0, help='duration of each run in seconds')
+    parser.add_argument('-f', '--fill', dest='fill', type=int, default=1000,
+                        help='number of datagrams queued before draining '
+                             'them, at most what fits in the receive buffer')
+    parser.add_argument('-n', '--repeat', dest='repeat', type=int, default=3,
+                        help='number of repetitions, the best is kept')
+    parser.add_argument('-r', '--read', dest='source_file',
+                        type=argparse.FileType('r'),
+                        help='file to read benchmark data from to compare '
+                             'against')
+    parser.add_argument('-w', '--write', dest='dest_file',
+                        type=argparse.FileType('w'),
+                        help='file to write benchmark data to')
+    parser.add_argument('--benchmark', dest='benchmark',
+                        choices=list(BENCHMARKS),
+                        help='specific benchmark to run')
+    main(parser.parse_args())
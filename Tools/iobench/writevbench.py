@@ -0,0 +1,129 @@
+"""Benchmark buffered writes of large payloads to a file.
+
+Writes about size MiB to a file opened with open(), with the access
+patterns of log shippers:
+
+- write() of a small header followed by a payload larger than the buffer;
+- writelines() of lists of small records, of large payloads, and of
+  records mixed with large payloads.
+
+A write which doesn't fit in the buffer along with the buffered data is
+sent to the file together with it, without being copied into the buffer.
+The file stays in the page cache, so the results mostly measure the
+copies and the system calls.
+
+Run it with two interpreters, writing the results of the first one with -w
+and comparing the second against them with -r.
+
+"""
+import json
+import os
+import tempfile
+import time
+
+
+def _best(func, repeat):
+    best = None
+    for _ in range(repeat):
+        t0 = time.perf_counter()
+        func()
+        t = time.perf_counter() - t0
+        best = t if best is None else min(best, t)
+    return best
+
+
+def header_payload(payload_size):
+    def bench(name, options):
+        header = b'x' * 100
+        payload = b'p' * payload_size
+        count = options.size * 1024 * 1024 // (payload_size + len(header))
+        def run():
+            with open(name, 'wb') as f:
+                write = f.write
+                for _ in range(count):
+                    write(header)
+                    write(payload)
+        return _best(run, options.repeat)
+    return bench
+
+
+def writelines_batches(sizes):
+    def bench(name, options):
+        batch = [b'r' * size for size in sizes]
+        count = options.size * 1024 * 1024 // sum(sizes)
+        def run():
+            with open(name, 'wb') as f:
+                writelines = f.writelines
+                for _ in range(count):
+                    writelines(batch)
+        return _best(run, options.repeat)
+    return bench
+
+
+BENCHMARKS = {
+    'write 100 + 10000': header_payload(10000),
+    'write 100 + 100000': header_payload(100000),
+    'writelines small': writelines_batches([80] * 50),
+    'writelines large': writelines_batches([20000] * 8),
+    'writelines mixed': writelines_batches([80, 100, 60, 30000] * 4),
+}
+
+
+def fmt(result):
+    return '{:.4f}'.format(result)
+
+
+def main(options):
+    names = list(BENCHMARKS)
+    if options.benchmark:
+        names = [options.benchmark]
+    prev_results = {}
+    if options.source_file:
+        with options.source_file:
+            prev_results = json.load(options.source_file)
+    fd, name = tempfile.mkstemp(dir=options.directory)
+    os.close(fd)
+    try:
+        print('{} MiB written\n'.format(options.size))
+        new_results = {}
+        for bench in names:
+            result = BENCHMARKS[bench](name, options)
+            new_results[bench] = result
+            print('{:<24}{:>16}'.format(bench, fmt(result)))
+    finally:
+        os.unlink(name)
+    if prev_results:
+        print('\nComparing new vs. old\n')
+        for bench, new_result in new_results.items():
+            if bench not in prev_results:
+                continue
+            old_result = prev_results[bench]
+            print('{:<24}{} vs. {} ({:.1%})'.format(
+                  bench, fmt(new_result), fmt(old_result),
+                  new_result / old_result))
+    if options.dest_file:
+        with options.dest_file:
+            json.dump(new_results, options.dest_file, indent=2)
+
+
+if __name__ == '__main__':
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-d', '--directory', dest='directory',
+                        help='directory to create the file in')
+    parser.add_argument('-s', '--size', dest='size', type=int, default=256,
+                        help='size of the data written in MiB')
+    parser.add_argument('-n', '--repeat', dest='repeat', type=int, default=3,
+                        help='number of repetitions, the best is kept')
+    parser.add_argument('-r', '--read', dest='source_file',
+                        type=argparse.FileType('r'),
+                        help='file to read benchmark data from to compare '
+                             'against')
+    parser.add_argument('-w', '--write', dest='dest_file',
+                        type=argparse.FileType('w'),
+                        help='file to write benchmark data to')
+    parser.add_argument('--benchmark', dest='benchmark',
+                        choices=list(BENCHMARKS),
+                        help='specific benchmark to run')
+    main(parser.parse_args())
@@ -0,0 +1,247 @@
+"""Benchmark marshal on the code objects of the standard library.
+
+Compiles every module of the Lib/ tree once, then measures the time taken
+by marshal.dumps() and marshal.loads() on the resulting code objects, the
+size of the data, and the memory allocated by loads().  loads() is also
+timed when every nested code object is used afterwards, which is the worst
+case for the lazy loading of marshal version 5.
+
+The startup benchmark writes the compiled modules as .pyc files for each
+marshal version from 4 on, and imports a set of large modules from them in
+a child process.  It reports the wall time of the child, interpreter
+startup included, and its peak RSS (ru_maxrss).  It runs first, since a
+child inherits the peak RSS of the process it is forked from.
+
+Run it with two interpreters, writing the results of the first one with -w
+and comparing the second against them with -r.
+
+"""
+import json
+import marshal
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+import tracemalloc
+from importlib.util import MAGIC_NUMBER
+
+
+def lib_codes(libdir):
+    """Return the code objects of the modules in libdir."""
+    codes = []
+    for dirpath, dirnames, filenames in os.walk(libdir):
+        dirnames.sort()
+        for fn in sorted(filenames):
+            if not fn.endswith('.py'):
+                continue
+            path = os.path.join(dirpath, fn)
+            with open(path, 'rb') as f:
+                source = f.read()
+            try:
+                codes.append(compile(source, path, 'exec'))
+            except (SyntaxError, ValueError):
+                # bad encodings and test files with deliberate errors
+                continue
+    return codes
+
+
+def touch(code):
+    for const in code.co_consts:
+        if isinstance(const, type(code)):
+            touch(const)
+
+
+def _best(func, repeat):
+    best = None
+    for _ in range(repeat):
+        t0 = time.perf_counter()
+        func()
+        t = time.perf_counter() - t0
+        best = t if best is None else min(best, t)
+    return best
+
+
+def dumps_time(codes, datas, repeat, version):
+    """dumps time (s)"""
+    def run():
+        for code in codes:
+            marshal.dumps(code, version)
+    return _best(run, repeat)
+
+
+def loads_time(codes, datas, repeat, version):
+    """loads time (s)"""
+    def run():
+        for data in datas:
+            marshal.loads(data)
+    return _best(run, repeat)
+
+
+def loads_all_time(codes, datas, repeat, version):
+    """loads+use time (s)"""
+    def run():
+        for data in datas:
+            touch(marshal.loads(data))
+    return _best(run, repeat)
+
+
+def loads_memory(codes, datas, repeat, version):
+    """loads memory (kB)"""
+    tracemalloc.start()
+    try:
+        loaded = [marshal.loads(data) for data in datas]
+        size = tracemalloc.get_traced_memory()[0]
+    finally:
+        tracemalloc.stop()
+    del loaded
+    return size / 1024
+
+
+def marshal_size(codes, datas, repeat, version):
+    """marshal size (kB)"""
+    return sum(map(len, datas)) / 1024
+
+
+BENCHMARKS = (dumps_time, loads_time, loads_all_time, loads_memory,
+              marshal_size)
+
+
+# Imported by the startup benchmark, with everything they import
+STARTUP_MODULES = (
+    'argparse', 'asyncio', 'concurrent.futures', 'csv', 'dataclasses',
+    'decimal', 'email.mime.multipart', 'email.parser', 'http.client',
+    'http.server', 'inspect', 'json', 'logging.handlers', 'pickle', 'pydoc',
+    'tarfile', 'typing', 'unittest', 'urllib.request', 'xml.dom.minidom',
+    'xml.etree.ElementTree', 'zipfile',
+)
+
+STARTUP_SCRIPT = """\
+import resource, sys
+sys.path.insert(0, {pycdir!r})
+for name in {modules!r}:
+    try:
+        __import__(name)
+    except ImportError:
+        # a dependency failed to compile
+        pass
+count = sum(1 for m in list(sys.modules.values())
+            if getattr(m, '__file__', '').startswith({pycdir!r}))
+print(count, resource.getrusage(resource.RUSAGE_SELF).ru_maxrss)
+"""
+
+
+def write_pycs(libdir, pycdir):
+    """Write the modules of libdir as sourceless .pyc files, under a
+    subdirectory of pycdir for each marshal version from 4 on."""
+    codes = lib_codes(libdir)
+    for version in range(4, marshal.version + 1):
+        for code in codes:
+            relpath = os.path.relpath(code.co_filename, libdir)
+            path = os.path.join(pycdir, 'v{}'.format(version),
+                                os.path.splitext(relpath)[0] + '.pyc')
+            os.makedirs(os.path.dirname(path), exist_ok=True)
+            with open(path, 'wb') as f:
+                # flags, mtime and source size are not checked without source
+                f.write(MAGIC_NUMBER + bytes(12) +
+                        marshal.dumps(code, version))
+
+
+def startup(libdir, repeat):
+    """Return the results of the startup benchmark for each version."""
+    results = {}
+    tmpdir = tempfile.mkdtemp(prefix='marshalbench-')
+    try:
+        # compiled in another process to keep this one small
+        subprocess.run([sys.executable, __file__, '--libdir', libdir,
+                        '--write-pycs', tmpdir], check=True)
+        for version in range(4, marshal.version + 1):
+            pycdir = os.path.join(tmpdir, 'v{}'.format(version))
+            script = STARTUP_SCRIPT.format(pycdir=pycdir,
+                                           modules=STARTUP_MODULES)
+            best_time = best_rss = None
+            for _ in range(repeat):
+                t0 = time.perf_counter()
+                out = subprocess.run([sys.executable, '-E', '-S', '-c',
+                                      script],
+                                     stdout=subprocess.PIPE, check=True,
+                                     universal_newlines=True).stdout
+                t = time.perf_counter() - t0
+                count, rss = map(int, out.split())
+                best_time = t if best_time is None else min(best_time, t)
+                best_rss = rss if best_rss is None else min(best_rss, rss)
+            results['startup time v{} (s)'.format(version)] = best_time
+            results['startup maxrss v{} (kB)'.format(version)] = best_rss
+    finally:
+        shutil.rmtree(tmpdir)
+    results['startup modules'] = count
+    return results
+
+
+def fmt(result):
+    return '{:.4f}'.format(result) if isinstance(result, float) else str(result)
+
+
+def main(options):
+    libdir = options.libdir or os.path.dirname(os.__file__)
+    if options.pycdir:
+        write_pycs(libdir, options.pycdir)
+        return
+    version = (marshal.version if options.version is None
+               else options.version)
+    benchmarks = BENCHMARKS
+    if options.benchmark:
+        benchmarks = [b for b in BENCHMARKS if b.__doc__ == options.benchmark]
+    prev_results = {}
+    if options.source_file:
+        with options.source_file:
+            prev_results = json.load(options.source_file)
+    new_results = {}
+    if options.benchmark in (None, 'startup') and os.name == 'posix':
+        new_results.update(startup(libdir, options.repeat))
+    codes = lib_codes(libdir)
+    datas = [marshal.dumps(code, version) for code in codes]
+    print('{} modules, marshal version {}\n'.format(len(codes), version))
+    for name, result in new_results.items():
+        print('{:<24}{:>16}'.format(name, fmt(result)))
+    for benchmark in benchmarks:
+        result = benchmark(codes, datas, options.repeat, version)
+        new_results[benchmark.__doc__] = result
+        print('{:<24}{:>16}'.format(benchmark.__doc__, fmt(result)))
+    if prev_results:
+        print('\nComparing new vs. old\n')
+        for name, new_result in new_results.items():
+            if name not in prev_results:
+                continue
+            old_result = prev_results[name]
+            print('{:<24}{} vs. {} ({:.1%})'.format(
+                  name, fmt(new_result), fmt(old_result),
+                  new_result / old_result))
+    if options.dest_file:
+        with options.dest_file:
+            json.dump(new_results, options.dest_file, indent=2)
+
+
+if __name__ == '__main__':
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-l', '--libdir', dest='libdir',
+                        help='directory to compile (default: the stdlib)')
+    parser.add_argument('-V', '--marshal-version', dest='version', type=int,
+                        help='marshal format version (default: the latest)')
+    parser.add_argument('-n', '--repeat', dest='repeat', type=int, default=3,
+                        help='number of repetitions, the best is kept')
+    parser.add_argument('-r', '--read', dest='source_file',
+                        type=argparse.FileType('r'),
+                        help='file to read benchmark data from to compare '
+                             'against')
+    parser.add_argument('-w', '--write', dest='dest_file',
+                        type=argparse.FileType('w'),
+                        help='file to write benchmark data to')
+    parser.add_argument('--benchmark', dest='benchmark',
+                        help='specific benchmark to run, or startup')
+    parser.add_argument('--write-pycs', dest='pycdir',
+                        help=argparse.SUPPRESS)
+    main(parser.parse_args())
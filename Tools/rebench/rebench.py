@@ -0,0 +1,173 @@
+"""Benchmark regular expression searches on a corpus of log lines.
+
+Generates a reproducible corpus of web server and application log lines,
+then measures the time taken to search every line with each pattern of a
+group of log filters, the way a log scanner applies its filters.  Each
+group exercises one shape of pattern: pure literals, alternations of
+literals, a literal prefix followed by a character class loop, character
+class loops alone, and general patterns.  The lines are searched both as
+str and as bytes.  With --linear the patterns are compiled with the
+re.LINEAR flag, skipping those the linear-time matcher does not support.
+
+Run it with two interpreters, writing the results of the first one with -w
+and comparing the second against them with -r.
+
+"""
+import json
+import random
+import re
+import time
+
+
+METHODS = ['GET', 'POST', 'PUT', 'DELETE', 'HEAD', 'PATCH']
+PATHS = ['/', '/index.html', '/api/v1/users', '/api/v1/orders/{id}',
+         '/api/v2/search?q={word}', '/static/js/app.{id}.js',
+         '/login', '/logout', '/admin/settings', '/health']
+LEVELS = ['DEBUG', 'INFO', 'INFO', 'INFO', 'WARNING', 'ERROR', 'CRITICAL']
+WORDS = ['connection', 'timeout', 'user', 'session', 'cache', 'database',
+         'request', 'response', 'worker', 'queue', 'retry', 'refused',
+         'backend', 'upstream', 'handshake', 'certificate', 'disk', 'memory']
+AGENTS = ['Mozilla/5.0 (X11; Linux x86_64)', 'curl/7.68.0',
+          'python-requests/2.24.0', 'Googlebot/2.1', 'Wget/1.20.3']
+
+
+def make_corpus(nlines, seed=0):
+    """Return a list of nlines log lines."""
+    rnd = random.Random(seed)
+    lines = []
+    for i in range(nlines):
+        ip = '.'.join(str(rnd.randrange(1, 255)) for _ in range(4))
+        stamp = '2020-%02d-%02dT%02d:%02d:%02d' % (
+            rnd.randint(1, 12), rnd.randint(1, 28), rnd.randrange(24),
+            rnd.randrange(60), rnd.randrange(60))
+        if rnd.random() < 0.6:
+            path = rnd.choice(PATHS).format(id=rnd.randrange(100000),
+                                            word=rnd.choice(WORDS))
+            lines.append('%s - - [%s] "%s %s HTTP/1.1" %d %d "%s"' % (
+                ip, stamp, rnd.choice(METHODS), path,
+                rnd.choice([200, 200, 200, 301, 304, 404, 500, 503]),
+                rnd.randrange(100000), rnd.choice(AGENTS)))
+        else:
+            message = ' '.join(rnd.choice(WORDS)
+                               for _ in range(rnd.randint(3, 12)))
+            lines.append('%s %s [worker-%d] %s: %s (pid=%d)' % (
+                stamp, rnd.choice(LEVELS), rnd.randrange(16),
+                rnd.choice(WORDS), message, rnd.randrange(1, 65536)))
+    return lines
+
+
+PATTERNS = {
+    'literal': [
+        r'timeout', r'connection refused', r'/admin/', r'HTTP/1.1" 500',
+        r'Googlebot', r'certificate', r'worker-13', r'handshake',
+    ],
+    'alternation': [
+        r'ERROR|CRITICAL', r'timeout|refused|handshake',
+        r'(?:GET|POST|PUT) /api/', r'" (?:500|503) ', r'curl|Wget|python',
+        r'(?:disk|memory) (?:cache|queue)', r'/login|/logout',
+        r'database|backend|upstream',
+    ],
+    'prefix+class': [
+        r'pid=\d+', r'worker-[0-9]+', r'/api/v1/orders/[0-9]+',
+        r'q=[a-z]+', r'HTTP/1\.[01]" [0-9]{3}', r'app\.\d+\.js',
+        r'\[worker-\w+\]', r'users[/?]?[a-z]*',
+    ],
+    'class': [
+        r'[A-Z]{5,}', r'\d{4}-\d{2}-\d{2}', r'[0-9]+\.[0-9]+\.[0-9]+',
+        r'[a-z]+ [a-z]+ [a-z]+ [a-z]+', r'\w+=\w+', r'[^ ]*Mozilla',
+    ],
+    'general': [
+        r'^\d+\.\d+\.\d+\.\d+ .*" 404', r'(\w+): .*\1', r'(?i)error',
+        r'^.{0,20}(?:INFO|DEBUG)', r'\b(?:retry|queue)\b.*\bdisk\b',
+        r'"(?:[^"\\]|\\.)*"',
+    ],
+}
+
+
+def _best(func, repeat):
+    best = None
+    for _ in range(repeat):
+        t0 = time.perf_counter()
+        func()
+        t = time.perf_counter() - t0
+        best = t if best is None else min(best, t)
+    return best
+
+
+def search_time(patterns, lines, repeat, flags=0):
+    def run():
+        for line in lines:
+            for search in searches:
+                search(line)
+    searches = []
+    for p in patterns:
+        try:
+            searches.append(re.compile(p, flags).search)
+        except re.error:
+            pass
+    return _best(run, repeat)
+
+
+def fmt(result):
+    return '{:.4f}'.format(result)
+
+
+def main(options):
+    lines = make_corpus(options.lines)
+    corpora = [('str', lines),
+               ('bytes', [line.encode('latin-1') for line in lines])]
+    groups = list(PATTERNS)
+    if options.benchmark:
+        groups = [g for g in groups if g == options.benchmark]
+    prev_results = {}
+    if options.source_file:
+        with options.source_file:
+            prev_results = json.load(options.source_file)
+    print('{} lines, {} kB\n'.format(len(lines),
+                                     sum(map(len, lines)) // 1024))
+    new_results = {}
+    for group in groups:
+        for kind, corpus in corpora:
+            patterns = PATTERNS[group]
+            if kind == 'bytes':
+                patterns = [p.encode('latin-1') for p in patterns]
+            name = '{} ({})'.format(group, kind)
+            result = search_time(patterns, corpus, options.repeat,
+                                 re.LINEAR if options.linear else 0)
+            new_results[name] = result
+            print('{:<24}{:>16}'.format(name, fmt(result)))
+    if prev_results:
+        print('\nComparing new vs. old\n')
+        for name, new_result in new_results.items():
+            if name not in prev_results:
+                continue
+            old_result = prev_results[name]
+            print('{:<24}{} vs. {} ({:.1%})'.format(
+                  name, fmt(new_result), fmt(old_result),
+                  new_result / old_result))
+    if options.dest_file:
+        with options.dest_file:
+            json.dump(new_results, options.dest_file, indent=2)
+
+
+if __name__ == '__main__':
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-l', '--lines', dest='lines', type=int,
+                        default=20000, help='number of log lines')
+    parser.add_argument('-n', '--repeat', dest='repeat', type=int, default=3,
+                        help='number of repetitions, the best is kept')
+    parser.add_argument('-r', '--read', dest='source_file',
+                        type=argparse.FileType('r'),
+                        help='file to read benchmark data from to compare '
+                             'against')
+    parser.add_argument('-w', '--write', dest='dest_file',
+                        type=argparse.FileType('w'),
+                        help='file to write benchmark data to')
+    parser.add_argument('--linear', dest='linear', action='store_true',
+                        help='use the linear-time matcher')
+    parser.add_argument('--benchmark', dest='benchmark',
+                        choices=list(PATTERNS),
+                        help='specific pattern group to run')
+    main(parser.parse_args())
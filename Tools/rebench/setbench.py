@@ -0,0 +1,183 @@
+"""Benchmark matching URL paths against a large set of route patterns.
+
+Generates a reproducible table of route patterns, the way a web framework
+compiles its URL map, and a list of request paths, most of which match one
+of the routes.  Each path is then matched against every route, either by
+calling the match() method of each compiled pattern in turn, or with a
+single call to re.RegexSet.match(), which makes one pass over the path.
+
+Run it with two interpreters, writing the results of the first one with -w
+and comparing the second against them with -r.
+
+"""
+import json
+import random
+import re
+import time
+
+
+RESOURCES = ['users', 'orders', 'items', 'carts', 'invoices', 'payments',
+             'products', 'reviews', 'sessions', 'tokens', 'groups', 'teams',
+             'projects', 'issues', 'comments', 'files', 'images', 'events',
+             'messages', 'alerts', 'reports', 'metrics', 'jobs', 'builds',
+             'tags', 'labels', 'webhooks', 'accounts', 'regions']
+ACTIONS = ['edit', 'delete', 'history', 'export', 'share', 'archive']
+SLUG = r'[\w-]+'
+
+
+def make_routes(nroutes, seed=0):
+    """Return a list of nroutes distinct route patterns."""
+    rnd = random.Random(seed)
+    routes = []
+    seen = set()
+    while len(routes) < nroutes:
+        version = 'v%d' % rnd.randint(1, 4)
+        resource = rnd.choice(RESOURCES)
+        sub = rnd.choice(RESOURCES)
+        shape = rnd.randrange(6)
+        if shape == 0:
+            route = r'/api/%s/%s/?$' % (version, resource)
+        elif shape == 1:
+            route = r'/api/%s/%s/(?P<id>\d+)/?$' % (version, resource)
+        elif shape == 2:
+            route = r'/api/%s/%s/(?P<id>\d+)/%s/?$' % (version, resource, sub)
+        elif shape == 3:
+            route = r'/api/%s/%s/(?P<id>\d+)/%s/(?P<sub>\d+)$' % (
+                version, resource, sub)
+        elif shape == 4:
+            route = r'/%s/(?P<slug>%s)/%s$' % (resource, SLUG,
+                                               rnd.choice(ACTIONS))
+        else:
+            route = r'/%s/%s/(?P<slug>%s)\.(?:json|xml|html)$' % (
+                resource, sub, SLUG)
+        if route not in seen:
+            seen.add(route)
+            routes.append(route)
+    return routes
+
+
+def make_paths(npaths, seed=0):
+    """Return a list of npaths request paths."""
+    rnd = random.Random(seed)
+    paths = []
+    for i in range(npaths):
+        version = 'v%d' % rnd.randint(1, 4)
+        resource = rnd.choice(RESOURCES)
+        sub = rnd.choice(RESOURCES)
+        ident = rnd.randrange(1, 10**6)
+        slug = '%s-%d' % (rnd.choice(RESOURCES), rnd.randrange(1000))
+        shape = rnd.randrange(7)
+        if shape == 0:
+            path = '/api/%s/%s/' % (version, resource)
+        elif shape == 1:
+            path = '/api/%s/%s/%d' % (version, resource, ident)
+        elif shape == 2:
+            path = '/api/%s/%s/%d/%s' % (version, resource, ident, sub)
+        elif shape == 3:
+            path = '/api/%s/%s/%d/%s/%d' % (version, resource, ident, sub,
+                                            rnd.randrange(100))
+        elif shape == 4:
+            path = '/%s/%s/%s' % (resource, slug, rnd.choice(ACTIONS))
+        elif shape == 5:
+            path = '/%s/%s/%s.%s' % (resource, sub, slug,
+                                     rnd.choice(['json', 'xml', 'html']))
+        else:
+            # not found
+            path = '/static/%s/%s.css' % (resource, slug)
+        paths.append(path)
+    return paths
+
+
+def _best(func, repeat):
+    best = None
+    for _ in range(repeat):
+        t0 = time.perf_counter()
+        func()
+        t = time.perf_counter() - t0
+        best = t if best is None else min(best, t)
+    return best
+
+
+def loop_time(routes, paths, repeat):
+    def run():
+        for path in paths:
+            [i for i, match in enumerate(matchers) if match(path)]
+    matchers = [re.compile(route).match for route in routes]
+    return _best(run, repeat)
+
+
+def set_time(routes, paths, repeat):
+    def run():
+        for path in paths:
+            match(path)
+    match = re.RegexSet(routes).match
+    return _best(run, repeat)
+
+
+BENCHMARKS = {
+    'pattern loop': loop_time,
+    'regex set': set_time,
+}
+
+
+def fmt(result):
+    return '{:.4f}'.format(result)
+
+
+def main(options):
+    routes = make_routes(options.routes)
+    paths = make_paths(options.paths)
+    names = list(BENCHMARKS)
+    if options.benchmark:
+        names = [options.benchmark]
+    prev_results = {}
+    if options.source_file:
+        with options.source_file:
+            prev_results = json.load(options.source_file)
+    # both ways must find the same routes
+    matchers = [re.compile(route).match for route in routes]
+    regex_set = re.RegexSet(routes)
+    for path in paths[:100]:
+        assert (regex_set.match(path) ==
+                [i for i, match in enumerate(matchers) if match(path)]), path
+    print('{} routes, {} paths\n'.format(len(routes), len(paths)))
+    new_results = {}
+    for name in names:
+        result = BENCHMARKS[name](routes, paths, options.repeat)
+        new_results[name] = result
+        print('{:<24}{:>16}'.format(name, fmt(result)))
+    if prev_results:
+        print('\nComparing new vs. old\n')
+        for name, new_result in new_results.items():
+            if name not in prev_results:
+                continue
+            old_result = prev_results[name]
+            print('{:<24}{} vs. {} ({:.1%})'.format(
+                  name, fmt(new_result), fmt(old_result),
+                  new_result / old_result))
+    if options.dest_file:
+        with options.dest_file:
+            json.dump(new_results, options.dest_file, indent=2)
+
+
+if __name__ == '__main__':
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-R', '--routes', dest='routes', type=int,
+                        default=1000, help='number of route patterns')
+    parser.add_argument('-p', '--paths', dest='paths', type=int,
+                        default=2000, help='number of request paths')
+    parser.add_argument('-n', '--repeat', dest='repeat', type=int, default=3,
+                        help='number of repetitions, the best is kept')
+    parser.add_argument('-r', '--read', dest='source_file',
+                        type=argparse.FileType('r'),
+                        help='file to read benchmark data from to compare '
+                             'against')
+    parser.add_argument('-w', '--write', dest='dest_file',
+                        type=argparse.FileType('w'),
+                        help='file to write benchmark data to')
+    parser.add_argument('--benchmark', dest='benchmark',
+                        choices=list(BENCHMARKS),
+                        help='specific benchmark to run')
+    main(parser.parse_args())
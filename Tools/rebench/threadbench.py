@@ -0,0 +1,134 @@
+"""Benchmark regular expression scanning from several threads.
+
+Splits the log corpus of rebench.py into chunks of a few megabytes and
+has a pool of threads scan every chunk with a group of log filters, the
+way a threaded log scanner does.  The regular expression engine releases
+the GIL while matching a long str, bytes or read-only buffer, so the
+threads can scan their chunks concurrently; the speedup column compares
+each thread count with a single thread.
+
+Run it with two interpreters, writing the results of the first one with -w
+and comparing the second against them with -r.
+
+"""
+import json
+import re
+import threading
+import time
+
+from rebench import make_corpus
+
+
+PATTERNS = [
+    r'timeout|refused|handshake', r'" (?:500|503) ', r'pid=\d+',
+    r'\d{4}-\d{2}-\d{2}', r'\bERROR\b.*\bdisk\b', r'(?i)certificate',
+]
+
+
+def make_chunks(lines, chunk_size):
+    """Join lines into chunks of about chunk_size characters."""
+    chunks = []
+    chunk = []
+    size = 0
+    for line in lines:
+        chunk.append(line)
+        size += len(line) + 1
+        if size >= chunk_size:
+            chunks.append('\n'.join(chunk))
+            chunk = []
+            size = 0
+    if chunk:
+        chunks.append('\n'.join(chunk))
+    return chunks
+
+
+def _best(func, repeat):
+    best = None
+    for _ in range(repeat):
+        t0 = time.perf_counter()
+        func()
+        t = time.perf_counter() - t0
+        best = t if best is None else min(best, t)
+    return best
+
+
+def scan_time(patterns, chunks, nthreads, repeat):
+    def worker(chunks):
+        for chunk in chunks:
+            for findall in findalls:
+                findall(chunk)
+    def run():
+        threads = [threading.Thread(target=worker,
+                                    args=(chunks[i::nthreads],))
+                   for i in range(nthreads)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+    findalls = [re.compile(p).findall for p in patterns]
+    return _best(run, repeat)
+
+
+def fmt(result):
+    return '{:.4f}'.format(result)
+
+
+def main(options):
+    lines = make_corpus(options.lines)
+    chunks = make_chunks(lines, options.chunk_size * 1024)
+    corpora = [('str', PATTERNS, chunks),
+               ('bytes', [p.encode('latin-1') for p in PATTERNS],
+                [c.encode('latin-1') for c in chunks])]
+    threads = [1, 2, 4, 8]
+    if options.threads:
+        threads = [options.threads]
+    prev_results = {}
+    if options.source_file:
+        with options.source_file:
+            prev_results = json.load(options.source_file)
+    print('{} chunks, {} kB\n'.format(len(chunks),
+                                      sum(map(len, chunks)) // 1024))
+    new_results = {}
+    for kind, patterns, corpus in corpora:
+        base = None
+        for nthreads in threads:
+            name = '{} ({} threads)'.format(kind, nthreads)
+            result = scan_time(patterns, corpus, nthreads, options.repeat)
+            base = base or result
+            new_results[name] = result
+            print('{:<24}{:>16}{:>8.2f}x'.format(name, fmt(result),
+                                                  base / result))
+    if prev_results:
+        print('\nComparing new vs. old\n')
+        for name, new_result in new_results.items():
+            if name not in prev_results:
+                continue
+            old_result = prev_results[name]
+            print('{:<24}{} vs. {} ({:.1%})'.format(
+                  name, fmt(new_result), fmt(old_result),
+                  new_result / old_result))
+    if options.dest_file:
+        with options.dest_file:
+            json.dump(new_results, options.dest_file, indent=2)
+
+
+if __name__ == '__main__':
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-l', '--lines', dest='lines', type=int,
+                        default=80000, help='number of log lines')
+    parser.add_argument('-c', '--chunk-size', dest='chunk_size', type=int,
+                        default=1024, help='chunk size in kB')
+    parser.add_argument('-t', '--threads', dest='threads', type=int,
+                        help='specific number of threads to run')
+    parser.add_argument('-n', '--repeat', dest='repeat', type=int, default=3,
+                        help='number of repetitions, the best is kept')
+    parser.add_argument('-r', '--read', dest='source_file',
+                        type=argparse.FileType('r'),
+                        help='file to read benchmark data from to compare '
+                             'against')
+    parser.add_argument('-w', '--write', dest='dest_file',
+                        type=argparse.FileType('w'),
+                        help='file to write benchmark data to')
+    main(parser.parse_args())